@@ -0,0 +1,109 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+
+#include "common/lang/memory.h"
+#include "common/lang/vector.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/hash_group_by_physical_operator.h"
+
+using namespace common;
+
+/**
+ * @brief 按下标读取元组中的一个值，代替需要表结构的 FieldExpr
+ */
+class CellExpr : public Expression
+{
+public:
+  explicit CellExpr(int index) : index_(index) {}
+
+  RC get_value(const Tuple &tuple, Value &value, Trx *trx = nullptr) const override
+  {
+    return tuple.cell_at(index_, value);
+  }
+  ExprType type() const override { return ExprType::FIELD; }
+  AttrType value_type() const override { return AttrType::INTS; }
+
+private:
+  int index_;
+};
+
+/**
+ * @brief 输出 (key, value) 两个整数列的算子，key 有 group_num 种不同的值
+ */
+class IntRowsPhysicalOperator : public PhysicalOperator
+{
+public:
+  IntRowsPhysicalOperator(int row_num, int group_num) : row_num_(row_num), group_num_(group_num)
+  {
+    tuple_.set_names({TupleCellSpec("key"), TupleCellSpec("value")});
+  }
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::STRING_LIST; }
+
+  RC open(Trx *) override
+  {
+    current_ = -1;
+    return RC::SUCCESS;
+  }
+
+  RC next() override
+  {
+    if (++current_ >= row_num_) {
+      return RC::RECORD_EOF;
+    }
+    // 打乱 key 出现的顺序，避免相邻的记录总是属于同一个分组
+    cells_[0].set_int(static_cast<int>((current_ * 2654435761LL) % group_num_));
+    cells_[1].set_int(current_);
+    tuple_.set_cells(cells_);
+    return RC::SUCCESS;
+  }
+
+  RC     close() override { return RC::SUCCESS; }
+  Tuple *current_tuple() override { return &tuple_; }
+
+private:
+  int            row_num_;
+  int            group_num_;
+  int            current_ = -1;
+  vector<Value>  cells_{Value(0), Value(0)};
+  ValueListTuple tuple_;
+};
+
+static void BM_HashGroupBy(benchmark::State &state)
+{
+  const int row_num   = 1000000;
+  const int group_num = static_cast<int>(state.range(0));
+
+  for (auto _ : state) {
+    // select key, sum(value) from t group by key
+    AggregateExpr                  aggregate_expr(AggregateType::SUM, make_unique<CellExpr>(1));
+    vector<unique_ptr<Expression>> group_by_exprs;
+    group_by_exprs.push_back(make_unique<CellExpr>(0));
+    HashGroupByPhysicalOperator group_by(std::move(group_by_exprs), vector<Expression *>{&aggregate_expr});
+    group_by.add_child(make_unique<IntRowsPhysicalOperator>(row_num, group_num));
+
+    group_by.open(nullptr);
+    int groups = 0;
+    while (group_by.next() == RC::SUCCESS) {
+      groups++;
+    }
+    group_by.close();
+    if (groups != group_num) {
+      state.SkipWithError("unexpected group number");
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * row_num);
+}
+
+BENCHMARK(BM_HashGroupBy)->Arg(16)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
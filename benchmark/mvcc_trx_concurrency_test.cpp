@@ -0,0 +1,185 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+
+#include "common/log/log.h"
+#include "common/lang/chrono.h"
+#include "common/lang/memory.h"
+#include "common/lang/thread.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/trx/mvcc_trx.h"
+
+using namespace common;
+using namespace benchmark;
+
+struct Stat
+{
+  int64_t begin_count       = 0;
+  int64_t commit_count      = 0;
+  int64_t commit_fail_count = 0;
+};
+
+/**
+ * @brief 测试事务开始、提交的吞吐量
+ * @details 只测试事务管理器本身的开销，事务中不包含任何数据操作
+ */
+class TrxBenchmark : public Fixture
+{
+public:
+  void SetUp(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      while (!setup_done_) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+      }
+      return;
+    }
+
+    LoggerFactory::init_default("mvcc_trx_concurrency.log", LOG_LEVEL_INFO);
+    trx_kit_ = make_unique<MvccTrxKit>();
+    trx_kit_->init();
+    setup_done_ = true;
+  }
+
+  void TearDown(const State &state) override
+  {
+    if (0 != state.thread_index()) {
+      return;
+    }
+
+    setup_done_ = false;
+    trx_kit_.reset();
+  }
+
+  void Commit(Trx *trx, Stat &stat)
+  {
+    trx->start_if_need();
+    stat.begin_count++;
+
+    RC rc = trx->commit();
+    if (OB_SUCC(rc)) {
+      stat.commit_count++;
+    } else {
+      stat.commit_fail_count++;
+    }
+  }
+
+  void ReportStat(State &state, const Stat &stat)
+  {
+    state.counters["begin"]       = Counter(stat.begin_count, Counter::kIsRate);
+    state.counters["commit"]      = Counter(stat.commit_count, Counter::kIsRate);
+    state.counters["commit_fail"] = Counter(stat.commit_fail_count, Counter::kIsRate);
+  }
+
+protected:
+  volatile bool          setup_done_ = false;
+  unique_ptr<MvccTrxKit> trx_kit_;
+  VacuousLogHandler      log_handler_;
+};
+
+/**
+ * @brief 每个事务都是一个新的事务对象，类似每个请求一个连接
+ */
+BENCHMARK_DEFINE_F(TrxBenchmark, CreateBeginCommit)(State &state)
+{
+  Stat stat;
+  for (auto _ : state) {
+    Trx *trx = trx_kit_->create_trx(log_handler_);
+    Commit(trx, stat);
+    trx_kit_->destroy_trx(trx);
+  }
+
+  ReportStat(state, stat);
+}
+
+BENCHMARK_REGISTER_F(TrxBenchmark, CreateBeginCommit)->Threads(1)->Threads(4)->Threads(16);
+
+/**
+ * @brief 每个线程复用一个事务对象，类似会话中连续执行多个事务
+ */
+BENCHMARK_DEFINE_F(TrxBenchmark, BeginCommit)(State &state)
+{
+  Stat stat;
+  Trx *trx = trx_kit_->create_trx(log_handler_);
+  for (auto _ : state) {
+    Commit(trx, stat);
+  }
+  trx_kit_->destroy_trx(trx);
+
+  ReportStat(state, stat);
+}
+
+BENCHMARK_REGISTER_F(TrxBenchmark, BeginCommit)->Threads(1)->Threads(4)->Threads(16);
+
+/**
+ * @brief 在事务不断开始、提交的同时获取活跃事务快照
+ */
+BENCHMARK_DEFINE_F(TrxBenchmark, ActiveSnapshot)(State &state)
+{
+  Stat            stat;
+  vector<int32_t> trx_ids;
+  Trx            *trx = trx_kit_->create_trx(log_handler_);
+  for (auto _ : state) {
+    trx->start_if_need();
+    stat.begin_count++;
+    trx_kit_->active_trx_ids(trx_ids);
+    if (OB_SUCC(trx->commit())) {
+      stat.commit_count++;
+    } else {
+      stat.commit_fail_count++;
+    }
+  }
+  trx_kit_->destroy_trx(trx);
+
+  ReportStat(state, stat);
+}
+
+BENCHMARK_REGISTER_F(TrxBenchmark, ActiveSnapshot)->Threads(4)->Threads(16);
+
+/**
+ * @brief 多个事务同时修改少量热点行，只测试行锁表的加锁和释放
+ * @details state.range(0) 是热点行的个数
+ */
+BENCHMARK_DEFINE_F(TrxBenchmark, HotRowLock)(State &state)
+{
+  Stat          stat;
+  int64_t       lock_fail_count = 0;
+  const int     hot_rows        = static_cast<int>(state.range(0));
+  RowLockTable &row_lock_table  = trx_kit_->row_lock_table();
+  Trx          *trx             = trx_kit_->create_trx(log_handler_);
+  int           i               = state.thread_index();
+  for (auto _ : state) {
+    trx->start_if_need();
+    stat.begin_count++;
+    RID rid(1, i++ % hot_rows);
+    if (OB_FAIL(row_lock_table.lock(trx->id(), 1 /*table_id*/, rid))) {
+      lock_fail_count++;
+    } else {
+      row_lock_table.unlock(trx->id(), 1 /*table_id*/, rid);
+    }
+
+    if (OB_SUCC(trx->commit())) {
+      stat.commit_count++;
+    } else {
+      stat.commit_fail_count++;
+    }
+  }
+  trx_kit_->destroy_trx(trx);
+
+  ReportStat(state, stat);
+  state.counters["lock_fail"] = Counter(lock_fail_count, Counter::kIsRate);
+}
+
+BENCHMARK_REGISTER_F(TrxBenchmark, HotRowLock)->Arg(1)->Arg(64)->Threads(1)->Threads(4)->Threads(16);
+
+////////////////////////////////////////////////////////////////////////////////
+
+BENCHMARK_MAIN();
@@ -0,0 +1,163 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+#include "common/lang/filesystem.h"
+#include "common/lang/memory.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#define private public
+#define protected public
+#include "storage/table/table.h"
+#undef private
+#undef protected
+
+#include "common/log/log.h"
+#include "sql/expr/aggregate_hash_table.h"
+#include "sql/expr/expression.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/record/record_manager.h"
+
+using namespace common;
+
+/**
+ * @brief 测试 PAX 页面的列编码
+ * @details 表结构为 (id int, status char(16), score int)，status 列有 state.range(0) 种不同的值。
+ * 不同的值较少时 status 列使用字典编码，很多时退化为不编码，对比两种情况下每个页面存放的记录数，
+ * 以及取列数据、过滤和分组的速度。
+ */
+class PaxEncodingBenchmark : public benchmark::Fixture
+{
+public:
+  static constexpr int RECORD_SIZE = 4 + 16 + 4;
+
+  void SetUp(const ::benchmark::State &state) override
+  {
+    LoggerFactory::init_default("pax_encoding_performance_test.log", LOG_LEVEL_WARN);
+
+    filesystem::remove(file_name_);
+    bpm_ = make_unique<BufferPoolManager>();
+    bpm_->init(make_unique<VacuousDoubleWriteBuffer>());
+    bpm_->create_file(file_name_);
+    bpm_->open_file(log_handler_, file_name_, buffer_pool_);
+
+    table_meta_.fields_.resize(3);
+    table_meta_.fields_[0].init("id", AttrType::INTS, 0, 4, true /*visible*/, 0);
+    table_meta_.fields_[1].init("status", AttrType::CHARS, 4, 16, true /*visible*/, 1);
+    table_meta_.fields_[2].init("score", AttrType::INTS, 20, 4, true /*visible*/, 2);
+
+    Frame *frame = nullptr;
+    buffer_pool_->allocate_page(&frame);
+    handler_.init_empty_page(*buffer_pool_, log_handler_, frame->page_num(), RECORD_SIZE, &table_meta_);
+    frame->unpin();
+
+    record_num_           = 0;
+    const int cardinality = static_cast<int>(state.range(0));
+    char      record[RECORD_SIZE];
+    for (int i = 0; !handler_.is_full(); i++) {
+      memset(record, 0, sizeof(record));
+      string status = "status-" + std::to_string(i % cardinality);
+      int    score  = i;
+      memcpy(record, &i, sizeof(i));
+      strncpy(record + 4, status.c_str(), 16);
+      memcpy(record + 20, &score, sizeof(score));
+      RID rid;
+      if (handler_.insert_record(record, &rid) != RC::SUCCESS) {
+        break;
+      }
+      record_num_++;
+    }
+
+    chunk_.add_column(make_unique<Column>(*table_meta_.field(1)), 1);
+    chunk_.add_column(make_unique<Column>(*table_meta_.field(2)), 2);
+  }
+
+  void TearDown(const ::benchmark::State &state) override
+  {
+    chunk_.reset();
+    handler_.cleanup();
+    bpm_->close_file(file_name_);
+    bpm_.reset();
+    filesystem::remove(file_name_);
+  }
+
+  void report(benchmark::State &state)
+  {
+    state.counters["rows_per_page"] = record_num_;
+    state.SetItemsProcessed(state.iterations() * record_num_);
+  }
+
+protected:
+  const char                   *file_name_ = "pax_encoding_performance_test.bp";
+  VacuousLogHandler             log_handler_;
+  unique_ptr<BufferPoolManager> bpm_;
+  DiskBufferPool               *buffer_pool_ = nullptr;
+  TableMeta                     table_meta_;
+  PaxRecordPageHandler          handler_;
+  Chunk                         chunk_;
+  int                           record_num_ = 0;
+};
+
+BENCHMARK_DEFINE_F(PaxEncodingBenchmark, Scan)(benchmark::State &state)
+{
+  for (auto _ : state) {
+    chunk_.reset_data();
+    handler_.get_chunk(chunk_);
+    benchmark::DoNotOptimize(chunk_.rows());
+  }
+  report(state);
+}
+
+BENCHMARK_DEFINE_F(PaxEncodingBenchmark, Filter)(benchmark::State &state)
+{
+  FieldExpr *field_expr = new FieldExpr(Field(nullptr, table_meta_.field(1)));
+  field_expr->set_pos(0);
+  ComparisonExpr  expr(CompOp::EQUAL_TO, unique_ptr<Expression>(field_expr), make_unique<ValueExpr>(Value("status-1")));
+  vector<uint8_t> select;
+  for (auto _ : state) {
+    chunk_.reset_data();
+    handler_.get_chunk(chunk_);
+    select.assign(chunk_.rows(), 1);
+    expr.eval(chunk_, select);
+    benchmark::DoNotOptimize(select.data());
+  }
+  report(state);
+}
+
+BENCHMARK_DEFINE_F(PaxEncodingBenchmark, GroupBy)(benchmark::State &state)
+{
+  AggregateExpr        aggregate_expr(AggregateType::SUM, nullptr);
+  vector<Expression *> aggregate_exprs{&aggregate_expr};
+  Chunk                groups_chunk;
+  Chunk                aggrs_chunk;
+  groups_chunk.add_column(make_unique<Column>(), 0);
+  aggrs_chunk.add_column(make_unique<Column>(), 0);
+  for (auto _ : state) {
+    StandardAggregateHashTable hash_table(aggregate_exprs);
+    chunk_.reset_data();
+    handler_.get_chunk(chunk_);
+    groups_chunk.column(0).reference(chunk_.column(0));
+    aggrs_chunk.column(0).reference(chunk_.column(1));
+    hash_table.add_chunk(groups_chunk, aggrs_chunk);
+    benchmark::DoNotOptimize(hash_table.size());
+  }
+  report(state);
+}
+
+// 4 种不同的值时使用字典编码，1000000 种不同的值时不编码
+BENCHMARK_REGISTER_F(PaxEncodingBenchmark, Scan)->Arg(4)->Arg(1000000);
+BENCHMARK_REGISTER_F(PaxEncodingBenchmark, Filter)->Arg(4)->Arg(1000000);
+BENCHMARK_REGISTER_F(PaxEncodingBenchmark, GroupBy)->Arg(4)->Arg(1000000);
+
+BENCHMARK_MAIN();
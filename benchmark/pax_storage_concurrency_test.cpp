@@ -81,6 +81,7 @@ public:
   virtual string Name() const = 0;
 
   string record_filename() const { return this->Name() + ".record"; }
+  string fsm_filename() const { return this->Name() + ".fsm"; }
 
   virtual void SetUp(const State &state)
   {
@@ -107,6 +108,16 @@ public:
       LOG_WARN("failed to open record file. filename=%s, rc=%s", record_filename.c_str(), strrc(rc));
       throw runtime_error("failed to open record file");
     }
+
+    ::remove(this->fsm_filename().c_str());
+    rc = bpm_.create_file(this->fsm_filename().c_str());
+    if (OB_SUCC(rc)) {
+      rc = bpm_.open_file(log_handler_, this->fsm_filename().c_str(), fsm_buffer_pool_);
+    }
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to open free space map file. rc=%s", strrc(rc));
+      throw runtime_error("failed to open free space map file");
+    }
     table_meta_ = new TableMeta;
     table_meta_->fields_.resize(2);
     table_meta_->fields_[0].attr_type_ = AttrType::INTS;
@@ -115,12 +126,17 @@ public:
     table_meta_->fields_[1].attr_type_ = AttrType::CHARS;
     table_meta_->fields_[1].attr_len_  = 11;
     table_meta_->fields_[1].field_id_  = 1;
-    handler_                           = new RecordFileHandler(StorageFormat::PAX_FORMAT);
+    handler_                           = new RecordFileHandler(storage_format_);
     rc                                 = handler_->init(*buffer_pool_, log_handler_, table_meta_);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to init record file handler. rc=%s", strrc(rc));
       throw runtime_error("failed to init record file handler");
     }
+    rc = handler_->init_free_space_map(*fsm_buffer_pool_);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to init free space map. rc=%s", strrc(rc));
+      throw runtime_error("failed to init free space map");
+    }
     LOG_INFO("test %s setup done. threads=%d, thread index=%d", 
              this->Name().c_str(), state.threads(), state.thread_index());
   }
@@ -141,6 +157,9 @@ public:
     buffer_pool_->close_file();
     bpm_.close_file(this->record_filename().c_str());
     buffer_pool_ = nullptr;
+    fsm_buffer_pool_->close_file();
+    bpm_.close_file(this->fsm_filename().c_str());
+    fsm_buffer_pool_ = nullptr;
     LOG_INFO("test %s teardown done. threads=%d, thread index=%d",
         this->Name().c_str(),
         state.threads(),
@@ -271,8 +290,10 @@ public:
   }
 
 protected:
+  StorageFormat      storage_format_ = StorageFormat::PAX_FORMAT;
   BufferPoolManager  bpm_{512};
   DiskBufferPool    *buffer_pool_ = nullptr;
+  DiskBufferPool    *fsm_buffer_pool_ = nullptr;
   RecordFileHandler *handler_     = nullptr;
   VacuousLogHandler  log_handler_;
   TableMeta         *table_meta_ = nullptr;
@@ -436,6 +457,87 @@ BENCHMARK_REGISTER_F(DISABLED_ScanChunkBenchmark, ScanChunk)->Threads(10)->Arg(4
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * @brief 对比列存与行存的全表扫描吞吐
+ * @details 对第一列求和。PAX 格式使用 ChunkFileScanner 按页读取列数据，
+ * ROW 格式使用 RecordFileScanner 逐条读取记录。参数1是记录数，参数2是存储格式。
+ */
+class ColumnScanBenchmark : public BenchmarkBase
+{
+public:
+  string Name() const override { return "column_scan"; }
+
+  void SetUp(const State &state) override
+  {
+    storage_format_ = static_cast<StorageFormat>(state.range(1));
+    BenchmarkBase::SetUp(state);
+
+    int32_t max = state.range(0);
+    ASSERT(max > 0, "invalid argument count. %ld", state.range(0));
+    vector<RID> rids;
+    FillUp(0, max, rids);
+  }
+
+  int64_t SumFirstColumn()
+  {
+    int64_t sum = 0;
+    Table   table;
+    table.table_meta_.storage_format_ = storage_format_;
+    if (storage_format_ == StorageFormat::PAX_FORMAT) {
+      ChunkFileScanner scanner;
+      RC rc = scanner.open_scan_chunk(&table, *buffer_pool_, log_handler_, ReadWriteMode::READ_ONLY);
+      ASSERT(rc == RC::SUCCESS, "failed to open chunk scanner. rc=%s", strrc(rc));
+      Chunk     chunk;
+      FieldMeta fm;
+      fm.init("col1", AttrType::INTS, 0, 4, true, 0);
+      chunk.add_column(make_unique<Column>(fm, 2048), 0);
+      while (OB_SUCC(scanner.next_chunk(chunk))) {
+        const int32_t *values = reinterpret_cast<const int32_t *>(chunk.column(0).data());
+        for (int i = 0; i < chunk.rows(); i++) {
+          sum += values[i];
+        }
+        chunk.reset_data();
+      }
+      scanner.close_scan();
+    } else {
+      RecordFileScanner scanner;
+      VacuousTrx        trx;
+      RC rc = scanner.open_scan(&table, *buffer_pool_, &trx, log_handler_, ReadWriteMode::READ_ONLY, nullptr);
+      ASSERT(rc == RC::SUCCESS, "failed to open record scanner. rc=%s", strrc(rc));
+      Record record;
+      while (OB_SUCC(scanner.next(record))) {
+        sum += *reinterpret_cast<const int32_t *>(record.data());
+      }
+      scanner.close_scan();
+    }
+    return sum;
+  }
+};
+
+BENCHMARK_DEFINE_F(ColumnScanBenchmark, ColumnScan)(State &state)
+{
+  const int64_t records  = state.range(0);
+  const int64_t expected = records * (records - 1) / 2;
+  int64_t       mismatch = 0;
+  for (auto _ : state) {
+    int64_t sum = SumFirstColumn();
+    if (sum != expected) {
+      mismatch++;
+    }
+    DoNotOptimize(sum);
+  }
+
+  state.SetItemsProcessed(state.iterations() * records);
+  state.SetLabel(state.range(1) == static_cast<int64_t>(StorageFormat::PAX_FORMAT) ? "pax" : "row");
+  state.counters["mismatch"] = mismatch;
+}
+
+BENCHMARK_REGISTER_F(ColumnScanBenchmark, ColumnScan)
+    ->Args({100 * 1000, static_cast<int64_t>(StorageFormat::PAX_FORMAT)})
+    ->Args({100 * 1000, static_cast<int64_t>(StorageFormat::ROW_FORMAT)});
+
+////////////////////////////////////////////////////////////////////////////////
+
 struct DISABLED_MixtureBenchmark : public BenchmarkBase
 {
   string Name() const override { return "mixture"; }
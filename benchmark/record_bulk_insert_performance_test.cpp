@@ -0,0 +1,187 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+
+#include "common/lang/filesystem.h"
+#include "common/lang/memory.h"
+#include "common/lang/stdexcept.h"
+#include "common/log/log.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/disk_log_handler.h"
+#include "storage/clog/integrated_log_replayer.h"
+#include "storage/record/record_manager.h"
+
+using namespace common;
+
+/**
+ * @brief 测试导入大量记录的速度
+ * @details 记录结构为 (id int, name char(16), score int)，对比逐条插入和批量插入 state.range(0) 条记录。
+ * 逐条插入时每条记录都要查找空闲空间映射、加页面锁并记录一条日志，批量插入只追加到新页面，
+ * 每个页面记录一条整页镜像日志。
+ */
+class RecordBulkInsertBenchmark : public benchmark::Fixture
+{
+public:
+  static constexpr int RECORD_SIZE = 4 + 16 + 4;
+
+  void SetUp(const ::benchmark::State &state) override
+  {
+    LoggerFactory::init_default("record_bulk_insert_performance_test.log", LOG_LEVEL_WARN);
+  }
+
+  /// 每次测试使用新的文件和日志
+  void open()
+  {
+    filesystem::remove_all(directory_);
+    filesystem::create_directories(directory_);
+    const string record_file = (directory_ / "bulk_insert.bp").string();
+    const string fsm_file    = (directory_ / "bulk_insert.fsm").string();
+
+    bpm_ = make_unique<BufferPoolManager>();
+    bpm_->init(make_unique<VacuousDoubleWriteBuffer>());
+
+    log_handler_  = make_unique<DiskLogHandler>();
+    log_replayer_ = make_unique<IntegratedLogReplayer>(*bpm_);
+    RC rc         = log_handler_->init(directory_.c_str());
+    if (OB_SUCC(rc)) {
+      rc = log_handler_->replay(*log_replayer_, 0);
+    }
+    if (OB_SUCC(rc)) {
+      rc = log_handler_->start();
+    }
+    if (OB_SUCC(rc)) {
+      rc = bpm_->create_file(record_file.c_str());
+    }
+    if (OB_SUCC(rc)) {
+      rc = bpm_->open_file(*log_handler_, record_file.c_str(), buffer_pool_);
+    }
+    if (OB_SUCC(rc)) {
+      rc = bpm_->create_file(fsm_file.c_str());
+    }
+    if (OB_SUCC(rc)) {
+      rc = bpm_->open_file(*log_handler_, fsm_file.c_str(), fsm_buffer_pool_);
+    }
+
+    handler_ = make_unique<RecordFileHandler>(StorageFormat::ROW_FORMAT);
+    if (OB_SUCC(rc)) {
+      rc = handler_->init(*buffer_pool_, *log_handler_, nullptr);
+    }
+    if (OB_SUCC(rc)) {
+      rc = handler_->init_free_space_map(*fsm_buffer_pool_);
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to open record file. rc=%s", strrc(rc));
+      throw runtime_error("failed to open record file");
+    }
+  }
+
+  void close()
+  {
+    handler_->close();
+    handler_.reset();
+    log_handler_->stop();
+    log_handler_->await_termination();
+    bpm_.reset();
+    log_replayer_.reset();
+    log_handler_.reset();
+    filesystem::remove_all(directory_);
+  }
+
+  void make_record(int64_t i, char *record)
+  {
+    const int32_t id    = static_cast<int32_t>(i);
+    const int32_t score = static_cast<int32_t>(i % 100);
+    memset(record, 0, RECORD_SIZE);
+    memcpy(record, &id, sizeof(id));
+    snprintf(record + 4, 16, "name-%d", id);
+    memcpy(record + 20, &score, sizeof(score));
+  }
+
+protected:
+  filesystem::path                  directory_ = "record_bulk_insert_performance_test";
+  unique_ptr<BufferPoolManager>     bpm_;
+  unique_ptr<DiskLogHandler>        log_handler_;
+  unique_ptr<IntegratedLogReplayer> log_replayer_;
+  DiskBufferPool                   *buffer_pool_     = nullptr;
+  DiskBufferPool                   *fsm_buffer_pool_ = nullptr;
+  unique_ptr<RecordFileHandler>     handler_;
+};
+
+BENCHMARK_DEFINE_F(RecordBulkInsertBenchmark, InsertRecord)(benchmark::State &state)
+{
+  const int64_t record_num = state.range(0);
+  char          record[RECORD_SIZE];
+  for (auto _ : state) {
+    state.PauseTiming();
+    open();
+    state.ResumeTiming();
+
+    for (int64_t i = 0; i < record_num; i++) {
+      make_record(i, record);
+      RID rid;
+      if (OB_FAIL(handler_->insert_record(record, RECORD_SIZE, &rid))) {
+        state.SkipWithError("failed to insert record");
+        break;
+      }
+    }
+
+    state.PauseTiming();
+    close();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * record_num);
+}
+
+BENCHMARK_DEFINE_F(RecordBulkInsertBenchmark, BulkInsert)(benchmark::State &state)
+{
+  const int64_t record_num = state.range(0);
+  char          record[RECORD_SIZE];
+  for (auto _ : state) {
+    state.PauseTiming();
+    open();
+    state.ResumeTiming();
+
+    RecordFileBulkInserter inserter;
+    inserter.open(*handler_, RECORD_SIZE);
+    for (int64_t i = 0; i < record_num; i++) {
+      make_record(i, record);
+      RID rid;
+      if (OB_FAIL(inserter.insert_record(record, &rid))) {
+        state.SkipWithError("failed to insert record");
+        break;
+      }
+    }
+    inserter.close();
+    state.counters["pages"] = inserter.page_count();
+
+    state.PauseTiming();
+    close();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * record_num);
+}
+
+BENCHMARK_REGISTER_F(RecordBulkInsertBenchmark, InsertRecord)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(RecordBulkInsertBenchmark, BulkInsert)
+    ->Arg(100000)
+    ->Arg(1000000)
+    ->Arg(10000000)
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
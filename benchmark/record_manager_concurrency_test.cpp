@@ -77,6 +77,7 @@ public:
   virtual string Name() const = 0;
 
   string record_filename() const { return this->Name() + ".record"; }
+  string fsm_filename() const { return this->Name() + ".fsm"; }
 
   virtual void SetUp(const State &state)
   {
@@ -104,12 +105,27 @@ public:
       throw runtime_error("failed to open record file");
     }
 
+    ::remove(this->fsm_filename().c_str());
+    rc = bpm_.create_file(this->fsm_filename().c_str());
+    if (OB_SUCC(rc)) {
+      rc = bpm_.open_file(log_handler_, this->fsm_filename().c_str(), fsm_buffer_pool_);
+    }
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to open free space map file. rc=%s", strrc(rc));
+      throw runtime_error("failed to open free space map file");
+    }
+
     handler_ = new RecordFileHandler(StorageFormat::ROW_FORMAT);
     rc       = handler_->init(*buffer_pool_, log_handler_, nullptr);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to init record file handler. rc=%s", strrc(rc));
       throw runtime_error("failed to init record file handler");
     }
+    rc = handler_->init_free_space_map(*fsm_buffer_pool_);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to init free space map. rc=%s", strrc(rc));
+      throw runtime_error("failed to init free space map");
+    }
     LOG_INFO("test %s setup done. threads=%d, thread index=%d", 
              this->Name().c_str(), state.threads(), state.thread_index());
   }
@@ -128,6 +144,9 @@ public:
     buffer_pool_->close_file();
     bpm_.close_file(this->record_filename().c_str());
     buffer_pool_ = nullptr;
+    fsm_buffer_pool_->close_file();
+    bpm_.close_file(this->fsm_filename().c_str());
+    fsm_buffer_pool_ = nullptr;
     LOG_INFO("test %s teardown done. threads=%d, thread index=%d",
         this->Name().c_str(),
         state.threads(),
@@ -231,6 +250,7 @@ public:
 protected:
   BufferPoolManager  bpm_{512};
   DiskBufferPool    *buffer_pool_ = nullptr;
+  DiskBufferPool    *fsm_buffer_pool_ = nullptr;
   RecordFileHandler *handler_;
   VacuousLogHandler  log_handler_;
 };
@@ -0,0 +1,149 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <benchmark/benchmark.h>
+
+#include "common/lang/memory.h"
+#include "common/lang/vector.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/hash_semi_join_physical_operator.h"
+#include "sql/operator/logical_operator.h"
+#include "sql/operator/predicate_physical_operator.h"
+#include "sql/stmt/select_stmt.h"
+
+using namespace common;
+
+/**
+ * @brief 按下标读取元组中的一个值，代替需要表结构的 FieldExpr
+ */
+class CellExpr : public Expression
+{
+public:
+  explicit CellExpr(int index) : index_(index) {}
+
+  RC get_value(const Tuple &tuple, Value &value, Trx *trx = nullptr) const override
+  {
+    return tuple.cell_at(index_, value);
+  }
+  ExprType type() const override { return ExprType::FIELD; }
+  AttrType value_type() const override { return AttrType::INTS; }
+
+private:
+  int index_;
+};
+
+/**
+ * @brief 输出一个整数列的算子，第 i 行的值是 i * step
+ */
+class IntRowsPhysicalOperator : public PhysicalOperator
+{
+public:
+  IntRowsPhysicalOperator(int row_num, int step) : row_num_(row_num), step_(step)
+  {
+    tuple_.set_names({TupleCellSpec("id")});
+  }
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::STRING_LIST; }
+
+  RC open(Trx *) override
+  {
+    current_ = -1;
+    return RC::SUCCESS;
+  }
+
+  RC next() override
+  {
+    if (++current_ >= row_num_) {
+      return RC::RECORD_EOF;
+    }
+    cells_[0].set_int(current_ * step_);
+    tuple_.set_cells(cells_);
+    return RC::SUCCESS;
+  }
+
+  RC     close() override { return RC::SUCCESS; }
+  Tuple *current_tuple() override { return &tuple_; }
+
+private:
+  int            row_num_;
+  int            step_;
+  int            current_ = -1;
+  vector<Value>  cells_{Value(0)};
+  ValueListTuple tuple_;
+};
+
+/// 外表的行数，子查询的行数由参数指定。子查询的值是偶数，所以外表大约一半的行满足 IN
+static const int OUTER_ROW_NUM = 10000;
+
+static int drain(PhysicalOperator &oper)
+{
+  int rows = 0;
+  oper.open(nullptr);
+  while (oper.next() == RC::SUCCESS) {
+    rows++;
+  }
+  oper.close();
+  return rows;
+}
+
+/**
+ * @brief select id from t1 where id in (select id from t2)，每行都在 ComparisonExpr 中执行子查询
+ * @param cacheable 为 false 时每一行都重新执行子查询，为 true 时子查询的结果只物化一次
+ */
+static void run_subquery_predicate(benchmark::State &state, bool cacheable)
+{
+  const int subquery_row_num = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    auto subquery = make_unique<SubqueryExpr>(nullptr);
+    subquery->set_physical_operator(make_unique<IntRowsPhysicalOperator>(subquery_row_num, 2));
+    if (cacheable) {
+      subquery->set_outer_fields({});
+    }
+    auto comparison = make_unique<ComparisonExpr>(CompOp::IN, make_unique<CellExpr>(0), std::move(subquery));
+
+    PredicatePhysicalOperator predicate(std::move(comparison));
+    predicate.add_child(make_unique<IntRowsPhysicalOperator>(OUTER_ROW_NUM, 1));
+    benchmark::DoNotOptimize(drain(predicate));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * OUTER_ROW_NUM);
+}
+
+static void BM_InSubqueryPerRow(benchmark::State &state) { run_subquery_predicate(state, false /*cacheable*/); }
+
+static void BM_InSubqueryCached(benchmark::State &state) { run_subquery_predicate(state, true /*cacheable*/); }
+
+static void run_semi_join(benchmark::State &state, JoinType join_type)
+{
+  const int subquery_row_num = static_cast<int>(state.range(0));
+  for (auto _ : state) {
+    vector<unique_ptr<Expression>> left_keys;
+    vector<unique_ptr<Expression>> right_keys;
+    left_keys.push_back(make_unique<CellExpr>(0));
+    right_keys.push_back(make_unique<CellExpr>(0));
+    HashSemiJoinPhysicalOperator join(join_type, std::move(left_keys), std::move(right_keys));
+    join.add_child(make_unique<IntRowsPhysicalOperator>(OUTER_ROW_NUM, 1));
+    join.add_child(make_unique<IntRowsPhysicalOperator>(subquery_row_num, 2));
+    benchmark::DoNotOptimize(drain(join));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * OUTER_ROW_NUM);
+}
+
+/// select id from t1 where id in (select id from t2)，改写成哈希半连接
+static void BM_InSemiJoin(benchmark::State &state) { run_semi_join(state, JoinType::SEMI); }
+
+/// select id from t1 where id not in (select id from t2)，改写成考虑 null 的哈希反连接
+static void BM_NotInAntiJoin(benchmark::State &state) { run_semi_join(state, JoinType::NULL_AWARE_ANTI); }
+
+BENCHMARK(BM_InSubqueryPerRow)->Arg(100)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_InSubqueryCached)->Arg(100)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_InSemiJoin)->Arg(100)->Arg(10000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_NotInAntiJoin)->Arg(100)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -386,4 +386,43 @@ int readn(int fd, void *buf, int size)
   }
   return 0;
 }
+
+int pwriten(int fd, const void *buf, int size, int64_t offset)
+{
+  const char *tmp = (const char *)buf;
+  while (size > 0) {
+    const ssize_t ret = ::pwrite(fd, tmp, size, offset);
+    if (ret >= 0) {
+      tmp += ret;
+      size -= ret;
+      offset += ret;
+      continue;
+    }
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
+
+int preadn(int fd, void *buf, int size, int64_t offset)
+{
+  char *tmp = (char *)buf;
+  while (size > 0) {
+    const ssize_t ret = ::pread(fd, tmp, size, offset);
+    if (ret > 0) {
+      tmp += ret;
+      size -= ret;
+      offset += ret;
+      continue;
+    }
+    if (0 == ret)
+      return -1;  // end of file
+
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
 }  // namespace common
@@ -0,0 +1,97 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#include "common/lang/memory.h"
+#include "common/lang/string_view.h"
+#include "common/lang/vector.h"
+
+namespace common {
+
+/**
+ * @brief 按块分配内存的内存区域
+ * @details 每次向系统申请一大块内存，分配时只在当前块中移动位置，不能单独释放，clear 或者析构时一起释放。
+ * 适合保存大量生命周期相同的小对象，比如哈希表的键，避免每个对象单独 new 的开销和内存碎片。
+ * 分配出去的内存在 clear 之前一直有效，地址不会变化。不支持并发访问。
+ */
+class Arena
+{
+public:
+  static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+  explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE) : block_size_(block_size) {}
+  Arena(const Arena &)            = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  /**
+   * @brief 分配 size 字节的内存，按照 8 字节对齐
+   */
+  char *allocate(size_t size)
+  {
+    const size_t aligned_size = (size + 7) & ~static_cast<size_t>(7);
+    if (aligned_size > remaining_) {
+      // 比块还大的对象单独分配一块，不浪费当前块剩下的空间
+      if (aligned_size > block_size_ / 4) {
+        return new_block(aligned_size);
+      }
+      current_   = new_block(block_size_);
+      remaining_ = block_size_;
+    }
+    char *result = current_;
+    current_ += aligned_size;
+    remaining_ -= aligned_size;
+    return result;
+  }
+
+  /**
+   * @brief 把一段数据拷贝到 Arena 中，返回拷贝后的数据
+   */
+  string_view copy(string_view data)
+  {
+    char *buffer = allocate(data.size());
+    memcpy(buffer, data.data(), data.size());
+    return string_view(buffer, data.size());
+  }
+
+  /**
+   * @brief 释放所有分配的内存
+   */
+  void clear()
+  {
+    blocks_.clear();
+    current_      = nullptr;
+    remaining_    = 0;
+    memory_usage_ = 0;
+  }
+
+  /// 向系统申请的内存总量
+  size_t memory_usage() const { return memory_usage_; }
+
+private:
+  char *new_block(size_t size)
+  {
+    blocks_.emplace_back(new char[size]);
+    memory_usage_ += size;
+    return blocks_.back().get();
+  }
+
+private:
+  size_t                     block_size_;
+  vector<unique_ptr<char[]>> blocks_;
+  char                      *current_      = nullptr;
+  size_t                     remaining_    = 0;
+  size_t                     memory_usage_ = 0;
+};
+
+}  // namespace common
@@ -0,0 +1,47 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdlib.h>
+
+#include "common/memory_budget.h"
+#include "common/lang/algorithm.h"
+#include "common/value.h"
+#include "session/session.h"
+
+size_t MemoryBudget::default_limit()
+{
+  static const size_t limit = []() {
+    const char *memtracer_limit = getenv("MT_MEMORY_LIMIT");
+    if (memtracer_limit == nullptr) {
+      return DEFAULT_LIMIT;
+    }
+    const size_t process_limit = strtoull(memtracer_limit, nullptr, 10);
+    return process_limit == 0 ? DEFAULT_LIMIT : std::min(DEFAULT_LIMIT, process_limit / 2);
+  }();
+  return limit;
+}
+
+MemoryBudget *MemoryBudget::current()
+{
+  Session *session = Session::current_session();
+  return session == nullptr ? nullptr : &session->query_memory_budget();
+}
+
+size_t MemoryBudget::value_memory(const Value &value)
+{
+  size_t size = sizeof(Value);
+  switch (value.attr_type()) {
+    case AttrType::CHARS:
+    case AttrType::TEXTS: size += value.length() + 1; break;
+    case AttrType::VECTORS: size += value.length(); break;
+    default: break;
+  }
+  return size;
+}
@@ -0,0 +1,76 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stddef.h>
+
+class Value;
+
+/**
+ * @brief 一条查询可以使用的内存预算
+ * @details 排序、哈希聚合这些需要缓存所有输入的算子在保存数据之前先向预算申请，
+ * 申请不到时就把数据写到磁盘上（spill），而不是无限制地占用内存。
+ * 统计的是算子缓存的数据大小的估算值，不是进程实际分配的内存。
+ * 每个会话有一个预算，同一时刻一个会话只执行一条查询，所以它就是当前查询的预算，
+ * 大小可以通过 `set query_memory_limit = <bytes>` 修改。
+ * 预算不是线程安全的，只能在执行查询的线程中使用。
+ */
+class MemoryBudget
+{
+public:
+  static constexpr size_t DEFAULT_LIMIT = 256 * 1024 * 1024;
+
+  explicit MemoryBudget(size_t limit = default_limit()) : limit_(limit) {}
+
+  size_t limit() const { return limit_; }
+  size_t used() const { return used_; }
+  void   set_limit(size_t limit) { limit_ = limit; }
+
+  /**
+   * @brief 申请 size 字节，超出预算时不申请并返回 false
+   */
+  bool try_consume(size_t size)
+  {
+    if (used_ + size > limit_) {
+      return false;
+    }
+    used_ += size;
+    return true;
+  }
+
+  /**
+   * @brief 不检查预算直接申请，用于无法再溢出到磁盘的数据，比如一条记录
+   */
+  void consume(size_t size) { used_ += size; }
+
+  void release(size_t size) { used_ = size > used_ ? 0 : used_ - size; }
+
+  /**
+   * @brief 新会话的默认预算
+   * @details 使用 MemTracer 运行时（设置了 MT_MEMORY_LIMIT 环境变量），进程超过内存上限会直接退出，
+   * 这时默认预算不超过这个上限的一半，让查询先溢出到磁盘而不是撞上进程的上限。
+   */
+  static size_t default_limit();
+
+  /**
+   * @brief 当前线程正在执行的会话的预算，没有会话时（比如单元测试）返回 nullptr，表示不限制
+   */
+  static MemoryBudget *current();
+
+  /**
+   * @brief 估算一个 Value 占用的内存，包括字符串等单独分配的数据
+   */
+  static size_t value_memory(const Value &value);
+
+private:
+  size_t limit_ = DEFAULT_LIMIT;
+  size_t used_  = 0;
+};
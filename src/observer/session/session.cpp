@@ -24,7 +24,7 @@ Session &Session::default_session()
   return session;
 }
 
-Session::Session(const Session &other) : db_(other.db_) {}
+Session::Session(const Session &other) : db_(other.db_), query_memory_budget_(other.query_memory_budget_.limit()) {}
 
 Session::~Session()
 {
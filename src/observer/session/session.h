@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/memory_budget.h"
 #include "common/types.h"
 #include "common/lang/string.h"
 
@@ -83,6 +84,11 @@ public:
   void          set_execution_mode(const ExecutionMode mode) { execution_mode_ = mode; }
   ExecutionMode get_execution_mode() const { return execution_mode_; }
 
+  /**
+   * @brief 当前会话中执行的查询可以使用的内存预算
+   */
+  MemoryBudget &query_memory_budget() { return query_memory_budget_; }
+
   bool used_chunk_mode() { return used_chunk_mode_; }
 
   void set_used_chunk_mode(bool used_chunk_mode) { used_chunk_mode_ = used_chunk_mode; }
@@ -113,4 +119,6 @@ private:
   bool used_chunk_mode_ = false;
 
   ExecutionMode execution_mode_ = ExecutionMode::TUPLE_ITERATOR;
+
+  MemoryBudget query_memory_budget_;  ///< 排序、聚合等算子缓存数据的内存预算
 };
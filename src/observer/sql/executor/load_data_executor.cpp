@@ -33,15 +33,16 @@ RC LoadDataExecutor::execute(SQLStageEvent *sql_event)
 }
 
 /**
- * 从文件中导入数据时使用。尝试向表中插入解析后的一行数据。
+ * 从文件中导入数据时使用。把解析后的一行数据组装成一条记录。
  * @param table  要导入的表
  * @param file_values 从文件中读取到的一行数据，使用分隔符拆分后的几个字段值
- * @param record_values Table::insert_record使用的参数，为了防止频繁的申请内存
+ * @param record_values Table::make_record使用的参数，为了防止频繁的申请内存
+ * @param record 生成的记录
  * @param errmsg 如果出现错误，通过这个参数返回错误信息
  * @return 成功返回RC::SUCCESS
  */
-RC insert_record_from_file(
-    Table *table, std::vector<std::string> &file_values, std::vector<Value> &record_values, std::stringstream &errmsg)
+RC make_record_from_file(Table *table, std::vector<std::string> &file_values, std::vector<Value> &record_values,
+    Record &record, std::stringstream &errmsg)
 {
 
   const int field_num     = record_values.size();
@@ -65,12 +66,9 @@ RC insert_record_from_file(
   }
 
   if (RC::SUCCESS == rc) {
-    Record record;
     rc = table->make_record(field_num, record_values.data(), record);
     if (rc != RC::SUCCESS) {
       errmsg << "insert failed.";
-    } else if (RC::SUCCESS != (rc = table->insert_record(record))) {
-      errmsg << "insert failed.";
     }
   }
   return rc;
@@ -99,25 +97,37 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, SqlResult
   std::vector<std::string> file_values;
   const std::string        delim("|");
   int                      line_num        = 0;
-  int                      insertion_count = 0;
-  RC                       rc              = RC::SUCCESS;
-  while (!fs.eof() && RC::SUCCESS == rc) {
-    std::getline(fs, line);
-    line_num++;
-    if (common::is_blank(line.c_str())) {
-      continue;
+  int64_t                  insertion_count = 0;
+  std::stringstream        errmsg;
+
+  // 记录通过批量插入的方式追加到新的页面中。没有唯一索引时，索引项在所有记录导入完成后再统一插入
+  bool has_unique_index = false;
+  for (int i = 0; i < table->table_meta().index_num(); i++) {
+    has_unique_index = has_unique_index || table->table_meta().index(i)->is_unique();
+  }
+
+  auto next_record = [&](Record &record) -> RC {
+    while (!fs.eof()) {
+      std::getline(fs, line);
+      line_num++;
+      if (common::is_blank(line.c_str())) {
+        continue;
+      }
+
+      file_values.clear();
+      common::split_string(line, delim, file_values);
+      return make_record_from_file(table, file_values, record_values, record, errmsg);
     }
+    return RC::RECORD_EOF;
+  };
 
-    file_values.clear();
-    common::split_string(line, delim, file_values);
-    std::stringstream errmsg;
-    rc = insert_record_from_file(table, file_values, record_values, errmsg);
-    if (rc != RC::SUCCESS) {
-      result_string << "Line:" << line_num << " insert record failed:" << errmsg.str() << ". error:" << strrc(rc)
-                    << std::endl;
-    } else {
-      insertion_count++;
+  RC rc = table->bulk_insert_records(next_record, !has_unique_index /*defer_index*/, insertion_count);
+  if (rc != RC::SUCCESS) {
+    if (errmsg.str().empty()) {
+      errmsg << "insert failed.";
     }
+    result_string << "Line:" << line_num << " insert record failed:" << errmsg.str() << ". error:" << strrc(rc)
+                  << std::endl;
   }
   fs.close();
 
@@ -34,6 +34,13 @@ RC SetVariableExecutor::execute(SQLStageEvent *sql_event)
       } else {
         rc = RC::INVALID_ARGUMENT;
       }
+    } else if (strcasecmp(var_name, "query_memory_limit") == 0) {
+      // 单位是字节，排序和聚合超过这个大小后会把数据写到磁盘上
+      if (var_value.attr_type() == AttrType::INTS && var_value.get_int() > 0) {
+        session->query_memory_budget().set_limit(static_cast<size_t>(var_value.get_int()));
+      } else {
+        rc = RC::VARIABLE_NOT_VALID;
+      }
     } else if (strcasecmp(var_name, "NAMES") == 0) {
       // nop
     } else {
@@ -14,8 +14,96 @@ See the Mulan PSL v2 for more details. */
 
 RC StandardAggregateHashTable::add_chunk(Chunk &groups_chunk, Chunk &aggrs_chunk)
 {
-  // your code here
-  exit(-1);
+  if (groups_chunk.rows() != aggrs_chunk.rows() || aggrs_chunk.column_num() != static_cast<int>(aggr_types_.size())) {
+    LOG_WARN("groups chunk and aggregates chunk mismatch. group rows=%d, aggregate rows=%d, aggregate columns=%d",
+             groups_chunk.rows(), aggrs_chunk.rows(), aggrs_chunk.column_num());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  // 只按照一个字典编码的列分组时，同一个字典编号只需要查找一次哈希表，不需要每一行都解码和计算哈希值
+  const bool      by_code = groups_chunk.column_num() == 1 &&
+                       groups_chunk.column(0).column_type() == Column::Type::DICTIONARY_COLUMN;
+  const uint8_t  *codes   = by_code ? reinterpret_cast<const uint8_t *>(groups_chunk.column(0).data()) : nullptr;
+  vector<vector<Value> *> code_aggrs(by_code ? groups_chunk.column(0).dictionary_size() : 0, nullptr);
+
+  // COUNT 从 0 开始计数，一个分组中的值都是 null 时结果是 0，其它聚合函数的结果是 null
+  vector<Value> initial_aggrs(aggr_types_.size());
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    if (aggr_types_[i] == AggregateType::COUNT) {
+      initial_aggrs[i].set_int(0);
+    }
+  }
+
+  vector<Value> group_values(groups_chunk.column_num());
+  for (int row = 0; row < groups_chunk.rows(); row++) {
+    vector<Value> *aggrs = by_code ? code_aggrs[codes[row]] : nullptr;
+    if (aggrs == nullptr) {
+      for (int col = 0; col < groups_chunk.column_num(); col++) {
+        group_values[col] = groups_chunk.get_value(col, row);
+      }
+      auto iter = aggr_values_.find(group_values);
+      if (iter == aggr_values_.end()) {
+        iter = aggr_values_.emplace(group_values, initial_aggrs).first;
+      }
+      // unordered_map 扩容时不会移动元素，可以保存元素的指针
+      aggrs = &iter->second;
+      if (by_code) {
+        code_aggrs[codes[row]] = aggrs;
+      }
+    }
+
+    for (size_t i = 0; i < aggr_types_.size(); i++) {
+      RC rc = aggregate(aggr_types_[i], aggrs_chunk.get_value(i, row), (*aggrs)[i]);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC StandardAggregateHashTable::aggregate(AggregateType aggr_type, const Value &value, Value &aggr_value)
+{
+  // 聚合函数忽略 null 值
+  if (value.is_null()) {
+    return RC::SUCCESS;
+  }
+
+  // 还没有聚合过任何值时，aggr_value 的类型是 UNDEFINED
+  const bool first = aggr_value.attr_type() == AttrType::UNDEFINED;
+  Value      result;
+  RC         rc = RC::SUCCESS;
+  switch (aggr_type) {
+    case AggregateType::COUNT: {
+      aggr_value.set_int(first ? 1 : aggr_value.get_int() + 1);
+    } break;
+    case AggregateType::SUM: {
+      if (first) {
+        aggr_value = value;
+      } else if (OB_SUCC(rc = Value::add(aggr_value, value, result))) {
+        aggr_value = result;
+      }
+    } break;
+    case AggregateType::MAX: {
+      if (first) {
+        aggr_value = value;
+      } else if (OB_SUCC(rc = Value::max(aggr_value, value, result))) {
+        aggr_value = result;
+      }
+    } break;
+    case AggregateType::MIN: {
+      if (first) {
+        aggr_value = value;
+      } else if (OB_SUCC(rc = Value::min(aggr_value, value, result))) {
+        aggr_value = result;
+      }
+    } break;
+    default: {
+      LOG_WARN("unsupported aggregation type in hash table. type=%d", static_cast<int>(aggr_type));
+      rc = RC::UNIMPLEMENTED;
+    } break;
+  }
+  return rc;
 }
 
 void StandardAggregateHashTable::Scanner::open_scan()
@@ -29,15 +117,27 @@ RC StandardAggregateHashTable::Scanner::next(Chunk &output_chunk)
   if (it_ == end_) {
     return RC::RECORD_EOF;
   }
-  while (it_ != end_ && output_chunk.rows() <= output_chunk.capacity()) {
+  // 字符串的 Value 只保存了实际的字符，写入定长的列时需要补齐
+  vector<char> buffer;
+  auto append_value = [&buffer](Column &column, const Value &value) {
+    // 分组中没有聚合过任何值时结果是 null
+    if (value.is_null() || value.attr_type() == AttrType::UNDEFINED) {
+      column.set_null(column.count());
+    }
+    buffer.assign(column.attr_len(), 0);
+    memcpy(buffer.data(), value.data(), std::min(value.length(), column.attr_len()));
+    column.append_one(buffer.data());
+  };
+
+  while (it_ != end_ && output_chunk.rows() < output_chunk.capacity()) {
     auto &group_by_values = it_->first;
     auto &aggrs           = it_->second;
     for (int i = 0; i < output_chunk.column_num(); i++) {
       auto col_idx = output_chunk.column_ids(i);
       if (col_idx >= static_cast<int>(group_by_values.size())) {
-        output_chunk.column(i).append_one((char *)aggrs[col_idx - group_by_values.size()].data());
+        append_value(output_chunk.column(i), aggrs[col_idx - group_by_values.size()]);
       } else {
-        output_chunk.column(i).append_one((char *)group_by_values[col_idx].data());
+        append_value(output_chunk.column(i), group_by_values[col_idx]);
       }
     }
     it_++;
@@ -63,7 +163,14 @@ bool StandardAggregateHashTable::VectorEqual::operator()(const vector<Value> &lh
   if (lhs.size() != rhs.size()) {
     return false;
   }
+  // 分组时所有的 null 属于同一个分组
   for (size_t i = 0; i < lhs.size(); ++i) {
+    if (lhs[i].is_null() || rhs[i].is_null()) {
+      if (lhs[i].is_null() != rhs[i].is_null()) {
+        return false;
+      }
+      continue;
+    }
     if (rhs[i].compare(lhs[i]) != 0) {
       return false;
     }
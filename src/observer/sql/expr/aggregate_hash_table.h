@@ -43,6 +43,7 @@ public:
 
   /**
    * @brief 将 groups_chunk 和 aggrs_chunk 写入到哈希表中。哈希表中记录了聚合结果。
+   * @details groups_chunk 中只有一个字典编码的列时，直接按照字典编号分组。
    */
   virtual RC add_chunk(Chunk &groups_chunk, Chunk &aggrs_chunk) = 0;
 
@@ -94,6 +95,14 @@ public:
   StandardHashTable::iterator begin() { return aggr_values_.begin(); }
   StandardHashTable::iterator end() { return aggr_values_.end(); }
 
+  size_t size() const { return aggr_values_.size(); }
+
+private:
+  /**
+   * @brief 把一个值聚合到 aggr_value 中，当前支持 COUNT/SUM/MAX/MIN
+   */
+  static RC aggregate(AggregateType aggr_type, const Value &value, Value &aggr_value);
+
 private:
   /// group by values -> aggregate values
   StandardHashTable                aggr_values_;
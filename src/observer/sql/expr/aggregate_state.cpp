@@ -8,8 +8,10 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
+#include <stdint.h>
 #include <type_traits>
 
+#include "common/lang/algorithm.h"
 #include "sql/expr/aggregate_state.h"
 
 #ifdef USE_SIMD
@@ -31,5 +33,30 @@ void SumState<T>::update(const T *values, int size)
 #endif
 }
 
+template <typename T>
+void SumState<T>::update(const T *values, int size, const char *null_bitmap)
+{
+  if (null_bitmap == nullptr) {
+    update(values, size);
+    return;
+  }
+
+  int begin = 0;  // 还没有累加的、连续没有 null 的一段值的开始位置
+  for (int i = 0; i < size; i += 8) {
+    const uint8_t bits = static_cast<uint8_t>(null_bitmap[i / 8]);
+    if (bits == 0) {
+      continue;
+    }
+    update(values + begin, i - begin);
+    for (int j = i; j < std::min(i + 8, size); j++) {
+      if ((bits & (1 << (j - i))) == 0) {
+        value += values[j];
+      }
+    }
+    begin = std::min(i + 8, size);
+  }
+  update(values + begin, size - begin);
+}
+
 template class SumState<int>;
 template class SumState<float>;
\ No newline at end of file
@@ -15,4 +15,10 @@ public:
   SumState() : value(0) {}
   T    value;
   void update(const T *values, int size);
+
+  /**
+   * @brief 累加 values 中不为 null 的值
+   * @details 按字节检查 null_bitmap，连续没有 null 的值整段累加，只有包含 null 的字节才逐位处理
+   */
+  void update(const T *values, int size, const char *null_bitmap);
 };
\ No newline at end of file
@@ -20,6 +20,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/parser/parse_defs.h"
 #include "sql/operator/physical_operator.h"
 #include "sql/operator/logical_operator.h"
+#include "sql/operator/sort_key.h"
 #include "sql/stmt/select_stmt.h"
 
 class SelectStmt;
@@ -208,6 +209,54 @@ RC ComparisonExpr::compare_value(const Value &left, const Value &right, bool &re
   return rc;
 }
 
+RC ComparisonExpr::compare_subquery_result(const Value &left, const SubqueryResult &result, bool &value) const
+{
+  value = false;
+  switch (comp_) {
+    case CompOp::EXISTS: value = !result.values.empty(); break;
+    case CompOp::NOT_EXISTS: value = result.values.empty(); break;
+    case CompOp::IN: {
+      if (left.is_null()) {
+        break;
+      }
+      if (result.find(left, value)) {
+        break;
+      }
+      for (const Value &right : result.values) {
+        RC rc = compare_value(left, right, value);
+        if (rc != RC::SUCCESS || value) {
+          return rc;
+        }
+      }
+    } break;
+    case CompOp::NOT_IN: {
+      if (result.values.empty()) {
+        value = true;
+        break;
+      }
+      if (left.is_null() || result.has_null) {
+        break;
+      }
+      bool found = false;
+      if (result.find(left, found)) {
+        value = !found;
+        break;
+      }
+      for (const Value &right : result.values) {
+        RC rc = compare_value(left, right, value);
+        if (rc != RC::SUCCESS || !value) {
+          return rc;
+        }
+      }
+    } break;
+    default: {
+      LOG_WARN("unsupported comparison with subquery result. %d", comp_);
+      return RC::INTERNAL;
+    }
+  }
+  return RC::SUCCESS;
+}
+
 RC ComparisonExpr::try_get_value(Value &cell) const
 {
   if (left_->type() == ExprType::VALUE && right_->type() == ExprType::VALUE) {
@@ -288,6 +337,24 @@ RC ComparisonExpr::get_value(const Tuple &tuple, Value &value, Trx *trx) const
       return rc;
     }
 
+    // 能缓存的子查询直接用物化的结果判断，不用逐个取值
+    const bool is_set_comp = comp_ == CompOp::EXISTS || comp_ == CompOp::NOT_EXISTS ||
+                             ((comp_ == CompOp::IN || comp_ == CompOp::NOT_IN) && sub_query_value == &right_value);
+    if (is_set_comp && subquery_expr->cacheable()) {
+      std::shared_ptr<SubqueryResult> result;
+      rc = subquery_expr->get_result(tuple, result);
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to get result of subquery. rc=%s", strrc(rc));
+        return rc;
+      }
+      bool bool_value = false;
+      rc              = compare_subquery_result(left_value, *result, bool_value);
+      if (rc == RC::SUCCESS) {
+        value.set_boolean(bool_value);
+      }
+      return rc;
+    }
+
     bool bool_value = false;
     // 循环执行子查询的算子，直到找到一个满足条件的值
     bool has_sub_queried_ = false;
@@ -489,6 +556,13 @@ RC ComparisonExpr::eval(Chunk &chunk, std::vector<uint8_t> &select)
     LOG_WARN("failed to get value of right expression. rc=%s", strrc(rc));
     return rc;
   }
+
+  // 任何一个参数为 null 时比较结果都不成立，按照 null 位图把这些行排除掉。与 null 常量比较时所有行都不成立
+  left_column.filter_nulls(select);
+  right_column.filter_nulls(select);
+  if (left_column.attr_type() == AttrType::NULLS || right_column.attr_type() == AttrType::NULLS) {
+    return RC::SUCCESS;
+  }
   if (left_column.attr_type() != right_column.attr_type()) {
     LOG_WARN("cannot compare columns with different types");
     return RC::INTERNAL;
@@ -497,8 +571,9 @@ RC ComparisonExpr::eval(Chunk &chunk, std::vector<uint8_t> &select)
     rc = compare_column<int>(left_column, right_column, select);
   } else if (left_column.attr_type() == AttrType::FLOATS) {
     rc = compare_column<float>(left_column, right_column, select);
+  } else if (left_column.attr_type() == AttrType::CHARS) {
+    rc = compare_string_column(left_column, right_column, select);
   } else {
-    // TODO: support string compare
     LOG_WARN("unsupported data type %d", left_column.attr_type());
     return RC::INTERNAL;
   }
@@ -524,6 +599,49 @@ RC ComparisonExpr::compare_column(const Column &left, const Column &right, std::
   return rc;
 }
 
+RC ComparisonExpr::compare_string_column(const Column &left, const Column &right, std::vector<uint8_t> &result) const
+{
+  const bool left_const  = left.column_type() == Column::Type::CONSTANT_COLUMN;
+  const bool right_const = right.column_type() == Column::Type::CONSTANT_COLUMN;
+  const bool left_dict   = left.column_type() == Column::Type::DICTIONARY_COLUMN;
+  const bool right_dict  = right.column_type() == Column::Type::DICTIONARY_COLUMN;
+
+  // 字典编码的列与常量比较时，每个字典项只需要比较一次，然后按照字典编号过滤
+  if ((left_dict && right_const) || (left_const && right_dict)) {
+    const Column &dict_column = left_dict ? left : right;
+    const Value   constant    = (left_dict ? right : left).get_value(0);
+    const int     attr_len    = dict_column.attr_len();
+
+    std::vector<uint8_t> matches(dict_column.dictionary_size());
+    for (int code = 0; code < dict_column.dictionary_size(); code++) {
+      Value entry(AttrType::CHARS, const_cast<char *>(dict_column.dictionary() + code * attr_len), attr_len);
+      bool  bool_value = false;
+      RC    rc = left_dict ? compare_value(entry, constant, bool_value) : compare_value(constant, entry, bool_value);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+      matches[code] = bool_value ? 1 : 0;
+    }
+
+    const uint8_t *codes = reinterpret_cast<const uint8_t *>(dict_column.data());
+    for (int i = 0; i < dict_column.count(); i++) {
+      result[i] &= matches[codes[i]];
+    }
+    return RC::SUCCESS;
+  }
+
+  const int rows = left_const ? right.count() : left.count();
+  for (int i = 0; i < rows; i++) {
+    bool bool_value = false;
+    RC   rc = compare_value(left.get_value(left_const ? 0 : i), right.get_value(right_const ? 0 : i), bool_value);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    result[i] &= bool_value ? 1 : 0;
+  }
+  return RC::SUCCESS;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ConjunctionExpr::ConjunctionExpr(Type type, vector<unique_ptr<Expression>> &children)
     : conjunction_type_(type), children_(std::move(children))
@@ -768,6 +886,12 @@ RC ArithmeticExpr::calc_column(const Column &left_column, const Column &right_co
     column.set_column_type(Column::Type::NORMAL_COLUMN);
     rc = execute_calc<false, false>(left_column, right_column, column, arithmetic_type_, target_type);
   }
+
+  // 任何一个参数为 null 时结果都是 null，按字节合并两边的 null 位图，计算时不需要逐个检查
+  if (OB_SUCC(rc)) {
+    column.merge_nulls(left_column);
+    column.merge_nulls(right_column);
+  }
   return rc;
 }
 
@@ -1169,6 +1293,12 @@ RC SubqueryExpr::open_physical_operator(Tuple *outer_tuple) const
 }
 RC SubqueryExpr::close_physical_operator() const
 {
+  if (cacheable_) {
+    // 物化时算子已经关闭了，这里只需要结束对结果的遍历
+    current_result_.reset();
+    current_index_ = 0;
+    return RC::SUCCESS;
+  }
   if (physical_operator_ == nullptr) {
     LOG_WARN("physical operator is null");
     return RC::INVALID_ARGUMENT;
@@ -1199,6 +1329,23 @@ RC       SubqueryExpr::get_value(const Tuple &tuple, Value &value, Trx *trx) con
 
   trx_ = trx;
 
+  if (cacheable_) {
+    if (current_result_ == nullptr) {
+      rc = get_result(tuple, current_result_, trx);
+      if (rc != RC::SUCCESS) {
+        return rc;
+      }
+      current_index_ = 0;
+    }
+    if (current_index_ >= current_result_->values.size()) {
+      current_result_.reset();
+      current_index_ = 0;
+      return RC::RECORD_EOF;
+    }
+    value = current_result_->values[current_index_++];
+    return RC::SUCCESS;
+  }
+
   auto *tuple__ = const_cast<Tuple*>(&tuple);
   if (!is_open_) {
     rc = open_physical_operator(tuple__);
@@ -1251,6 +1398,154 @@ void SubqueryExpr::set_logical_operator(std::unique_ptr<LogicalOperator> logical
 void SubqueryExpr::set_physical_operator(std::unique_ptr<PhysicalOperator> physical_operator)
 {
   physical_operator_ = std::move(physical_operator);
+  result_cache_.clear();
+  cached_value_num_ = 0;
+  current_result_.reset();
+  current_index_ = 0;
+}
+void SubqueryExpr::set_outer_fields(std::vector<std::unique_ptr<FieldExpr>> outer_fields)
+{
+  outer_fields_ = std::move(outer_fields);
+  cacheable_    = true;
+}
+
+RC SubqueryExpr::get_result(const Tuple &tuple, std::shared_ptr<SubqueryResult> &result, Trx *trx) const
+{
+  if (physical_operator_ == nullptr) {
+    LOG_WARN("physical operator is null");
+    return RC::INVALID_ARGUMENT;
+  }
+  trx_ = trx;
+
+  // 缓存的键是外层字段的值编码，取不到外层字段的值时不缓存
+  std::string key;
+  bool        use_cache = true;
+  for (const auto &field_expr : outer_fields_) {
+    Value outer_value;
+    if (field_expr->get_value(tuple, outer_value) != RC::SUCCESS) {
+      use_cache = false;
+      break;
+    }
+    SortKeyEncoder::encode_value(outer_value, false /*desc*/, key);
+  }
+
+  if (use_cache) {
+    auto iter = result_cache_.find(key);
+    if (iter != result_cache_.end()) {
+      result = iter->second;
+      return RC::SUCCESS;
+    }
+  }
+
+  auto new_result = std::make_shared<SubqueryResult>();
+  RC   rc         = materialize(tuple, *new_result);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+  new_result->build_index();
+
+  if (use_cache) {
+    if (cached_value_num_ + new_result->values.size() > MAX_CACHED_VALUE_NUM) {
+      result_cache_.clear();
+      cached_value_num_ = 0;
+    }
+    cached_value_num_ += new_result->values.size();
+    result_cache_.emplace(std::move(key), new_result);
+  }
+  result = std::move(new_result);
+  return RC::SUCCESS;
+}
+
+RC SubqueryExpr::materialize(const Tuple &tuple, SubqueryResult &result) const
+{
+  physical_operator_->set_outer_tuple(const_cast<Tuple *>(&tuple));
+  RC rc = physical_operator_->open(trx_);
+  if (rc != RC::SUCCESS) {
+    LOG_WARN("failed to open physical operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  while ((rc = physical_operator_->next()) == RC::SUCCESS) {
+    Tuple *sub_tuple = physical_operator_->current_tuple();
+    // 子查询的结果中，tuple 只能有一个 cell
+    if (sub_tuple->cell_num() > 1) {
+      LOG_WARN("tuple cell count is not 1");
+      rc = RC::INVALID_ARGUMENT;
+      break;
+    }
+    Value value;
+    rc = sub_tuple->cell_at(0, value);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to get value from subquery tuple. rc=%s", strrc(rc));
+      break;
+    }
+    result.has_null = result.has_null || value.is_null();
+    result.values.push_back(std::move(value));
+  }
+
+  RC close_rc = physical_operator_->close();
+  if (rc == RC::RECORD_EOF) {
+    rc = close_rc;
+  } else {
+    LOG_WARN("failed to execute subquery. rc=%s", strrc(rc));
+  }
+  return rc;
+}
+
+bool SubqueryResult::hash_key(const Value &value, std::string &key)
+{
+  switch (value.attr_type()) {
+    case AttrType::INTS:
+    case AttrType::DATES: {
+      const int int_value = value.get_int();
+      key.assign(reinterpret_cast<const char *>(&int_value), sizeof(int_value));
+    } break;
+    case AttrType::CHARS: {
+      // 与 compare_string 一致：长度相同并且在第一个 '\0' 之前的内容相同才相等
+      const int length = value.length();
+      key.assign(reinterpret_cast<const char *>(&length), sizeof(length));
+      key.append(value.data(), strnlen(value.data(), length));
+    } break;
+    default: return false;
+  }
+  return true;
+}
+
+void SubqueryResult::build_index()
+{
+  hashable = false;
+  type     = AttrType::UNDEFINED;
+  keys.clear();
+
+  for (const Value &value : values) {
+    if (value.is_null()) {
+      continue;
+    }
+    if (type == AttrType::UNDEFINED) {
+      type = value.attr_type();
+    } else if (type != value.attr_type()) {
+      keys.clear();
+      return;
+    }
+
+    std::string key;
+    if (!hash_key(value, key)) {
+      keys.clear();
+      return;
+    }
+    keys.insert(std::move(key));
+  }
+  hashable = type != AttrType::UNDEFINED;
+}
+
+bool SubqueryResult::find(const Value &value, bool &found) const
+{
+  std::string key;
+  if (!hashable || value.is_null() || value.attr_type() != type || !hash_key(value, key)) {
+    return false;
+  }
+  found = keys.count(key) > 0;
+  return true;
 }
 void                               SubqueryExpr::set_trx(Trx *trx) { trx_ = trx; }
 void                               SubqueryExpr::set_stmt(std::unique_ptr<SelectStmt> stmt) { stmt_ = std::move(stmt); }
@@ -16,6 +16,8 @@ See the Mulan PSL v2 for more details. */
 
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "common/value.h"
 #include "storage/field/field.h"
@@ -27,6 +29,7 @@ class ParsedSqlNode;
 class SelectStmt;
 class LogicalOperator;
 class PhysicalOperator;
+struct SubqueryResult;
 
 /**
  * @defgroup Expression
@@ -338,9 +341,21 @@ public:
    */
   RC compare_value(const Value &left, const Value &right, bool &value) const;
 
+  /**
+   * @brief 用物化的子查询结果计算 IN/NOT IN/EXISTS/NOT EXISTS
+   * @details 与逐行比较的语义相同：left 为 null 时 IN 和 NOT IN 都为 false，
+   * 子查询结果包含 null 且没有匹配的值时 NOT IN 为 false，结果为空时 NOT IN 为 true。
+   */
+  RC compare_subquery_result(const Value &left, const SubqueryResult &result, bool &value) const;
+
   template <typename T>
   RC compare_column(const Column &left, const Column &right, std::vector<uint8_t> &result) const;
 
+  /**
+   * @brief 比较字符串列，字典编码的列与常量比较时只比较字典项
+   */
+  RC compare_string_column(const Column &left, const Column &right, std::vector<uint8_t> &result) const;
+
 private:
   CompOp                      comp_;
   std::unique_ptr<Expression> left_;
@@ -554,6 +569,7 @@ public:
   AttrType                     value_type() const override;
   int                          value_length() const override;
   RC                           get_value(const Tuple &tuple, Value &value, Trx *trx = nullptr) const override;
+  CompOp                       comp() const { return comp_op_; }
   std::unique_ptr<Expression> &left();
   std::unique_ptr<Expression> &right();
 
@@ -563,11 +579,38 @@ private:
   std::unique_ptr<Expression> right_;
 };
 
+/**
+ * @brief 子查询物化后的结果
+ * @ingroup Expression
+ * @details 非 null 的值类型都相同并且是整数、日期或字符串时，额外建一个哈希集合，IN/NOT IN 不用逐个比较。
+ * 其它类型的比较可能有精度或者类型转换的问题，还是逐个调用 Value::compare。
+ */
+struct SubqueryResult
+{
+  std::vector<Value>              values;
+  bool                            has_null = false;
+  bool                            hashable = false;
+  AttrType                        type     = AttrType::UNDEFINED;  ///< 非 null 值的类型，hashable 时有效
+  std::unordered_set<std::string> keys;
+
+  void build_index();
+
+  /**
+   * @brief 用哈希集合判断 value 是否在结果中
+   * @return 不能用哈希集合判断时返回 false，调用方需要逐个比较
+   */
+  bool find(const Value &value, bool &found) const;
+
+  static bool hash_key(const Value &value, std::string &key);
+};
+
 // 
 /**
  * @brief 常量值列表表达式
  * @ingroup Expression
  * @details SubqueryExpr 接管 sqlnode, stmt, operate
+ * 生成逻辑计划时会找出子查询引用的外层字段（outer_fields），执行时子查询一次性物化，
+ * 并按外层字段的值缓存结果：不相关子查询整个语句只执行一次，相关子查询遇到相同的外层值时直接复用。
  * @author Soulter
  */
 class SubqueryExpr : public Expression
@@ -590,13 +633,38 @@ public:
   std::unique_ptr<LogicalOperator> &logical_operator();
   std::unique_ptr<PhysicalOperator> &physical_operator();
 
+  void set_outer_fields(std::vector<std::unique_ptr<FieldExpr>> outer_fields);
+  const std::vector<std::unique_ptr<FieldExpr>> &outer_fields() const { return outer_fields_; }
+
+  /// 是否分析过外层字段，只有分析过的子查询才能缓存结果
+  bool cacheable() const { return cacheable_; }
+
+  /**
+   * @brief 取子查询在外层 tuple 下的全部结果，没有缓存时执行子查询并缓存
+   */
+  RC get_result(const Tuple &tuple, std::shared_ptr<SubqueryResult> &result, Trx *trx = nullptr) const;
+
+private:
+  RC materialize(const Tuple &tuple, SubqueryResult &result) const;
+
 private:
+  /// 相关子查询缓存的值的总数超过这个值时清空缓存
+  static constexpr size_t MAX_CACHED_VALUE_NUM = 64 * 1024;
+
   ParsedSqlNode* sub_query_sn_;
   std::unique_ptr<SelectStmt>    stmt_;
   std::unique_ptr<LogicalOperator> logical_operator_;
   std::unique_ptr<PhysicalOperator> physical_operator_;
   mutable bool is_open_ = false;
   mutable Trx *trx_;
+
+  std::vector<std::unique_ptr<FieldExpr>> outer_fields_;
+  bool                                    cacheable_ = false;
+
+  mutable std::unordered_map<std::string, std::shared_ptr<SubqueryResult>> result_cache_;
+  mutable size_t                                                          cached_value_num_ = 0;
+  mutable std::shared_ptr<SubqueryResult>                                 current_result_;  ///< get_value 正在遍历的结果
+  mutable size_t                                                          current_index_ = 0;
 };
 
 
@@ -303,7 +303,7 @@ public:
       } else {
         memcpy(data + field_meta->offset(), cell.data(), length);
       }
-      Bitmap new_bitmap(data, null_bitmap_start);
+      Bitmap new_bitmap(data + null_bitmap_start, speces_.size());
       if (cell.is_null()) {
         new_bitmap.set_bit(field_meta->field_id());  // 设置 null bitmap
       } else {
@@ -452,6 +452,7 @@ public:
 
   void set_names(const std::vector<TupleCellSpec> &specs) { specs_ = specs; }
   void set_cells(const std::vector<Value> &cells) { cells_ = cells; }
+  void set_cells(const Value *cells, int cell_num) { cells_.assign(cells, cells + cell_num); }
 
   virtual int cell_num() const override { return static_cast<int>(cells_.size()); }
 
@@ -88,6 +88,7 @@ RC AggregateVecPhysicalOperator::open(Trx *trx)
     rc = RC::SUCCESS;
   }
 
+  outputted_ = false;
   return rc;
 }
 template <class STATE, typename T>
@@ -95,13 +96,30 @@ void AggregateVecPhysicalOperator::update_aggregate_state(void *state, const Col
 {
   STATE *state_ptr = reinterpret_cast<STATE *>(state);
   T *    data      = (T *)column.data();
-  state_ptr->update(data, column.count());
+  state_ptr->update(data, column.count(), column.null_bitmap());
 }
 
 RC AggregateVecPhysicalOperator::next(Chunk &chunk)
 {
-  // your code here
-  exit(-1);
+  // 没有分组时只输出一行聚合结果
+  if (outputted_) {
+    return RC::RECORD_EOF;
+  }
+
+  output_chunk_.reset_data();
+  for (size_t aggr_idx = 0; aggr_idx < aggregate_expressions_.size(); aggr_idx++) {
+    auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[aggr_idx]);
+    if (aggregate_expr->value_type() == AttrType::INTS) {
+      append_to_column<SumState<int>, int>(aggr_values_.at(aggr_idx), output_chunk_.column(aggr_idx));
+    } else if (aggregate_expr->value_type() == AttrType::FLOATS) {
+      append_to_column<SumState<float>, float>(aggr_values_.at(aggr_idx), output_chunk_.column(aggr_idx));
+    } else {
+      ASSERT(false, "not supported value type");
+    }
+  }
+
+  outputted_ = true;
+  return chunk.reference(output_chunk_);
 }
 
 RC AggregateVecPhysicalOperator::close()
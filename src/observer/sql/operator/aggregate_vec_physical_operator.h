@@ -71,4 +71,5 @@ private:
   Chunk                     chunk_;
   Chunk                     output_chunk_;
   AggregateValues           aggr_values_;
+  bool                      outputted_ = false;  ///< 聚合结果已经输出
 };
\ No newline at end of file
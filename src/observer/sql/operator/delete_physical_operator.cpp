@@ -40,9 +40,15 @@ RC DeletePhysicalOperator::open(Trx *trx)
       return rc;
     }
 
+    // 表扫描返回的记录可能直接引用页面中的数据，扫描结束后就失效了，这里拷贝一份
     RowTuple *row_tuple = static_cast<RowTuple *>(tuple);
     Record   &record    = row_tuple->record();
-    records_.emplace_back(std::move(record));
+    Record   &copy      = records_.emplace_back();
+    copy.set_rid(record.rid());
+    rc = copy.copy_data(record.data(), record.len());
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
   }
 
   child->close();
@@ -8,4 +8,100 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
-#include "sql/operator/group_by_vec_physical_operator.h"
\ No newline at end of file
+#include "sql/operator/group_by_vec_physical_operator.h"
+#include "common/log/log.h"
+
+using namespace std;
+using namespace common;
+
+GroupByVecPhysicalOperator::GroupByVecPhysicalOperator(
+    vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions)
+    : group_by_exprs_(std::move(group_by_exprs)),
+      aggregate_expressions_(std::move(expressions)),
+      hash_table_(aggregate_expressions_),
+      scanner_(&hash_table_)
+{
+  value_expressions_.reserve(aggregate_expressions_.size());
+  for (Expression *expr : aggregate_expressions_) {
+    ASSERT(expr->type() == ExprType::AGGREGATION, "expected an aggregation expression");
+    Expression *child_expr = static_cast<AggregateExpr *>(expr)->child().get();
+    ASSERT(child_expr != nullptr, "aggregation expression must have a child expression");
+    value_expressions_.emplace_back(child_expr);
+  }
+
+  int col_id = 0;
+  for (const unique_ptr<Expression> &expr : group_by_exprs_) {
+    output_chunk_.add_column(make_unique<Column>(expr->value_type(), expr->value_length()), col_id++);
+  }
+  for (Expression *expr : aggregate_expressions_) {
+    if (static_cast<AggregateExpr *>(expr)->aggregate_type() == AggregateType::COUNT) {
+      output_chunk_.add_column(make_unique<Column>(AttrType::INTS, sizeof(int)), col_id++);
+    } else {
+      output_chunk_.add_column(make_unique<Column>(expr->value_type(), expr->value_length()), col_id++);
+    }
+  }
+}
+
+RC GroupByVecPhysicalOperator::open(Trx *trx)
+{
+  ASSERT(children_.size() == 1, "group by operator only support one child, but got %d", children_.size());
+
+  PhysicalOperator &child = *children_[0];
+  RC                rc    = child.open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_INFO("failed to open child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  while (OB_SUCC(rc = child.next(chunk_))) {
+    Chunk groups_chunk;
+    Chunk aggrs_chunk;
+    for (size_t i = 0; i < group_by_exprs_.size(); i++) {
+      auto column = make_unique<Column>();
+      if (OB_FAIL(rc = group_by_exprs_[i]->get_column(chunk_, *column))) {
+        LOG_WARN("failed to get column of group by expression. rc=%s", strrc(rc));
+        return rc;
+      }
+      groups_chunk.add_column(std::move(column), i);
+    }
+    for (size_t i = 0; i < value_expressions_.size(); i++) {
+      auto column = make_unique<Column>();
+      if (OB_FAIL(rc = value_expressions_[i]->get_column(chunk_, *column))) {
+        LOG_WARN("failed to get column of aggregation expression. rc=%s", strrc(rc));
+        return rc;
+      }
+      aggrs_chunk.add_column(std::move(column), i);
+    }
+
+    if (OB_FAIL(rc = hash_table_.add_chunk(groups_chunk, aggrs_chunk))) {
+      LOG_WARN("failed to add chunk to aggregate hash table. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to get next chunk from child. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  scanner_.open_scan();
+  return RC::SUCCESS;
+}
+
+RC GroupByVecPhysicalOperator::next(Chunk &chunk)
+{
+  output_chunk_.reset_data();
+  RC rc = scanner_.next(output_chunk_);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return chunk.reference(output_chunk_);
+}
+
+RC GroupByVecPhysicalOperator::close()
+{
+  scanner_.close_scan();
+  children_[0]->close();
+  LOG_INFO("close group by operator");
+  return RC::SUCCESS;
+}
@@ -16,20 +16,32 @@ See the Mulan PSL v2 for more details. */
 /**
  * @brief Group By 物理算子(vectorized)
  * @ingroup PhysicalOperator
+ * @details 在 open 时读取子算子的所有数据，按照分组表达式的值写入 StandardAggregateHashTable，
+ * next 时从哈希表中输出结果。输出的列依次是分组表达式和聚合表达式。
+ * 按照一个字典编码的列分组时，哈希表直接使用字典编号分组，不需要解码每一行。
  */
 class GroupByVecPhysicalOperator : public PhysicalOperator
 {
 public:
   GroupByVecPhysicalOperator(
-      std::vector<std::unique_ptr<Expression>> &&group_by_exprs, std::vector<Expression *> &&expressions){};
+      std::vector<std::unique_ptr<Expression>> &&group_by_exprs, std::vector<Expression *> &&expressions);
 
   virtual ~GroupByVecPhysicalOperator() = default;
 
   PhysicalOperatorType type() const override { return PhysicalOperatorType::GROUP_BY_VEC; }
 
-  RC open(Trx *trx) override { return RC::UNIMPLEMENTED; }
-  RC next(Chunk &chunk) override { return RC::UNIMPLEMENTED; }
-  RC close() override { return RC::UNIMPLEMENTED; }
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
 
 private:
-};
\ No newline at end of file
+  std::vector<std::unique_ptr<Expression>> group_by_exprs_;
+  std::vector<Expression *>                aggregate_expressions_;  ///< 聚合表达式
+  std::vector<Expression *>                value_expressions_;      ///< 聚合表达式的参数
+
+  StandardAggregateHashTable          hash_table_;
+  StandardAggregateHashTable::Scanner scanner_;
+
+  Chunk chunk_;
+  Chunk output_chunk_;
+};
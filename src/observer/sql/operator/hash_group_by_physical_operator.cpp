@@ -27,6 +27,8 @@ HashGroupByPhysicalOperator::HashGroupByPhysicalOperator(
 {
 }
 
+HashGroupByPhysicalOperator::~HashGroupByPhysicalOperator() { clear_groups(); }
+
 RC HashGroupByPhysicalOperator::open(Trx *trx)
 {
   ASSERT(children_.size() == 1, "group by operator only support one child, but got %d", children_.size());
@@ -44,6 +46,15 @@ RC HashGroupByPhysicalOperator::open(Trx *trx)
     return rc;
   }
 
+  // 子查询中的算子会被多次打开，每次都重新分组
+  clear_groups();
+  group_by_values_.resize(group_by_exprs_.size());
+  child_specs_.clear();
+  partition_files_.clear();
+  pending_partitions_.clear();
+  spilled_partition_num_ = 0;
+  budget_                = memory_budget_ != nullptr ? memory_budget_ : MemoryBudget::current();
+
   // // 创建 havings 中的聚合表达式等
   // having_aggr_value_exprs_.reserve(having_aggr_exprs_.size());
   // for (Expression *expr : having_aggr_exprs_) {
@@ -60,11 +71,6 @@ RC HashGroupByPhysicalOperator::open(Trx *trx)
   //   having_aggregator_list.emplace_back(aggregate_expr->create_aggregator());
   // }
 
-  ExpressionTuple<Expression *> group_value_expression_tuple(value_expressions_);
-  // ExpressionTuple<Expression *> having_group_value_expression_tuple(having_aggr_value_exprs_);
-
-  ValueListTuple group_by_evaluated_tuple;
-
   while (OB_SUCC(rc = child.next())) {
     Tuple *child_tuple = child.current_tuple();
     if (nullptr == child_tuple) {
@@ -72,30 +78,10 @@ RC HashGroupByPhysicalOperator::open(Trx *trx)
       return RC::INTERNAL;
     }
 
-    // 找到对应的group
-    GroupType *found_group = nullptr;
-    rc                     = find_group(*child_tuple, found_group);
-    if (OB_FAIL(rc)) {
-      LOG_WARN("failed to find group. rc=%s", strrc(rc));
-      return rc;
-    }
-
-    // 计算需要做聚合的值
-    group_value_expression_tuple.set_tuple(child_tuple);
-    // having_group_value_expression_tuple.set_tuple(child_tuple);
-
-    // 计算聚合值
-    GroupValueType &group_value = get<1>(*found_group);
-    rc = aggregate(get<0>(group_value), group_value_expression_tuple);
+    rc = add_row(*child_tuple, 0);
     if (OB_FAIL(rc)) {
-      LOG_WARN("failed to aggregate values. rc=%s", strrc(rc));
       return rc;
     }
-    // rc = aggregate(having_aggregator_list, having_group_value_expression_tuple);
-    // if (OB_FAIL(rc)) {
-    //   LOG_WARN("(having) failed to aggregate values. rc=%s", strrc(rc));
-    //   return rc;
-    // }
   }
 
   if (RC::RECORD_EOF == rc) {
@@ -108,13 +94,9 @@ RC HashGroupByPhysicalOperator::open(Trx *trx)
   }
 
   // 得到最终聚合后的值
-  for (GroupType &group : groups_) {
-    GroupValueType &group_value = get<1>(group);
-    rc = evaluate(group_value);
-    if (OB_FAIL(rc)) {
-      LOG_WARN("failed to evaluate group value. rc=%s", strrc(rc));
-      return rc;
-    }
+  rc = finish_pass(0);
+  if (OB_FAIL(rc)) {
+    return rc;
   }
 
   // having 中 aggr 表达式的结果
@@ -135,17 +117,20 @@ RC HashGroupByPhysicalOperator::open(Trx *trx)
 
 RC HashGroupByPhysicalOperator::next()
 {
-  if (current_group_ == groups_.end()) {
-    return RC::RECORD_EOF;
-  }
-
-  if (first_emited_) {
+  if (first_emited_ && current_group_ != groups_.end()) {
     ++current_group_;
-  } else {
-    first_emited_ = true;
   }
-  if (current_group_ == groups_.end()) {
-    return RC::RECORD_EOF;
+  first_emited_ = true;
+
+  // 内存中的分组输出完之后，再聚合溢出到磁盘上的分区
+  while (current_group_ == groups_.end()) {
+    if (pending_partitions_.empty()) {
+      return RC::RECORD_EOF;
+    }
+    RC rc = aggregate_partition();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
   }
 
   return RC::SUCCESS;
@@ -154,67 +139,230 @@ RC HashGroupByPhysicalOperator::next()
 RC HashGroupByPhysicalOperator::close()
 {
   children_[0]->close();
+  clear_groups();
+  partition_files_.clear();
+  pending_partitions_.clear();
   LOG_INFO("close group by operator");
   return RC::SUCCESS;
 }
 
-Tuple *HashGroupByPhysicalOperator::current_tuple()
+RC HashGroupByPhysicalOperator::add_row(const Tuple &tuple, int depth)
 {
-  if (current_group_ != groups_.end()) {
-    GroupValueType &group_value = get<1>(*current_group_);
-    return &get<1>(group_value);
+  // 找到对应的group
+  GroupValueType *found_group = nullptr;
+  RC              rc          = find_group(tuple, depth, found_group);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to find group. rc=%s", strrc(rc));
+    return rc;
   }
-  return nullptr;
+  if (found_group == nullptr) {
+    return spill_row(tuple, depth);
+  }
+
+  // 计算需要做聚合的值
+  ExpressionTuple<Expression *> group_value_expression_tuple(value_expressions_);
+  group_value_expression_tuple.set_tuple(&tuple);
+
+  // 计算聚合值
+  rc = aggregate(get<0>(*found_group), group_value_expression_tuple);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to aggregate values. rc=%s", strrc(rc));
+  }
+  return rc;
 }
 
-RC HashGroupByPhysicalOperator::find_group(const Tuple &child_tuple, GroupType *&found_group)
+RC HashGroupByPhysicalOperator::spill_row(const Tuple &tuple, int depth)
 {
-  found_group = nullptr;
+  const int cell_num = tuple.cell_num();
+  if (child_specs_.empty()) {
+    child_specs_.resize(cell_num);
+    for (int i = 0; i < cell_num; i++) {
+      tuple.spec_at(i, child_specs_[i]);
+    }
+    spill_tuple_.set_names(child_specs_);
+  }
 
-  RC rc = RC::SUCCESS;
+  // group_key_ 是 find_group 刚刚计算出来的，同一个分组的记录一定进入同一个分区
+  const size_t hash      = std::hash<string_view>()(group_key_);
+  const size_t partition = (hash >> (depth * SPILL_PARTITION_BITS)) % SPILL_PARTITION_NUM;
+  partition_files_.resize(SPILL_PARTITION_NUM);
+  unique_ptr<SpillFile> &file = partition_files_[partition];
 
-  ExpressionTuple<unique_ptr<Expression>> group_by_expression_tuple(group_by_exprs_);
-  ValueListTuple                          group_by_evaluated_tuple;
-  group_by_expression_tuple.set_tuple(&child_tuple);
-  rc = ValueListTuple::make(group_by_expression_tuple, group_by_evaluated_tuple);
-  if (OB_FAIL(rc)) {
-    LOG_WARN("failed to get values from expression tuple. rc=%s", strrc(rc));
+  RC rc = RC::SUCCESS;
+  if (file == nullptr && OB_FAIL(rc = SpillFile::create(file))) {
     return rc;
   }
 
-  // 找到对应的group
-  for (GroupType &group : groups_) {
-    int compare_result = 0;
-    rc                 = group_by_evaluated_tuple.compare(get<0>(group), compare_result);
+  spill_values_.resize(cell_num);
+  for (int i = 0; i < cell_num; i++) {
+    if (OB_FAIL(rc = tuple.cell_at(i, spill_values_[i]))) {
+      return rc;
+    }
+  }
+  return file->write_row(string_view(), spill_values_.data(), cell_num);
+}
+
+RC HashGroupByPhysicalOperator::finish_pass(int depth)
+{
+  RC rc = RC::SUCCESS;
+  for (GroupValueType &group_value : groups_) {
+    rc = evaluate(group_value);
     if (OB_FAIL(rc)) {
-      LOG_WARN("failed to compare group by values. rc=%s", strrc(rc));
+      LOG_WARN("failed to evaluate group value. rc=%s", strrc(rc));
       return rc;
     }
+  }
+
+  for (unique_ptr<SpillFile> &file : partition_files_) {
+    if (file == nullptr) {
+      continue;
+    }
+    if (OB_FAIL(rc = file->rewind())) {
+      return rc;
+    }
+    LOG_INFO("HASH-GROUP-BY: spill a partition. rows=%zu, depth=%d", file->row_num(), depth);
+    pending_partitions_.push_back(SpillPartition{std::move(file), depth + 1});
+    spilled_partition_num_++;
+  }
+  partition_files_.clear();
+
+  current_group_ = groups_.begin();
+  return rc;
+}
+
+RC HashGroupByPhysicalOperator::aggregate_partition()
+{
+  SpillPartition partition = std::move(pending_partitions_.back());
+  pending_partitions_.pop_back();
+
+  clear_groups();
 
-    if (compare_result == 0) {
-      found_group = &group;
-      break;
+  RC rc = RC::SUCCESS;
+  while (OB_SUCC(rc = partition.file->read_row(spill_key_, spill_values_))) {
+    spill_tuple_.set_cells(spill_values_);
+    rc = add_row(spill_tuple_, partition.depth);
+    if (OB_FAIL(rc)) {
+      return rc;
     }
   }
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to read spilled rows. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  return finish_pass(partition.depth);
+}
+
+void HashGroupByPhysicalOperator::clear_groups()
+{
+  groups_.clear();
+  group_index_.clear();
+  key_arena_.clear();
+  current_group_ = groups_.end();
+  if (budget_ != nullptr) {
+    budget_->release(memory_used_);
+  }
+  memory_used_ = 0;
+}
+
+Tuple *HashGroupByPhysicalOperator::current_tuple()
+{
+  if (current_group_ != groups_.end()) {
+    return &get<1>(*current_group_);
+  }
+  return nullptr;
+}
 
-  // 如果没有找到对应的group，创建一个新的group
-  if (nullptr == found_group) {
-    AggregatorList aggregator_list;
-    create_aggregator_list(aggregator_list);
+void HashGroupByPhysicalOperator::encode_group_key(const Value &value, string &key)
+{
+  const AttrType attr_type = value.attr_type();
+  key.push_back(static_cast<char>(attr_type));
+  switch (attr_type) {
+    case AttrType::NULLS: break;
+    case AttrType::INTS:
+    case AttrType::DATES:
+    case AttrType::BOOLEANS: {
+      key.append(value.data(), value.length());
+    } break;
+    case AttrType::FLOATS: {
+      // 0.0 和 -0.0 比较时相等，编码也要相同
+      float number = value.get_float();
+      if (number == 0) {
+        number = 0;
+      }
+      key.append(reinterpret_cast<const char *>(&number), sizeof(number));
+    } break;
+    case AttrType::CHARS: {
+      const uint32_t len = static_cast<uint32_t>(strnlen(value.data(), value.length()));
+      key.append(reinterpret_cast<const char *>(&len), sizeof(len));
+      key.append(value.data(), len);
+    } break;
+    default: {
+      const string   str = value.to_string();
+      const uint32_t len = static_cast<uint32_t>(str.size());
+      key.append(reinterpret_cast<const char *>(&len), sizeof(len));
+      key.append(str);
+    } break;
+  }
+}
+
+RC HashGroupByPhysicalOperator::find_group(const Tuple &child_tuple, int depth, GroupValueType *&found_group)
+{
+  found_group = nullptr;
+
+  RC rc = RC::SUCCESS;
 
-    ValueListTuple child_tuple_to_value;
-    rc = ValueListTuple::make(child_tuple, child_tuple_to_value);
+  group_key_.clear();
+  for (size_t i = 0; i < group_by_exprs_.size(); i++) {
+    rc = group_by_exprs_[i]->get_value(child_tuple, group_by_values_[i]);
     if (OB_FAIL(rc)) {
-      LOG_WARN("failed to make tuple to value list. rc=%s", strrc(rc));
+      LOG_WARN("failed to get value of group by expression. rc=%s", strrc(rc));
       return rc;
     }
+    encode_group_key(group_by_values_[i], group_key_);
+  }
 
-    CompositeTuple composite_tuple;
-    composite_tuple.add_tuple(make_unique<ValueListTuple>(std::move(child_tuple_to_value)));
-    groups_.emplace_back(std::move(group_by_evaluated_tuple), 
-                         GroupValueType(std::move(aggregator_list), std::move(composite_tuple)));
-    found_group = &groups_.back();
+  // 找到对应的group
+  auto iter = group_index_.find(string_view(group_key_));
+  if (iter != group_index_.end()) {
+    found_group = &groups_[iter->second];
+    return rc;
+  }
+
+  // 如果没有找到对应的group，创建一个新的group，先估算它需要的内存
+  if (budget_ != nullptr) {
+    // 分组本身、哈希表中的节点和键、每个聚合函数的状态和结果
+    size_t group_memory = sizeof(GroupValueType) + 8 * sizeof(void *) + group_key_.size() +
+                          aggregate_expressions_.size() * 2 * sizeof(Value);
+    Value  cell;
+    for (int i = 0; i < child_tuple.cell_num(); i++) {
+      child_tuple.cell_at(i, cell);
+      group_memory += MemoryBudget::value_memory(cell) + sizeof(TupleCellSpec);
+    }
+    if (!budget_->try_consume(group_memory)) {
+      // 至少保留一个分组，保证每一轮都能处理掉一部分记录
+      if (depth < MAX_SPILL_DEPTH && !groups_.empty()) {
+        return rc;
+      }
+      budget_->consume(group_memory);
+    }
+    memory_used_ += group_memory;
   }
 
+  AggregatorList aggregator_list;
+  create_aggregator_list(aggregator_list);
+
+  ValueListTuple child_tuple_to_value;
+  rc = ValueListTuple::make(child_tuple, child_tuple_to_value);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to make tuple to value list. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  CompositeTuple composite_tuple;
+  composite_tuple.add_tuple(make_unique<ValueListTuple>(std::move(child_tuple_to_value)));
+  groups_.emplace_back(std::move(aggregator_list), std::move(composite_tuple));
+  group_index_.emplace(key_arena_.copy(group_key_), groups_.size() - 1);
+  found_group = &groups_.back();
   return rc;
-}
\ No newline at end of file
+}
@@ -14,15 +14,28 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/string.h"
+#include "common/lang/string_view.h"
+#include "common/lang/unordered_map.h"
+#include "common/memory_budget.h"
+#include "common/mm/arena.h"
 #include "sql/operator/group_by_physical_operator.h"
+#include "sql/operator/spill_file.h"
 #include "sql/expr/composite_tuple.h"
 
 /**
  * @brief Group By Hash 方式物理算子
  * @ingroup PhysicalOperator
  * @details 通过 hash 的方式进行 group by 操作。当聚合函数存在 group by
- * 表达式时，默认采用这个物理算子（当前也只有这个物理算子）。 NOTE:
- * 当前并没有使用hash方式实现，而是每次使用线性查找的方式。
+ * 表达式时，默认采用这个物理算子（当前也只有这个物理算子）。
+ * 每条记录的 group by 值编码成一个字节串作为哈希表的键，值相等当且仅当编码相等，
+ * 所以查找分组时只需要计算一次哈希并比较字节串。编码使用的缓冲区和 Value 在记录之间复用，
+ * 只有出现新的分组时才把键拷贝到 Arena 中，处理已有分组的记录时不需要分配内存。
+ *
+ * 新的分组超出内存预算（MemoryBudget）时，已有分组的记录照常聚合，
+ * 属于新分组的记录按照键的哈希值写到若干个分区文件中。输出完内存中的分组后，
+ * 再逐个读取分区文件重新聚合，分区仍然放不下时用哈希值的其它位继续拆分。
+ * 同一个分组的记录一定在同一个分区中，所以每个分组只会输出一次。
  */
 class HashGroupByPhysicalOperator : public GroupByPhysicalOperator
 {
@@ -31,7 +44,7 @@ public:
       std::vector<std::unique_ptr<Expression>> &&group_by_exprs, 
       std::vector<Expression *> &&expressions);
 
-  virtual ~HashGroupByPhysicalOperator() = default;
+  virtual ~HashGroupByPhysicalOperator();
 
   PhysicalOperatorType type() const override { return PhysicalOperatorType::HASH_GROUP_BY; }
 
@@ -41,25 +54,79 @@ public:
 
   Tuple *current_tuple() override;
 
+  /**
+   * @brief 指定使用的内存预算，没有指定时使用当前会话的预算
+   */
+  void set_memory_budget(MemoryBudget *memory_budget) { memory_budget_ = memory_budget; }
+
+  /// 最近一次执行时写到磁盘上的分区个数
+  size_t spilled_partition_num() const { return spilled_partition_num_; }
+
+  /**
+   * @brief 把 group by 的值编码到 key 的末尾
+   * @details 每个值先写一个字节的类型，null 只有这一个字节。定长的值按照内存表示写入，
+   * 字符串先写长度再写内容，这样不同的值列表编码后一定不同。
+   */
+  static void encode_group_key(const Value &value, string &key);
+
 private:
   using AggregatorList = GroupByPhysicalOperator::AggregatorList;
   using GroupValueType = GroupByPhysicalOperator::GroupValueType;
-  /// 聚合出来的一组数据
-  using GroupType = std::tuple<ValueListTuple, GroupValueType>;
+
+  /// 每次溢出时用哈希值中的这么多位划分分区
+  static constexpr int SPILL_PARTITION_BITS = 3;
+  static constexpr int SPILL_PARTITION_NUM  = 1 << SPILL_PARTITION_BITS;
+  /// 拆分这么多次之后不再溢出，避免哈希值的位用完
+  static constexpr int MAX_SPILL_DEPTH = 10;
+
+  struct SpillPartition
+  {
+    unique_ptr<SpillFile> file;
+    int                   depth = 0;  ///< 被拆分的次数，决定使用哈希值的哪几位
+  };
 
 private:
-  RC find_group(const Tuple &child_tuple, GroupType *&found_group);
+  /**
+   * @brief 查找记录所在的分组，没有时创建一个
+   * @details 创建分组超出内存预算时不创建，found_group 为 nullptr，记录需要溢出到分区文件中
+   */
+  RC find_group(const Tuple &child_tuple, int depth, GroupValueType *&found_group);
+
+  RC add_row(const Tuple &tuple, int depth);
+  RC spill_row(const Tuple &tuple, int depth);
+  /// 一轮聚合结束，计算分组的结果，把这一轮的分区文件放到待处理的列表中
+  RC finish_pass(int depth);
+  /// 聚合下一个待处理的分区
+  RC aggregate_partition();
+  void clear_groups();
 
 private:
   std::vector<std::unique_ptr<Expression>> group_by_exprs_;
 
-  /// 一组一条数据
-  /// pair的first是group by 的值列表，second是计算出来的表达式值列表
-  /// TODO 改成hash/unordered_map
-  std::vector<GroupType> groups_;
+  /// 一组一条数据，按照分组出现的顺序存放
+  std::vector<GroupValueType> groups_;
+  /// 编码后的 group by 值到 groups_ 中下标的映射，键的内存在 key_arena_ 中
+  unordered_map<string_view, size_t> group_index_;
+  common::Arena                      key_arena_;
+
+  /// 计算 group by 值和编码时复用的内存
+  std::vector<Value> group_by_values_;
+  string             group_key_;
+
+  std::vector<GroupValueType>::iterator current_group_;
+  bool                                  first_emited_ = false;  /// 第一条数据是否已经输出
+
+  MemoryBudget *memory_budget_ = nullptr;
+  MemoryBudget *budget_        = nullptr;  ///< 本次执行使用的预算，nullptr 表示不限制
+  size_t        memory_used_   = 0;        ///< 向预算申请的内存
 
-  std::vector<GroupType>::iterator current_group_;
-  bool                             first_emited_ = false;  /// 第一条数据是否已经输出
+  std::vector<TupleCellSpec>         child_specs_;      ///< 写到分区文件中的记录的列
+  std::vector<unique_ptr<SpillFile>> partition_files_;  ///< 当前这一轮聚合的分区文件
+  std::vector<SpillPartition>        pending_partitions_;
+  size_t                             spilled_partition_num_ = 0;
+  ValueListTuple                     spill_tuple_;  ///< 从分区文件中读出来的记录
+  std::vector<Value>                 spill_values_;
+  string                             spill_key_;
 
   std::vector<Expression *> having_aggr_value_exprs_;
   std::vector<Expression *> having_aggr_exprs_;
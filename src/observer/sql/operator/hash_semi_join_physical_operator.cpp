@@ -0,0 +1,160 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/hash_semi_join_physical_operator.h"
+#include "common/log/log.h"
+#include "sql/operator/hash_group_by_physical_operator.h"
+
+using namespace std;
+
+HashSemiJoinPhysicalOperator::HashSemiJoinPhysicalOperator(
+    JoinType join_type, vector<unique_ptr<Expression>> &&left_keys, vector<unique_ptr<Expression>> &&right_keys)
+    : join_type_(join_type), left_keys_(std::move(left_keys)), right_keys_(std::move(right_keys))
+{
+  ASSERT(join_type_ != JoinType::INNER, "hash semi join does not support inner join");
+  ASSERT(left_keys_.size() == right_keys_.size(), "the number of join keys does not match");
+}
+
+string HashSemiJoinPhysicalOperator::param() const
+{
+  return join_type_ == JoinType::NULL_AWARE_ANTI ? "null_aware" : "";
+}
+
+RC HashSemiJoinPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 2) {
+    LOG_WARN("hash semi join operator should have 2 children");
+    return RC::INTERNAL;
+  }
+
+  if (outer_tuple != nullptr) {
+    children_[0]->set_outer_tuple(outer_tuple);
+    children_[1]->set_outer_tuple(outer_tuple);
+  }
+
+  RC rc = build(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to build hash set of semi join. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = children_[0]->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open left child of semi join. rc=%s", strrc(rc));
+  }
+  return rc;
+}
+
+RC HashSemiJoinPhysicalOperator::build(Trx *trx)
+{
+  hash_set_.clear();
+  right_empty_    = true;
+  right_has_null_ = false;
+
+  PhysicalOperator *right = children_[1].get();
+  RC                rc    = right->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open right child of semi join. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  while (OB_SUCC(rc = right->next())) {
+    right_empty_  = false;
+    bool has_null = false;
+    rc            = encode_key(right_keys_, *right->current_tuple(), has_null);
+    if (OB_FAIL(rc)) {
+      break;
+    }
+    if (has_null) {
+      right_has_null_ = true;
+      continue;
+    }
+    hash_set_.insert(key_);
+  }
+
+  RC close_rc = right->close();
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to read right child of semi join. rc=%s", strrc(rc));
+    return rc;
+  }
+  return close_rc;
+}
+
+RC HashSemiJoinPhysicalOperator::next()
+{
+  PhysicalOperator *left = children_[0].get();
+  RC                rc   = RC::SUCCESS;
+  while (OB_SUCC(rc = left->next())) {
+    if (join_type_ == JoinType::NULL_AWARE_ANTI) {
+      if (right_empty_) {
+        return rc;
+      }
+      if (right_has_null_) {
+        // 右表有 null，NOT IN 不可能为 true
+        return RC::RECORD_EOF;
+      }
+    }
+
+    bool has_null = false;
+    rc            = encode_key(left_keys_, *left->current_tuple(), has_null);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    const bool found = !has_null && hash_set_.count(key_) > 0;
+    switch (join_type_) {
+      case JoinType::SEMI: {
+        if (found) {
+          return rc;
+        }
+      } break;
+      case JoinType::ANTI: {
+        if (!found) {
+          return rc;
+        }
+      } break;
+      case JoinType::NULL_AWARE_ANTI: {
+        if (!has_null && !found) {
+          return rc;
+        }
+      } break;
+      default: {
+        LOG_WARN("unsupported join type. %d", static_cast<int>(join_type_));
+        return RC::INTERNAL;
+      }
+    }
+  }
+  return rc;
+}
+
+RC HashSemiJoinPhysicalOperator::close()
+{
+  hash_set_.clear();
+  return children_[0]->close();
+}
+
+RC HashSemiJoinPhysicalOperator::encode_key(const vector<unique_ptr<Expression>> &exprs, const Tuple &tuple, bool &has_null)
+{
+  key_.clear();
+  for (const unique_ptr<Expression> &expr : exprs) {
+    Value value;
+    RC    rc = expr->get_value(tuple, value);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get value of join key. rc=%s", strrc(rc));
+      return rc;
+    }
+    if (value.is_null()) {
+      has_null = true;
+      return RC::SUCCESS;
+    }
+    HashGroupByPhysicalOperator::encode_group_key(value, key_);
+  }
+  return RC::SUCCESS;
+}
@@ -0,0 +1,71 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/string.h"
+#include "common/lang/unordered_set.h"
+#include "sql/operator/join_logical_operator.h"
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 哈希半连接/反连接物理算子
+ * @ingroup PhysicalOperator
+ * @details 第一个子算子是左表（探测端），第二个子算子是右表（构建端）。open 时读取右表的全部数据，
+ * 把 right_keys 的值编码后放到哈希集合中，然后逐行读取左表，用 left_keys 的值查找，只输出左表的行。
+ * 任何一个键为 null 的行都不会匹配。
+ * - SEMI: 找到匹配时输出，对应 IN 和 EXISTS；
+ * - ANTI: 没有匹配时输出，对应 NOT EXISTS；
+ * - NULL_AWARE_ANTI: 对应 NOT IN。右表为空时输出所有行；否则左表的键为 null，
+ *   或者右表中有 null 时，NOT IN 的结果是 null，不输出；其它情况与 ANTI 相同。
+ */
+class HashSemiJoinPhysicalOperator : public PhysicalOperator
+{
+public:
+  HashSemiJoinPhysicalOperator(JoinType join_type, std::vector<std::unique_ptr<Expression>> &&left_keys,
+      std::vector<std::unique_ptr<Expression>> &&right_keys);
+
+  virtual ~HashSemiJoinPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override
+  {
+    return join_type_ == JoinType::SEMI ? PhysicalOperatorType::HASH_SEMI_JOIN : PhysicalOperatorType::HASH_ANTI_JOIN;
+  }
+
+  std::string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+
+  Tuple *current_tuple() override { return children_[0]->current_tuple(); }
+
+  RC tuple_schema(TupleSchema &schema) const override { return children_[0]->tuple_schema(schema); }
+
+private:
+  RC build(Trx *trx);
+
+  /**
+   * @brief 计算 tuple 上的键并编码到 key_ 中
+   * @param has_null 有一个键为 null 时设置为 true
+   */
+  RC encode_key(const std::vector<std::unique_ptr<Expression>> &exprs, const Tuple &tuple, bool &has_null);
+
+private:
+  JoinType                                 join_type_;
+  std::vector<std::unique_ptr<Expression>> left_keys_;
+  std::vector<std::unique_ptr<Expression>> right_keys_;
+
+  unordered_set<string> hash_set_;
+  bool                  right_empty_    = true;   ///< 右表是否没有数据
+  bool                  right_has_null_ = false;  ///< 右表是否有键为 null 的行
+
+  string key_;  ///< 编码键时复用的内存
+};
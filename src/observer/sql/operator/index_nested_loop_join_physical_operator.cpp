@@ -0,0 +1,149 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/index_nested_loop_join_physical_operator.h"
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+IndexNestedLoopJoinPhysicalOperator::IndexNestedLoopJoinPhysicalOperator(
+    Table *table, Index *index, ReadWriteMode mode, std::unique_ptr<Expression> left_key)
+    : table_(table), index_(index), mode_(mode), left_key_(std::move(left_key))
+{}
+
+RC IndexNestedLoopJoinPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 1) {
+    LOG_WARN("index nested loop join operator should have 1 child");
+    return RC::INTERNAL;
+  }
+
+  record_handler_ = table_->record_handler();
+  if (nullptr == record_handler_) {
+    LOG_WARN("invalid record handler");
+    return RC::INTERNAL;
+  }
+
+  right_tuple_.set_schema(table_, table_->table_meta().field_metas());
+  right_tuple_.table_alias_ = table_alias_;
+
+  left_       = children_[0].get();
+  left_tuple_ = nullptr;
+  round_done_ = true;
+  trx_        = trx;
+  return left_->open(trx);
+}
+
+RC IndexNestedLoopJoinPhysicalOperator::next()
+{
+  RC  rc = RC::SUCCESS;
+  RID rid;
+  while (true) {
+    if (round_done_) {
+      rc = left_next();
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+      continue;
+    }
+
+    rc = index_scanner_->next_entry(&rid);
+    if (rc == RC::RECORD_EOF) {
+      round_done_ = true;
+      continue;
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get next index entry. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    rc = record_handler_->get_record(rid, current_record_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+
+    rc = trx_->visit_record(table_, current_record_, mode_);
+    if (rc == RC::RECORD_INVISIBLE) {
+      continue;
+    }
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    right_tuple_.set_record(&current_record_);
+    joined_tuple_.set_right(&right_tuple_);
+    return RC::SUCCESS;
+  }
+}
+
+RC IndexNestedLoopJoinPhysicalOperator::close()
+{
+  if (index_scanner_ != nullptr) {
+    index_scanner_->destroy();
+    index_scanner_ = nullptr;
+  }
+
+  RC rc = left_->close();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to close left oper. rc=%s", strrc(rc));
+  }
+  return rc;
+}
+
+Tuple *IndexNestedLoopJoinPhysicalOperator::current_tuple() { return &joined_tuple_; }
+
+RC IndexNestedLoopJoinPhysicalOperator::left_next()
+{
+  RC rc = left_->next();
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  left_tuple_ = left_->current_tuple();
+  joined_tuple_.set_left(left_tuple_);
+
+  Value key;
+  rc = left_key_->get_value(*left_tuple_, key);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get join key from left tuple. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  // null 与任何值都不相等，这一行不会有匹配的记录
+  if (key.is_null()) {
+    return RC::SUCCESS;
+  }
+
+  std::vector<IndexUserKey> keys{IndexUserKey(key)};
+  if (nullptr == index_scanner_) {
+    index_scanner_ = index_->create_scanner(keys, true /*left_inclusive*/, keys, true /*right_inclusive*/);
+    if (nullptr == index_scanner_) {
+      LOG_WARN("failed to create index scanner");
+      return RC::INTERNAL;
+    }
+  } else {
+    rc = index_scanner_->rescan(keys, true /*left_inclusive*/, keys, true /*right_inclusive*/);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to rescan index. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  round_done_ = false;
+  return RC::SUCCESS;
+}
+
+std::string IndexNestedLoopJoinPhysicalOperator::param() const
+{
+  return std::string(index_->index_meta().name()) + " ON " + table_->name();
+}
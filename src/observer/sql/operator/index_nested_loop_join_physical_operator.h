@@ -0,0 +1,67 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/expr/tuple.h"
+#include "sql/operator/physical_operator.h"
+#include "storage/record/record_manager.h"
+
+class Index;
+class IndexScanner;
+
+/**
+ * @brief 索引嵌套循环连接算子
+ * @ingroup PhysicalOperator
+ * @details 右表（内表）在连接列上有索引时，对左表的每一行计算连接键，用它在右表的索引上做等值查找，
+ * 只访问匹配的记录，而不是像 NestedLoopJoinPhysicalOperator 那样每一行都把右表完整扫描一遍。
+ * 这样连接的代价与左表的行数成正比，适合左表小、右表大的情况。
+ * 只有一个子算子，即左表；右表直接通过 table_ 和 index_ 访问。所有查找复用同一个索引扫描器。
+ * 连接条件本身仍然由上层的 Predicate 算子判断，这里只负责根据索引找出候选的行。
+ */
+class IndexNestedLoopJoinPhysicalOperator : public PhysicalOperator
+{
+public:
+  IndexNestedLoopJoinPhysicalOperator(
+      Table *table, Index *index, ReadWriteMode mode, std::unique_ptr<Expression> left_key);
+  virtual ~IndexNestedLoopJoinPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::INDEX_NESTED_LOOP_JOIN; }
+
+  std::string param() const override;
+
+  RC     open(Trx *trx) override;
+  RC     next() override;
+  RC     close() override;
+  Tuple *current_tuple() override;
+
+  void set_table_alias(const std::string &table_alias) { table_alias_ = table_alias; }
+
+private:
+  RC left_next();  //! 左表遍历下一条数据，并用它的连接键重新开始索引查找
+
+private:
+  Trx               *trx_            = nullptr;
+  Table             *table_          = nullptr;
+  Index             *index_          = nullptr;
+  ReadWriteMode      mode_           = ReadWriteMode::READ_WRITE;
+  std::string        table_alias_;
+  IndexScanner      *index_scanner_  = nullptr;
+  RecordFileHandler *record_handler_ = nullptr;
+
+  std::unique_ptr<Expression> left_key_;  ///< 在左表的行上计算，与右表的索引列比较
+
+  PhysicalOperator *left_       = nullptr;
+  Tuple            *left_tuple_ = nullptr;
+  Record            current_record_;
+  RowTuple          right_tuple_;
+  JoinedTuple       joined_tuple_;
+  bool              round_done_ = true;  //! 当前左表行的索引查找是否结束
+};
@@ -59,12 +59,17 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
 
   tuple_.set_schema(table_, table_->table_meta().field_metas());
 
-  trx_ = trx;
+  trx_   = trx;
+  count_ = 0;
   return RC::SUCCESS;
 }
 
 RC IndexScanPhysicalOperator::next()
 {
+  if (limit_ >= 0 && count_ >= limit_) {
+    return RC::RECORD_EOF;
+  }
+
   RID rid;
   RC  rc = RC::SUCCESS;
 
@@ -95,6 +100,9 @@ RC IndexScanPhysicalOperator::next()
       LOG_TRACE("record invisible");
       continue;
     } else {
+      if (OB_SUCC(rc)) {
+        count_++;
+      }
       return rc;
     }
   }
@@ -143,5 +151,9 @@ RC IndexScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
 
 std::string IndexScanPhysicalOperator::param() const
 {
-  return std::string(index_->index_meta().name()) + " ON " + table_->name();
+  std::string param = std::string(index_->index_meta().name()) + " ON " + table_->name();
+  if (limit_ >= 0) {
+    param += ", limit=" + std::to_string(limit_);
+  }
+  return param;
 }
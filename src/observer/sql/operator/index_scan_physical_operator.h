@@ -42,6 +42,9 @@ public:
 
   void set_predicates(std::vector<std::unique_ptr<Expression>> &&exprs);
 
+  /// 返回 limit 行之后就结束扫描，-1 表示不限制
+  void set_limit(int limit) { limit_ = limit; }
+
   bool is_or_conjunction = false;
 
 private:
@@ -64,5 +67,8 @@ private:
   bool               left_inclusive_  = false;
   bool               right_inclusive_ = false;
 
+  int limit_ = -1;
+  int count_ = 0;  ///< 已经返回的记录数
+
   std::vector<std::unique_ptr<Expression>> predicates_;
 };
@@ -16,18 +16,43 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/operator/logical_operator.h"
 
+/**
+ * @brief 连接的类型
+ * @ingroup LogicalOperator
+ */
+enum class JoinType
+{
+  INNER,            ///< 内连接，输出左右两边组合起来的行
+  SEMI,             ///< 半连接，左表的行在右表中有匹配时输出，用于 IN/EXISTS
+  ANTI,             ///< 反连接，左表的行在右表中没有匹配时输出，用于 NOT EXISTS
+  NULL_AWARE_ANTI,  ///< 考虑 null 的反连接，用于 NOT IN
+};
+
 /**
  * @brief 连接算子
  * @ingroup LogicalOperator
  * @details 连接算子，用于连接两个表。对应的物理算子或者实现，可能有NestedLoopJoin，HashJoin等等。
+ * 半连接和反连接由子查询改写得到（见 SubqueryToJoinRewriter），只输出左表的行，
+ * 按 left_keys 和 right_keys 逐个相等来匹配。
  */
 class JoinLogicalOperator : public LogicalOperator
 {
 public:
   JoinLogicalOperator()          = default;
+  JoinLogicalOperator(JoinType join_type, std::vector<std::unique_ptr<Expression>> &&left_keys,
+      std::vector<std::unique_ptr<Expression>> &&right_keys)
+      : join_type_(join_type), left_keys_(std::move(left_keys)), right_keys_(std::move(right_keys))
+  {}
   virtual ~JoinLogicalOperator() = default;
 
   LogicalOperatorType type() const override { return LogicalOperatorType::JOIN; }
 
+  JoinType                                  join_type() const { return join_type_; }
+  std::vector<std::unique_ptr<Expression>> &left_keys() { return left_keys_; }
+  std::vector<std::unique_ptr<Expression>> &right_keys() { return right_keys_; }
+
 private:
+  JoinType                                 join_type_ = JoinType::INNER;
+  std::vector<std::unique_ptr<Expression>> left_keys_;   ///< 在左表的行上计算
+  std::vector<std::unique_ptr<Expression>> right_keys_;  ///< 在右表的行上计算
 };
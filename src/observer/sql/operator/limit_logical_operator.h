@@ -0,0 +1,43 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#pragma once
+
+#include "common/lang/algorithm.h"
+#include "sql/operator/logical_operator.h"
+
+/**
+ * @brief limit 表示只返回部分结果
+ * @ingroup LogicalOperator
+ * @details 跳过前 offset 行，然后最多返回 limit 行。子算子是排序时可以合并成 Top-N，
+ * 子算子是表扫描时会把 limit + offset 下推到扫描中，见 LimitPushdownRewriter。
+ */
+class LimitLogicalOperator : public LogicalOperator
+{
+public:
+  LimitLogicalOperator(int limit, int offset) : limit_(limit), offset_(offset) {}
+  virtual ~LimitLogicalOperator() = default;
+
+  LogicalOperatorType type() const override { return LogicalOperatorType::LIMIT; }
+
+  int limit() const { return limit_; }
+  int offset() const { return offset_; }
+
+  /// 子算子最多需要产生的行数，即 limit + offset
+  int fetch_num() const
+  {
+    return static_cast<int>(std::min<int64_t>(static_cast<int64_t>(limit_) + offset_, INT32_MAX));
+  }
+
+private:
+  int limit_  = -1;
+  int offset_ = 0;
+};
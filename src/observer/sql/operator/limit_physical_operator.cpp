@@ -0,0 +1,74 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#include "sql/operator/limit_physical_operator.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+string LimitPhysicalOperator::param() const
+{
+  string param = "limit=" + std::to_string(limit_);
+  if (offset_ > 0) {
+    param += ", offset=" + std::to_string(offset_);
+  }
+  return param;
+}
+
+RC LimitPhysicalOperator::open(Trx *trx)
+{
+  count_   = 0;
+  skipped_ = 0;
+  if (children_.empty()) {
+    return RC::SUCCESS;
+  }
+
+  PhysicalOperator *child = children_[0].get();
+  if (outer_tuple != nullptr) {
+    child->set_outer_tuple(outer_tuple);
+  }
+
+  RC rc = child->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open child operator: %s", strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC LimitPhysicalOperator::next()
+{
+  if (children_.empty() || count_ >= limit_) {
+    return RC::RECORD_EOF;
+  }
+
+  PhysicalOperator *child = children_[0].get();
+  RC                rc    = RC::SUCCESS;
+  for (; skipped_ < offset_; skipped_++) {
+    if (OB_FAIL(rc = child->next())) {
+      return rc;
+    }
+  }
+
+  rc = child->next();
+  if (OB_SUCC(rc)) {
+    count_++;
+  }
+  return rc;
+}
+
+RC LimitPhysicalOperator::close()
+{
+  if (!children_.empty()) {
+    children_[0]->close();
+  }
+  return RC::SUCCESS;
+}
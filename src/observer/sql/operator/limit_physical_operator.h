@@ -0,0 +1,46 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#pragma once
+
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief limit 物理算子
+ * @ingroup PhysicalOperator
+ * @details 跳过子算子输出的前 offset 行，再返回 limit 行之后就不再从子算子读取数据，
+ * 下层的扫描、连接等算子也就不用产生剩下的数据了。
+ */
+class LimitPhysicalOperator : public PhysicalOperator
+{
+public:
+  LimitPhysicalOperator(int limit, int offset) : limit_(limit), offset_(offset) {}
+
+  virtual ~LimitPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::LIMIT; }
+
+  std::string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+
+  Tuple *current_tuple() override { return children_[0]->current_tuple(); }
+
+  RC tuple_schema(TupleSchema &schema) const override { return children_[0]->tuple_schema(schema); }
+
+private:
+  int limit_   = -1;
+  int offset_  = 0;
+  int count_   = 0;  ///< 已经返回的行数
+  int skipped_ = 0;  ///< 已经跳过的行数
+};
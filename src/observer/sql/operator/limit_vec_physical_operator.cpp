@@ -0,0 +1,92 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#include "sql/operator/limit_vec_physical_operator.h"
+#include "common/lang/algorithm.h"
+#include "common/log/log.h"
+
+using namespace std;
+
+string LimitVecPhysicalOperator::param() const
+{
+  string param = "limit=" + std::to_string(limit_);
+  if (offset_ > 0) {
+    param += ", offset=" + std::to_string(offset_);
+  }
+  return param;
+}
+
+RC LimitVecPhysicalOperator::open(Trx *trx)
+{
+  count_   = 0;
+  skipped_ = 0;
+  if (children_.empty()) {
+    return RC::SUCCESS;
+  }
+
+  RC rc = children_[0]->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open child operator: %s", strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC LimitVecPhysicalOperator::next(Chunk &chunk)
+{
+  if (children_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  RC rc = RC::SUCCESS;
+  while (count_ < limit_) {
+    child_chunk_.reset();
+    if (OB_FAIL(rc = children_[0]->next(child_chunk_))) {
+      return rc;
+    }
+
+    const int rows  = child_chunk_.rows();
+    const int begin = std::min(offset_ - skipped_, rows);
+    const int end   = std::min(rows, begin + (limit_ - count_));
+    skipped_ += begin;
+    if (begin >= end) {
+      continue;
+    }
+
+    count_ += end - begin;
+    if (begin == 0 && end == rows) {
+      return chunk.reference(child_chunk_);
+    }
+
+    select_.assign(rows, 0);
+    std::fill(select_.begin() + begin, select_.begin() + end, 1);
+    output_chunk_.reset();
+    for (int i = 0; i < child_chunk_.column_num(); i++) {
+      const Column &column = child_chunk_.column(i);
+      auto          output_column = make_unique<Column>(column.attr_type(), column.attr_len(), end - begin);
+      if (OB_FAIL(rc = output_column->append_selected(column, select_))) {
+        LOG_WARN("failed to copy rows of limit. rc=%s", strrc(rc));
+        return rc;
+      }
+      output_chunk_.add_column(std::move(output_column), child_chunk_.column_ids(i));
+    }
+    return chunk.reference(output_chunk_);
+  }
+  return RC::RECORD_EOF;
+}
+
+RC LimitVecPhysicalOperator::close()
+{
+  if (!children_.empty()) {
+    children_[0]->close();
+  }
+  return RC::SUCCESS;
+}
@@ -0,0 +1,49 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#pragma once
+
+#include "sql/operator/physical_operator.h"
+#include "storage/common/chunk.h"
+
+/**
+ * @brief limit 物理算子(vectorized)
+ * @ingroup PhysicalOperator
+ * @details 整个 chunk 都在 [offset, offset + limit) 范围内时直接引用子算子的 chunk，
+ * 否则只拷贝范围内的行。
+ */
+class LimitVecPhysicalOperator : public PhysicalOperator
+{
+public:
+  LimitVecPhysicalOperator(int limit, int offset) : limit_(limit), offset_(offset) {}
+
+  virtual ~LimitVecPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::LIMIT_VEC; }
+
+  std::string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+  RC tuple_schema(TupleSchema &schema) const override { return children_[0]->tuple_schema(schema); }
+
+private:
+  int limit_   = -1;
+  int offset_  = 0;
+  int count_   = 0;  ///< 已经返回的行数
+  int skipped_ = 0;  ///< 已经跳过的行数
+
+  Chunk                child_chunk_;
+  Chunk                output_chunk_;  ///< chunk 只有一部分行需要输出时，拷贝到这里
+  std::vector<uint8_t> select_;
+};
@@ -13,7 +13,10 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "sql/operator/order_by_physical_operator.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/string_view.h"
 #include "common/log/log.h"
+#include "sql/operator/sort_key.h"
 #include "storage/record/record.h"
 #include "storage/table/table.h"
 
@@ -25,9 +28,17 @@ OrderByPhysicalOperator::OrderByPhysicalOperator(vector<unique_ptr<Expression>>
 {
 }
 
+OrderByPhysicalOperator::~OrderByPhysicalOperator() { clear_rows(); }
+
 RC OrderByPhysicalOperator::open(Trx *trx)
 {
   tuple_idx_ = 0;
+  cell_num_  = 0;
+  specs_.clear();
+  clear_rows();
+  runs_.clear();
+  spilled_run_num_ = 0;
+  merging_         = false;
   if (children_.empty()) {
     return RC::SUCCESS;
   }
@@ -45,12 +56,53 @@ RC OrderByPhysicalOperator::open(Trx *trx)
     return rc;
   }
 
-  // while (child->next() == RC::SUCCESS) {
+  budget_ = memory_budget_ != nullptr ? memory_budget_ : MemoryBudget::current();
+
+  // 每行的排序键只在这里计算一次，排序时直接比较编码后的字节
+  SortKeyEncoder encoder(order_by_exprs_, order_by_descs_);
+  string         row_key;
+  vector<Value>  row_values;
   // 不屏蔽下层算子传回来的 rc
   while ((rc = child->next()) == RC::SUCCESS) {
-    ValueListTuple tuple;
-    ValueListTuple::make(*child->current_tuple(), tuple);
-    tuples_.push_back(std::make_unique<ValueListTuple>(tuple));
+    const Tuple *tuple = child->current_tuple();
+    if (specs_.empty()) {
+      cell_num_ = tuple->cell_num();
+      specs_.resize(cell_num_);
+      for (int i = 0; i < cell_num_; i++) {
+        tuple->spec_at(i, specs_[i]);
+      }
+      tuple_.set_names(specs_);
+    }
+
+    row_key.clear();
+    rc = encoder.encode(*tuple, row_key);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    row_values.resize(cell_num_);
+    size_t row_memory = row_key.size() + 2 * sizeof(uint32_t);
+    for (int i = 0; i < cell_num_; i++) {
+      tuple->cell_at(i, row_values[i]);
+      row_memory += MemoryBudget::value_memory(row_values[i]);
+    }
+
+    if (budget_ != nullptr) {
+      // 超出预算时先把已经缓存的行写到磁盘上，这一行无论如何都要保存下来
+      if (!budget_->try_consume(row_memory)) {
+        if (!order_.empty() && OB_FAIL(rc = spill_run())) {
+          return rc;
+        }
+        budget_->consume(row_memory);
+      }
+      memory_used_ += row_memory;
+    }
+
+    for (Value &value : row_values) {
+      values_.emplace_back(std::move(value));
+    }
+    keys_.append(row_key);
+    order_.push_back(static_cast<uint32_t>(key_offsets_.size() - 1));
+    key_offsets_.push_back(static_cast<uint32_t>(keys_.size()));
   }
 
   if (rc != RC::RECORD_EOF) {
@@ -58,41 +110,154 @@ RC OrderByPhysicalOperator::open(Trx *trx)
     return rc;
   }
 
-  // 由于 null 在排序中被当成最小值，所以需要对 null 值进行特殊处理
-  std::sort(tuples_.begin(), tuples_.end(), [this](const std::unique_ptr<ValueListTuple> &left, const std::unique_ptr<ValueListTuple> &right) {
-    for (size_t i = 0; i < order_by_exprs_.size(); i++) {
-      Value left_value;
-      order_by_exprs_[i]->get_value(*left, left_value);
-      Value right_value;
-      order_by_exprs_[i]->get_value(*right, right_value);
-      // 如果 left 和 right 都是 null，则认为它们相等
-      if (left_value.is_null() && right_value.is_null()) {
-        continue;
-      }
-      // 如果 left 是 null，则认为它小于 right
-      if (left_value.is_null()) {
-        return order_by_descs_[i] ? false : true;
-      }
-      // 如果 right 是 null，则认为它大于 left
-      if (right_value.is_null()) {
-        return order_by_descs_[i] ? true : false;
-      }
-      // 如果 left 和 right 都不为 null，则比较它们的值
-      if (left_value.compare(right_value) != 0) {
-        return order_by_descs_[i] ? left_value.compare(right_value) > 0 : left_value.compare(right_value) < 0;
+  if (!runs_.empty()) {
+    return start_merge();
+  }
+  sort_rows();
+  return RC::SUCCESS;
+}
+
+void OrderByPhysicalOperator::sort_rows()
+{
+  // 所有排序键的长度相同时（比如只按数值列排序）才能做基数排序
+  const size_t row_num  = order_.size();
+  const size_t key_size = row_num == 0 ? 0 : keys_.size() / row_num;
+  bool         fixed    = key_size <= MAX_RADIX_SORT_KEY_SIZE;
+  for (size_t i = 0; fixed && i < row_num; i++) {
+    fixed = key_offsets_[i + 1] - key_offsets_[i] == key_size;
+  }
+
+  if (fixed) {
+    radix_sort(key_size);
+  } else {
+    comparison_sort();
+  }
+}
+
+RC OrderByPhysicalOperator::spill_run()
+{
+  sort_rows();
+
+  unique_ptr<SpillFile> run;
+  RC                    rc = SpillFile::create(run);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  for (uint32_t row : order_) {
+    const string_view key(keys_.data() + key_offsets_[row], key_offsets_[row + 1] - key_offsets_[row]);
+    rc = run->write_row(key, values_.data() + static_cast<size_t>(row) * cell_num_, cell_num_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  if (OB_FAIL(rc = run->rewind())) {
+    return rc;
+  }
+
+  LOG_INFO("ORDER-BY: spill a sorted run. rows=%zu, memory=%zu", order_.size(), memory_used_);
+  runs_.push_back(std::move(run));
+  spilled_run_num_++;
+  clear_rows();
+  return rc;
+}
+
+RC OrderByPhysicalOperator::start_merge()
+{
+  RC rc = RC::SUCCESS;
+  if (!order_.empty() && OB_FAIL(rc = spill_run())) {
+    return rc;
+  }
+
+  // run 太多时，先把最前面的一批归并成一个，放在原来的位置上，保持 run 之间的先后顺序
+  while (runs_.size() > MAX_MERGE_FAN_IN) {
+    vector<unique_ptr<SpillFile>> batch;
+    for (size_t i = 0; i < MAX_MERGE_FAN_IN; i++) {
+      batch.push_back(std::move(runs_[i]));
+    }
+    runs_.erase(runs_.begin(), runs_.begin() + MAX_MERGE_FAN_IN);
+
+    unique_ptr<SpillFile> merged;
+    if (OB_FAIL(rc = SpillFile::create(merged)) || OB_FAIL(rc = merger_.init(std::move(batch)))) {
+      return rc;
+    }
+    while (OB_SUCC(rc = merger_.next())) {
+      const vector<Value> &values = merger_.values();
+      if (OB_FAIL(rc = merged->write_row(merger_.key(), values.data(), static_cast<int>(values.size())))) {
+        return rc;
       }
     }
-    return false;
-  });
+    if (rc != RC::RECORD_EOF || OB_FAIL(rc = merged->rewind())) {
+      return rc;
+    }
+    runs_.insert(runs_.begin(), std::move(merged));
+  }
 
-  return RC::SUCCESS;
+  merging_ = true;
+  return merger_.init(std::move(runs_));
+}
+
+void OrderByPhysicalOperator::clear_rows()
+{
+  values_.clear();
+  keys_.clear();
+  key_offsets_.assign(1, 0);
+  order_.clear();
+  if (budget_ != nullptr) {
+    budget_->release(memory_used_);
+  }
+  memory_used_ = 0;
+}
+
+void OrderByPhysicalOperator::radix_sort(size_t key_size)
+{
+  // 从最低位的字节开始，每一轮按一个字节做稳定的计数排序
+  vector<uint32_t> buffer(order_.size());
+  for (size_t byte = key_size; byte-- > 0;) {
+    size_t counts[257] = {0};
+    for (uint32_t row : order_) {
+      counts[static_cast<uint8_t>(keys_[row * key_size + byte]) + 1]++;
+    }
+    // 所有行的这个字节都相同，不需要移动
+    if (std::find(std::begin(counts), std::end(counts), order_.size()) != std::end(counts)) {
+      continue;
+    }
+    for (int i = 1; i < 257; i++) {
+      counts[i] += counts[i - 1];
+    }
+    for (uint32_t row : order_) {
+      buffer[counts[static_cast<uint8_t>(keys_[row * key_size + byte])]++] = row;
+    }
+    order_.swap(buffer);
+  }
+}
+
+void OrderByPhysicalOperator::comparison_sort()
+{
+  auto key = [this](uint32_t row) {
+    return string_view(keys_.data() + key_offsets_[row], key_offsets_[row + 1] - key_offsets_[row]);
+  };
+  std::stable_sort(order_.begin(), order_.end(), [&key](uint32_t left, uint32_t right) {
+    return key(left) < key(right);
+  });
 }
 
 RC OrderByPhysicalOperator::next()
 {
+  if (merging_) {
+    RC rc = merger_.next();
+    if (OB_SUCC(rc)) {
+      const vector<Value> &values = merger_.values();
+      tuple_.set_cells(values.data(), static_cast<int>(values.size()));
+    }
+    return rc;
+  }
+
   tuple_idx_++;
-  LOG_INFO("ORDER-BY: tuple_idx_=%d, tuples_.size()=%d", tuple_idx_, tuples_.size());
-  return tuple_idx_ <= tuples_.size() ? RC::SUCCESS : RC::RECORD_EOF;
+  if (tuple_idx_ > order_.size()) {
+    return RC::RECORD_EOF;
+  }
+  tuple_.set_cells(values_.data() + static_cast<size_t>(order_[tuple_idx_ - 1]) * cell_num_, cell_num_);
+  return RC::SUCCESS;
 }
 
 RC OrderByPhysicalOperator::close()
@@ -102,13 +267,16 @@ RC OrderByPhysicalOperator::close()
   }
   // close 的时候养成习惯，清理资源，关闭子算子！！！！！！spent 30mins hereee
   children_[0]->close();
-  tuples_.clear();
+  clear_rows();
+  runs_.clear();
+  merger_.init({});
+  merging_   = false;
   tuple_idx_ = 0;
   return RC::SUCCESS;
 }
 Tuple *OrderByPhysicalOperator::current_tuple()
 {
-  return tuples_[tuple_idx_ - 1].get();
+  return &tuple_;
 }
 
 RC OrderByPhysicalOperator::tuple_schema(TupleSchema &schema) const
@@ -14,13 +14,20 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/memory_budget.h"
 #include "sql/expr/tuple.h"
 #include "sql/operator/physical_operator.h"
+#include "sql/operator/spill_file.h"
 #include "sql/expr/expression_tuple.h"
 
 /**
  * @brief 排序物理算子
  * @ingroup PhysicalOperator
+ * @details 所有的行在 open 时读取出来，值连续保存在 values_ 中。每行的排序键只计算一次，
+ * 编码成可以用 memcmp 比较的字节串（参考 SortKeyEncoder）保存在 keys_ 中，排序时只移动行号。
+ * 所有排序键等长且不太长时使用基数排序，否则按 memcmp 做比较排序。排序是稳定的。
+ * 缓存的行超过内存预算（MemoryBudget）时，把已经缓存的行排好序写到一个临时文件中（一个 run），
+ * 读完所有输入后多路归并这些 run，也就是外部归并排序。run 太多时先分批归并，减少同时打开的文件。
  */
 class OrderByPhysicalOperator : public PhysicalOperator
 {
@@ -28,7 +35,7 @@ public:
   OrderByPhysicalOperator(std::vector<std::unique_ptr<Expression>> &&expressions,
                           std::vector<bool> &&order_by_descs);
 
-  virtual ~OrderByPhysicalOperator() = default;
+  virtual ~OrderByPhysicalOperator();
 
   PhysicalOperatorType type() const override { return PhysicalOperatorType::ORDER_BY; }
 
@@ -36,15 +43,55 @@ public:
   RC next() override;
   RC close() override;
 
-  int cell_num() const { return tuples_[0]->cell_num(); }
+  int cell_num() const { return cell_num_; }
 
   Tuple *current_tuple() override;
 
+  /**
+   * @brief 指定使用的内存预算，没有指定时使用当前会话的预算
+   */
+  void set_memory_budget(MemoryBudget *memory_budget) { memory_budget_ = memory_budget; }
+
+  /// 最近一次执行时写到磁盘上的 run 的个数
+  size_t spilled_run_num() const { return spilled_run_num_; }
+
   RC tuple_schema(TupleSchema &schema) const override;
 
 private:
-  std::vector<std::unique_ptr<Expression>>     order_by_exprs_;  // 排序依赖的表达式
-  std::vector<bool>                            order_by_descs_;  // 排序方向
-  std::vector<std::unique_ptr<ValueListTuple>> tuples_;          // 存储排序后的元组
-  size_t                                       tuple_idx_ = 0;       // 当前返回的元组索引，从 1 开始，索引下标的时候要减 1
+  /// 排序键比这个长度更长时，基数排序需要扫描的轮数太多，改用比较排序
+  static constexpr size_t MAX_RADIX_SORT_KEY_SIZE = 16;
+
+  /// 一次归并最多同时打开的 run 的个数
+  static constexpr size_t MAX_MERGE_FAN_IN = 64;
+
+  void sort_rows();
+  void radix_sort(size_t key_size);
+  void comparison_sort();
+
+  /// 把缓存的行排好序写到一个新的 run 中，并释放它们占用的内存
+  RC spill_run();
+  /// 归并所有的 run，准备输出
+  RC   start_merge();
+  void clear_rows();
+
+private:
+  std::vector<std::unique_ptr<Expression>> order_by_exprs_;  // 排序依赖的表达式
+  std::vector<bool>                        order_by_descs_;  // 排序方向
+
+  int                        cell_num_ = 0;
+  std::vector<TupleCellSpec> specs_;        // 子算子输出的列
+  std::vector<Value>         values_;       // 所有行的值，每行 cell_num_ 个
+  std::string                keys_;         // 所有行的排序键
+  std::vector<uint32_t>      key_offsets_;  // 第 i 行的排序键是 keys_[key_offsets_[i], key_offsets_[i + 1])
+  std::vector<uint32_t>      order_;        // 排序后的行号
+  ValueListTuple             tuple_;
+  size_t                     tuple_idx_ = 0;  // 当前返回的元组索引，从 1 开始，索引下标的时候要减 1
+
+  MemoryBudget                      *memory_budget_   = nullptr;
+  MemoryBudget                      *budget_          = nullptr;  // 本次执行使用的预算，nullptr 表示不限制
+  size_t                             memory_used_     = 0;        // 向预算申请的内存
+  std::vector<unique_ptr<SpillFile>> runs_;                       // 写到磁盘上的有序的 run
+  size_t                             spilled_run_num_ = 0;
+  SpillFileMerger                    merger_;
+  bool                               merging_ = false;  // 是否从 run 中归并输出
 };
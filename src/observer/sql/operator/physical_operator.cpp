@@ -20,6 +20,9 @@ std::string physical_operator_type_name(PhysicalOperatorType type)
     case PhysicalOperatorType::TABLE_SCAN: return "TABLE_SCAN";
     case PhysicalOperatorType::INDEX_SCAN: return "INDEX_SCAN";
     case PhysicalOperatorType::NESTED_LOOP_JOIN: return "NESTED_LOOP_JOIN";
+    case PhysicalOperatorType::INDEX_NESTED_LOOP_JOIN: return "INDEX_NESTED_LOOP_JOIN";
+    case PhysicalOperatorType::HASH_SEMI_JOIN: return "HASH_SEMI_JOIN";
+    case PhysicalOperatorType::HASH_ANTI_JOIN: return "HASH_ANTI_JOIN";
     case PhysicalOperatorType::EXPLAIN: return "EXPLAIN";
     case PhysicalOperatorType::PREDICATE: return "PREDICATE";
     case PhysicalOperatorType::INSERT: return "INSERT";
@@ -34,6 +37,9 @@ std::string physical_operator_type_name(PhysicalOperatorType type)
     case PhysicalOperatorType::TABLE_SCAN_VEC: return "TABLE_SCAN_VEC";
     case PhysicalOperatorType::EXPR_VEC: return "EXPR_VEC";
     case PhysicalOperatorType::VECTOR_INDEX_SCAN: return "VECTOR_INDEX_SCAN";
+    case PhysicalOperatorType::TOP_N: return "TOP_N";
+    case PhysicalOperatorType::LIMIT: return "LIMIT";
+    case PhysicalOperatorType::LIMIT_VEC: return "LIMIT_VEC";
     default: return "UNKNOWN";
   }
 }
@@ -41,6 +41,9 @@ enum class PhysicalOperatorType
   TABLE_SCAN_VEC,
   INDEX_SCAN,
   NESTED_LOOP_JOIN,
+  INDEX_NESTED_LOOP_JOIN,
+  HASH_SEMI_JOIN,
+  HASH_ANTI_JOIN,
   EXPLAIN,
   PREDICATE,
   PREDICATE_VEC,
@@ -57,6 +60,9 @@ enum class PhysicalOperatorType
   EXPR_VEC,
   UPDATE,
   ORDER_BY,
+  TOP_N,
+  LIMIT,
+  LIMIT_VEC,
   VECTOR_INDEX_SCAN,
 };
 
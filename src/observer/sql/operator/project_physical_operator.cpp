@@ -19,8 +19,8 @@ See the Mulan PSL v2 for more details. */
 
 using namespace std;
 
-ProjectPhysicalOperator::ProjectPhysicalOperator(vector<unique_ptr<Expression>> &&expressions, int limit)
-    : expressions_(std::move(expressions)), tuple_(expressions_), limit_(limit)
+ProjectPhysicalOperator::ProjectPhysicalOperator(vector<unique_ptr<Expression>> &&expressions)
+    : expressions_(std::move(expressions)), tuple_(expressions_)
 {
 }
 
@@ -48,10 +48,9 @@ RC ProjectPhysicalOperator::open(Trx *trx)
 
 RC ProjectPhysicalOperator::next()
 {
-  if (children_.empty() || (limit_ >= 0 && count_ >= limit_)) {
+  if (children_.empty()) {
     return RC::RECORD_EOF;
   }
-  count_++;
   return children_[0]->next();
 }
 
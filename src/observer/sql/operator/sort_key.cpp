@@ -0,0 +1,118 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sql/operator/sort_key.h"
+#include "common/log/log.h"
+#include "common/value.h"
+#include "sql/expr/expression.h"
+#include "sql/expr/tuple.h"
+
+namespace {
+
+void append_uint32(uint32_t value, string &key)
+{
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    key.push_back(static_cast<char>((value >> shift) & 0xFF));
+  }
+}
+
+void append_uint64(uint64_t value, string &key)
+{
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key.push_back(static_cast<char>((value >> shift) & 0xFF));
+  }
+}
+
+/// 负数的所有位取反，非负数只翻转符号位，这样按无符号数比较的顺序就是原来的数值顺序
+void append_double(double value, string &key)
+{
+  if (value == 0) {
+    value = 0;  // -0 与 0 相等
+  }
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  bits = (bits & (1ULL << 63)) ? ~bits : bits ^ (1ULL << 63);
+  append_uint64(bits, key);
+}
+
+void append_float(float value, string &key)
+{
+  if (value == 0) {
+    value = 0;
+  }
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  bits = (bits & (1U << 31)) ? ~bits : bits ^ (1U << 31);
+  append_uint32(bits, key);
+}
+
+/// 字符串比较时在 '\0' 处结束，所以用 '\0' 作为结束符，短的字符串排在以它为前缀的字符串前面
+void append_string(const char *data, size_t length, string &key)
+{
+  key.append(data, strnlen(data, length));
+  key.push_back('\0');
+}
+
+}  // namespace
+
+RC SortKeyEncoder::encode(const Tuple &tuple, string &key) const
+{
+  for (size_t i = 0; i < exprs_.size(); i++) {
+    Value value;
+    RC    rc = exprs_[i]->get_value(tuple, value);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get value of sort expression. rc=%s", strrc(rc));
+      return rc;
+    }
+    encode_value(value, descs_[i], key);
+  }
+  return RC::SUCCESS;
+}
+
+void SortKeyEncoder::encode_value(const Value &value, bool desc, string &key)
+{
+  const size_t begin = key.size();
+  if (value.is_null()) {
+    key.push_back('\0');
+  } else {
+    key.push_back('\1');
+    switch (value.attr_type()) {
+      // 整数和浮点数可能出现在同一个表达式的结果中，统一按 double 编码才能互相比较
+      case AttrType::INTS: append_double(value.get_int(), key); break;
+      case AttrType::FLOATS: append_double(value.get_float(), key); break;
+      case AttrType::DATES: append_uint32(static_cast<uint32_t>(value.get_int()) ^ (1U << 31), key); break;
+      case AttrType::BOOLEANS: key.push_back(value.get_boolean() ? '\1' : '\0'); break;
+      case AttrType::CHARS: append_string(value.data(), value.length(), key); break;
+      case AttrType::TEXTS: {
+        const string text = value.get_string();
+        append_string(text.data(), text.size(), key);
+      } break;
+      case AttrType::VECTORS: {
+        // 按元素的字典序比较，每个元素前加一个标记字节，维度少的向量排在前面
+        const VectorData &vector = value.get_vector();
+        for (size_t i = 0; i < vector.dim; i++) {
+          key.push_back('\1');
+          append_float(vector.vector[i], key);
+        }
+        key.push_back('\0');
+      } break;
+      default: break;
+    }
+  }
+
+  if (desc) {
+    for (size_t i = begin; i < key.size(); i++) {
+      key[i] = static_cast<char>(~key[i]);
+    }
+  }
+}
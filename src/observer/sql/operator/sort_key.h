@@ -0,0 +1,47 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/memory.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/rc.h"
+
+class Expression;
+class Tuple;
+class Value;
+
+/**
+ * @brief 把排序表达式的值编码成可以直接用 memcmp 比较的排序键
+ * @ingroup PhysicalOperator
+ * @details 每个排序表达式依次编码：先是一个字节的 null 标记（null 为 0，非 null 为 1，null 排在最前面），
+ * 然后是值本身：整数和浮点数按大端序编码并处理符号位，字符串以 0 结尾。降序的表达式把它编码出来的字节全部取反。
+ * 这样排序时只需要比较两段字节，不用每次比较都重新计算表达式。
+ * 排序键的顺序与 Value::compare 一致，但浮点数是精确比较的，不使用 EPSILON。
+ */
+class SortKeyEncoder
+{
+public:
+  SortKeyEncoder(const vector<unique_ptr<Expression>> &exprs, const vector<bool> &descs)
+      : exprs_(exprs), descs_(descs)
+  {}
+
+  /**
+   * @brief 计算 tuple 的排序键并追加到 key 后面
+   */
+  RC encode(const Tuple &tuple, string &key) const;
+
+  static void encode_value(const Value &value, bool desc, string &key);
+
+private:
+  const vector<unique_ptr<Expression>> &exprs_;
+  const vector<bool>                   &descs_;
+};
@@ -0,0 +1,251 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sql/operator/spill_file.h"
+#include "common/lang/algorithm.h"
+#include "common/log/log.h"
+#include "common/value.h"
+
+SpillFile::~SpillFile()
+{
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+RC SpillFile::create(unique_ptr<SpillFile> &file)
+{
+  FILE *fp = tmpfile();
+  if (fp == nullptr) {
+    LOG_WARN("failed to create spill file. error=%s", strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+  file        = make_unique<SpillFile>();
+  file->file_ = fp;
+  return RC::SUCCESS;
+}
+
+RC SpillFile::write(const void *data, size_t size)
+{
+  if (size > 0 && fwrite(data, size, 1, file_) != 1) {
+    LOG_WARN("failed to write spill file. size=%zu, error=%s", size, strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+  return RC::SUCCESS;
+}
+
+RC SpillFile::read(void *data, size_t size)
+{
+  if (size > 0 && fread(data, size, 1, file_) != 1) {
+    if (feof(file_)) {
+      return RC::RECORD_EOF;
+    }
+    LOG_WARN("failed to read spill file. size=%zu, error=%s", size, strerror(errno));
+    return RC::IOERR_READ;
+  }
+  return RC::SUCCESS;
+}
+
+RC SpillFile::rewind()
+{
+  if (fflush(file_) != 0 || fseek(file_, 0, SEEK_SET) != 0) {
+    LOG_WARN("failed to rewind spill file. error=%s", strerror(errno));
+    return RC::IOERR_SEEK;
+  }
+  return RC::SUCCESS;
+}
+
+RC SpillFile::write_row(string_view key, const Value *values, int value_num)
+{
+  const uint32_t key_size = static_cast<uint32_t>(key.size());
+  const uint32_t num      = static_cast<uint32_t>(value_num);
+
+  RC rc = RC::SUCCESS;
+  if (OB_FAIL(rc = write(&key_size, sizeof(key_size))) || OB_FAIL(rc = write(key.data(), key.size())) ||
+      OB_FAIL(rc = write(&num, sizeof(num)))) {
+    return rc;
+  }
+  for (int i = 0; i < value_num; i++) {
+    if (OB_FAIL(rc = write_value(values[i]))) {
+      return rc;
+    }
+  }
+  row_num_++;
+  return rc;
+}
+
+RC SpillFile::read_row(string &key, vector<Value> &values)
+{
+  uint32_t key_size = 0;
+  RC       rc       = read(&key_size, sizeof(key_size));
+  if (OB_FAIL(rc)) {
+    return rc;  // 包括读到文件末尾
+  }
+  key.resize(key_size);
+  uint32_t num = 0;
+  if (OB_FAIL(rc = read(key.data(), key_size)) || OB_FAIL(rc = read(&num, sizeof(num)))) {
+    return rc == RC::RECORD_EOF ? RC::IOERR_READ : rc;
+  }
+  values.resize(num);
+  for (uint32_t i = 0; i < num; i++) {
+    if (OB_FAIL(rc = read_value(values[i]))) {
+      return rc == RC::RECORD_EOF ? RC::IOERR_READ : rc;
+    }
+  }
+  return rc;
+}
+
+RC SpillFile::write_value(const Value &value)
+{
+  const uint8_t type = static_cast<uint8_t>(value.attr_type());
+  RC            rc   = write(&type, sizeof(type));
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  switch (value.attr_type()) {
+    case AttrType::INTS:
+    case AttrType::FLOATS:
+    case AttrType::BOOLEANS:
+    case AttrType::DATES: {
+      const uint32_t length = static_cast<uint32_t>(value.length());
+      if (OB_FAIL(rc = write(&length, sizeof(length)))) {
+        return rc;
+      }
+      rc = write(value.data(), length);
+    } break;
+    case AttrType::CHARS: {
+      const uint32_t length = static_cast<uint32_t>(strnlen(value.data(), value.length()));
+      if (OB_FAIL(rc = write(&length, sizeof(length)))) {
+        return rc;
+      }
+      rc = write(value.data(), length);
+    } break;
+    case AttrType::TEXTS: {
+      const string   text   = value.get_string();
+      const uint32_t length = static_cast<uint32_t>(text.size());
+      if (OB_FAIL(rc = write(&length, sizeof(length)))) {
+        return rc;
+      }
+      rc = write(text.data(), length);
+    } break;
+    case AttrType::VECTORS: {
+      const VectorData &vector = value.get_vector();
+      const uint32_t    dim    = static_cast<uint32_t>(vector.dim);
+      if (OB_FAIL(rc = write(&dim, sizeof(dim)))) {
+        return rc;
+      }
+      rc = write(vector.vector, dim * sizeof(float));
+    } break;
+    default: break;  // NULL 和未定义的值只有类型
+  }
+  return rc;
+}
+
+RC SpillFile::read_value(Value &value)
+{
+  uint8_t type = 0;
+  RC      rc   = read(&type, sizeof(type));
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  const AttrType attr_type = static_cast<AttrType>(type);
+  if (attr_type == AttrType::NULLS) {
+    value.set_null();
+    return rc;
+  }
+  if (attr_type == AttrType::UNDEFINED || attr_type >= AttrType::MAXTYPE) {
+    value = Value();
+    return rc;
+  }
+
+  uint32_t length = 0;
+  if (OB_FAIL(rc = read(&length, sizeof(length)))) {
+    return rc;
+  }
+  const size_t data_size = attr_type == AttrType::VECTORS ? length * sizeof(float) : length;
+  buffer_.resize(data_size + 1);
+  if (OB_FAIL(rc = read(buffer_.data(), data_size))) {
+    return rc;
+  }
+  buffer_[data_size] = '\0';
+
+  switch (attr_type) {
+    case AttrType::CHARS: value.set_string(buffer_.data(), static_cast<int>(length)); break;
+    case AttrType::TEXTS: value = Value::TextValue(buffer_.data(), static_cast<int>(length)); break;
+    case AttrType::VECTORS: {
+      VectorData vector{.offset = 0, .dim = length, .vector = reinterpret_cast<const float *>(buffer_.data())};
+      value.set_vector(vector);
+    } break;
+    default: value = Value(attr_type, buffer_.data(), static_cast<int>(length)); break;
+  }
+  return rc;
+}
+
+RC SpillFileMerger::init(vector<unique_ptr<SpillFile>> &&files)
+{
+  sources_.clear();
+  heap_.clear();
+  started_ = false;
+
+  sources_.resize(files.size());
+  for (size_t i = 0; i < files.size(); i++) {
+    Source &source = sources_[i];
+    source.file    = std::move(files[i]);
+    RC rc          = source.file->read_row(source.key, source.values);
+    if (OB_SUCC(rc)) {
+      heap_.push_back(i);
+    } else if (rc != RC::RECORD_EOF) {
+      return rc;
+    }
+  }
+  std::make_heap(heap_.begin(), heap_.end(), [this](size_t left, size_t right) { return greater(left, right); });
+  return RC::SUCCESS;
+}
+
+RC SpillFileMerger::next()
+{
+  auto heap_greater = [this](size_t left, size_t right) { return greater(left, right); };
+
+  // 上一次输出的行所在的文件补充一行
+  if (started_) {
+    Source &source = sources_[current_];
+    RC      rc     = source.file->read_row(source.key, source.values);
+    if (OB_SUCC(rc)) {
+      heap_.push_back(current_);
+      std::push_heap(heap_.begin(), heap_.end(), heap_greater);
+    } else if (rc != RC::RECORD_EOF) {
+      return rc;
+    } else {
+      source.file.reset();
+    }
+  }
+
+  if (heap_.empty()) {
+    return RC::RECORD_EOF;
+  }
+  std::pop_heap(heap_.begin(), heap_.end(), heap_greater);
+  current_ = heap_.back();
+  heap_.pop_back();
+  started_ = true;
+  return RC::SUCCESS;
+}
+
+bool SpillFileMerger::greater(size_t left, size_t right) const
+{
+  const int cmp = sources_[left].key.compare(sources_[right].key);
+  return cmp != 0 ? cmp > 0 : left > right;
+}
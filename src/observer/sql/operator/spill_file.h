@@ -0,0 +1,107 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <stdio.h>
+
+#include "common/lang/memory.h"
+#include "common/lang/string.h"
+#include "common/lang/string_view.h"
+#include "common/lang/vector.h"
+#include "common/rc.h"
+
+class Value;
+
+/**
+ * @brief 算子内存不够时保存中间数据的临时文件
+ * @ingroup PhysicalOperator
+ * @details 文件由 tmpfile 创建，关闭后自动删除。先顺序写入若干行，调用 rewind 后再从头顺序读出来。
+ * 每行包含一个字节串（比如排序键，可以为空）和一组值，值按照类型编码，读出来时重新构造成 Value。
+ * 读写都经过 stdio 的缓冲，不会每行一次系统调用。
+ */
+class SpillFile
+{
+public:
+  SpillFile() = default;
+  ~SpillFile();
+
+  SpillFile(const SpillFile &)            = delete;
+  SpillFile &operator=(const SpillFile &) = delete;
+
+  static RC create(unique_ptr<SpillFile> &file);
+
+  RC write_row(string_view key, const Value *values, int value_num);
+
+  /**
+   * @brief 读取下一行，values 会被调整成这一行的值个数
+   * @return 读到文件末尾时返回 RECORD_EOF
+   */
+  RC read_row(string &key, vector<Value> &values);
+
+  /**
+   * @brief 写完之后回到文件开头，准备读取
+   */
+  RC rewind();
+
+  size_t row_num() const { return row_num_; }
+
+private:
+  RC write(const void *data, size_t size);
+  RC read(void *data, size_t size);
+
+  RC write_value(const Value &value);
+  RC read_value(Value &value);
+
+private:
+  FILE  *file_    = nullptr;
+  size_t row_num_ = 0;
+  string buffer_;  ///< 读取字符串时复用的内存
+};
+
+/**
+ * @brief 多路归并若干个按照键有序的 SpillFile
+ * @ingroup PhysicalOperator
+ * @details 用一个小顶堆保存每个文件当前的行，每次输出键最小的一行再从它所在的文件补充一行。
+ * 键按照 memcmp 比较，键相同时先输出前面的文件中的行，所以按输入顺序生成的文件归并后排序是稳定的。
+ */
+class SpillFileMerger
+{
+public:
+  /**
+   * @brief 从头开始归并 files 中的文件，文件需要已经 rewind
+   */
+  RC init(vector<unique_ptr<SpillFile>> &&files);
+
+  /**
+   * @brief 取下一行，所有文件都读完时返回 RECORD_EOF
+   */
+  RC next();
+
+  const string        &key() const { return sources_[current_].key; }
+  const vector<Value> &values() const { return sources_[current_].values; }
+
+private:
+  struct Source
+  {
+    unique_ptr<SpillFile> file;
+    string                key;
+    vector<Value>         values;
+  };
+
+  /// 堆顶是最小的行，所以比较函数是大于
+  bool greater(size_t left, size_t right) const;
+
+private:
+  vector<Source> sources_;
+  vector<size_t> heap_;
+  size_t         current_ = 0;
+  bool           started_ = false;
+};
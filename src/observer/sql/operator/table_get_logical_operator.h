@@ -38,6 +38,10 @@ public:
   void set_not_use_index(bool not_use_index) { not_use_index_ = not_use_index; }
   bool not_use_index() const { return not_use_index_; }
 
+  /// 最多需要扫描出的行数，-1 表示不限制，由 LimitPushdownRewriter 设置
+  void set_limit(int limit) { limit_ = limit; }
+  int  limit() const { return limit_; }
+
   bool is_or_conjunction = false;
 
   void set_table_alias(const std::string &table_alias) { table_alias_ = table_alias; }
@@ -47,6 +51,7 @@ private:
   Table        *table_ = nullptr;
   ReadWriteMode mode_  = ReadWriteMode::READ_WRITE;
   bool          not_use_index_ = false;
+  int           limit_         = -1;
 
   // 与当前表相关的过滤操作，可以尝试在遍历数据时执行
   // 这里的表达式都是比较简单的比较运算，并且左右两边都是取字段表达式或值表达式
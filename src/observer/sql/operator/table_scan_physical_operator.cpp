@@ -27,16 +27,28 @@ RC TableScanPhysicalOperator::open(Trx *trx)
     rc = view->get_record_scanner(record_scanner_view_, trx, mode_);;
   } else {
     rc = table_->get_record_scanner(record_scanner_, trx, mode_);
+    records_.clear();
+    record_idx_ = 0;
+    if (rc == RC::SUCCESS) {
+      ZoneFilter zone_filter;
+      zone_filter.init(table_, predicates_, is_or_conjunction);
+      record_scanner_.set_zone_filter(std::move(zone_filter));
+    }
   }
   if (rc == RC::SUCCESS) {
     tuple_.set_schema(table_, table_->table_meta().field_metas());
   }
-  trx_ = trx;
+  trx_   = trx;
+  count_ = 0;
   return rc;
 }
 
 RC TableScanPhysicalOperator::next()
 {
+  if (limit_ >= 0 && count_ >= limit_) {
+    return RC::RECORD_EOF;
+  }
+
   RC rc = RC::SUCCESS;
 
   if (table_->is_view()) {
@@ -75,10 +87,21 @@ RC TableScanPhysicalOperator::next()
       }
     }
   } else {
+    // 每次从扫描器中取一个页面的记录，current_record_ 只引用其中的数据，不做拷贝
     bool filter_result = false;
-    while (OB_SUCC(rc = record_scanner_.next(current_record_))) {
+    while (true) {
+      if (record_idx_ >= records_.size()) {
+        record_idx_ = 0;
+        if (OB_FAIL(rc = record_scanner_.next_batch(records_))) {
+          break;
+        }
+      }
+
+      const Record &record = records_[record_idx_++];
+      current_record_.set_rid(record.rid());
+      current_record_.set_data(const_cast<char *>(record.data()), record.len());
       LOG_DEBUG("got a record. rid=%s", current_record_.rid().to_string().c_str());
-      
+
       tuple_.set_record(&current_record_);
       tuple_.set_rid(RID(current_record_.rid()));
       tuple_.set_table_name(table_->name());
@@ -99,12 +122,22 @@ RC TableScanPhysicalOperator::next()
     }
   }
 
-  
+  if (OB_SUCC(rc)) {
+    count_++;
+  }
   return rc;
 }
 
-RC TableScanPhysicalOperator::close() { 
-  return record_scanner_.close_scan(); 
+RC TableScanPhysicalOperator::close()
+{
+  if (!table_->is_view()) {
+    sql_debug("table scan %s: scanned %ld pages, skipped %ld pages by zone map",
+        table_->name(), record_scanner_.scanned_pages(), record_scanner_.skipped_pages());
+  }
+  // 记录引用的页面在关闭扫描后就释放了
+  records_.clear();
+  record_idx_ = 0;
+  return record_scanner_.close_scan();
 }
 
 Tuple *TableScanPhysicalOperator::current_tuple()
@@ -113,7 +146,14 @@ Tuple *TableScanPhysicalOperator::current_tuple()
   return &tuple_;
 }
 
-string TableScanPhysicalOperator::param() const { return table_->name(); }
+string TableScanPhysicalOperator::param() const
+{
+  string param = table_->name();
+  if (limit_ >= 0) {
+    param += ", limit=" + std::to_string(limit_);
+  }
+  return param;
+}
 
 void TableScanPhysicalOperator::set_predicates(vector<unique_ptr<Expression>> &&exprs)
 {
@@ -45,6 +45,9 @@ public:
 
   void set_predicates(std::vector<std::unique_ptr<Expression>> &&exprs);
 
+  /// 返回 limit 行之后就结束扫描，-1 表示不限制
+  void set_limit(int limit) { limit_ = limit; }
+
   bool is_or_conjunction = false;
 
   void set_table_alias(const std::string &table_alias) { table_alias_ = table_alias; }
@@ -58,8 +61,12 @@ private:
   Trx                                     *trx_   = nullptr;
   ReadWriteMode                            mode_  = ReadWriteMode::READ_WRITE;
   RecordFileScanner                        record_scanner_;
+  std::vector<Record>                      records_;         ///< 当前页面中满足条件并且可见的记录
+  size_t                                   record_idx_ = 0;  ///< 下一条要返回的记录在 records_ 中的位置
   Record                                   current_record_;
   RowTuple                                 tuple_;
+  int                                      limit_ = -1;
+  int                                      count_ = 0;  ///< 已经返回的记录数
 
   // view 会用到这个
   std::vector<std::unique_ptr<Expression>> predicates_;  // TODO chang predicate to table tuple filter
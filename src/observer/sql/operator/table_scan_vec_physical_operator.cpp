@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/table_scan_vec_physical_operator.h"
 #include "event/sql_debug.h"
 #include "storage/table/table.h"
+#include "common/lang/algorithm.h"
 
 using namespace std;
 
@@ -21,18 +22,42 @@ RC TableScanVecPhysicalOperator::open(Trx *trx)
     LOG_WARN("failed to get chunk scanner", strrc(rc));
     return rc;
   }
-  // TODO: don't need to fetch all columns from record manager
-  for (int i = 0; i < table_->table_meta().field_num(); ++i) {
-    all_columns_.add_column(
-        make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
-    filterd_columns_.add_column(
-        make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
+
+  // 向量化执行时所有的过滤条件都是 AND 关系
+  ZoneFilter zone_filter;
+  zone_filter.init(table_, predicates_, false /*is_or_conjunction*/);
+  chunk_scanner_.set_zone_filter(std::move(zone_filter));
+
+  // 输出的 Chunk 中总是包含所有的列，第 i 列就是 field_id 为 i 的字段
+  const TableMeta &table_meta = table_->table_meta();
+  for (int i = 0; i < table_meta.field_num(); ++i) {
+    all_columns_.add_column(make_unique<Column>(*table_meta.field(i)), table_meta.field(i)->field_id());
+    filterd_columns_.add_column(make_unique<Column>(*table_meta.field(i)), table_meta.field(i)->field_id());
+  }
+
+  // 过滤条件只用到了部分列时才需要延迟物化
+  late_materialization_ = !predicates_.empty() && !predicate_field_ids_.empty() &&
+                          static_cast<int>(predicate_field_ids_.size()) < table_meta.field_num();
+  if (late_materialization_) {
+    for (int i = 0; i < table_meta.field_num(); ++i) {
+      const FieldMeta *field = table_meta.field(i);
+      if (std::find(predicate_field_ids_.begin(), predicate_field_ids_.end(), field->field_id()) !=
+          predicate_field_ids_.end()) {
+        predicate_columns_.add_column(make_unique<Column>(*field), field->field_id());
+      } else {
+        late_columns_.add_column(make_unique<Column>(*field), field->field_id());
+      }
+    }
   }
   return rc;
 }
 
 RC TableScanVecPhysicalOperator::next(Chunk &chunk)
 {
+  if (late_materialization_) {
+    return next_late_materialized(chunk);
+  }
+
   RC rc = RC::SUCCESS;
 
   all_columns_.reset_data();
@@ -48,13 +73,13 @@ RC TableScanVecPhysicalOperator::next(Chunk &chunk)
         return rc;
       }
       // TODO: if all setted, it doesn't need to set one by one
-      for (int i = 0; i < all_columns_.rows(); i++) {
-        if (select_[i] == 0) {
-          continue;
-        }
-        for (int j = 0; j < all_columns_.column_num(); j++) {
-          filterd_columns_.column(j).append_one(
-              (char *)all_columns_.column(filterd_columns_.column_ids(j)).get_value(i).data());
+      // 字典编码的列只拷贝字典编号，过滤后的列仍然是字典编码的
+      for (int j = 0; j < all_columns_.column_num(); j++) {
+        rc = filterd_columns_.column(j).append_selected(
+            all_columns_.column(filterd_columns_.column_ids(j)), select_);
+        if (OB_FAIL(rc)) {
+          LOG_WARN("failed to copy filtered column. rc=%s", strrc(rc));
+          return rc;
         }
       }
       chunk.reference(filterd_columns_);
@@ -63,7 +88,58 @@ RC TableScanVecPhysicalOperator::next(Chunk &chunk)
   return rc;
 }
 
-RC TableScanVecPhysicalOperator::close() { return chunk_scanner_.close_scan(); }
+RC TableScanVecPhysicalOperator::next_late_materialized(Chunk &chunk)
+{
+  RC rc = RC::SUCCESS;
+  while (true) {
+    predicate_columns_.reset_data();
+    if (OB_FAIL(rc = chunk_scanner_.next_chunk(predicate_columns_))) {
+      return rc;
+    }
+
+    // 过滤条件按照 field_id 访问列，把读取到的列放到 all_columns_ 对应的位置上
+    for (int i = 0; i < predicate_columns_.column_num(); i++) {
+      all_columns_.column(predicate_columns_.column_ids(i)).reference(predicate_columns_.column(i));
+    }
+    select_.assign(predicate_columns_.rows(), 1);
+    rc = filter(all_columns_);
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("filtered failed=%s", strrc(rc));
+      return rc;
+    }
+    if (std::any_of(select_.begin(), select_.end(), [](uint8_t selected) { return selected != 0; })) {
+      break;
+    }
+  }
+
+  filterd_columns_.reset_data();
+  for (int i = 0; i < predicate_columns_.column_num(); i++) {
+    rc = filterd_columns_.column(predicate_columns_.column_ids(i)).append_selected(predicate_columns_.column(i), select_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to copy filtered column. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  // 页面还没有释放，只读取满足条件的记录的其它列
+  rc = chunk_scanner_.selected_chunk(late_columns_, select_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to fetch selected records. rc=%s", strrc(rc));
+    return rc;
+  }
+  for (int i = 0; i < late_columns_.column_num(); i++) {
+    filterd_columns_.column(late_columns_.column_ids(i)).reference(late_columns_.column(i));
+  }
+  chunk.reference(filterd_columns_);
+  return rc;
+}
+
+RC TableScanVecPhysicalOperator::close()
+{
+  sql_debug("table scan %s: scanned %ld pages, skipped %ld pages by zone map",
+      table_->name(), chunk_scanner_.scanned_pages(), chunk_scanner_.skipped_pages());
+  return chunk_scanner_.close_scan();
+}
 
 string TableScanVecPhysicalOperator::param() const { return table_->name(); }
 
@@ -38,9 +38,18 @@ public:
 
   void set_predicates(std::vector<std::unique_ptr<Expression>> &&exprs);
 
+  /**
+   * @brief 设置过滤条件用到的列，由优化器决定
+   * @details 设置以后按照延迟物化的方式扫描：先读取这些列并计算过滤条件，其它列只读取满足条件的记录。
+   */
+  void set_predicate_fields(std::vector<int> &&field_ids) { predicate_field_ids_ = std::move(field_ids); }
+
 private:
   RC filter(Chunk &chunk);
 
+  /// 延迟物化时获取下一批满足条件的记录，会跳过没有记录满足条件的页面
+  RC next_late_materialized(Chunk &chunk);
+
 private:
   Table                                   *table_ = nullptr;
   ReadWriteMode                            mode_  = ReadWriteMode::READ_WRITE;
@@ -49,4 +58,9 @@ private:
   Chunk                                    filterd_columns_;
   std::vector<uint8_t>                     select_;
   std::vector<std::unique_ptr<Expression>> predicates_;
+
+  bool             late_materialization_ = false;
+  std::vector<int> predicate_field_ids_;  ///< 过滤条件用到的列
+  Chunk            predicate_columns_;    ///< 过滤条件用到的列的数据
+  Chunk            late_columns_;         ///< 其它列中满足条件的记录
 };
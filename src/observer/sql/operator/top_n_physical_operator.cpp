@@ -0,0 +1,138 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/top_n_physical_operator.h"
+#include "common/lang/algorithm.h"
+#include "common/log/log.h"
+#include "sql/operator/sort_key.h"
+
+using namespace std;
+
+TopNPhysicalOperator::TopNPhysicalOperator(
+    vector<unique_ptr<Expression>> &&expressions, vector<bool> &&order_by_descs, int limit)
+    : order_by_exprs_(std::move(expressions)), order_by_descs_(std::move(order_by_descs)), limit_(limit)
+{}
+
+string TopNPhysicalOperator::param() const { return "limit=" + std::to_string(limit_); }
+
+RC TopNPhysicalOperator::open(Trx *trx)
+{
+  rows_.clear();
+  heap_.clear();
+  row_idx_ = 0;
+  if (children_.empty()) {
+    return RC::SUCCESS;
+  }
+
+  PhysicalOperator *child = children_[0].get();
+  if (outer_tuple != nullptr) {
+    child->set_outer_tuple(outer_tuple);
+  }
+
+  RC rc = child->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open child operator: %s", strrc(rc));
+    return rc;
+  }
+  if (limit_ <= 0) {
+    return RC::SUCCESS;
+  }
+
+  SortKeyEncoder encoder(order_by_exprs_, order_by_descs_);
+  auto           heap_less = [this](size_t left, size_t right) { return less(rows_[left], rows_[right]); };
+  size_t         sequence  = 0;
+  while (OB_SUCC(rc = child->next())) {
+    const Tuple *tuple = child->current_tuple();
+    if (sequence == 0) {
+      vector<TupleCellSpec> specs(tuple->cell_num());
+      for (int i = 0; i < tuple->cell_num(); i++) {
+        tuple->spec_at(i, specs[i]);
+      }
+      tuple_.set_names(specs);
+    }
+
+    key_.clear();
+    rc = encoder.encode(*tuple, key_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    if (rows_.size() < static_cast<size_t>(limit_)) {
+      rows_.emplace_back();
+      heap_.push_back(rows_.size() - 1);
+    } else if (key_ < rows_[heap_.front()].key) {
+      // 比堆顶小，替换掉目前保留的最大的一行。键相等时新的行更大，保留先输入的行
+      std::pop_heap(heap_.begin(), heap_.end(), heap_less);
+    } else {
+      sequence++;
+      continue;
+    }
+
+    Row &row = rows_[heap_.back()];
+    row.key.swap(key_);
+    row.sequence = sequence++;
+    rc           = read_row(*tuple, row);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    std::push_heap(heap_.begin(), heap_.end(), heap_less);
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("TOP-N: failed to get next tuple. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  heap_.clear();
+  std::sort(rows_.begin(), rows_.end(), less);
+  return RC::SUCCESS;
+}
+
+RC TopNPhysicalOperator::read_row(const Tuple &tuple, Row &row)
+{
+  row.values.resize(tuple.cell_num());
+  for (int i = 0; i < tuple.cell_num(); i++) {
+    RC rc = tuple.cell_at(i, row.values[i]);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get cell of tuple. index=%d, rc=%s", i, strrc(rc));
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC TopNPhysicalOperator::next()
+{
+  if (row_idx_ >= rows_.size()) {
+    return RC::RECORD_EOF;
+  }
+  const Row &row = rows_[row_idx_++];
+  tuple_.set_cells(row.values);
+  return RC::SUCCESS;
+}
+
+RC TopNPhysicalOperator::close()
+{
+  if (!children_.empty()) {
+    children_[0]->close();
+  }
+  rows_.clear();
+  heap_.clear();
+  row_idx_ = 0;
+  return RC::SUCCESS;
+}
+
+RC TopNPhysicalOperator::tuple_schema(TupleSchema &schema) const
+{
+  if (children_.empty()) {
+    return RC::SUCCESS;
+  }
+  return children_[0]->tuple_schema(schema);
+}
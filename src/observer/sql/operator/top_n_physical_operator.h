@@ -0,0 +1,70 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/expr/tuple.h"
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 排序后只取前 N 行的物理算子
+ * @ingroup PhysicalOperator
+ * @details 用于 ORDER BY 后面跟着 LIMIT 的查询。只用一个大小为 N 的大顶堆保存目前最小的 N 行，
+ * 新的行比堆顶小时替换掉堆顶，内存占用与 N 相关而不是与输入的行数相关。
+ * 行的比较使用 SortKeyEncoder 编码的排序键，键相同的行按输入顺序输出，与 OrderByPhysicalOperator 的结果相同。
+ */
+class TopNPhysicalOperator : public PhysicalOperator
+{
+public:
+  TopNPhysicalOperator(
+      std::vector<std::unique_ptr<Expression>> &&expressions, std::vector<bool> &&order_by_descs, int limit);
+
+  virtual ~TopNPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::TOP_N; }
+
+  std::string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+
+  Tuple *current_tuple() override { return &tuple_; }
+
+  RC tuple_schema(TupleSchema &schema) const override;
+
+private:
+  struct Row
+  {
+    std::string        key;
+    size_t             sequence = 0;  // 输入的顺序，排序键相同时用来保证稳定
+    std::vector<Value> values;
+  };
+
+  /// 按照排序键比较两行，排序键相同时先输入的行更小
+  static bool less(const Row &left, const Row &right)
+  {
+    const int cmp = left.key.compare(right.key);
+    return cmp != 0 ? cmp < 0 : left.sequence < right.sequence;
+  }
+
+  RC read_row(const Tuple &tuple, Row &row);
+
+private:
+  std::vector<std::unique_ptr<Expression>> order_by_exprs_;
+  std::vector<bool>                        order_by_descs_;
+  int                                      limit_ = 0;
+
+  std::vector<Row>    rows_;  // open 之后按照排序键从小到大排列
+  std::vector<size_t> heap_;  // rows_ 的下标组成的大顶堆
+  std::string         key_;   // 当前行的排序键
+  ValueListTuple      tuple_;
+  size_t              row_idx_ = 0;  // 下一次 next 返回的行
+};
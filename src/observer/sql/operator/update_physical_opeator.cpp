@@ -1,10 +1,13 @@
 #include "update_physical_opeator.h"
 #include "common/log/log.h"
 #include "storage/table/view.h"
+#include "storage/trx/trx.h"
 
 // 注意，update 的时候不会使用索引
 RC UpdatePhysicalOperator::open(Trx *trx)
 {
+  trx_ = trx;
+
   auto &child = children_[0];
   RC    rc    = child->open(trx);
   if (OB_FAIL(rc)) {
@@ -59,6 +62,13 @@ RC UpdatePhysicalOperator::open(Trx *trx)
           return RC::INTERNAL;
         }
         update_table = base_table_map[tuple_table_name];
+        // 先加行锁，其它事务正在修改这条记录时直接返回冲突
+        rc = trx_->lock_record(update_table, update_rid);
+        if (OB_FAIL(rc)) {
+          LOG_WARN("failed to lock record. table=%s, rid=%s, rc=%s",
+                   update_table->name(), update_rid.to_string().c_str(), strrc(rc));
+          return rc;
+        }
         // 正式开始更新
         rc = update_table->visit_record(update_rid, [this, tuple](Record &record) {
           Record             old_record(record);
@@ -127,6 +137,12 @@ RC UpdatePhysicalOperator::open(Trx *trx)
 
     } else {
       // 非视图更新情况
+      rc = trx_->lock_record(table_, tuple->record().rid());
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to lock record. table=%s, rid=%s, rc=%s",
+                 table_->name(), tuple->record().rid().to_string().c_str(), strrc(rc));
+        return rc;
+      }
       rc = table_->visit_record(tuple->record().rid(), [this, tuple](Record &record) {
         Record             old_record(record);
         std::vector<Value> cells_to_update;  // 先存，防止有一个 field 更新异常导致部分写入。
@@ -24,6 +24,7 @@ public:
   Tuple *current_tuple() override { return nullptr; }
 
 private:
+  Trx                                     *trx_   = nullptr;
   Table                                   *table_ = nullptr;
   std::vector<FieldMeta>                   field_metas_;  // 需要更新的字段，等号左边
   std::vector<std::unique_ptr<Expression>> exprs_;        // 更新的表达式，等号右边
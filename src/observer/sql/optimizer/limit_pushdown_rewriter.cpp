@@ -0,0 +1,35 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#include "sql/optimizer/limit_pushdown_rewriter.h"
+#include "sql/operator/limit_logical_operator.h"
+#include "sql/operator/table_get_logical_operator.h"
+
+RC LimitPushdownRewriter::rewrite(std::unique_ptr<LogicalOperator> &oper, bool &change_made)
+{
+  if (oper->type() != LogicalOperatorType::LIMIT || oper->children().size() != 1) {
+    return RC::SUCCESS;
+  }
+
+  // 谓词没有全部下推到扫描中时，limit 下面还有 predicate 算子，不能下推
+  std::unique_ptr<LogicalOperator> &child_oper = oper->children().front();
+  if (child_oper->type() != LogicalOperatorType::TABLE_GET) {
+    return RC::SUCCESS;
+  }
+
+  auto limit_oper     = static_cast<LimitLogicalOperator *>(oper.get());
+  auto table_get_oper = static_cast<TableGetLogicalOperator *>(child_oper.get());
+  if (table_get_oper->limit() != limit_oper->fetch_num()) {
+    table_get_oper->set_limit(limit_oper->fetch_num());
+    change_made = true;
+  }
+  return RC::SUCCESS;
+}
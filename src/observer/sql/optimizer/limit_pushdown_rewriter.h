@@ -0,0 +1,29 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#pragma once
+
+#include "sql/optimizer/rewrite_rule.h"
+
+/**
+ * @brief 将 limit 下推到表数据扫描中
+ * @ingroup Rewriter
+ * @details limit 的子算子是表扫描（谓词已经下推到扫描中，或者恒为真的谓词已经被删除）时，
+ * 扫描只需要返回 limit + offset 行就可以结束了。
+ */
+class LimitPushdownRewriter : public RewriteRule
+{
+public:
+  LimitPushdownRewriter()          = default;
+  virtual ~LimitPushdownRewriter() = default;
+
+  RC rewrite(std::unique_ptr<LogicalOperator> &oper, bool &change_made) override;
+};
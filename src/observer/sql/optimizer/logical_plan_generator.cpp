@@ -23,6 +23,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/explain_logical_operator.h"
 #include "sql/operator/insert_logical_operator.h"
 #include "sql/operator/join_logical_operator.h"
+#include "sql/operator/limit_logical_operator.h"
 #include "sql/operator/logical_operator.h"
 #include "sql/operator/predicate_logical_operator.h"
 #include "sql/operator/project_logical_operator.h"
@@ -217,8 +218,18 @@ RC LogicalPlanGenerator::create_plan(SelectStmt *select_stmt, unique_ptr<Logical
     last_oper = &order_by_oper;
   }
 
-  auto project_oper =
-      make_unique<ProjectLogicalOperator>(std::move(select_stmt->query_expressions()), select_stmt->limit_);
+  // limit 放在投影的下面，这样它的子算子是排序或者表扫描时，物理计划可以把它们合并起来
+  unique_ptr<LogicalOperator> limit_oper;
+  if (select_stmt->limit_ >= 0) {
+    limit_oper = make_unique<LimitLogicalOperator>(select_stmt->limit_, select_stmt->offset_);
+    if (*last_oper) {
+      limit_oper->add_child(std::move(*last_oper));
+    }
+
+    last_oper = &limit_oper;
+  }
+
+  auto project_oper = make_unique<ProjectLogicalOperator>(std::move(select_stmt->query_expressions()));
   if (*last_oper) {
     project_oper->add_child(std::move(*last_oper));
   }
@@ -227,6 +238,125 @@ RC LogicalPlanGenerator::create_plan(SelectStmt *select_stmt, unique_ptr<Logical
   return RC::SUCCESS;
 }
 
+/**
+ * @brief 判断字段是否属于子查询自己 FROM 子句中的表
+ * @details 表相同但别名不在子查询的 FROM 子句中时，字段引用的是外层同名表，也当作外层字段。
+ */
+static bool is_own_field(const SelectStmt &stmt, const FieldExpr &field_expr)
+{
+  for (size_t i = 0; i < stmt.tables_.size(); i++) {
+    if (stmt.tables_[i] != field_expr.field().table()) {
+      continue;
+    }
+    const string alias = field_expr.table_alias_std_string();
+    if (alias.empty() || i >= stmt.table_alias_.size() || stmt.table_alias_[i] == alias) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void add_outer_field(const FieldExpr &field_expr, vector<unique_ptr<FieldExpr>> &outer_fields)
+{
+  for (auto &outer_field : outer_fields) {
+    if (outer_field->field().table() == field_expr.field().table() &&
+        0 == strcmp(outer_field->field_name(), field_expr.field_name()) &&
+        outer_field->table_alias_std_string() == field_expr.table_alias_std_string()) {
+      return;
+    }
+  }
+  auto outer_field = make_unique<FieldExpr>(field_expr.field());
+  outer_field->set_table_alias(field_expr.table_alias_std_string());
+  outer_fields.push_back(std::move(outer_field));
+}
+
+static RC collect_outer_fields(
+    const SelectStmt &stmt, unique_ptr<Expression> &expr, vector<unique_ptr<FieldExpr>> &outer_fields)
+{
+  if (expr == nullptr) {
+    return RC::SUCCESS;
+  }
+
+  switch (expr->type()) {
+    case ExprType::FIELD: {
+      auto field_expr = static_cast<FieldExpr *>(expr.get());
+      if (!is_own_field(stmt, *field_expr)) {
+        add_outer_field(*field_expr, outer_fields);
+      }
+      return RC::SUCCESS;
+    }
+    case ExprType::SUB_QUERY: {
+      // 嵌套子查询已经先分析过了，它的外层字段可能属于当前子查询，也可能来自更外层
+      auto subquery_expr = static_cast<SubqueryExpr *>(expr.get());
+      for (auto &field_expr : subquery_expr->outer_fields()) {
+        if (!is_own_field(stmt, *field_expr)) {
+          add_outer_field(*field_expr, outer_fields);
+        }
+      }
+      return RC::SUCCESS;
+    }
+    default: {
+      return ExpressionIterator::iterate_child_expr(*expr, [&stmt, &outer_fields](unique_ptr<Expression> &child) {
+        return collect_outer_fields(stmt, child, outer_fields);
+      });
+    }
+  }
+}
+
+static RC collect_outer_fields(
+    const SelectStmt &stmt, LogicalOperator &oper, vector<unique_ptr<FieldExpr>> &outer_fields)
+{
+  RC rc = RC::SUCCESS;
+  for (auto &expr : oper.expressions()) {
+    if (OB_FAIL(rc = collect_outer_fields(stmt, expr, outer_fields))) {
+      return rc;
+    }
+  }
+
+  if (oper.type() == LogicalOperatorType::GROUP_BY) {
+    for (auto &expr : static_cast<GroupByLogicalOperator &>(oper).group_by_expressions()) {
+      if (OB_FAIL(rc = collect_outer_fields(stmt, expr, outer_fields))) {
+        return rc;
+      }
+    }
+  } else if (oper.type() == LogicalOperatorType::TABLE_GET) {
+    for (auto &expr : static_cast<TableGetLogicalOperator &>(oper).predicates()) {
+      if (OB_FAIL(rc = collect_outer_fields(stmt, expr, outer_fields))) {
+        return rc;
+      }
+    }
+  }
+
+  for (auto &child : oper.children()) {
+    if (OB_FAIL(rc = collect_outer_fields(stmt, *child, outer_fields))) {
+      return rc;
+    }
+  }
+  return rc;
+}
+
+RC LogicalPlanGenerator::create_subquery_plan(SubqueryExpr *subquery_expr)
+{
+  auto                        subquery_stmt = static_cast<SelectStmt *>(subquery_expr->stmt().get());
+  unique_ptr<LogicalOperator> subquery_oper;
+  RC                          rc = create_plan(subquery_stmt, subquery_oper);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to create subquery logical operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  vector<unique_ptr<FieldExpr>> outer_fields;
+  rc = collect_outer_fields(*subquery_stmt, *subquery_oper, outer_fields);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to collect outer fields of subquery. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  subquery_expr->set_outer_fields(std::move(outer_fields));
+  subquery_expr->set_logical_operator(std::move(subquery_oper));
+  return RC::SUCCESS;
+}
+
 RC LogicalPlanGenerator::create_plan(FilterStmt *filter_stmt, unique_ptr<LogicalOperator> &logical_operator)
 {
   RC                                  rc = RC::SUCCESS;
@@ -244,26 +374,16 @@ RC LogicalPlanGenerator::create_plan(FilterStmt *filter_stmt, unique_ptr<Logical
         auto cmp_expr_ = static_cast<ComparisonExpr *>(condition.get());
         // exists / not exists 可能会使得 left_expr 为空
         if (cmp_expr_->left() != nullptr && cmp_expr_->left()->type() == ExprType::SUB_QUERY) {
-          auto sub_query_expr = static_cast<SubqueryExpr *>(cmp_expr_->left().get());
-          auto sub_query_stmt = static_cast<SelectStmt *>(sub_query_expr->stmt().get());
-          unique_ptr<LogicalOperator> sub_query_oper;
-          rc = create_plan(sub_query_stmt, sub_query_oper);
+          rc = create_subquery_plan(static_cast<SubqueryExpr *>(cmp_expr_->left().get()));
           if (rc != RC::SUCCESS) {
-            LOG_WARN("failed to create subquery logical operator. rc=%s", strrc(rc));
             return rc;
           }
-          sub_query_expr->set_logical_operator(std::move(sub_query_oper));
         }
         if (cmp_expr_->right() != nullptr && cmp_expr_->right()->type() == ExprType::SUB_QUERY) {
-          auto sub_query_expr = static_cast<SubqueryExpr *>(cmp_expr_->right().get());
-          auto sub_query_stmt = static_cast<SelectStmt *>(sub_query_expr->stmt().get());
-          unique_ptr<LogicalOperator> sub_query_oper;
-          rc = create_plan(sub_query_stmt, sub_query_oper);
+          rc = create_subquery_plan(static_cast<SubqueryExpr *>(cmp_expr_->right().get()));
           if (rc != RC::SUCCESS) {
-            LOG_WARN("failed to create subquery logical operator. rc=%s", strrc(rc));
             return rc;
           }
-          sub_query_expr->set_logical_operator(std::move(sub_query_oper));
         }
         
         cmp_expr = unique_ptr<ComparisonExpr>(static_cast<ComparisonExpr *>(condition.release()));
@@ -514,15 +634,11 @@ RC LogicalPlanGenerator::create_plan(UpdateStmt *update_stmt, std::unique_ptr<Lo
   auto update_stmt_exprs = std::move(update_stmt->exprs());
   for (auto &expr : update_stmt_exprs) {
     if (expr->type() == ExprType::SUB_QUERY) {
-      auto sub_query_expr = static_cast<SubqueryExpr *>(expr.get());
-      auto sub_query_stmt = static_cast<SelectStmt *>(sub_query_expr->stmt().get());
-      unique_ptr<LogicalOperator> sub_query_logical_oper;
-      rc = create_plan(sub_query_stmt, sub_query_logical_oper);
+      rc = create_subquery_plan(static_cast<SubqueryExpr *>(expr.get()));
       if (rc != RC::SUCCESS) {
         LOG_PANIC("update_logical_generator: failed to create sub query logical plan. rc=%s", strrc(rc));
         return rc;
       }
-      sub_query_expr->set_logical_operator(std::move(sub_query_logical_oper));
     }
   }
 
@@ -28,6 +28,7 @@ class DeleteStmt;
 class ExplainStmt;
 class UpdateStmt;
 class LogicalOperator;
+class SubqueryExpr;
 
 class LogicalPlanGenerator
 {
@@ -49,5 +50,11 @@ private:
   RC create_group_by_plan(SelectStmt *select_stmt, std::unique_ptr<LogicalOperator> &logical_operator);
   RC create_order_by_plan(SelectStmt *select_stmt, std::unique_ptr<LogicalOperator> &logical_operator);
 
+  /**
+   * @brief 为子查询创建逻辑计划，并找出它引用的外层查询的字段
+   * @details 子查询执行时按这些外层字段的值缓存结果，不相关子查询只需要执行一次。
+   */
+  RC create_subquery_plan(SubqueryExpr *subquery_expr);
+
   int implicit_cast_cost(AttrType from, AttrType to);
 };
\ No newline at end of file
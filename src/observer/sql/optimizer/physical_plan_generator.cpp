@@ -14,8 +14,10 @@ See the Mulan PSL v2 for more details. */
 
 #include <utility>
 
+#include "common/lang/set.h"
 #include "common/log/log.h"
 #include "sql/expr/expression.h"
+#include "sql/expr/expression_iterator.h"
 #include "sql/operator/aggregate_vec_physical_operator.h"
 #include "sql/operator/calc_logical_operator.h"
 #include "sql/operator/calc_physical_operator.h"
@@ -25,11 +27,16 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/explain_physical_operator.h"
 #include "sql/operator/expr_vec_physical_operator.h"
 #include "sql/operator/group_by_vec_physical_operator.h"
+#include "sql/operator/index_nested_loop_join_physical_operator.h"
 #include "sql/operator/index_scan_physical_operator.h"
 #include "sql/operator/insert_logical_operator.h"
 #include "sql/operator/insert_physical_operator.h"
 #include "sql/operator/join_logical_operator.h"
+#include "sql/operator/hash_semi_join_physical_operator.h"
 #include "sql/operator/join_physical_operator.h"
+#include "sql/operator/limit_logical_operator.h"
+#include "sql/operator/limit_physical_operator.h"
+#include "sql/operator/limit_vec_physical_operator.h"
 #include "sql/operator/predicate_logical_operator.h"
 #include "sql/operator/predicate_physical_operator.h"
 #include "sql/operator/project_logical_operator.h"
@@ -47,6 +54,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/optimizer/physical_plan_generator.h"
 #include "sql/operator/order_by_logical_operator.h"
 #include "sql/operator/order_by_physical_operator.h"
+#include "sql/operator/top_n_physical_operator.h"
 #include "sql/operator/vector_index_scan_physical_operator.h"
 using namespace std;
 
@@ -99,6 +107,10 @@ RC PhysicalPlanGenerator::create(LogicalOperator &logical_operator, unique_ptr<P
       return create_plan(static_cast<OrderByLogicalOperator &>(logical_operator), oper);
     } break;
 
+    case LogicalOperatorType::LIMIT: {
+      return create_plan(static_cast<LimitLogicalOperator &>(logical_operator), oper);
+    } break;
+
     default: {
       ASSERT(false, "unknown logical operator type");
       return RC::INVALID_ARGUMENT;
@@ -124,6 +136,9 @@ RC PhysicalPlanGenerator::create_vec(LogicalOperator &logical_operator, unique_p
     case LogicalOperatorType::EXPLAIN: {
       return create_vec_plan(static_cast<ExplainLogicalOperator &>(logical_operator), oper);
     } break;
+    case LogicalOperatorType::LIMIT: {
+      return create_vec_plan(static_cast<LimitLogicalOperator &>(logical_operator), oper);
+    } break;
     default: {
       return RC::INVALID_ARGUMENT;
     }
@@ -133,6 +148,109 @@ RC PhysicalPlanGenerator::create_vec(LogicalOperator &logical_operator, unique_p
 
 
 
+/**
+ * @brief 收集 AND 连接的比较条件，表达式中有 OR 时不收集
+ */
+static void collect_and_comparisons(Expression *expr, vector<ComparisonExpr *> &comparisons)
+{
+  if (expr->type() == ExprType::COMPARISON) {
+    comparisons.push_back(static_cast<ComparisonExpr *>(expr));
+  } else if (expr->type() == ExprType::CONJUNCTION) {
+    auto conjunction_expr = static_cast<ConjunctionExpr *>(expr);
+    if (conjunction_expr->conjunction_type() != ConjunctionExpr::Type::AND) {
+      return;
+    }
+    for (auto &child : conjunction_expr->children()) {
+      collect_and_comparisons(child.get(), comparisons);
+    }
+  }
+}
+
+/**
+ * @brief 收集算子输出的行中包含的表。半连接和反连接只输出左表的行
+ */
+static void collect_output_tables(LogicalOperator &oper, vector<const TableGetLogicalOperator *> &tables)
+{
+  if (oper.type() == LogicalOperatorType::TABLE_GET) {
+    tables.push_back(static_cast<const TableGetLogicalOperator *>(&oper));
+    return;
+  }
+
+  vector<unique_ptr<LogicalOperator>> &children = oper.children();
+  if (oper.type() == LogicalOperatorType::JOIN &&
+      static_cast<JoinLogicalOperator &>(oper).join_type() != JoinType::INNER) {
+    collect_output_tables(*children.front(), tables);
+    return;
+  }
+  for (auto &child : children) {
+    collect_output_tables(*child, tables);
+  }
+}
+
+/**
+ * @brief 字段是否来自这个表。两边都有别名时别名也要相同，与 RowTuple::find_cell 的规则一致
+ */
+static bool is_field_of(const FieldExpr &field_expr, const TableGetLogicalOperator &table_get)
+{
+  if (field_expr.field().table() != table_get.table()) {
+    return false;
+  }
+  const string alias = field_expr.table_alias_std_string();
+  return alias.empty() || table_get.table_alias().empty() || alias == table_get.table_alias();
+}
+
+static bool is_field_of_any(const FieldExpr &field_expr, const vector<const TableGetLogicalOperator *> &tables)
+{
+  for (const TableGetLogicalOperator *table_get : tables) {
+    if (is_field_of(field_expr, *table_get)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief 在连接条件中找一个 左表字段 = 右表字段 的等值条件，并且右表在这个字段上有索引
+ * @details 两边的类型必须相同，索引按字节比较键值，类型不同时查不到相等的值。
+ * 浮点数比较时有误差，与索引的精确查找不一致，也不使用
+ * @param[out] left_field 左表的连接字段
+ * @return 找到的索引，没有可用的索引时返回 nullptr
+ */
+static Index *find_join_index(const vector<ComparisonExpr *> &join_conditions,
+    const vector<const TableGetLogicalOperator *> &left_tables, const TableGetLogicalOperator &right_table,
+    FieldExpr *&left_field)
+{
+  for (ComparisonExpr *comparison_expr : join_conditions) {
+    if (comparison_expr->comp() != CompOp::EQUAL_TO || comparison_expr->left()->type() != ExprType::FIELD ||
+        comparison_expr->right()->type() != ExprType::FIELD) {
+      continue;
+    }
+
+    auto first  = static_cast<FieldExpr *>(comparison_expr->left().get());
+    auto second = static_cast<FieldExpr *>(comparison_expr->right().get());
+    for (int i = 0; i < 2; i++, std::swap(first, second)) {
+      // 同一个字段可能同时匹配左右两边的表（比如自连接没有别名），无法区分，不使用
+      if (!is_field_of_any(*first, left_tables) || is_field_of(*first, right_table) ||
+          !is_field_of(*second, right_table) || is_field_of_any(*second, left_tables)) {
+        continue;
+      }
+
+      const AttrType attr_type = second->value_type();
+      if (first->value_type() != attr_type ||
+          (attr_type != AttrType::INTS && attr_type != AttrType::DATES && attr_type != AttrType::CHARS)) {
+        continue;
+      }
+
+      Index *index = right_table.table()->find_index_by_fields({second->field_name()});
+      if (index != nullptr) {
+        left_field = first;
+        return index;
+      }
+    }
+  }
+  return nullptr;
+}
+
 RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, unique_ptr<PhysicalOperator> &oper)
 {
   vector<unique_ptr<Expression>> &predicates = table_get_oper.predicates();
@@ -224,6 +342,7 @@ RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, u
 
     index_scan_oper->set_predicates(std::move(predicates));
     index_scan_oper->is_or_conjunction = table_get_oper.is_or_conjunction;
+    index_scan_oper->set_limit(table_get_oper.limit());
     oper                               = unique_ptr<PhysicalOperator>(index_scan_oper);
     LOG_INFO("use index scan");
     return RC::SUCCESS;
@@ -232,6 +351,7 @@ RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, u
   table_scan_oper->set_table_alias(table_get_oper.table_alias());
   table_scan_oper->set_predicates(std::move(predicates));
   table_scan_oper->is_or_conjunction = table_get_oper.is_or_conjunction;
+  table_scan_oper->set_limit(table_get_oper.limit());
   oper                               = unique_ptr<PhysicalOperator>(table_scan_oper);
   LOG_INFO("use table scan");
 
@@ -245,17 +365,24 @@ RC PhysicalPlanGenerator::create_plan(PredicateLogicalOperator &pred_oper, uniqu
 
   LogicalOperator &child_oper = *children_opers.front();
 
+  // 检查是否只有一个表达式(ConjunctionExpr)
+  vector<unique_ptr<Expression>> &expressions = pred_oper.expressions();
+  ASSERT(expressions.size() == 1, "predicate logical operator's children should be 1");
+
   unique_ptr<PhysicalOperator> child_phy_oper;
-  RC                           rc = create(child_oper, child_phy_oper);
+  RC                           rc = RC::SUCCESS;
+  if (child_oper.type() == LogicalOperatorType::JOIN) {
+    vector<ComparisonExpr *> join_conditions;
+    collect_and_comparisons(expressions.front().get(), join_conditions);
+    rc = create_plan(static_cast<JoinLogicalOperator &>(child_oper), child_phy_oper, join_conditions);
+  } else {
+    rc = create(child_oper, child_phy_oper);
+  }
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to create child operator of predicate operator. rc=%s", strrc(rc));
     return rc;
   }
 
-  // 检查是否只有一个表达式(ConjunctionExpr)
-  vector<unique_ptr<Expression>> &expressions = pred_oper.expressions();
-  ASSERT(expressions.size() == 1, "predicate logical operator's children should be 1");
-
   unique_ptr<Expression> expression = std::move(expressions.front());
 
   // 取出子查询的逻辑算子，创建物理算子
@@ -313,11 +440,39 @@ RC PhysicalPlanGenerator::create_plan(ProjectLogicalOperator &project_oper, uniq
 
   unique_ptr<PhysicalOperator> child_phy_oper;
 
+  RC rc = RC::SUCCESS;
+  if (!child_opers.empty()) {
+    LogicalOperator *child_oper = child_opers.front().get();
+
+    rc = create(*child_oper, child_phy_oper);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to create project logical operator's child physical operator. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  auto project_operator = make_unique<ProjectPhysicalOperator>(std::move(project_oper.expressions()));
+  if (child_phy_oper) {
+    project_operator->add_child(std::move(child_phy_oper));
+  }
+
+  oper = std::move(project_operator);
+
+  LOG_TRACE("create a project physical operator");
+  return rc;
+}
+
+RC PhysicalPlanGenerator::create_plan(LimitLogicalOperator &limit_oper, unique_ptr<PhysicalOperator> &oper)
+{
+  vector<unique_ptr<LogicalOperator>> &child_opers = limit_oper.children();
+
+  unique_ptr<PhysicalOperator> child_phy_oper;
+
   do {
     // 将orderby + limit 转化为向量索引查询计划
     // condition: limit, order by
-    int limit = project_oper.limit();
-    if (limit != -1 && child_opers.size() == 1 && child_opers[0]->type() == LogicalOperatorType::ORDER_BY) {
+    int limit = limit_oper.fetch_num();
+    if (child_opers.size() == 1 && child_opers[0]->type() == LogicalOperatorType::ORDER_BY) {
       const auto order_by_oper = static_cast<OrderByLogicalOperator *>(child_opers[0].get());
       const std::vector<std::unique_ptr<LogicalOperator>> &order_by_children = order_by_oper->children();
       const std::vector<std::unique_ptr<Expression>>      &order_by_exprs    = order_by_oper->expressions();
@@ -372,26 +527,38 @@ RC PhysicalPlanGenerator::create_plan(ProjectLogicalOperator &project_oper, uniq
     }
   } while (false);
 
+  // 其它的 order by + limit 只保留前 limit + offset 行，不需要对所有的行排序
+  if (child_phy_oper == nullptr && child_opers.size() == 1 && child_opers[0]->type() == LogicalOperatorType::ORDER_BY) {
+    auto &order_by_oper = static_cast<OrderByLogicalOperator &>(*child_opers[0]);
+    auto  top_n_oper    = make_unique<TopNPhysicalOperator>(
+        std::move(order_by_oper.expressions()), std::move(order_by_oper.order_by_descs()), limit_oper.fetch_num());
+    auto &order_by_children = order_by_oper.children();
+    if (!order_by_children.empty()) {
+      unique_ptr<PhysicalOperator> grandchild_phy_oper;
+      RC                           rc = create(*order_by_children[0], grandchild_phy_oper);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to create order by logical operator's child physical operator. rc=%s", strrc(rc));
+        return rc;
+      }
+      top_n_oper->add_child(std::move(grandchild_phy_oper));
+    }
+    child_phy_oper = std::move(top_n_oper);
+  }
+
+
   RC rc = RC::SUCCESS;
   if (!child_opers.empty() && child_phy_oper == nullptr) {
-    LogicalOperator *child_oper = child_opers.front().get();
-
-    rc = create(*child_oper, child_phy_oper);
+    rc = create(*child_opers.front(), child_phy_oper);
     if (OB_FAIL(rc)) {
-      LOG_WARN("failed to create project logical operator's child physical operator. rc=%s", strrc(rc));
+      LOG_WARN("failed to create limit logical operator's child physical operator. rc=%s", strrc(rc));
       return rc;
     }
   }
 
-  auto project_operator =
-      make_unique<ProjectPhysicalOperator>(std::move(project_oper.expressions()), project_oper.limit());
+  oper = make_unique<LimitPhysicalOperator>(limit_oper.limit(), limit_oper.offset());
   if (child_phy_oper) {
-    project_operator->add_child(std::move(child_phy_oper));
+    oper->add_child(std::move(child_phy_oper));
   }
-
-  oper = std::move(project_operator);
-
-  LOG_TRACE("create a project physical operator");
   return rc;
 }
 
@@ -453,6 +620,12 @@ RC PhysicalPlanGenerator::create_plan(ExplainLogicalOperator &explain_oper, uniq
 }
 
 RC PhysicalPlanGenerator::create_plan(JoinLogicalOperator &join_oper, unique_ptr<PhysicalOperator> &oper)
+{
+  return create_plan(join_oper, oper, vector<ComparisonExpr *>());
+}
+
+RC PhysicalPlanGenerator::create_plan(
+    JoinLogicalOperator &join_oper, unique_ptr<PhysicalOperator> &oper, const vector<ComparisonExpr *> &join_conditions)
 {
   RC rc = RC::SUCCESS;
 
@@ -462,10 +635,56 @@ RC PhysicalPlanGenerator::create_plan(JoinLogicalOperator &join_oper, unique_ptr
     return RC::INTERNAL;
   }
 
-  unique_ptr<PhysicalOperator> join_physical_oper(new NestedLoopJoinPhysicalOperator);
+  // 左表可能还是一个连接，连接条件要继续传下去
+  auto create_child = [this, &join_conditions](
+                          LogicalOperator &child_oper, unique_ptr<PhysicalOperator> &child_phy_oper) {
+    if (child_oper.type() == LogicalOperatorType::JOIN) {
+      return create_plan(static_cast<JoinLogicalOperator &>(child_oper), child_phy_oper, join_conditions);
+    }
+    return create(child_oper, child_phy_oper);
+  };
+
+  if (join_oper.join_type() == JoinType::INNER && child_opers[1]->type() == LogicalOperatorType::TABLE_GET) {
+    auto &right_oper = static_cast<TableGetLogicalOperator &>(*child_opers[1]);
+
+    FieldExpr *left_field = nullptr;
+    Index     *index      = nullptr;
+    if (!right_oper.not_use_index() && right_oper.predicates().empty()) {
+      vector<const TableGetLogicalOperator *> left_tables;
+      collect_output_tables(*child_opers[0], left_tables);
+      index = find_join_index(join_conditions, left_tables, right_oper, left_field);
+    }
+
+    if (index != nullptr) {
+      unique_ptr<PhysicalOperator> left_phy_oper;
+      rc = create_child(*child_opers[0], left_phy_oper);
+      if (rc != RC::SUCCESS) {
+        LOG_WARN("failed to create physical child oper. rc=%s", strrc(rc));
+        return rc;
+      }
+
+      auto left_key = make_unique<FieldExpr>(left_field->field());
+      left_key->set_table_alias(left_field->table_alias_std_string());
+      auto index_join_oper = make_unique<IndexNestedLoopJoinPhysicalOperator>(
+          right_oper.table(), index, right_oper.read_write_mode(), std::move(left_key));
+      index_join_oper->set_table_alias(right_oper.table_alias());
+      index_join_oper->add_child(std::move(left_phy_oper));
+      oper = std::move(index_join_oper);
+      LOG_INFO("use index nested loop join");
+      return rc;
+    }
+  }
+
+  unique_ptr<PhysicalOperator> join_physical_oper;
+  if (join_oper.join_type() == JoinType::INNER) {
+    join_physical_oper = make_unique<NestedLoopJoinPhysicalOperator>();
+  } else {
+    join_physical_oper = make_unique<HashSemiJoinPhysicalOperator>(
+        join_oper.join_type(), std::move(join_oper.left_keys()), std::move(join_oper.right_keys()));
+  }
   for (auto &child_oper : child_opers) {
     unique_ptr<PhysicalOperator> child_physical_oper;
-    rc = create(*child_oper, child_physical_oper);
+    rc = create_child(*child_oper, child_physical_oper);
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to create physical child oper. rc=%s", strrc(rc));
       return rc;
@@ -522,6 +741,34 @@ RC PhysicalPlanGenerator::create_vec_plan(TableGetLogicalOperator &table_get_ope
   vector<unique_ptr<Expression>> &predicates = table_get_oper.predicates();
   Table *table = table_get_oper.table();
   TableScanVecPhysicalOperator *table_scan_oper = new TableScanVecPhysicalOperator(table, table_get_oper.read_write_mode());
+
+  // 收集过滤条件用到的列，扫描时先只读取这些列，其它列只读取满足条件的记录（延迟物化）。
+  // 条件中有按位置引用的列时，不知道用到了哪些列，不做延迟物化
+  set<int>                               predicate_fields;
+  bool                                   late_materialization = true;
+  function<RC(unique_ptr<Expression> &)> collect_fields       = [&](unique_ptr<Expression> &expr) -> RC {
+    if (expr->type() == ExprType::FIELD && expr->pos() == -1) {
+      const Field &field = static_cast<FieldExpr *>(expr.get())->field();
+      if (field.table() == table) {
+        predicate_fields.insert(field.meta()->field_id());
+      } else {
+        late_materialization = false;
+      }
+      return RC::SUCCESS;
+    }
+    if (expr->pos() != -1) {
+      late_materialization = false;
+      return RC::SUCCESS;
+    }
+    return ExpressionIterator::iterate_child_expr(*expr, collect_fields);
+  };
+  for (unique_ptr<Expression> &predicate : predicates) {
+    collect_fields(predicate);
+  }
+  if (late_materialization && !predicate_fields.empty()) {
+    table_scan_oper->set_predicate_fields(vector<int>(predicate_fields.begin(), predicate_fields.end()));
+  }
+
   table_scan_oper->set_predicates(std::move(predicates));
   oper = unique_ptr<PhysicalOperator>(table_scan_oper);
   LOG_TRACE("use vectorized table scan");
@@ -594,6 +841,28 @@ RC PhysicalPlanGenerator::create_vec_plan(ProjectLogicalOperator &project_oper,
 }
 
 
+RC PhysicalPlanGenerator::create_vec_plan(LimitLogicalOperator &limit_oper, unique_ptr<PhysicalOperator> &oper)
+{
+  vector<unique_ptr<LogicalOperator>> &child_opers = limit_oper.children();
+
+  unique_ptr<PhysicalOperator> child_phy_oper;
+
+  RC rc = RC::SUCCESS;
+  if (!child_opers.empty()) {
+    rc = create_vec(*child_opers.front(), child_phy_oper);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to create limit logical operator's child physical operator. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  oper = make_unique<LimitVecPhysicalOperator>(limit_oper.limit(), limit_oper.offset());
+  if (child_phy_oper) {
+    oper->add_child(std::move(child_phy_oper));
+  }
+  return rc;
+}
+
 RC PhysicalPlanGenerator::create_vec_plan(ExplainLogicalOperator &explain_oper, unique_ptr<PhysicalOperator> &oper)
 {
   vector<unique_ptr<LogicalOperator>> &child_opers = explain_oper.children();
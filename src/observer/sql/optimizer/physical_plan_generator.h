@@ -28,7 +28,9 @@ class JoinLogicalOperator;
 class CalcLogicalOperator;
 class GroupByLogicalOperator;
 class OrderByLogicalOperator;
+class LimitLogicalOperator;
 class UpdateLogicalOperator;
+class ComparisonExpr;
 
 /**
  * @brief 物理计划生成器
@@ -53,6 +55,13 @@ private:
   RC create_plan(DeleteLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
   RC create_plan(ExplainLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
   RC create_plan(JoinLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
+  /**
+   * @brief 创建连接的物理计划
+   * @param join_conditions 连接上方 Predicate 中用 AND 连接的比较条件，用来选择连接算法。
+   * 这些条件仍然由 Predicate 判断，这里不会修改它们
+   */
+  RC create_plan(JoinLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper,
+      const std::vector<ComparisonExpr *> &join_conditions);
   RC create_plan(CalcLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
   RC create_plan(GroupByLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
   RC create_plan(UpdateLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
@@ -61,4 +70,6 @@ private:
   RC create_vec_plan(GroupByLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
   RC create_vec_plan(ExplainLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
   RC create_plan(OrderByLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
+  RC create_plan(LimitLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
+  RC create_vec_plan(LimitLogicalOperator &logical_oper, std::unique_ptr<PhysicalOperator> &oper);
 };
@@ -16,14 +16,18 @@ See the Mulan PSL v2 for more details. */
 #include "common/log/log.h"
 #include "sql/operator/logical_operator.h"
 #include "sql/optimizer/expression_rewriter.h"
+#include "sql/optimizer/limit_pushdown_rewriter.h"
 #include "sql/optimizer/predicate_pushdown_rewriter.h"
 #include "sql/optimizer/predicate_rewrite.h"
+#include "sql/optimizer/subquery_to_join_rewriter.h"
 
 Rewriter::Rewriter()
 {
   rewrite_rules_.emplace_back(new ExpressionRewriter);
   rewrite_rules_.emplace_back(new PredicateRewriteRule);
+  rewrite_rules_.emplace_back(new SubqueryToJoinRewriter);
   rewrite_rules_.emplace_back(new PredicatePushdownRewriter);
+  rewrite_rules_.emplace_back(new LimitPushdownRewriter);
 }
 
 RC Rewriter::rewrite(std::unique_ptr<LogicalOperator> &oper, bool &change_made)
@@ -0,0 +1,340 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include "sql/optimizer/subquery_to_join_rewriter.h"
+#include "common/lang/algorithm.h"
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+#include "sql/expr/expression_iterator.h"
+#include "sql/operator/group_by_logical_operator.h"
+#include "sql/operator/join_logical_operator.h"
+#include "sql/operator/table_get_logical_operator.h"
+
+using namespace std;
+
+namespace {
+
+/// 子查询条件中各部分引用的字段
+struct ExprRefs
+{
+  bool outer    = false;  ///< 引用了外层查询的字段
+  bool inner    = false;  ///< 引用了子查询自己的字段
+  bool subquery = false;  ///< 包含嵌套的子查询
+};
+
+bool is_outer_field(const SubqueryExpr &subquery, const FieldExpr &field_expr)
+{
+  for (const auto &outer_field : subquery.outer_fields()) {
+    if (outer_field->field().table() == field_expr.field().table() &&
+        0 == strcmp(outer_field->field_name(), field_expr.field_name()) &&
+        outer_field->table_alias_std_string() == field_expr.table_alias_std_string()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief 收集表达式引用的字段
+ * @param subquery 为空时所有字段都算作 inner
+ */
+void collect_refs(const SubqueryExpr *subquery, Expression &expr, ExprRefs &refs)
+{
+  switch (expr.type()) {
+    case ExprType::FIELD: {
+      if (subquery != nullptr && is_outer_field(*subquery, static_cast<FieldExpr &>(expr))) {
+        refs.outer = true;
+      } else {
+        refs.inner = true;
+      }
+    } break;
+    case ExprType::SUB_QUERY: {
+      refs.subquery = true;
+      if (subquery != nullptr) {
+        for (const auto &field_expr : static_cast<SubqueryExpr &>(expr).outer_fields()) {
+          refs.outer = refs.outer || is_outer_field(*subquery, *field_expr);
+        }
+      }
+    } break;
+    default: {
+      ExpressionIterator::iterate_child_expr(expr, [subquery, &refs](unique_ptr<Expression> &child) {
+        if (child != nullptr) {
+          collect_refs(subquery, *child, refs);
+        }
+        return RC::SUCCESS;
+      });
+    } break;
+  }
+}
+
+bool has_outer_refs(const SubqueryExpr &subquery, vector<unique_ptr<Expression>> &exprs)
+{
+  for (auto &expr : exprs) {
+    ExprRefs refs;
+    if (expr != nullptr) {
+      collect_refs(&subquery, *expr, refs);
+    }
+    if (refs.outer) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool has_outer_refs(const SubqueryExpr &subquery, LogicalOperator &oper)
+{
+  if (has_outer_refs(subquery, oper.expressions())) {
+    return true;
+  }
+  if (oper.type() == LogicalOperatorType::GROUP_BY &&
+      has_outer_refs(subquery, static_cast<GroupByLogicalOperator &>(oper).group_by_expressions())) {
+    return true;
+  }
+  if (oper.type() == LogicalOperatorType::TABLE_GET &&
+      has_outer_refs(subquery, static_cast<TableGetLogicalOperator &>(oper).predicates())) {
+    return true;
+  }
+  for (auto &child : oper.children()) {
+    if (has_outer_refs(subquery, *child)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// 两边类型相同并且是整数、日期或字符串时，编码后相等与 Value::compare 相等一致，才能用哈希连接
+bool is_hashable_key(const Expression &left, const Expression &right)
+{
+  const AttrType type = left.value_type();
+  if (type != right.value_type()) {
+    return false;
+  }
+  return type == AttrType::INTS || type == AttrType::DATES || type == AttrType::CHARS;
+}
+
+}  // namespace
+
+RC SubqueryToJoinRewriter::rewrite(unique_ptr<LogicalOperator> &oper, bool &change_made)
+{
+  if (oper->type() != LogicalOperatorType::PREDICATE || oper->children().size() != 1 ||
+      oper->expressions().size() != 1) {
+    return RC::SUCCESS;
+  }
+
+  RC                                      rc        = RC::SUCCESS;
+  unique_ptr<Expression>                 &predicate = oper->expressions().front();
+  vector<unique_ptr<JoinLogicalOperator>> joins;
+  bool                                    predicate_empty = false;
+  if (predicate->type() == ExprType::CONJUNCTION) {
+    auto conjunction_expr = static_cast<ConjunctionExpr *>(predicate.get());
+    if (conjunction_expr->conjunction_type() != ConjunctionExpr::Type::AND) {
+      return RC::SUCCESS;
+    }
+
+    vector<unique_ptr<Expression>> &children = conjunction_expr->children();
+    for (auto &child : children) {
+      unique_ptr<JoinLogicalOperator> join;
+      if (OB_FAIL(rc = try_convert(child, join))) {
+        return rc;
+      }
+      if (join != nullptr) {
+        joins.push_back(std::move(join));
+      }
+    }
+    children.erase(remove(children.begin(), children.end(), nullptr), children.end());
+    predicate_empty = children.empty();
+  } else {
+    unique_ptr<JoinLogicalOperator> join;
+    if (OB_FAIL(rc = try_convert(predicate, join))) {
+      return rc;
+    }
+    if (join != nullptr) {
+      joins.push_back(std::move(join));
+    }
+    predicate_empty = (predicate == nullptr);
+  }
+
+  if (joins.empty()) {
+    return rc;
+  }
+
+  // 所有条件都改写成了连接，谓词算子就不需要了
+  unique_ptr<LogicalOperator> left = std::move(oper);
+  if (predicate_empty) {
+    left = std::move(left->children().front());
+  }
+  for (auto &join : joins) {
+    join->children().insert(join->children().begin(), std::move(left));
+    left = std::move(join);
+  }
+  oper        = std::move(left);
+  change_made = true;
+  return rc;
+}
+
+RC SubqueryToJoinRewriter::try_convert(unique_ptr<Expression> &expr, unique_ptr<JoinLogicalOperator> &join)
+{
+  if (expr->type() != ExprType::COMPARISON) {
+    return RC::SUCCESS;
+  }
+
+  auto         comparison_expr = static_cast<ComparisonExpr *>(expr.get());
+  const CompOp comp            = comparison_expr->comp();
+  if (comp != CompOp::IN && comp != CompOp::NOT_IN && comp != CompOp::EXISTS && comp != CompOp::NOT_EXISTS) {
+    return RC::SUCCESS;
+  }
+  if (comparison_expr->right() == nullptr || comparison_expr->right()->type() != ExprType::SUB_QUERY) {
+    return RC::SUCCESS;
+  }
+
+  auto                         subquery = static_cast<SubqueryExpr *>(comparison_expr->right().get());
+  unique_ptr<LogicalOperator> &project  = subquery->logical_operator();
+  if (!subquery->cacheable() || project == nullptr || project->type() != LogicalOperatorType::PROJECTION ||
+      project->children().size() != 1) {
+    return RC::SUCCESS;
+  }
+
+  const bool                     correlated = !subquery->outer_fields().empty();
+  unique_ptr<LogicalOperator>   &plan       = project->children().front();
+  vector<unique_ptr<Expression>> left_keys;
+  vector<unique_ptr<Expression>> right_keys;
+  JoinType                       join_type = JoinType::SEMI;
+  if (comp == CompOp::IN || comp == CompOp::NOT_IN) {
+    unique_ptr<Expression> &left = comparison_expr->left();
+    if (left == nullptr || left->type() == ExprType::SPECIAL_PLACEHOLDER || left->type() == ExprType::VALUES ||
+        project->expressions().size() != 1) {
+      return RC::SUCCESS;
+    }
+
+    ExprRefs left_refs;
+    collect_refs(nullptr, *left, left_refs);
+    unique_ptr<Expression> &project_expr = project->expressions().front();
+    if (left_refs.subquery || !is_hashable_key(*left, *project_expr)) {
+      return RC::SUCCESS;
+    }
+
+    if (correlated) {
+      // NOT IN 的 null 语义要按外层的值分别判断，不改写
+      if (comp == CompOp::NOT_IN) {
+        return RC::SUCCESS;
+      }
+      ExprRefs project_refs;
+      collect_refs(subquery, *project_expr, project_refs);
+      if (project_refs.outer || !extract_correlated_keys(*subquery, plan, left_keys, right_keys)) {
+        return RC::SUCCESS;
+      }
+    }
+
+    // 投影的表达式直接在投影下面的算子输出的行上计算，与投影算子的计算方式相同
+    left_keys.push_back(std::move(left));
+    right_keys.push_back(std::move(project_expr));
+    join_type = (comp == CompOp::IN) ? JoinType::SEMI : JoinType::NULL_AWARE_ANTI;
+  } else {
+    // 不相关的 EXISTS 只会执行一次，不需要改写
+    if (!correlated || !extract_correlated_keys(*subquery, plan, left_keys, right_keys)) {
+      return RC::SUCCESS;
+    }
+    join_type = (comp == CompOp::EXISTS) ? JoinType::SEMI : JoinType::ANTI;
+  }
+
+  LOG_DEBUG("rewrite subquery to join. join type=%d, key num=%d", static_cast<int>(join_type), left_keys.size());
+  join = make_unique<JoinLogicalOperator>(join_type, std::move(left_keys), std::move(right_keys));
+  join->add_child(std::move(plan));
+  expr.reset();
+  return RC::SUCCESS;
+}
+
+bool SubqueryToJoinRewriter::extract_correlated_keys(const SubqueryExpr &subquery, unique_ptr<LogicalOperator> &plan,
+    vector<unique_ptr<Expression>> &left_keys, vector<unique_ptr<Expression>> &right_keys)
+{
+  if (plan->type() != LogicalOperatorType::PREDICATE || plan->children().size() != 1 ||
+      plan->expressions().size() != 1) {
+    return false;
+  }
+
+  unique_ptr<Expression>          &predicate = plan->expressions().front();
+  vector<unique_ptr<Expression> *> conditions;
+  if (predicate->type() == ExprType::CONJUNCTION) {
+    auto conjunction_expr = static_cast<ConjunctionExpr *>(predicate.get());
+    if (conjunction_expr->conjunction_type() != ConjunctionExpr::Type::AND) {
+      return false;
+    }
+    for (auto &child : conjunction_expr->children()) {
+      conditions.push_back(&child);
+    }
+  } else {
+    conditions.push_back(&predicate);
+  }
+
+  // 先检查所有条件，确定可以改写之后再修改计划
+  vector<pair<ComparisonExpr *, bool /*outer_on_left*/>> key_conditions;
+  for (unique_ptr<Expression> *condition : conditions) {
+    ExprRefs refs;
+    collect_refs(&subquery, **condition, refs);
+    if (!refs.outer) {
+      continue;
+    }
+    if ((*condition)->type() != ExprType::COMPARISON) {
+      return false;
+    }
+
+    auto comparison_expr = static_cast<ComparisonExpr *>(condition->get());
+    if (comparison_expr->comp() != CompOp::EQUAL_TO) {
+      return false;
+    }
+    ExprRefs left_refs;
+    ExprRefs right_refs;
+    collect_refs(&subquery, *comparison_expr->left(), left_refs);
+    collect_refs(&subquery, *comparison_expr->right(), right_refs);
+    if (left_refs.subquery || right_refs.subquery) {
+      return false;
+    }
+    const bool outer_on_left  = left_refs.outer && !left_refs.inner && right_refs.inner && !right_refs.outer;
+    const bool outer_on_right = right_refs.outer && !right_refs.inner && left_refs.inner && !left_refs.outer;
+    if ((!outer_on_left && !outer_on_right) ||
+        !is_hashable_key(*comparison_expr->left(), *comparison_expr->right())) {
+      return false;
+    }
+    key_conditions.emplace_back(comparison_expr, outer_on_left);
+  }
+
+  if (key_conditions.empty() || has_outer_refs(subquery, *plan->children().front())) {
+    return false;
+  }
+
+  for (auto &[comparison_expr, outer_on_left] : key_conditions) {
+    unique_ptr<Expression> &outer_expr = outer_on_left ? comparison_expr->left() : comparison_expr->right();
+    unique_ptr<Expression> &inner_expr = outer_on_left ? comparison_expr->right() : comparison_expr->left();
+    left_keys.push_back(std::move(outer_expr));
+    right_keys.push_back(std::move(inner_expr));
+  }
+  for (unique_ptr<Expression> *condition : conditions) {
+    for (auto &key_condition : key_conditions) {
+      if (condition->get() == key_condition.first) {
+        condition->reset();
+        break;
+      }
+    }
+  }
+
+  bool predicate_empty = (predicate == nullptr);
+  if (!predicate_empty && predicate->type() == ExprType::CONJUNCTION) {
+    auto &children = static_cast<ConjunctionExpr *>(predicate.get())->children();
+    children.erase(remove(children.begin(), children.end(), nullptr), children.end());
+    predicate_empty = children.empty();
+  }
+  if (predicate_empty) {
+    unique_ptr<LogicalOperator> child = std::move(plan->children().front());
+    plan                              = std::move(child);
+  }
+  return true;
+}
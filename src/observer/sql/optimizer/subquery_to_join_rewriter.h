@@ -0,0 +1,55 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <vector>
+
+#include "sql/optimizer/rewrite_rule.h"
+
+class ComparisonExpr;
+class JoinLogicalOperator;
+class SubqueryExpr;
+
+/**
+ * @brief 把谓词中的子查询改写成半连接或反连接
+ * @ingroup Rewriter
+ * @details 谓词是 AND 连接的条件时，逐个检查其中的子查询条件，能改写的从谓词中删除，
+ * 在谓词算子上面加一个连接算子，谓词算子作为左表，子查询的计划（去掉投影）作为右表：
+ * - x IN (SELECT y ...)：半连接，连接键是 x = y；
+ * - x NOT IN (SELECT y ...)：不相关子查询改写成考虑 null 的反连接；
+ * - EXISTS / NOT EXISTS：子查询的谓词中与外层相关的条件都是 外层表达式 = 内层表达式 时，
+ *   把这些条件取出来作为连接键，改写成半连接或反连接。IN 的相关子查询也这样处理。
+ * 连接键两边的类型必须相同，并且是整数、日期或字符串，这样哈希比较与 Value::compare 的结果一致。
+ * 其它子查询仍然在 ComparisonExpr 中执行，结果由 SubqueryExpr 缓存。
+ */
+class SubqueryToJoinRewriter : public RewriteRule
+{
+public:
+  SubqueryToJoinRewriter()          = default;
+  virtual ~SubqueryToJoinRewriter() = default;
+
+  RC rewrite(std::unique_ptr<LogicalOperator> &oper, bool &change_made) override;
+
+private:
+  /**
+   * @brief 尝试把一个条件改写成连接
+   * @param join 能改写时返回连接算子，它只有右表一个子算子
+   */
+  RC try_convert(std::unique_ptr<Expression> &expr, std::unique_ptr<JoinLogicalOperator> &join);
+
+  /**
+   * @brief 把相关子查询谓词中 外层表达式 = 内层表达式 的条件取出来作为连接键
+   * @param plan 子查询投影下面的算子，成功时会删除取出的条件
+   * @return 不能改写时返回 false，此时不会修改 plan
+   */
+  bool extract_correlated_keys(const SubqueryExpr &subquery, std::unique_ptr<LogicalOperator> &plan,
+      std::vector<std::unique_ptr<Expression>> &left_keys, std::vector<std::unique_ptr<Expression>> &right_keys);
+};
@@ -124,6 +124,17 @@ struct OrderBySqlNode
  * 甚至可以包含复杂的表达式。
  */
 
+/**
+ * @brief 描述 limit 子句
+ * @ingroup SQLParser
+ * @details 支持 LIMIT count 和 LIMIT offset, count 两种写法
+ */
+struct LimitSqlNode
+{
+  int limit  = -1;  ///< 最多返回的行数，-1 表示不限制
+  int offset = 0;   ///< 跳过前面的行数
+};
+
 struct SelectSqlNode
 {
   std::vector<std::unique_ptr<Expression>> expressions;  ///< 查询的字段的表达式
@@ -133,6 +144,7 @@ struct SelectSqlNode
   std::vector<ConditionSqlNode>            havings;      ///< having clause
   std::vector<OrderBySqlNode>              order_by;     ///< order by clause
   int                                      limit;        ///< limit clause，-1 表示不限制
+  int                                      offset;       ///< limit clause 中跳过的行数
 };
 
 /**
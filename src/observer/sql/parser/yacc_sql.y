@@ -149,6 +149,7 @@ UnboundAggregateExpr *create_aggregate_expression(AggregateType type,
   RelAttrSqlNode *                           rel_attr;
   RelationSqlNode *                          relation;
   OrderBySqlNode *                           order_by_node;
+  LimitSqlNode *                             limit_node;
   std::vector<OrderBySqlNode> *              order_by_list;
   std::vector<AttrInfoSqlNode> *             attr_infos;
   AttrInfoSqlNode *                          attr_info;
@@ -192,7 +193,7 @@ UnboundAggregateExpr *create_aggregate_expression(AggregateType type,
 %type <condition_list>      where
 %type <condition_list>      condition_list
 %type <condition_list>      having
-%type <number>              limit
+%type <limit_node>          limit
 %type <join_list>           join_list
 %type <string>              storage_format
 %type <relation_list>       rel_list
@@ -855,7 +856,14 @@ select_stmt:        /*  select 语句的语法解析树*/
       }
 
       // limit
-      $$->selection.limit = $10;
+      if ($10 != nullptr) {
+        $$->selection.limit  = $10->limit;
+        $$->selection.offset = $10->offset;
+        delete $10;
+      } else {
+        $$->selection.limit  = -1;
+        $$->selection.offset = 0;
+      }
     }
     ;
 calc_stmt:
@@ -1235,11 +1243,19 @@ order_by_item:
 limit:
     /* empty */
     {
-      $$ = -1;
+      $$ = nullptr;
     }
     | LIMIT NUMBER
     {
-      $$ = $2;
+      $$ = new LimitSqlNode;
+      $$->limit = $2;
+    }
+    | LIMIT NUMBER COMMA NUMBER
+    {
+      /* 与 MySQL 相同，LIMIT offset, count */
+      $$ = new LimitSqlNode;
+      $$->offset = $2;
+      $$->limit  = $4;
     }
     ;
 
@@ -70,6 +70,8 @@ StorageFormat CreateTableStmt::get_storage_format(const char *format_str) {
     format = StorageFormat::ROW_FORMAT;
   } else if (0 == strcasecmp(format_str, "PAX")) {
     format = StorageFormat::PAX_FORMAT;
+  } else if (0 == strcasecmp(format_str, "SLOTTED")) {
+    format = StorageFormat::SLOTTED_FORMAT;
   } else {
     format = StorageFormat::UNKNOWN_FORMAT;
   }
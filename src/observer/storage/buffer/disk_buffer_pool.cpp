@@ -595,14 +595,9 @@ RC DiskBufferPool::recover_page(PageNum page_num)
 
 RC DiskBufferPool::write_page(PageNum page_num, Page &page)
 {
-  scoped_lock lock_guard(wr_lock_);
-  int64_t     offset = ((int64_t)page_num) * sizeof(Page);
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to write page %lld of %d due to failed to seek %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_SEEK;
-  }
-
-  if (writen(file_desc_, &page, sizeof(Page)) != 0) {
+  // 使用 pwrite 写入指定位置，多个线程同时刷页面时不需要互斥地移动文件读写位置
+  int64_t offset = ((int64_t)page_num) * sizeof(Page);
+  if (pwriten(file_desc_, &page, sizeof(Page), offset) != 0) {
     LOG_ERROR("Failed to write page %lld of %d due to %s.", offset, file_desc_, strerror(errno));
     return RC::IOERR_WRITE;
   }
@@ -737,15 +732,8 @@ RC DiskBufferPool::load_page(PageNum page_num, Frame *frame)
     return rc;
   }
 
-  scoped_lock lock_guard(wr_lock_);
-  int64_t          offset = ((int64_t)page_num) * BP_PAGE_SIZE;
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to load page %s:%d, due to failed to lseek:%s.", file_name_.c_str(), page_num, strerror(errno));
-
-    return RC::IOERR_SEEK;
-  }
-
-  int ret = readn(file_desc_, &page, BP_PAGE_SIZE);
+  int64_t offset = ((int64_t)page_num) * BP_PAGE_SIZE;
+  int     ret    = preadn(file_desc_, &page, BP_PAGE_SIZE, offset);
   if (ret != 0) {
     LOG_ERROR("Failed to load page %s, file_desc:%d, page num:%d, due to failed to read data:%s, ret=%d, page count=%d",
               file_name_.c_str(), file_desc_, page_num, strerror(errno), ret, file_header_->allocated_pages);
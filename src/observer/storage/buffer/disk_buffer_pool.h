@@ -273,6 +273,9 @@ public:
 
   const char *filename() const { return file_name_.c_str(); }
 
+  /// 文件中的页面个数，包括第0个页面和已经释放的页面
+  PageNum page_count() const { return file_header_->page_count; }
+
 protected:
   RC allocate_frame(PageNum page_num, Frame **buf);
 
@@ -308,7 +311,6 @@ private:
   string file_name_;  /// 文件名
 
   common::Mutex lock_;
-  common::Mutex wr_lock_;
 
 private:
   friend class BufferPoolIterator;
@@ -8,6 +8,7 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
 #include "storage/common/column.h"
 
@@ -71,6 +72,9 @@ void Column::init(const Value &value)
   own_       = true;
   memcpy(data_, value.data(), attr_len_);
   column_type_ = Type::CONSTANT_COLUMN;
+  if (value.is_null()) {
+    set_null(0);
+  }
 }
 
 void Column::reset()
@@ -84,6 +88,12 @@ void Column::reset()
   own_         = false;
   attr_type_   = AttrType::UNDEFINED;
   attr_len_    = -1;
+  if (column_type_ == Type::DICTIONARY_COLUMN) {
+    column_type_ = Type::NORMAL_COLUMN;
+  }
+  dictionary_      = nullptr;
+  dictionary_size_ = 0;
+  null_bitmap_     = nullptr;
 }
 
 RC Column::append_one(char *data) { return append(data, 1); }
@@ -99,16 +109,81 @@ RC Column::append(char *data, int count)
     return RC::INTERNAL;
   }
 
-  memcpy(data_ + count_ * attr_len_, data, count * attr_len_);
+  memcpy(data_ + count_ * value_size(), data, count * value_size());
   count_ += count;
   return RC::SUCCESS;
 }
 
+RC Column::append_selected(const Column &column, const vector<uint8_t> &select)
+{
+  if (!own_) {
+    LOG_WARN("append data to non-owned column");
+    return RC::INTERNAL;
+  }
+
+  if (count_ == 0) {
+    reset_data();
+    if (column.column_type() == Type::DICTIONARY_COLUMN) {
+      set_dictionary(column.dictionary(), column.dictionary_size());
+    }
+  }
+
+  const bool same_dictionary = column_type_ == Type::DICTIONARY_COLUMN &&
+                               column.column_type() == Type::DICTIONARY_COLUMN &&
+                               dictionary_ == column.dictionary();
+  if (column_type_ == Type::DICTIONARY_COLUMN && !same_dictionary) {
+    LOG_WARN("cannot append values of another dictionary to a dictionary column");
+    return RC::INTERNAL;
+  }
+
+  const int rows = std::min(column.count(), static_cast<int>(select.size()));
+  for (int i = 0; i < rows; i++) {
+    if (select[i] == 0) {
+      continue;
+    }
+    if (count_ >= capacity_) {
+      LOG_WARN("append data to full column");
+      return RC::INTERNAL;
+    }
+    if (column.is_null(i)) {
+      set_null(count_);
+    }
+    if (same_dictionary || column.column_type() == Type::NORMAL_COLUMN) {
+      memcpy(data_ + count_ * value_size(), column.data() + i * value_size(), value_size());
+    } else {
+      Value value = column.get_value(i);
+      memcpy(data_ + count_ * attr_len_, value.data(), attr_len_);
+    }
+    count_++;
+  }
+  return RC::SUCCESS;
+}
+
+void Column::reset_data()
+{
+  count_ = 0;
+  if (column_type_ == Type::DICTIONARY_COLUMN) {
+    column_type_ = Type::NORMAL_COLUMN;
+  }
+  dictionary_      = nullptr;
+  dictionary_size_ = 0;
+  null_bitmap_     = nullptr;
+}
+
 Value Column::get_value(int index) const
 {
   if (index >= count_ || index < 0) {
     return Value();
   }
+  if (is_null(index)) {
+    Value value;
+    value.set_null();
+    return value;
+  }
+  if (column_type_ == Type::DICTIONARY_COLUMN) {
+    const uint8_t code = static_cast<uint8_t>(data_[index]);
+    return Value(attr_type_, const_cast<char *>(&dictionary_[code * attr_len_]), attr_len_);
+  }
   return Value(attr_type_, &data_[index * attr_len_], attr_len_);
 }
 
@@ -127,4 +202,118 @@ void Column::reference(const Column &column)
   this->column_type_ = column.column_type();
   this->attr_type_   = column.attr_type();
   this->attr_len_    = column.attr_len();
-}
\ No newline at end of file
+
+  this->dictionary_      = column.dictionary();
+  this->dictionary_size_ = column.dictionary_size();
+  this->null_bitmap_     = column.null_bitmap();
+}
+
+void Column::reference(char *data, int count)
+{
+  if (data_ != nullptr && own_) {
+    delete[] data_;
+  }
+
+  data_        = data;
+  count_       = count;
+  capacity_    = count;
+  own_         = false;
+  column_type_ = Type::NORMAL_COLUMN;
+
+  dictionary_      = nullptr;
+  dictionary_size_ = 0;
+  null_bitmap_     = nullptr;
+}
+
+void Column::reference_dictionary(char *codes, int count, const char *dictionary, int dictionary_size)
+{
+  reference(codes, count);
+  set_dictionary(dictionary, dictionary_size);
+}
+
+void Column::set_dictionary(const char *dictionary, int dictionary_size)
+{
+  ASSERT(count_ == 0 || !own_, "cannot change the representation of a non-empty column");
+  column_type_     = Type::DICTIONARY_COLUMN;
+  dictionary_      = dictionary;
+  dictionary_size_ = dictionary_size;
+}
+
+char *Column::mutable_null_bitmap(int size)
+{
+  // 第一次标记 null 时才分配位图，引用的位图先拷贝一份再修改
+  const size_t bitmap_size = (std::max({capacity_, count_, size}) + 7) / 8;
+  if (null_bitmap_ == nullptr && !null_buffer_.empty() && null_buffer_.size() >= bitmap_size) {
+    memset(null_buffer_.data(), 0, null_buffer_.size());
+    null_bitmap_ = null_buffer_.data();
+  } else if (null_bitmap_ != null_buffer_.data() || null_buffer_.size() < bitmap_size) {
+    vector<char> buffer(bitmap_size, 0);
+    if (null_bitmap_ != nullptr) {
+      memcpy(buffer.data(), null_bitmap_, std::min(bitmap_size, static_cast<size_t>((count_ + 7) / 8)));
+    }
+    null_buffer_.swap(buffer);
+    null_bitmap_ = null_buffer_.data();
+  }
+  return null_buffer_.data();
+}
+
+void Column::set_nulls(int begin, int end)
+{
+  if (begin >= end) {
+    return;
+  }
+
+  // 中间完整的字节整体填充，两端不完整的字节逐位设置
+  char *bitmap = mutable_null_bitmap(end);
+  int   index  = begin;
+  for (; index < end && index % 8 != 0; index++) {
+    bitmap[index / 8] |= static_cast<char>(1 << (index % 8));
+  }
+  const int full_bytes = (end - index) / 8;
+  memset(bitmap + index / 8, 0xFF, full_bytes);
+  for (index += full_bytes * 8; index < end; index++) {
+    bitmap[index / 8] |= static_cast<char>(1 << (index % 8));
+  }
+}
+
+void Column::merge_nulls(const Column &column)
+{
+  if (!column.has_null()) {
+    return;
+  }
+  if (column.column_type() == Type::CONSTANT_COLUMN) {
+    set_nulls(0, std::max(count_, 1));
+    return;
+  }
+
+  const int   bytes  = (std::min(count_, column.count()) + 7) / 8;
+  char       *bitmap = mutable_null_bitmap(count_);
+  const char *other  = column.null_bitmap();
+  for (int i = 0; i < bytes; i++) {
+    bitmap[i] |= other[i];
+  }
+}
+
+void Column::filter_nulls(vector<uint8_t> &select) const
+{
+  if (!has_null()) {
+    return;
+  }
+  if (column_type_ == Type::CONSTANT_COLUMN) {
+    std::fill(select.begin(), select.end(), 0);
+    return;
+  }
+
+  const int rows  = std::min(count_, static_cast<int>(select.size()));
+  const int bytes = (rows + 7) / 8;
+  for (int i = 0; i < bytes; i++) {
+    uint8_t bits = static_cast<uint8_t>(null_bitmap_[i]);
+    while (bits != 0) {
+      const int row = i * 8 + __builtin_ctz(bits);
+      if (row < rows) {
+        select[row] = 0;
+      }
+      bits &= bits - 1;
+    }
+  }
+}
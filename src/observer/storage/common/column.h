@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <string.h>
 
+#include "common/lang/vector.h"
 #include "storage/field/field_meta.h"
 
 /**
@@ -23,8 +24,9 @@ class Column
 public:
   enum class Type
   {
-    NORMAL_COLUMN,   /// Normal column represents a list of fixed-length values
-    CONSTANT_COLUMN  /// Constant column represents a single value
+    NORMAL_COLUMN,     /// Normal column represents a list of fixed-length values
+    CONSTANT_COLUMN,   /// Constant column represents a single value
+    DICTIONARY_COLUMN  /// Dictionary column stores a one-byte code per value, the values are in the dictionary
   };
 
   Column()               = default;
@@ -52,36 +54,122 @@ public:
   RC append(char *data, int count);
 
   /**
-   * @brief 获取 index 位置的列值
+   * @brief 获取 index 位置的列值，值为 null 时返回 null 的 Value
    */
   Value get_value(int index) const;
 
+  /**
+   * @brief 把 column 中 select 标记的值追加到当前列
+   * @details 当前列为空时使用与 column 相同的表示方式，字典编码的列只拷贝字典编号，
+   * 字典仍然引用 column 的字典。
+   */
+  RC append_selected(const Column &column, const vector<uint8_t> &select);
+
   /**
    * @brief 获取列数据的实际大小（字节）
    */
-  int data_len() const { return count_ * attr_len_; }
+  int data_len() const { return count_ * value_size(); }
 
   char *data() const { return data_; }
 
   /**
    * @brief 重置列数据，但不修改元信息
+   * @details 字典编码的列会恢复成普通的列，字典也属于列数据
    */
-  void reset_data() { count_ = 0; }
+  void reset_data();
 
   /**
    * @brief 引用另一个 Column
    */
   void reference(const Column &column);
 
+  /**
+   * @brief 引用外部的一段定长列数据，不拷贝
+   * @details 列的类型和长度保持不变。引用期间不能追加数据，调用者需要保证使用期间这段内存一直有效。
+   * @param data 第一个列值的起始地址
+   * @param count 列值的个数
+   */
+  void reference(char *data, int count);
+
+  /**
+   * @brief 引用外部的一段字典编码的列数据，不拷贝
+   * @param codes 每个值在字典中的编号，一个字节
+   * @param count 列值的个数
+   * @param dictionary 字典，每一项都是 attr_len 长度的值
+   * @param dictionary_size 字典项的个数
+   */
+  void reference_dictionary(char *codes, int count, const char *dictionary, int dictionary_size);
+
+  /**
+   * @brief 把一个空的列变成字典编码的列，之后追加的数据都是字典编号
+   */
+  void set_dictionary(const char *dictionary, int dictionary_size);
+
+  /**
+   * @brief 列中是否有 null 值
+   * @details 没有 null 值的列不分配 null 位图，处理这样的列时不需要检查 null
+   */
+  bool has_null() const { return null_bitmap_ != nullptr; }
+
+  /**
+   * @brief index 位置的值是否为 null，常量列只看第一个值
+   */
+  bool is_null(int index) const
+  {
+    if (column_type_ == Type::CONSTANT_COLUMN) {
+      index = 0;
+    }
+    return null_bitmap_ != nullptr && (null_bitmap_[index / 8] & (1 << (index % 8))) != 0;
+  }
+
+  /**
+   * @brief null 位图，第 i 位为 1 表示第 i 个值为 null，没有 null 值时为 nullptr
+   * @details 与记录中的 null 位图使用相同的位序，见 common::Bitmap
+   */
+  const char *null_bitmap() const { return null_bitmap_; }
+
+  /**
+   * @brief 把 [begin, end) 位置的值标记为 null
+   * @details null 位图总是由列自己分配，引用外部数据的列也可以标记 null。
+   * 标记 null 的位置上的列值仍然占用空间，但内容没有意义。
+   */
+  void set_nulls(int begin, int end);
+  void set_null(int index) { set_nulls(index, index + 1); }
+
+  /**
+   * @brief 把 column 中的 null 标记合并到当前列，按字节做或运算
+   * @details 用于计算表达式，任何一个参数为 null 时结果都是 null。column 是常量列时按照它的唯一一个值处理
+   */
+  void merge_nulls(const Column &column);
+
+  /**
+   * @brief 把 select 中值为 null 的行清零
+   * @details 比较运算的任何一个参数为 null 时结果都不成立。按字节检查 null 位图，只有不为 0 的字节才需要逐位处理
+   */
+  void filter_nulls(vector<uint8_t> &select) const;
+
+  const char *dictionary() const { return dictionary_; }
+  int         dictionary_size() const { return dictionary_size_; }
+
+  /**
+   * @brief 每个列值在 data 中占用的字节数，字典编码的列是一个字节的编号
+   */
+  int value_size() const { return column_type_ == Type::DICTIONARY_COLUMN ? 1 : attr_len_; }
+
   void set_column_type(Type column_type) { column_type_ = column_type; }
   void set_count(int count) { count_ = count; }
 
   int      count() const { return count_; }
   int      capacity() const { return capacity_; }
+  bool     own() const { return own_; }
   AttrType attr_type() const { return attr_type_; }
   int      attr_len() const { return attr_len_; }
   Type     column_type() const { return column_type_; }
 
+private:
+  /// 列自己的 null 位图，至少可以存放 size 个值的标记
+  char *mutable_null_bitmap(int size);
+
 private:
   static constexpr size_t DEFAULT_CAPACITY = 8192;
 
@@ -98,4 +186,11 @@ private:
   int attr_len_ = -1;
   /// 列类型
   Type column_type_ = Type::NORMAL_COLUMN;
+  /// 字典编码的列引用的字典，data_ 中存放的是字典编号
+  const char *dictionary_      = nullptr;
+  int         dictionary_size_ = 0;
+  /// null 位图，可能指向 null_buffer_，也可能引用其它列的 null 位图
+  const char *null_bitmap_ = nullptr;
+  /// 列自己的 null 位图占用的内存
+  vector<char> null_buffer_;
 };
\ No newline at end of file
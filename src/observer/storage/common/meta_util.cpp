@@ -48,7 +48,22 @@ string table_vector_data_file(const char *base_dir, const char *table_name)
   return filesystem::path(base_dir) / (string(table_name) + TABLE_VECTOR_DATA_SUFFIX);
 }
 
+string table_zone_map_file(const char *base_dir, const char *table_name)
+{
+  return filesystem::path(base_dir) / (string(table_name) + TABLE_ZONE_MAP_SUFFIX);
+}
+
+string table_fsm_file(const char *base_dir, const char *table_name)
+{
+  return filesystem::path(base_dir) / (string(table_name) + TABLE_FSM_SUFFIX);
+}
+
 string table_vector_index_file(const char *base_dir, const char *table_name, const char *vector_index_name)
 {
   return filesystem::path(base_dir) / (string(table_name) + "-" + vector_index_name + TABLE_VECTOR_INDEX_SUFFIX);
-}
\ No newline at end of file
+}
+
+string table_text_fsm_file(const char *base_dir, const char *table_name)
+{
+  return filesystem::path(base_dir) / (string(table_name) + TABLE_TEXT_FSM_SUFFIX);
+}
@@ -23,6 +23,9 @@ static constexpr const char *TABLE_INDEX_SUFFIX      = ".index";
 static constexpr const char *TABLE_TEXT_DATA_SUFFIX   = ".textdata";
 static constexpr const char *TABLE_VECTOR_DATA_SUFFIX = ".vectordata";
 static constexpr const char *TABLE_VECTOR_INDEX_SUFFIX = ".vectorindex";
+static constexpr const char *TABLE_ZONE_MAP_SUFFIX     = ".zonemap";
+static constexpr const char *TABLE_FSM_SUFFIX          = ".fsm";
+static constexpr const char *TABLE_TEXT_FSM_SUFFIX     = ".textfsm";
 
 string db_meta_file(const char *base_dir, const char *db_name);
 string table_meta_file(const char *base_dir, const char *table_name);
@@ -30,4 +33,7 @@ string table_data_file(const char *base_dir, const char *table_name);
 string table_index_file(const char *base_dir, const char *table_name, const char *index_name);
 string table_vector_index_file(const char *base_dir, const char *table_name, const char *vector_index_name);
 string table_text_data_file(const char *base_dir, const char *table_name);
-string table_vector_data_file(const char *base_dir, const char *table_name);
\ No newline at end of file
+string table_vector_data_file(const char *base_dir, const char *table_name);
+string table_zone_map_file(const char *base_dir, const char *table_name);
+string table_fsm_file(const char *base_dir, const char *table_name);
+string table_text_fsm_file(const char *base_dir, const char *table_name);
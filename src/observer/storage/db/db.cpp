@@ -35,6 +35,10 @@ using namespace common;
 
 Db::~Db()
 {
+  if (trx_kit_) {
+    trx_kit_->stop_background_tasks();
+  }
+
   for (auto &iter : opened_tables_) {
     delete iter.second;
   }
@@ -140,6 +144,12 @@ RC Db::init(const char *name, const char *dbpath, const char *trx_kit_name, cons
     return rc;
   }
 
+  rc = trx_kit_->start_background_tasks(*this);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to start trx background tasks. dbpath=%s, rc=%s", dbpath, strrc(rc));
+    return rc;
+  }
+
   return rc;
 }
 
@@ -247,6 +257,15 @@ RC Db::open_all_tables()
     LOG_INFO("Open table: %s, file: %s", table->name(), filename.c_str());
   }
 
+  // 所有表的文件都打开后，新创建的文件才不会与已有的文件使用相同的 buffer pool 编号
+  for (auto &[table_name, table] : opened_tables_) {
+    rc = table->init_free_space_map();
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to init free space map. table=%s, rc=%s", table_name.c_str(), strrc(rc));
+      return rc;
+    }
+  }
+
   LOG_INFO("All table have been opened. num=%d", opened_tables_.size());
   return rc;
 }
@@ -339,7 +358,13 @@ void Db::all_tables(vector<string> &table_names) const
 
 RC Db::sync()
 {
-  RC rc = RC::SUCCESS;
+  // 检查点之前的事务日志不会再重放，先让事务模块把依赖日志的状态落到数据中
+  RC rc = trx_kit_->checkpoint(*this);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to checkpoint trx kit. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    return rc;
+  }
+
   // 调用所有表的sync函数刷新数据到磁盘
   for (const auto &table_pair : opened_tables_) {
     Table *table = table_pair.second;
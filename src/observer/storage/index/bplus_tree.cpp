@@ -2112,7 +2112,12 @@ RC BplusTreeScanner::next_entry(RID &rid)
 
 RC BplusTreeScanner::close()
 {
-  inited_ = false;
+  // 释放扫描过程中持有的页面和锁，之后可以重新 open 另一个范围
+  mtr_.latch_memo().release();
+  current_frame_ = nullptr;
+  right_key_     = nullptr;
+  iter_index_    = -1;
+  inited_        = false;
   LOG_TRACE("bplus tree scanner closed");
   return RC::SUCCESS;
 }
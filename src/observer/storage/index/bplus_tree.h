@@ -741,7 +741,7 @@ public:
 
   /**
    * @brief 关闭当前扫描器
-   * @details 可以不调用，在析构函数时会自动执行
+   * @details 可以不调用，在析构函数时会自动执行。关闭后可以再次调用 open 扫描新的范围，复用同一个扫描器
    */
   RC close();
 
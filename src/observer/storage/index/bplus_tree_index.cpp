@@ -160,6 +160,13 @@ RC BplusTreeIndexScanner::open(const std::vector<IndexUserKey> &left_keys, bool
 
 RC BplusTreeIndexScanner::next_entry(RID *rid) { return tree_scanner_.next_entry(*rid); }
 
+RC BplusTreeIndexScanner::rescan(const std::vector<IndexUserKey> &left_keys, bool left_inclusive,
+    const std::vector<IndexUserKey> &right_keys, bool right_inclusive)
+{
+  tree_scanner_.close();
+  return tree_scanner_.open(left_keys, left_inclusive, right_keys, right_inclusive);
+}
+
 RC BplusTreeIndexScanner::destroy()
 {
   delete this;
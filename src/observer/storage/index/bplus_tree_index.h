@@ -66,6 +66,8 @@ public:
 
   RC next_entry(RID *rid) override;
   RC destroy() override;
+  RC rescan(const std::vector<IndexUserKey> &left_keys, bool left_inclusive,
+      const std::vector<IndexUserKey> &right_keys, bool right_inclusive) override;
 
   RC open(const std::vector<IndexUserKey> &left_keys, bool left_inclusive, const std::vector<IndexUserKey> &right_keys,
       bool right_inclusive);
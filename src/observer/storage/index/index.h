@@ -108,6 +108,14 @@ public:
    */
   virtual RC next_entry(RID *rid) = 0;
   virtual RC destroy()            = 0;
+
+  /**
+   * @brief 放弃当前的扫描，重新扫描另一个范围
+   * @details 参数与 Index::create_scanner 相同。需要反复扫描同一个索引时（比如 index nested loop join
+   * 按外表的每一行查找内表），复用扫描器可以避免每次都重新创建
+   */
+  virtual RC rescan(const std::vector<IndexUserKey> &left_keys, bool left_inclusive,
+      const std::vector<IndexUserKey> &right_keys, bool right_inclusive) = 0;
 };
 
 class IndexUserKey
@@ -0,0 +1,331 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/record/free_space_map.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/functional.h"
+#include "common/lang/string.h"
+#include "common/lang/thread.h"
+#include "common/log/log.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/frame.h"
+
+uint8_t FreeSpaceMap::category_of(int free_bytes)
+{
+  if (free_bytes <= 0) {
+    return FULL;
+  }
+  return static_cast<uint8_t>(std::min(free_bytes, BP_PAGE_DATA_SIZE) * MAX_CATEGORY / BP_PAGE_DATA_SIZE);
+}
+
+RC FreeSpaceMap::init(DiskBufferPool &buffer_pool, PageNum data_page_count)
+{
+  buffer_pool_ = &buffer_pool;
+
+  RC     rc         = RC::SUCCESS;
+  Frame *root_frame = nullptr;
+  if (buffer_pool.page_count() <= ROOT_PAGE) {
+    // 新文件，分配根页面。新分配的页面内容都是0，表示没有叶子页面
+    rc = buffer_pool.allocate_page(&root_frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate root page of free space map. file=%s, rc=%s", buffer_pool.filename(), strrc(rc));
+      return rc;
+    }
+    if (root_frame->page_num() != ROOT_PAGE) {
+      LOG_ERROR("unexpected root page of free space map. file=%s, page num=%d",
+                buffer_pool.filename(), root_frame->page_num());
+      root_frame->unpin();
+      return RC::INTERNAL;
+    }
+    root_frame->mark_dirty();
+  } else {
+    rc = get_page(ROOT_PAGE, root_frame);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  // 根页面与叶子页面的修改都没有日志，异常退出后可能对不上，这时重新开始记录
+  FsmRootPage *root           = reinterpret_cast<FsmRootPage *>(root_frame->data());
+  const int    leaf_page_num  = buffer_pool.page_count() - leaf_page(0);
+  if (root->leaf_num < 0 || root->leaf_num > std::min(leaf_page_num, MAX_LEAF_NUM) || root->page_count < 0 ||
+      root->page_count > root->leaf_num * LEAF_SLOTS) {
+    LOG_WARN("invalid free space map, rebuild it. file=%s, leaf num=%d, page count=%d",
+             buffer_pool.filename(), root->leaf_num, root->page_count);
+    memset(root_frame->data(), 0, BP_PAGE_DATA_SIZE);
+    root_frame->mark_dirty();
+  }
+
+  const PageNum recorded_page_count = std::max(root->page_count, ROOT_PAGE);
+  root_frame->unpin();
+
+  // 没有记录过的页面可能是异常退出前新分配的，也可能是这个表以前没有空闲空间映射，都当作有空闲空间
+  for (PageNum page_num = recorded_page_count; page_num < data_page_count; page_num++) {
+    rc = update(page_num, MAX_CATEGORY);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to init free space of page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+  }
+
+  LOG_INFO("open free space map done. file=%s, recorded page count=%d, data page count=%d",
+           buffer_pool.filename(), recorded_page_count, data_page_count);
+  return RC::SUCCESS;
+}
+
+void FreeSpaceMap::close() { buffer_pool_ = nullptr; }
+
+RC FreeSpaceMap::get_page(PageNum fsm_page_num, Frame *&frame)
+{
+  if (buffer_pool_ == nullptr) {
+    LOG_WARN("free space map is not opened");
+    return RC::INTERNAL;
+  }
+
+  RC rc = buffer_pool_->get_this_page(fsm_page_num, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get page of free space map. file=%s, page num=%d, rc=%s",
+             buffer_pool_->filename(), fsm_page_num, strrc(rc));
+  }
+  return rc;
+}
+
+RC FreeSpaceMap::extend(PageNum page_num)
+{
+  // 调用者持有根页面的写锁。新的叶子页面在 leaf_num 增加之前不会被其它线程访问，不需要加锁
+  Frame       *root_frame = nullptr;
+  RC           rc         = get_page(ROOT_PAGE, root_frame);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  FsmRootPage *root = reinterpret_cast<FsmRootPage *>(root_frame->data());
+  for (int leaf = root->leaf_num; leaf <= page_num / LEAF_SLOTS; leaf++) {
+    if (leaf >= MAX_LEAF_NUM) {
+      LOG_WARN("free space map is full. file=%s, page num=%d", buffer_pool_->filename(), page_num);
+      rc = RC::BUFFERPOOL_NOBUF;
+      break;
+    }
+
+    // 异常退出前可能已经分配了叶子页面但是没有记录到根页面上，这时直接复用
+    Frame *leaf_frame = nullptr;
+    if (leaf_page(leaf) < buffer_pool_->page_count()) {
+      rc = get_page(leaf_page(leaf), leaf_frame);
+    } else {
+      rc = buffer_pool_->allocate_page(&leaf_frame);
+      if (OB_SUCC(rc) && leaf_frame->page_num() != leaf_page(leaf)) {
+        LOG_ERROR("unexpected leaf page of free space map. file=%s, expect=%d, page num=%d",
+                  buffer_pool_->filename(), leaf_page(leaf), leaf_frame->page_num());
+        leaf_frame->unpin();
+        rc = RC::INTERNAL;
+      }
+    }
+    if (OB_FAIL(rc)) {
+      break;
+    }
+
+    memset(leaf_frame->data(), 0, BP_PAGE_DATA_SIZE);
+    leaf_frame->mark_dirty();
+    leaf_frame->unpin();
+
+    root->leaf_max[leaf] = FULL;
+    root->leaf_num       = leaf + 1;
+    root_frame->mark_dirty();
+  }
+
+  root_frame->unpin();
+  return rc;
+}
+
+RC FreeSpaceMap::update(PageNum page_num, uint8_t category)
+{
+  Frame *root_frame = nullptr;
+  RC     rc         = get_page(ROOT_PAGE, root_frame);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  FsmRootPage *root = reinterpret_cast<FsmRootPage *>(root_frame->data());
+  const int    leaf = page_num / LEAF_SLOTS;
+
+  root_frame->read_latch();
+  bool recorded = page_num < root->page_count;
+  root_frame->read_unlatch();
+
+  if (!recorded) {
+    root_frame->write_latch();
+    rc = extend(page_num);
+    if (OB_SUCC(rc) && page_num >= root->page_count) {
+      root->page_count = page_num + 1;
+      root_frame->mark_dirty();
+    }
+    root_frame->write_unlatch();
+    if (OB_FAIL(rc)) {
+      root_frame->unpin();
+      return rc;
+    }
+  }
+
+  Frame *leaf_frame = nullptr;
+  rc                = get_page(leaf_page(leaf), leaf_frame);
+  if (OB_FAIL(rc)) {
+    root_frame->unpin();
+    return rc;
+  }
+
+  leaf_frame->write_latch();
+  uint8_t &slot = reinterpret_cast<uint8_t *>(leaf_frame->data())[page_num % LEAF_SLOTS];
+  if (slot != category) {
+    slot = category;
+    leaf_frame->mark_dirty();
+  }
+
+  // 持有叶子页面的写锁，其它线程不会降低根页面上的上界，只可能提高
+  root_frame->read_latch();
+  bool raise = category > root->leaf_max[leaf];
+  root_frame->read_unlatch();
+  if (raise) {
+    root_frame->write_latch();
+    if (category > root->leaf_max[leaf]) {
+      root->leaf_max[leaf] = category;
+      root_frame->mark_dirty();
+    }
+    root_frame->write_unlatch();
+  }
+  leaf_frame->write_unlatch();
+
+  leaf_frame->unpin();
+  root_frame->unpin();
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::get(PageNum page_num, uint8_t &category)
+{
+  category = FULL;
+
+  Frame *root_frame = nullptr;
+  RC     rc         = get_page(ROOT_PAGE, root_frame);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  root_frame->read_latch();
+  bool recorded = page_num < reinterpret_cast<FsmRootPage *>(root_frame->data())->page_count;
+  root_frame->read_unlatch();
+  root_frame->unpin();
+  if (!recorded) {
+    return RC::SUCCESS;
+  }
+
+  Frame *leaf_frame = nullptr;
+  rc                = get_page(leaf_page(page_num / LEAF_SLOTS), leaf_frame);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  leaf_frame->read_latch();
+  category = reinterpret_cast<const uint8_t *>(leaf_frame->data())[page_num % LEAF_SLOTS];
+  leaf_frame->read_unlatch();
+  leaf_frame->unpin();
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::search(uint8_t min_category, PageNum &page_num)
+{
+  const size_t thread_hash = hash<thread::id>()(std::this_thread::get_id());
+  return search(min_category, static_cast<PageNum>(thread_hash % BPFileHeader::MAX_PAGE_NUM), page_num);
+}
+
+RC FreeSpaceMap::search(uint8_t min_category, PageNum start, PageNum &page_num)
+{
+  Frame *root_frame = nullptr;
+  RC     rc         = get_page(ROOT_PAGE, root_frame);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  const FsmRootPage *root = reinterpret_cast<const FsmRootPage *>(root_frame->data());
+
+  root_frame->read_latch();
+  const PageNum page_count = root->page_count;
+  root_frame->read_unlatch();
+
+  if (page_count <= 0) {
+    root_frame->unpin();
+    return RC::RECORD_EOF;
+  }
+
+  // 从起始位置循环查找所有记录过的页面，最后回到起始叶子页面的前半部分
+  start                = start % page_count;
+  const int leaf_num   = (page_count + LEAF_SLOTS - 1) / LEAF_SLOTS;
+  const int start_leaf = start / LEAF_SLOTS;
+  const int start_slot = start % LEAF_SLOTS;
+
+  rc = RC::RECORD_EOF;
+  for (int i = 0; i <= leaf_num && rc == RC::RECORD_EOF; i++) {
+    const int leaf  = (start_leaf + i) % leaf_num;
+    const int begin = (i == 0) ? start_slot : 0;
+    const int end   = (i == leaf_num) ? start_slot : LEAF_SLOTS;
+    if (begin >= end) {
+      continue;
+    }
+
+    root_frame->read_latch();
+    bool may_have = root->leaf_max[leaf] >= min_category;
+    root_frame->read_unlatch();
+    if (may_have) {
+      rc = search_leaf(leaf, begin, end, min_category, page_num);
+    }
+  }
+
+  root_frame->unpin();
+  return rc;
+}
+
+RC FreeSpaceMap::search_leaf(int leaf, int begin, int end, uint8_t min_category, PageNum &page_num)
+{
+  Frame *leaf_frame = nullptr;
+  RC     rc         = get_page(leaf_page(leaf), leaf_frame);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = RC::RECORD_EOF;
+  leaf_frame->read_latch();
+  const uint8_t *slots        = reinterpret_cast<const uint8_t *>(leaf_frame->data());
+  uint8_t        max_category = FULL;
+  for (int slot = begin; slot < end; slot++) {
+    if (slots[slot] >= min_category) {
+      page_num = leaf * LEAF_SLOTS + slot;
+      rc       = RC::SUCCESS;
+      break;
+    }
+    max_category = std::max(max_category, slots[slot]);
+  }
+
+  // 根页面上的上界偏大，持有叶子页面的读锁修正，这期间不会有其它线程修改这个叶子页面
+  if (rc == RC::RECORD_EOF && begin == 0 && end == LEAF_SLOTS) {
+    Frame *root_frame = nullptr;
+    if (OB_SUCC(get_page(ROOT_PAGE, root_frame))) {
+      FsmRootPage *root = reinterpret_cast<FsmRootPage *>(root_frame->data());
+      root_frame->write_latch();
+      if (root->leaf_max[leaf] > max_category) {
+        root->leaf_max[leaf] = max_category;
+        root_frame->mark_dirty();
+      }
+      root_frame->write_unlatch();
+      root_frame->unpin();
+    }
+  }
+
+  leaf_frame->read_unlatch();
+  leaf_frame->unpin();
+  return rc;
+}
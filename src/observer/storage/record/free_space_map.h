@@ -0,0 +1,114 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/rc.h"
+#include "common/types.h"
+#include "storage/buffer/page.h"
+
+class DiskBufferPool;
+class Frame;
+
+/**
+ * @brief 空闲空间映射的根页面
+ * @ingroup RecordManager
+ * @details 根页面后面跟着每个叶子页面中最大分类的上界，查找时先在根页面上过滤掉没有足够空间的叶子页面。
+ */
+struct FsmRootPage
+{
+  int32_t leaf_num;    ///< 已经分配的叶子页面个数
+  PageNum page_count;  ///< 记录过的数据页面数，页面号不小于它的数据页面都还没有记录
+  uint8_t leaf_max[0];  ///< 每个叶子页面中最大的分类，只会大于等于真实值
+};
+
+/**
+ * @brief 记录文件的空闲空间映射(free space map)
+ * @ingroup RecordManager
+ * @details 记录每个数据页面还有多少空闲空间，插入记录时用来查找有足够空间的页面。
+ * 空闲空间按照页面大小等分成256个分类，每个数据页面用一个字节记录分类，0表示页面已经满了。
+ * 这些信息保存在单独的文件中，由自己的 DiskBufferPool 管理：
+ * 第1个页面是根页面 FsmRootPage，后面都是叶子页面，第i个叶子页面记录数据页面
+ * [i * LEAF_SLOTS, (i + 1) * LEAF_SLOTS) 的分类。
+ *
+ * 打开表时只需要读取根页面，不需要遍历数据文件。查找时只对访问到的页面加读锁，
+ * 修改时只对一个叶子页面加写锁，不同的线程从不同的位置开始查找，所以并发插入的线程会分散到不同的页面上。
+ * 加锁的顺序总是先叶子页面后根页面，查找时不会同时持有根页面和叶子页面的锁去等待另一个锁。
+ *
+ * 空闲空间映射只是一个提示，修改不记录日志：
+ * - 记录的空间比实际的多时，插入记录时会发现页面是满的，这时修正分类后重新查找；
+ * - 记录的空间比实际的少时，只是浪费了一些空间，删除记录、回收旧版本时会修正；
+ * - 数据库异常退出后，没有记录过的数据页面在打开时都当作有空闲空间。
+ */
+class FreeSpaceMap
+{
+public:
+  static constexpr uint8_t FULL         = 0;
+  static constexpr uint8_t MAX_CATEGORY = 255;
+
+  static constexpr PageNum ROOT_PAGE     = 1;
+  static constexpr int     LEAF_SLOTS    = BP_PAGE_DATA_SIZE;
+  static constexpr int     MAX_LEAF_NUM  = BP_PAGE_DATA_SIZE - sizeof(FsmRootPage);
+
+public:
+  FreeSpaceMap()  = default;
+  ~FreeSpaceMap() = default;
+
+  /**
+   * @brief 根据空闲的字节数计算分类，向下取整
+   */
+  static uint8_t category_of(int free_bytes);
+
+  /**
+   * @brief 打开空闲空间映射
+   * @param buffer_pool     空闲空间映射自己的文件
+   * @param data_page_count 数据文件的页面数，还没有记录过的数据页面当作有空闲空间
+   */
+  RC init(DiskBufferPool &buffer_pool, PageNum data_page_count);
+  void close();
+
+  /**
+   * @brief 修改数据页面的分类
+   * @details 调用者通常持有数据页面的写锁，这样分类与页面内容一起修改
+   */
+  RC update(PageNum page_num, uint8_t category);
+
+  RC get(PageNum page_num, uint8_t &category);
+
+  /**
+   * @brief 查找一个分类不小于 min_category 的数据页面
+   * @details 从当前线程对应的位置开始查找，找不到时返回 RC::RECORD_EOF
+   */
+  RC search(uint8_t min_category, PageNum &page_num);
+
+  /**
+   * @brief 从指定的数据页面开始循环查找
+   */
+  RC search(uint8_t min_category, PageNum start, PageNum &page_num);
+
+private:
+  RC get_page(PageNum fsm_page_num, Frame *&frame);
+
+  /**
+   * @brief 分配叶子页面，直到能够记录指定的数据页面
+   */
+  RC extend(PageNum page_num);
+
+  /**
+   * @brief 在叶子页面中的 [begin, end) 范围内查找
+   * @details 查找了整个叶子页面却没有找到时，修正根页面上记录的上界
+   */
+  RC search_leaf(int leaf, int begin, int end, uint8_t min_category, PageNum &page_num);
+
+  static PageNum leaf_page(int leaf) { return ROOT_PAGE + 1 + leaf; }
+
+private:
+  DiskBufferPool *buffer_pool_ = nullptr;
+};
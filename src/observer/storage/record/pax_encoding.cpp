@@ -0,0 +1,252 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/record/pax_encoding.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+
+using namespace common;
+
+int PaxColumnIndex::bytes_per_record() const
+{
+  switch (encoding) {
+    case PaxEncoding::DICTIONARY: return sizeof(uint8_t);
+    case PaxEncoding::RLE: return 0;
+    default: return field_len;
+  }
+}
+
+int PaxColumnIndex::fixed_size() const
+{
+  switch (encoding) {
+    case PaxEncoding::DICTIONARY: return sizeof(int32_t) + entry_capacity * field_len;
+    case PaxEncoding::RLE: return sizeof(int32_t) + entry_capacity * (sizeof(uint16_t) + field_len);
+    default: return 0;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+PaxDictionary::PaxDictionary(char *area, const PaxColumnIndex &index)
+    : entry_num_(reinterpret_cast<int32_t *>(area)),
+      entries_(area + sizeof(int32_t)),
+      codes_(entries_ + index.entry_capacity * index.field_len),
+      field_len_(index.field_len),
+      entry_capacity_(index.entry_capacity)
+{}
+
+int PaxDictionary::find(const char *value) const
+{
+  const int entry_num = *entry_num_;
+  for (int i = 0; i < entry_num; i++) {
+    if (memcmp(entries_ + i * field_len_, value, field_len_) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void PaxDictionary::set(SlotNum slot_num, const char *value)
+{
+  int code = find(value);
+  if (code < 0) {
+    code = (*entry_num_)++;
+    memcpy(entries_ + code * field_len_, value, field_len_);
+  }
+  codes_[slot_num] = static_cast<char>(code);
+}
+
+void PaxDictionary::shrink(Bitmap &bitmap, int record_capacity)
+{
+  int new_codes[MAX_ENTRY_NUM];
+  std::fill(std::begin(new_codes), std::end(new_codes), -1);
+  for (int slot = bitmap.next_setted_bit(0); slot != -1; slot = bitmap.next_setted_bit(slot + 1)) {
+    new_codes[static_cast<uint8_t>(codes_[slot])] = 0;
+  }
+
+  // 新的编号按照原来的顺序分配，字典项只会往前移动
+  int entry_num = 0;
+  for (int code = 0; code < *entry_num_; code++) {
+    if (new_codes[code] < 0) {
+      continue;
+    }
+    if (entry_num != code) {
+      memcpy(entries_ + entry_num * field_len_, entries_ + code * field_len_, field_len_);
+    }
+    new_codes[code] = entry_num++;
+  }
+  *entry_num_ = entry_num;
+
+  for (int slot = 0; slot < record_capacity; slot++) {
+    const int new_code = new_codes[static_cast<uint8_t>(codes_[slot])];
+    codes_[slot]       = static_cast<char>(new_code < 0 ? 0 : new_code);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+PaxRunLength::PaxRunLength(char *area, const PaxColumnIndex &index)
+    : run_num_(reinterpret_cast<int32_t *>(area)),
+      ends_(reinterpret_cast<uint16_t *>(area + sizeof(int32_t))),
+      values_(area + sizeof(int32_t) + index.entry_capacity * sizeof(uint16_t)),
+      field_len_(index.field_len),
+      entry_capacity_(index.entry_capacity)
+{}
+
+int PaxRunLength::find_run(SlotNum slot_num) const
+{
+  return static_cast<int>(std::upper_bound(ends_, ends_ + *run_num_, slot_num) - ends_);
+}
+
+bool PaxRunLength::equal(int run, const char *value) const
+{
+  return memcmp(this->value(run), value, field_len_) == 0;
+}
+
+int PaxRunLength::new_runs(SlotNum slot_num, const char *value) const
+{
+  const int run_num = *run_num_;
+  if (run_num == 0) {
+    return 1;
+  }
+
+  const int run = find_run(slot_num);
+  if (run == run_num) {
+    return equal(run_num - 1, value) ? 0 : 1;
+  }
+  if (equal(run, value)) {
+    return 0;
+  }
+
+  const SlotNum begin = run_begin(run);
+  const SlotNum end   = ends_[run];
+  if (end - begin == 1) {
+    return 0;
+  }
+  if (slot_num == begin) {
+    return (run > 0 && equal(run - 1, value)) ? 0 : 1;
+  }
+  if (slot_num == end - 1) {
+    return (run + 1 < run_num && equal(run + 1, value)) ? 0 : 1;
+  }
+  return 2;
+}
+
+void PaxRunLength::set(SlotNum slot_num, const char *value)
+{
+  const int run_num = *run_num_;
+  if (run_num == 0) {
+    insert_run(0, slot_num + 1, value);
+    return;
+  }
+
+  // 写入还没有覆盖到的槽位，中间跳过的槽位都没有记录，合并到前一个游程中
+  int run = find_run(slot_num);
+  if (run == run_num) {
+    if (equal(run_num - 1, value)) {
+      ends_[run_num - 1] = slot_num + 1;
+    } else {
+      insert_run(run_num, slot_num + 1, value);
+    }
+    return;
+  }
+
+  if (equal(run, value)) {
+    return;
+  }
+
+  const SlotNum begin = run_begin(run);
+  const SlotNum end   = ends_[run];
+  if (end - begin == 1) {
+    memcpy(this->value(run), value, field_len_);
+    if (run > 0 && equal(run - 1, value)) {
+      remove_run(run - 1);
+      run--;
+    }
+    if (run + 1 < *run_num_ && equal(run + 1, value)) {
+      remove_run(run);
+    }
+  } else if (slot_num == begin) {
+    if (run > 0 && equal(run - 1, value)) {
+      ends_[run - 1]++;
+    } else {
+      insert_run(run, slot_num + 1, value);
+    }
+  } else if (slot_num == end - 1) {
+    ends_[run]--;
+    if (run + 1 < run_num && equal(run + 1, value)) {
+      // 后一个游程的开始位置就是当前游程的结束位置，已经向前扩展了
+    } else {
+      insert_run(run + 1, end, value);
+    }
+  } else {
+    vector<char> old_value(this->value(run), this->value(run) + field_len_);
+    ends_[run] = slot_num;
+    insert_run(run + 1, slot_num + 1, value);
+    insert_run(run + 2, end, old_value.data());
+  }
+}
+
+void PaxRunLength::decode(SlotNum begin, SlotNum end, char *out) const
+{
+  int run = find_run(begin);
+  for (SlotNum slot_num = begin; slot_num < end; run++) {
+    if (run >= *run_num_) {
+      memset(out, 0, (end - slot_num) * field_len_);
+      break;
+    }
+
+    const SlotNum run_end = std::min<SlotNum>(ends_[run], end);
+    const char   *value   = this->value(run);
+    for (; slot_num < run_end; slot_num++, out += field_len_) {
+      memcpy(out, value, field_len_);
+    }
+  }
+}
+
+void PaxRunLength::shrink(Bitmap &bitmap, int record_capacity)
+{
+  vector<uint16_t> ends;
+  vector<char>     values;
+  for (int slot = bitmap.next_setted_bit(0); slot != -1; slot = bitmap.next_setted_bit(slot + 1)) {
+    const char *value = get(slot);
+    if (!ends.empty() && memcmp(values.data() + (ends.size() - 1) * field_len_, value, field_len_) == 0) {
+      ends.back() = slot + 1;
+    } else {
+      ends.push_back(slot + 1);
+      values.insert(values.end(), value, value + field_len_);
+    }
+  }
+
+  *run_num_ = static_cast<int32_t>(ends.size());
+  if (!ends.empty()) {
+    memcpy(ends_, ends.data(), ends.size() * sizeof(uint16_t));
+    memcpy(values_, values.data(), values.size());
+  }
+}
+
+void PaxRunLength::insert_run(int run, SlotNum end, const char *value)
+{
+  const int run_num = *run_num_;
+  memmove(ends_ + run + 1, ends_ + run, (run_num - run) * sizeof(uint16_t));
+  memmove(this->value(run + 1), this->value(run), (run_num - run) * field_len_);
+  ends_[run] = static_cast<uint16_t>(end);
+  memcpy(this->value(run), value, field_len_);
+  (*run_num_)++;
+}
+
+void PaxRunLength::remove_run(int run)
+{
+  const int run_num = *run_num_;
+  memmove(ends_ + run, ends_ + run + 1, (run_num - run - 1) * sizeof(uint16_t));
+  memmove(this->value(run), this->value(run + 1), (run_num - run - 1) * field_len_);
+  (*run_num_)--;
+}
@@ -0,0 +1,166 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/bitmap.h"
+#include "common/types.h"
+
+/**
+ * @brief PAX 页面中列数据的编码方式
+ * @ingroup RecordManager
+ */
+enum class PaxEncoding : int32_t
+{
+  PLAIN = 0,   ///< 不编码，每个槽位存放一个定长的值
+  DICTIONARY,  ///< 字典编码，页面内的字典加上每个槽位一个字节的编号
+  RLE,         ///< 游程编码(run-length encoding)，连续相同的值只存放一次
+};
+
+/**
+ * @brief PAX 页面中一列的描述信息，所有列的描述信息组成 column index
+ * @ingroup RecordManager
+ * @details 一列占用的空间分成两部分，一部分与记录数有关，一部分是固定的（字典、游程）。
+ */
+struct PaxColumnIndex
+{
+  int32_t     end_offset;      ///< 列数据在数据区中的结束位置，上一列的结束位置就是这一列的开始位置
+  int32_t     record_offset;   ///< 字段在记录中的偏移量
+  int32_t     field_len;       ///< 字段长度
+  PaxEncoding encoding;        ///< 编码方式
+  int32_t     entry_capacity;  ///< 最多可以存放的字典项或者游程个数，不编码时为0
+
+  /// 每条记录占用的空间
+  int bytes_per_record() const;
+  /// 与记录数无关的固定空间
+  int fixed_size() const;
+  /// 存放 record_capacity 条记录时这一列占用的空间
+  int area_size(int record_capacity) const { return fixed_size() + bytes_per_record() * record_capacity; }
+};
+
+/**
+ * @brief 页面上一个字典编码的列
+ * @ingroup RecordManager
+ * @details 列数据的组织：
+ * @code
+ * | entry_num | entry_capacity 个字典项 | record_capacity 个字节的编号 |
+ * @endcode
+ * 字典项只会追加，删除或者更新记录后不再使用的字典项不会立即清理，字典满了以后再调用 shrink 清理。
+ */
+class PaxDictionary
+{
+public:
+  static constexpr int MAX_ENTRY_NUM = 256;
+
+  PaxDictionary(char *area, const PaxColumnIndex &index);
+
+  void init() { *entry_num_ = 0; }
+
+  int         entry_num() const { return *entry_num_; }
+  const char *entries() const { return entries_; }
+  char       *codes() const { return codes_; }
+
+  const char *get(SlotNum slot_num) const
+  {
+    return entries_ + static_cast<uint8_t>(codes_[slot_num]) * field_len_;
+  }
+
+  /**
+   * @brief 值在字典中的编号，不存在时返回 -1
+   */
+  int find(const char *value) const;
+
+  bool can_set(const char *value) const { return entry_num() < entry_capacity_ || find(value) >= 0; }
+
+  /**
+   * @brief 写入一个值，调用前需要用 can_set 检查
+   */
+  void set(SlotNum slot_num, const char *value);
+
+  /**
+   * @brief 去掉有效记录没有用到的字典项，重新编号
+   */
+  void shrink(common::Bitmap &bitmap, int record_capacity);
+
+private:
+  int32_t *entry_num_      = nullptr;
+  char    *entries_        = nullptr;
+  char    *codes_          = nullptr;
+  int      field_len_      = 0;
+  int      entry_capacity_ = 0;
+};
+
+/**
+ * @brief 页面上一个游程编码的列
+ * @ingroup RecordManager
+ * @details 列数据的组织：
+ * @code
+ * | run_num | entry_capacity 个游程的结束槽位(uint16_t) | entry_capacity 个值 |
+ * @endcode
+ * 第 i 个游程覆盖槽位 [ends[i-1], ends[i])，最后一个游程之后的槽位还没有写过。
+ * 没有记录的槽位可以是任意值，所以写入新的槽位时会尽量合并到前一个游程中。
+ * 在游程中间修改一个值会把游程拆开，游程满了以后再调用 shrink 按照有效记录重新合并。
+ */
+class PaxRunLength
+{
+public:
+  PaxRunLength(char *area, const PaxColumnIndex &index);
+
+  void init() { *run_num_ = 0; }
+
+  int run_num() const { return *run_num_; }
+
+  const char *get(SlotNum slot_num) const { return value(find_run(slot_num)); }
+
+  bool can_set(SlotNum slot_num, const char *value) const
+  {
+    return run_num() + new_runs(slot_num, value) <= entry_capacity_;
+  }
+
+  /**
+   * @brief 写入一个值，调用前需要用 can_set 检查
+   */
+  void set(SlotNum slot_num, const char *value);
+
+  /**
+   * @brief 把槽位 [begin, end) 的值解码到 out 中
+   */
+  void decode(SlotNum begin, SlotNum end, char *out) const;
+
+  /**
+   * @brief 按照有效记录重新合并游程
+   */
+  void shrink(common::Bitmap &bitmap, int record_capacity);
+
+  /// 包含指定槽位的游程，槽位还没有写过时返回 run_num
+  int find_run(SlotNum slot_num) const;
+
+  /// 游程 [run_begin, run_end) 中的槽位的值都是 run_value(run)
+  SlotNum     run_begin(int run) const { return run == 0 ? 0 : ends_[run - 1]; }
+  SlotNum     run_end(int run) const { return ends_[run]; }
+  const char *run_value(int run) const { return value(run); }
+
+private:
+  /// 写入一个值需要增加的游程个数
+  int new_runs(SlotNum slot_num, const char *value) const;
+
+  char   *value(int run) const { return values_ + run * field_len_; }
+  bool    equal(int run, const char *value) const;
+
+  void insert_run(int run, SlotNum end, const char *value);
+  void remove_run(int run);
+
+private:
+  int32_t  *run_num_        = nullptr;
+  uint16_t *ends_           = nullptr;
+  char     *values_         = nullptr;
+  int       field_len_      = 0;
+  int       entry_capacity_ = 0;
+};
@@ -37,6 +37,7 @@ string RecordOperation::to_string() const
     case Type::INSERT: return ret + "INSERT";
     case Type::DELETE: return ret + "DELETE";
     case Type::UPDATE: return ret + "UPDATE";
+    case Type::PAGE_IMAGE: return ret + "PAGE_IMAGE";
     default: return ret + "UNKNOWN";
   }
 }
@@ -53,7 +54,8 @@ string RecordLogHeader::to_string() const
      << ", page_num:" << page_num;
 
   switch (RecordOperation(operation_type).type()) {
-    case RecordOperation::Type::INIT_PAGE: {
+    case RecordOperation::Type::INIT_PAGE:
+    case RecordOperation::Type::PAGE_IMAGE: {
       ss << ", record_size:" << record_size;
     } break;
     case RecordOperation::Type::INSERT:
@@ -149,6 +151,27 @@ RC RecordLogHandler::update_record(Frame *frame, const RID &rid, const char *rec
   return rc;
 }
 
+RC RecordLogHandler::page_image(Frame *frame)
+{
+  const int        log_payload_size = RecordLogHeader::SIZE + BP_PAGE_DATA_SIZE;
+  vector<char>     log_payload(log_payload_size);
+  RecordLogHeader *header = reinterpret_cast<RecordLogHeader *>(log_payload.data());
+  header->buffer_pool_id  = buffer_pool_id_;
+  header->operation_type  = RecordOperation(RecordOperation::Type::PAGE_IMAGE).type_id();
+  header->page_num        = frame->page_num();
+  header->record_size     = record_size_;
+  header->storage_format  = static_cast<int>(storage_format_);
+  header->column_num      = 0;
+  memcpy(log_payload.data() + RecordLogHeader::SIZE, frame->data(), BP_PAGE_DATA_SIZE);
+
+  LSN lsn = 0;
+  RC  rc  = log_handler_->append(lsn, LogModule::Id::RECORD_MANAGER, std::move(log_payload));
+  if (OB_SUCC(rc) && lsn > 0) {
+    frame->set_lsn(lsn);
+  }
+  return rc;
+}
+
 RC RecordLogHandler::delete_record(Frame *frame, const RID &rid)
 {
   RecordLogHeader header;
@@ -226,6 +249,13 @@ RC RecordLogReplayer::replay(const LogEntry &entry)
     case RecordOperation::Type::UPDATE: {
       rc = replay_update(*buffer_pool, *log_header);
     } break;
+    case RecordOperation::Type::PAGE_IMAGE: {
+      if (entry.payload_size() < RecordLogHeader::SIZE + BP_PAGE_DATA_SIZE) {
+        LOG_WARN("invalid page image log entry. payload size=%d", entry.payload_size());
+        return RC::INVALID_ARGUMENT;
+      }
+      rc = replay_page_image(*frame, *log_header);
+    } break;
     default: {
       LOG_WARN("unknown record operation type: %d", log_header->operation_type);
       return RC::INVALID_ARGUMENT;
@@ -328,4 +358,12 @@ RC RecordLogReplayer::replay_update(DiskBufferPool &buffer_pool, const RecordLog
   }
 
   return rc;
-}
\ No newline at end of file
+}
+
+RC RecordLogReplayer::replay_page_image(Frame &frame, const RecordLogHeader &header)
+{
+  // 页面在批量插入时只被这一条日志修改过，直接用日志中的内容覆盖
+  memcpy(frame.data(), header.data, BP_PAGE_DATA_SIZE);
+  frame.mark_dirty();
+  return RC::SUCCESS;
+}
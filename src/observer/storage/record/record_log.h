@@ -41,7 +41,8 @@ public:
     INIT_PAGE,  /// 初始化空页面
     INSERT,     /// 插入一条记录
     DELETE,     /// 删除一条记录
-    UPDATE      /// 更新一条记录
+    UPDATE,     /// 更新一条记录
+    PAGE_IMAGE  /// 整个页面的内容，批量插入时使用
   };
 
 public:
@@ -125,6 +126,14 @@ public:
    */
   RC update_record(Frame *frame, const RID &rid, const char *record);
 
+  /**
+   * @brief 记录整个页面的内容
+   * @details 批量插入时页面在内存中写满后记录一次，代替页面初始化和每条记录的插入日志。
+   * 回放时直接用日志中的内容覆盖页面。
+   * @param frame 页帧
+   */
+  RC page_image(Frame *frame);
+
 private:
   LogHandler   *log_handler_    = nullptr;
   int32_t       buffer_pool_id_ = -1;
@@ -149,6 +158,7 @@ private:
   RC replay_insert(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
   RC replay_delete(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
   RC replay_update(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
+  RC replay_page_image(Frame &frame, const RecordLogHeader &log_header);
 
 private:
   BufferPoolManager &bpm_;
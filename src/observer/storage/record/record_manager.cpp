@@ -12,6 +12,8 @@ See the Mulan PSL v2 for more details. */
 // Created by Meiyi & Longda on 2021/4/13.
 //
 #include "storage/record/record_manager.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/vector.h"
 #include "common/log/log.h"
 #include "storage/common/condition_filter.h"
 #include "storage/trx/trx.h"
@@ -24,6 +26,8 @@ RecordPageHandler   *RecordPageHandler::create(StorageFormat format)
 {
   if (format == StorageFormat::ROW_FORMAT) {
     return new RowRecordPageHandler();
+  } else if (format == StorageFormat::SLOTTED_FORMAT) {
+    return new SlottedRecordPageHandler();
   } else {
     return new PaxRecordPageHandler();
   }
@@ -86,6 +90,8 @@ RC RecordPageIterator::next(Record &record)
 {
   record_page_handler_->get_record(RID(page_num_, next_slot_num_), record);
 
+  // 遍历过程中更新记录时，PAX 页面可能会重新布局，页面容量和位图的大小都可能变化
+  bitmap_.init(record_page_handler_->bitmap_, record_page_handler_->page_header_->record_capacity);
   if (next_slot_num_ >= 0) {
     next_slot_num_ = bitmap_.next_setted_bit(next_slot_num_ + 1);
   }
@@ -276,6 +282,18 @@ RC RecordPageHandler::cleanup()
   return RC::SUCCESS;
 }
 
+RC RecordPageHandler::log_page_image(LogHandler &log_handler)
+{
+  RecordLogHandler record_log_handler;
+  RC rc = record_log_handler.init(log_handler, disk_buffer_pool_->id(), page_header_->record_real_size, storage_format_);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  frame_->mark_dirty();
+  return record_log_handler.page_image(frame_);
+}
+
 RC RowRecordPageHandler::insert_record(const char *data, RID *rid)
 {
   ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
@@ -388,103 +406,1181 @@ RC RowRecordPageHandler::update_record(const RID &rid, const char *data)
       // return rc; // ignore errors
     }
 
-    return RC::SUCCESS;
-  } else {
+    return RC::SUCCESS;
+  } else {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+}
+
+RC RowRecordPageHandler::get_record(const RID &rid, Record &record)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_ERROR("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  record.set_rid(rid);
+  record.copy_data(get_record_data(rid.slot_num), page_header_->record_real_size);
+  return RC::SUCCESS;
+}
+
+RC RowRecordPageHandler::get_records(vector<Record> &records, vector<char> &buffer)
+{
+  records.clear();
+  records.reserve(page_header_->record_num);
+
+  const PageNum page_num = frame_->page_num();
+  Bitmap        bitmap(bitmap_, page_header_->record_capacity);
+  for (int slot = bitmap.next_setted_bit(0); slot != -1; slot = bitmap.next_setted_bit(slot + 1)) {
+    Record &record = records.emplace_back();
+    record.set_rid(page_num, slot);
+    record.set_data(get_record_data(slot), page_header_->record_real_size);
+  }
+  return RC::SUCCESS;
+}
+
+PageNum RecordPageHandler::get_page_num() const
+{
+  if (nullptr == page_header_) {
+    return static_cast<PageNum>(-1);
+  }
+  return frame_->page_num();
+}
+
+bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
+
+int RecordPageHandler::free_space() const
+{
+  return (page_header_->record_capacity - page_header_->record_num) * page_header_->record_size;
+}
+
+/**
+ * @brief 新页面中一列的初始编码方式
+ * @details 字符串使用字典编码，定长的数值（包括 null 位图）使用游程编码，其它列不编码
+ */
+static PaxColumnIndex initial_column_index(AttrType attr_type, bool encodable, int field_len, int record_offset)
+{
+  PaxColumnIndex column{0, record_offset, field_len, PaxEncoding::PLAIN, 0};
+  if (!encodable) {
+    return column;
+  }
+
+  switch (attr_type) {
+    case AttrType::CHARS: {
+      const int entry_capacity = std::clamp(512 / field_len, 16, PaxDictionary::MAX_ENTRY_NUM);
+      if (field_len > 1 && entry_capacity * field_len <= PaxRecordPageHandler::MAX_DICTIONARY_SIZE) {
+        column.encoding       = PaxEncoding::DICTIONARY;
+        column.entry_capacity = entry_capacity;
+      }
+    } break;
+    case AttrType::INTS:
+    case AttrType::FLOATS:
+    case AttrType::BOOLEANS:
+    case AttrType::DATES:
+    case AttrType::NULLS: {
+      if (field_len <= 8) {
+        column.encoding       = PaxEncoding::RLE;
+        column.entry_capacity = PaxRecordPageHandler::run_length_capacity(field_len);
+      }
+    } break;
+    default: break;
+  }
+  return column;
+}
+
+/**
+ * @brief 列中的值放不下时换成的编码：更大的字典，或者不编码
+ */
+static PaxColumnIndex grow_column_index(const PaxColumnIndex &column)
+{
+  PaxColumnIndex grown = column;
+  const int      entry_capacity = std::min(column.entry_capacity * 2, PaxDictionary::MAX_ENTRY_NUM);
+  if (column.encoding == PaxEncoding::DICTIONARY && entry_capacity > column.entry_capacity &&
+      entry_capacity * column.field_len <= PaxRecordPageHandler::MAX_DICTIONARY_SIZE) {
+    grown.entry_capacity = entry_capacity;
+  } else {
+    grown.encoding       = PaxEncoding::PLAIN;
+    grown.entry_capacity = 0;
+  }
+  return grown;
+}
+
+RC PaxRecordPageHandler::init_empty_page(
+    DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size, TableMeta *table_meta)
+{
+  RC rc = init(buffer_pool, log_handler, page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page page_num:record_size %d:%d. rc=%s", page_num, record_size, strrc(rc));
+    return rc;
+  }
+
+  (void)log_handler_.init(log_handler, buffer_pool.id(), record_size, storage_format_);
+
+  // 按照字段的顺序排列各列，记录中除了字段以外剩下的就是 null 位图，放在最后一列。
+  // 事务字段在删除记录时会修改，不做编码，这样删除记录不会改变页面布局
+  vector<PaxColumnIndex> columns;
+  int                    null_bitmap_offset = -1;
+  int                    offset             = 0;
+  const int              field_num          = table_meta == nullptr ? 0 : table_meta->field_num();
+  int                    fields_size        = 0;
+  for (int i = 0; i < field_num; i++) {
+    fields_size += table_meta->field(i)->len();
+  }
+  const int null_bitmap_len = record_size - fields_size;
+  for (int i = 0; i < field_num; i++) {
+    const FieldMeta *field = table_meta->field(i);
+    // 事务字段的 field_id 是负数，不会按照列读取
+    ASSERT(!field->visible() || i == field->field_id(), "i should be the col_id of fields[i]");
+    if (null_bitmap_len > 0 && null_bitmap_offset < 0 && offset == table_meta->null_bitmap_start()) {
+      null_bitmap_offset = offset;
+      offset += null_bitmap_len;
+    }
+    columns.push_back(initial_column_index(field->type(), field->visible(), field->len(), offset));
+    offset += field->len();
+  }
+  if (null_bitmap_len > 0) {
+    columns.push_back(initial_column_index(
+        AttrType::NULLS, true /*encodable*/, null_bitmap_len, null_bitmap_offset < 0 ? offset : null_bitmap_offset));
+  }
+
+  // 字段很多时字典占用的固定空间可能比节省的还多，这时都不编码
+  vector<PaxColumnIndex> plain_columns = columns;
+  for (PaxColumnIndex &column : plain_columns) {
+    column.encoding       = PaxEncoding::PLAIN;
+    column.entry_capacity = 0;
+  }
+  if (page_capacity(columns) < page_capacity(plain_columns)) {
+    columns.swap(plain_columns);
+  }
+
+  init_page_layout(record_size, columns);
+
+  rc = log_handler_.init_new_page(frame_,
+      page_num,
+      span(reinterpret_cast<const char *>(column_index()), columns.size() * sizeof(PaxColumnIndex)));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page: write log failed. page_num:record_size %d:%d. rc=%s", 
+              page_num, record_size, strrc(rc));
+    return rc;
+  }
+
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+    int record_size, int col_num, const char *col_idx_data)
+{
+  RC rc = init(buffer_pool, log_handler, page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page page_num:record_size %d:%d. rc=%s", page_num, record_size, strrc(rc));
+    return rc;
+  }
+
+  (void)log_handler_.init(log_handler, buffer_pool.id(), record_size, storage_format_);
+
+  // 日志中的 col_num 是 column index 中 int 的个数，每一列占一个 PaxColumnIndex
+  const int              column_num = col_num * sizeof(int) / sizeof(PaxColumnIndex);
+  const PaxColumnIndex  *index      = reinterpret_cast<const PaxColumnIndex *>(col_idx_data);
+  vector<PaxColumnIndex> columns(index, index + column_num);
+  init_page_layout(record_size, columns);
+  return RC::SUCCESS;
+}
+
+int PaxRecordPageHandler::page_capacity(const vector<PaxColumnIndex> &columns)
+{
+  int bytes_per_record = 0;
+  int fixed_size       = columns.size() * sizeof(PaxColumnIndex) + 8 /*align*/;
+  for (const PaxColumnIndex &column : columns) {
+    bytes_per_record += column.bytes_per_record();
+    fixed_size += column.fixed_size() + 3 /*align*/;
+  }
+  // 列数据是按照字段的实际长度紧凑存放的，不需要按照对齐后的记录大小计算容量
+  return std::min(MAX_RECORD_CAPACITY, page_record_capacity(BP_PAGE_DATA_SIZE, bytes_per_record, fixed_size));
+}
+
+int PaxRecordPageHandler::init_page_layout(int record_size, const vector<PaxColumnIndex> &columns)
+{
+  const int column_num   = static_cast<int>(columns.size());
+  const int col_idx_size = column_num * sizeof(PaxColumnIndex);
+  const int capacity     = page_capacity(columns);
+
+  page_header_->record_num       = 0;
+  page_header_->column_num       = column_num;
+  page_header_->record_real_size = record_size;
+  page_header_->record_size      = align8(record_size);
+  page_header_->record_capacity  = capacity;
+  page_header_->col_idx_offset   = align8(PAGE_HEADER_SIZE + page_bitmap_size(capacity));
+  page_header_->data_offset      = page_header_->col_idx_offset + col_idx_size;
+
+  // 每一列的数据区按照4字节对齐，字典项个数和游程个数可以直接按照 int 访问
+  PaxColumnIndex *index      = column_index();
+  int             end_offset = 0;
+  for (int i = 0; i < column_num; i++) {
+    index[i]            = columns[i];
+    end_offset          = (end_offset + index[i].area_size(capacity) + 3) & ~3;
+    index[i].end_offset = end_offset;
+  }
+  ASSERT(page_header_->data_offset + end_offset <= BP_PAGE_DATA_SIZE, "Record overflow the page size");
+
+  for (int i = 0; i < column_num; i++) {
+    if (index[i].encoding == PaxEncoding::DICTIONARY) {
+      PaxDictionary(get_column_area(i), index[i]).init();
+    } else if (index[i].encoding == PaxEncoding::RLE) {
+      PaxRunLength(get_column_area(i), index[i]).init();
+    }
+  }
+
+  bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
+  memset(bitmap_, 0, page_bitmap_size(capacity));
+  return capacity;
+}
+
+RC PaxRecordPageHandler::reserve(SlotNum slot_num, const char *data)
+{
+  // 每次重新布局至少会把一列换成更大的编码，所以循环一定会结束
+  while (true) {
+    const int              column_num = page_header_->column_num;
+    PaxColumnIndex        *index      = column_index();
+    Bitmap                 bitmap(bitmap_, page_header_->record_capacity);
+    vector<PaxColumnIndex> columns;
+
+    for (int col_id = 0; col_id < column_num; col_id++) {
+      const char *value = data + index[col_id].record_offset;
+      if (index[col_id].encoding == PaxEncoding::DICTIONARY) {
+        PaxDictionary dictionary(get_column_area(col_id), index[col_id]);
+        if (dictionary.can_set(value)) {
+          continue;
+        }
+        dictionary.shrink(bitmap, page_header_->record_capacity);
+        if (dictionary.can_set(value)) {
+          continue;
+        }
+      } else if (index[col_id].encoding == PaxEncoding::RLE) {
+        PaxRunLength run_length(get_column_area(col_id), index[col_id]);
+        if (run_length.can_set(slot_num, value)) {
+          continue;
+        }
+        run_length.shrink(bitmap, page_header_->record_capacity);
+        if (run_length.can_set(slot_num, value)) {
+          continue;
+        }
+      } else {
+        continue;
+      }
+
+      if (columns.empty()) {
+        columns.assign(index, index + column_num);
+      }
+      columns[col_id] = grow_column_index(index[col_id]);
+    }
+
+    if (columns.empty()) {
+      return RC::SUCCESS;
+    }
+
+    RC rc = relayout(columns, slot_num);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+}
+
+RC PaxRecordPageHandler::relayout(const vector<PaxColumnIndex> &columns, SlotNum slot_num)
+{
+  const int old_capacity = page_header_->record_capacity;
+  const int capacity     = page_capacity(columns);
+
+  Bitmap bitmap(bitmap_, old_capacity);
+  if (slot_num >= capacity || (capacity < old_capacity && bitmap.next_setted_bit(capacity) != -1)) {
+    LOG_DEBUG("no room for records after changing column encoding. page_num=%d, record_num=%d, capacity=%d->%d",
+              get_page_num(), page_header_->record_num, old_capacity, capacity);
+    return RC::RECORD_NOMEM;
+  }
+
+  // 先把有效的记录读出来，重新布局以后再写回原来的槽位
+  const int       record_num  = page_header_->record_num;
+  const int       record_size = page_header_->record_real_size;
+  vector<SlotNum> slots;
+  vector<char>    records(record_num * record_size);
+  for (int slot = bitmap.next_setted_bit(0); slot != -1; slot = bitmap.next_setted_bit(slot + 1)) {
+    read_record_data(slot, records.data() + slots.size() * record_size);
+    slots.push_back(slot);
+  }
+
+  init_page_layout(record_size, columns);
+
+  Bitmap new_bitmap(bitmap_, capacity);
+  for (size_t i = 0; i < slots.size(); i++) {
+    new_bitmap.set_bit(slots[i]);
+    write_record_data(slots[i], records.data() + i * record_size);
+  }
+  page_header_->record_num = record_num;
+  frame_->mark_dirty();
+
+  LOG_DEBUG("change column encoding. page_num=%d, record_num=%d, capacity=%d->%d",
+            get_page_num(), record_num, old_capacity, capacity);
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert record into page while the page is readonly");
+
+  if (page_header_->record_num == page_header_->record_capacity) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  // 找到空闲位置
+  int index = Bitmap(bitmap_, page_header_->record_capacity).next_unsetted_bit(0);
+
+  // 编码后的列可能放不下这条记录，需要先调整页面布局，调整后页面容量可能会变化
+  RC rc = reserve(index, data);
+  if (OB_FAIL(rc)) {
+    LOG_DEBUG("Page has no room for the record, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return rc;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  bitmap.set_bit(index);
+  page_header_->record_num++;
+
+  rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  write_record_data(index, data);
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::recover_insert_record(const char *data, const RID &rid)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
+    return RC::RECORD_INVALID_RID;
+  }
+
+  RC rc = reserve(rid.slot_num, data);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to reserve space for record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    bitmap.set_bit(rid.slot_num);
+    page_header_->record_num++;
+  }
+
+  write_record_data(rid.slot_num, data);
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::delete_record(const RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot delete record from page while the page is readonly");
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (bitmap.get_bit(rid->slot_num)) {
+    bitmap.clear_bit(rid->slot_num);
+    page_header_->record_num--;
+    frame_->mark_dirty();
+
+    RC rc = log_handler_.delete_record(frame_, *rid);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to delete record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+      // return rc; // ignore errors
+    }
+
+    return RC::SUCCESS;
+  } else {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+}
+
+RC PaxRecordPageHandler::update_record(const RID &rid, const char *data)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record from page while the page is readonly");
+
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  RC rc = reserve(rid.slot_num, data);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Page has no room for the updated record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  frame_->mark_dirty();
+  write_record_data(rid.slot_num, data);
+
+  rc = log_handler_.update_record(frame_, rid, data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to update record. page_num %d:%d. rc=%s", 
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::get_record(const RID &rid, Record &record)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_DEBUG("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  RC rc = record.new_record(page_header_->record_real_size);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  read_record_data(rid.slot_num, record.data());
+  record.set_rid(rid);
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::get_records(vector<Record> &records, vector<char> &buffer)
+{
+  records.clear();
+  records.reserve(page_header_->record_num);
+
+  // 先分配好所有记录的空间，后面记录的数据指针不会因为扩容失效
+  const int record_size = page_header_->record_real_size;
+  buffer.resize(static_cast<size_t>(page_header_->record_num) * record_size);
+
+  const PageNum page_num = frame_->page_num();
+  Bitmap        bitmap(bitmap_, page_header_->record_capacity);
+  char         *data = buffer.data();
+  for (int slot = bitmap.next_setted_bit(0); slot != -1; slot = bitmap.next_setted_bit(slot + 1)) {
+    read_record_data(slot, data);
+    Record &record = records.emplace_back();
+    record.set_rid(page_num, slot);
+    record.set_data(data, record_size);
+    data += record_size;
+  }
+  return RC::SUCCESS;
+}
+
+// TODO: specify the column_ids that chunk needed. currenly we get all columns
+RC PaxRecordPageHandler::get_chunk(Chunk &chunk)
+{
+  const int capacity   = page_header_->record_capacity;
+  const int record_num = page_header_->record_num;
+
+  Bitmap bitmap(bitmap_, capacity);
+  // 有效记录都集中在页面开头时（没有删除过记录，或者删除的都在末尾），列数据在页面上就是连续的，
+  // 直接引用页面内存，不需要拷贝
+  const int  first_hole = bitmap.next_unsetted_bit(0);
+  const bool dense      = (first_hole == -1 || first_hole >= record_num);
+
+  // 中间有删除的记录时，按照位图把连续的有效记录段整段拷贝出来
+  vector<pair<SlotNum, SlotNum>> ranges;
+  if (dense) {
+    ranges.emplace_back(0, record_num);
+  } else {
+    int start = bitmap.next_setted_bit(0);
+    while (start != -1) {
+      int end = bitmap.next_unsetted_bit(start);
+      if (end == -1) {
+        end = capacity;
+      }
+      ranges.emplace_back(start, end);
+      start = end < capacity ? bitmap.next_setted_bit(end) : -1;
+    }
+  }
+
+  for (int i = 0; i < chunk.column_num(); i++) {
+    Column &column = chunk.column(i);
+    int     col_id = chunk.column_ids(i);
+    RC      rc     = check_column(column, col_id);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    // 字典编码的列只引用或者拷贝字典编号，字典引用页面上的字典
+    const PaxColumnIndex &index = column_index()[col_id];
+    if (dense && index.encoding == PaxEncoding::PLAIN) {
+      column.reference(get_field_data(0, col_id), record_num);
+    } else if (dense && index.encoding == PaxEncoding::DICTIONARY) {
+      PaxDictionary dictionary(get_column_area(col_id), index);
+      column.reference_dictionary(dictionary.codes(), record_num, dictionary.entries(), dictionary.entry_num());
+    } else {
+      // 游程编码的列总是解码到 Column 自己的内存中
+      prepare_column(column, col_id, record_num);
+      for (const auto &[start, end] : ranges) {
+        rc = append_column_data(column, col_id, start, end);
+        if (OB_FAIL(rc)) {
+          return rc;
+        }
+      }
+    }
+    append_column_nulls(column, col_id, ranges);
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::get_selected_chunk(Chunk &chunk, const vector<uint8_t> &select)
+{
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+
+  // 把选中的记录整理成连续的槽位区间，每一列按区间整段拷贝
+  vector<pair<SlotNum, SlotNum>> ranges;
+  int                            selected_num = 0;
+  size_t                         row          = 0;
+  for (int slot = bitmap.next_setted_bit(0); slot != -1 && row < select.size();
+       slot     = bitmap.next_setted_bit(slot + 1), row++) {
+    if (!select[row]) {
+      continue;
+    }
+    if (!ranges.empty() && ranges.back().second == slot) {
+      ranges.back().second = slot + 1;
+    } else {
+      ranges.emplace_back(slot, slot + 1);
+    }
+    selected_num++;
+  }
+
+  for (int i = 0; i < chunk.column_num(); i++) {
+    Column &column = chunk.column(i);
+    int     col_id = chunk.column_ids(i);
+    RC      rc     = check_column(column, col_id);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    prepare_column(column, col_id, selected_num);
+    for (const auto &[start, end] : ranges) {
+      rc = append_column_data(column, col_id, start, end);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+    append_column_nulls(column, col_id, ranges);
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::check_column(const Column &column, int col_id) const
+{
+  if (col_id < 0 || col_id >= page_header_->column_num) {
+    LOG_WARN("invalid column id. col_id=%d, column_num=%d", col_id, page_header_->column_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const int field_len = column_index()[col_id].field_len;
+  if (field_len != column.attr_len()) {
+    LOG_WARN("column length mismatch. col_id=%d, page field len=%d, column attr len=%d",
+             col_id, field_len, column.attr_len());
+    return RC::INVALID_ARGUMENT;
+  }
+  return RC::SUCCESS;
+}
+
+void PaxRecordPageHandler::prepare_column(Column &column, int col_id, int row_num) const
+{
+  if (!column.own() || column.capacity() < row_num) {
+    column.init(column.attr_type(), column.attr_len(), max(page_header_->record_capacity, column.capacity()));
+  }
+  column.reset_data();
+
+  const PaxColumnIndex &index = column_index()[col_id];
+  if (index.encoding == PaxEncoding::DICTIONARY) {
+    PaxDictionary dictionary(get_column_area(col_id), index);
+    column.set_dictionary(dictionary.entries(), dictionary.entry_num());
+  }
+}
+
+RC PaxRecordPageHandler::append_column_data(Column &column, int col_id, SlotNum start, SlotNum end) const
+{
+  const PaxColumnIndex &index = column_index()[col_id];
+
+  RC rc = RC::SUCCESS;
+  switch (index.encoding) {
+    case PaxEncoding::RLE: {
+      PaxRunLength run_length(get_column_area(col_id), index);
+      run_length.decode(start, end, column.data() + column.count() * index.field_len);
+      column.set_count(column.count() + end - start);
+    } break;
+    case PaxEncoding::DICTIONARY: {
+      PaxDictionary dictionary(get_column_area(col_id), index);
+      rc = column.append(dictionary.codes() + start, end - start);
+    } break;
+    default: {
+      rc = column.append(get_field_data(start, col_id), end - start);
+    } break;
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to append column data. col_id=%d, rc=%s", col_id, strrc(rc));
+  }
+  return rc;
+}
+
+int PaxRecordPageHandler::null_bit(int col_id) const
+{
+  // null 位图是最后一列，事务字段在记录中排在 null 位图之前，其它字段按顺序对应 null 位图中的每一位
+  const int column_num = page_header_->column_num;
+  if (column_num < 2 || col_id < 0 || col_id >= column_num - 1) {
+    return -1;
+  }
+
+  const PaxColumnIndex *index       = column_index();
+  const int             null_offset = index[column_num - 1].record_offset;
+  if (index[col_id].record_offset < null_offset) {
+    return -1;
+  }
+  int sys_field_num = 0;
+  for (int i = 0; i < column_num - 1; i++) {
+    if (index[i].record_offset < null_offset) {
+      sys_field_num++;
+    }
+  }
+  const int bit = col_id - sys_field_num;
+  return bit < index[column_num - 1].field_len * 8 ? bit : -1;
+}
+
+void PaxRecordPageHandler::append_column_nulls(
+    Column &column, int col_id, const vector<pair<SlotNum, SlotNum>> &ranges) const
+{
+  const int bit = null_bit(col_id);
+  if (bit < 0) {
+    return;
+  }
+
+  const int             null_col_id = page_header_->column_num - 1;
+  const PaxColumnIndex &index       = column_index()[null_col_id];
+  const int             byte        = bit / 8;
+  const char            mask        = static_cast<char>(1 << (bit % 8));
+
+  int row = 0;
+  if (index.encoding == PaxEncoding::RLE) {
+    // null 值通常很少，整个页面的 null 位图往往只有一个游程
+    PaxRunLength run_length(get_column_area(null_col_id), index);
+    for (const auto &[start, end] : ranges) {
+      SlotNum slot = start;
+      for (int run = run_length.find_run(start); slot < end && run < run_length.run_num(); run++) {
+        const SlotNum run_end = std::min(run_length.run_end(run), end);
+        if (run_length.run_value(run)[byte] & mask) {
+          column.set_nulls(row + slot - start, row + run_end - start);
+        }
+        slot = run_end;
+      }
+      row += end - start;
+    }
+    return;
+  }
+
+  for (const auto &[start, end] : ranges) {
+    for (SlotNum slot = start; slot < end; slot++, row++) {
+      const char *nulls = index.encoding == PaxEncoding::DICTIONARY
+                              ? PaxDictionary(get_column_area(null_col_id), index).get(slot)
+                              : get_field_data(slot, null_col_id);
+      if (nulls[byte] & mask) {
+        column.set_null(row);
+      }
+    }
+  }
+}
+
+void PaxRecordPageHandler::write_record_data(SlotNum slot_num, const char *data)
+{
+  const PaxColumnIndex *index = column_index();
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    const char *value = data + index[col_id].record_offset;
+    switch (index[col_id].encoding) {
+      case PaxEncoding::DICTIONARY: {
+        PaxDictionary(get_column_area(col_id), index[col_id]).set(slot_num, value);
+      } break;
+      case PaxEncoding::RLE: {
+        PaxRunLength(get_column_area(col_id), index[col_id]).set(slot_num, value);
+      } break;
+      default: {
+        memcpy(get_field_data(slot_num, col_id), value, index[col_id].field_len);
+      } break;
+    }
+  }
+}
+
+void PaxRecordPageHandler::read_record_data(SlotNum slot_num, char *data)
+{
+  const PaxColumnIndex *index = column_index();
+  for (int col_id = 0; col_id < page_header_->column_num; col_id++) {
+    const char *value = nullptr;
+    switch (index[col_id].encoding) {
+      case PaxEncoding::DICTIONARY: {
+        value = PaxDictionary(get_column_area(col_id), index[col_id]).get(slot_num);
+      } break;
+      case PaxEncoding::RLE: {
+        value = PaxRunLength(get_column_area(col_id), index[col_id]).get(slot_num);
+      } break;
+      default: {
+        value = get_field_data(slot_num, col_id);
+      } break;
+    }
+    memcpy(data + index[col_id].record_offset, value, index[col_id].field_len);
+  }
+}
+
+char *PaxRecordPageHandler::get_column_area(int col_id) const
+{
+  const int begin = col_id == 0 ? 0 : column_index()[col_id - 1].end_offset;
+  return frame_->data() + page_header_->data_offset + begin;
+}
+
+char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id) const
+{
+  return get_column_area(col_id) + column_index()[col_id].field_len * slot_num;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RC SlottedRecordPageHandler::init_empty_page(
+    DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size, TableMeta *table_meta)
+{
+  RC rc = init(buffer_pool, log_handler, page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page page_num:record_size %d:%d. rc=%s", page_num, record_size, strrc(rc));
+    return rc;
+  }
+
+  (void)log_handler_.init(log_handler, buffer_pool.id(), record_size, storage_format_);
+
+  // 只有字符串字段按照变长存放，每个字段记录偏移量和长度
+  vector<int> var_fields;
+  if (table_meta != nullptr) {
+    for (int i = 0; i < table_meta->field_num(); i++) {
+      const FieldMeta *field = table_meta->field(i);
+      if (field->type() == AttrType::CHARS && field->len() > static_cast<int>(sizeof(uint16_t))) {
+        var_fields.push_back(field->offset());
+        var_fields.push_back(field->len());
+      }
+    }
+  }
+
+  rc = init_page_layout(record_size, static_cast<int>(var_fields.size() / 2), var_fields.data());
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = log_handler_.init_new_page(
+      frame_, page_num, span(reinterpret_cast<const char *>(var_fields.data()), var_fields.size() * sizeof(int)));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page: write log failed. page_num:record_size %d:%d. rc=%s", 
+              page_num, record_size, strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+    int record_size, int col_num, const char *col_idx_data)
+{
+  RC rc = init(buffer_pool, log_handler, page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page page_num:record_size %d:%d. rc=%s", page_num, record_size, strrc(rc));
+    return rc;
+  }
+
+  (void)log_handler_.init(log_handler, buffer_pool.id(), record_size, storage_format_);
+
+  // 日志中的 col_num 是 column index 中 int 的个数，每个变长字段占两个
+  return init_page_layout(record_size, col_num / 2, reinterpret_cast<const int *>(col_idx_data));
+}
+
+RC SlottedRecordPageHandler::init_page_layout(int record_size, int var_field_num, const int *var_fields)
+{
+  int min_tuple_size = record_size;
+  for (int i = 0; i < var_field_num; i++) {
+    min_tuple_size -= var_fields[i * 2 + 1] - static_cast<int>(sizeof(uint16_t));
+  }
+
+  const int col_idx_size = var_field_num * 2 * sizeof(int);
+
+  page_header_->record_num       = 0;
+  page_header_->column_num       = var_field_num;
+  page_header_->record_real_size = record_size;
+  page_header_->record_size      = align8(record_size);
+  // 按照最短的记录计算最多能放多少条记录，另外预留对齐可能浪费的空间
+  page_header_->record_capacity = page_record_capacity(BP_PAGE_DATA_SIZE,
+      min_tuple_size + sizeof(Slot),
+      col_idx_size + sizeof(SlottedPageHeader) + 16 /*align*/);
+  page_header_->col_idx_offset = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity));
+  page_header_->data_offset    = align8(page_header_->col_idx_offset + col_idx_size + sizeof(SlottedPageHeader));
+
+  if (page_header_->data_offset + max_tuple_size() + static_cast<int>(sizeof(Slot)) > BP_PAGE_DATA_SIZE) {
+    LOG_ERROR("record is too large to fit in a page. record size=%d", record_size);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
+  memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
+  if (col_idx_size > 0) {
+    memcpy(frame_->data() + page_header_->col_idx_offset, var_fields, col_idx_size);
+  }
+
+  SlottedPageHeader *header = slotted_header();
+  header->slot_num          = 0;
+  header->heap_offset       = BP_PAGE_DATA_SIZE;
+  header->garbage_bytes     = 0;
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::insert_record(const char *data, RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert record into page while the page is readonly");
+
+  if (is_full()) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  // 优先复用空闲的槽位，否则在槽位目录末尾增加一个
+  SlottedPageHeader *header = slotted_header();
+  Bitmap             bitmap(bitmap_, page_header_->record_capacity);
+  int                index = bitmap.next_unsetted_bit(0);
+  if (index == header->slot_num) {
+    grow_slots();
+  }
+
+  RC rc = write_tuple(index, data);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to write tuple. page_num %d, slot_num %d, rc=%s", frame_->page_num(), index, strrc(rc));
+    return rc;
+  }
+  bitmap.set_bit(index);
+  page_header_->record_num++;
+
+  rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::recover_insert_record(const char *data, const RID &rid)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
+    return RC::RECORD_INVALID_RID;
+  }
+
+  SlottedPageHeader *header = slotted_header();
+  while (header->slot_num <= rid.slot_num) {
+    grow_slots();
+  }
+
+  RC rc = write_tuple(rid.slot_num, data);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    bitmap.set_bit(rid.slot_num);
+    page_header_->record_num++;
+  }
+
+  frame_->mark_dirty();
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::delete_record(const RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot delete record from page while the page is readonly");
+
+  SlottedPageHeader *header = slotted_header();
+  Bitmap             bitmap(bitmap_, page_header_->record_capacity);
+  if (rid->slot_num >= header->slot_num || !bitmap.get_bit(rid->slot_num)) {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  bitmap.clear_bit(rid->slot_num);
+  page_header_->record_num--;
+
+  Slot &slot = slots()[rid->slot_num];
+  header->garbage_bytes += slot.length;
+  slot.length = 0;
+
+  // 槽位目录末尾的空闲槽位可以直接收回
+  while (header->slot_num > 0 && !bitmap.get_bit(header->slot_num - 1)) {
+    header->slot_num--;
+  }
+  frame_->mark_dirty();
+
+  RC rc = log_handler_.delete_record(frame_, *rid);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to delete record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::update_record(const RID &rid, const char *data)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record from page while the page is readonly");
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (rid.slot_num >= slotted_header()->slot_num || !bitmap.get_bit(rid.slot_num)) {
     LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
     return RC::RECORD_NOT_EXIST;
   }
-}
 
-RC RowRecordPageHandler::get_record(const RID &rid, Record &record)
-{
-  if (rid.slot_num >= page_header_->record_capacity) {
-    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
-              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
-    return RC::RECORD_INVALID_RID;
+  RC rc = write_tuple(rid.slot_num, data);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to update record. page_num %d, slot_num %d, rc=%s", frame_->page_num(), rid.slot_num, strrc(rc));
+    return rc;
   }
+  frame_->mark_dirty();
+
+  rc = log_handler_.update_record(frame_, rid, data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to update record. page_num %d:%d. rc=%s", 
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
 
+RC SlottedRecordPageHandler::get_record(const RID &rid, Record &record)
+{
   Bitmap bitmap(bitmap_, page_header_->record_capacity);
-  if (!bitmap.get_bit(rid.slot_num)) {
-    LOG_ERROR("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+  if (rid.slot_num >= slotted_header()->slot_num || !bitmap.get_bit(rid.slot_num)) {
+    LOG_DEBUG("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
     return RC::RECORD_NOT_EXIST;
   }
 
+  RC rc = record.new_record(page_header_->record_real_size);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  decode(frame_->data() + slots()[rid.slot_num].offset, record.data());
   record.set_rid(rid);
-  record.copy_data(get_record_data(rid.slot_num), page_header_->record_real_size);
   return RC::SUCCESS;
 }
 
-PageNum RecordPageHandler::get_page_num() const
+RC SlottedRecordPageHandler::get_records(vector<Record> &records, vector<char> &buffer)
 {
-  if (nullptr == page_header_) {
-    return static_cast<PageNum>(-1);
+  records.clear();
+  records.reserve(page_header_->record_num);
+
+  // 变长的数据需要解码成定长的记录，先分配好所有记录的空间
+  const int record_size = page_header_->record_real_size;
+  buffer.resize(static_cast<size_t>(page_header_->record_num) * record_size);
+
+  const PageNum page_num = frame_->page_num();
+  Bitmap        bitmap(bitmap_, page_header_->record_capacity);
+  char         *data = buffer.data();
+  for (int slot = bitmap.next_setted_bit(0); slot != -1 && slot < slotted_header()->slot_num;
+       slot      = bitmap.next_setted_bit(slot + 1)) {
+    decode(frame_->data() + slots()[slot].offset, data);
+    Record &record = records.emplace_back();
+    record.set_rid(page_num, slot);
+    record.set_data(data, record_size);
+    data += record_size;
   }
-  return frame_->page_num();
+  return RC::SUCCESS;
 }
 
-bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
+bool SlottedRecordPageHandler::is_full() const
+{
+  if (page_header_->record_num >= page_header_->record_capacity) {
+    return true;
+  }
+  const int free_space = contiguous_free_space() + slotted_header()->garbage_bytes;
+  return free_space < max_tuple_size() + static_cast<int>(sizeof(Slot)) + UPDATE_RESERVED_SPACE;
+}
 
-RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
+int SlottedRecordPageHandler::free_space() const { return contiguous_free_space() + slotted_header()->garbage_bytes; }
+
+int SlottedRecordPageHandler::contiguous_free_space() const
 {
-  // your code here
-  exit(-1);
+  const SlottedPageHeader *header = slotted_header();
+  return header->heap_offset - (page_header_->data_offset + header->slot_num * static_cast<int>(sizeof(Slot)));
 }
 
-RC PaxRecordPageHandler::delete_record(const RID *rid)
+RC SlottedRecordPageHandler::write_tuple(SlotNum slot_num, const char *data)
 {
-  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
-         "cannot delete record from page while the page is readonly");
+  vector<char> tuple(max_tuple_size());
+  const int    length = encode(data, tuple.data());
+
+  SlottedPageHeader *header = slotted_header();
+  Slot              &slot   = slots()[slot_num];
+  if (length <= slot.length) {
+    // 原地更新，多出来的空间留给以后整理
+    memcpy(frame_->data() + slot.offset, tuple.data(), length);
+    header->garbage_bytes += slot.length - length;
+    slot.length = length;
+    return RC::SUCCESS;
+  }
 
-  Bitmap bitmap(bitmap_, page_header_->record_capacity);
-  if (bitmap.get_bit(rid->slot_num)) {
-    bitmap.clear_bit(rid->slot_num);
-    page_header_->record_num--;
-    frame_->mark_dirty();
+  if (contiguous_free_space() + header->garbage_bytes + slot.length < length) {
+    return RC::RECORD_NOMEM;
+  }
 
-    RC rc = log_handler_.delete_record(frame_, *rid);
-    if (OB_FAIL(rc)) {
-      LOG_ERROR("Failed to delete record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
-      // return rc; // ignore errors
-    }
+  header->garbage_bytes += slot.length;
+  slot.length = 0;
 
-    return RC::SUCCESS;
-  } else {
-    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
-    return RC::RECORD_NOT_EXIST;
+  const int offset = allocate(length);
+  ASSERT(offset > 0, "there should be enough space in the page");
+  memcpy(frame_->data() + offset, tuple.data(), length);
+  slot.offset = static_cast<uint16_t>(offset);
+  slot.length = static_cast<uint16_t>(length);
+  return RC::SUCCESS;
+}
+
+void SlottedRecordPageHandler::grow_slots()
+{
+  // 槽位目录向后增长会占用连续的空闲空间，空间都在碎片中时要先整理，否则会覆盖数据区最前面的记录
+  if (contiguous_free_space() < static_cast<int>(sizeof(Slot))) {
+    compact();
   }
+
+  SlottedPageHeader *header = slotted_header();
+  slots()[header->slot_num] = Slot{0, 0};
+  header->slot_num++;
 }
 
-RC PaxRecordPageHandler::get_record(const RID &rid, Record &record)
+int SlottedRecordPageHandler::allocate(int length)
 {
-  // your code here
-  exit(-1);
+  SlottedPageHeader *header = slotted_header();
+  if (contiguous_free_space() < length) {
+    if (contiguous_free_space() + header->garbage_bytes < length) {
+      return -1;
+    }
+    compact();
+  }
+
+  header->heap_offset -= length;
+  return header->heap_offset;
 }
 
-// TODO: specify the column_ids that chunk needed. currenly we get all columns
-RC PaxRecordPageHandler::get_chunk(Chunk &chunk)
+void SlottedRecordPageHandler::compact()
 {
-  // your code here
-  exit(-1);
+  SlottedPageHeader *header = slotted_header();
+  Slot              *slot_array = slots();
+
+  // 按照偏移量从大到小依次挪到页面末尾，目标位置不会覆盖还没有挪动的数据
+  vector<int> live_slots;
+  Bitmap      bitmap(bitmap_, page_header_->record_capacity);
+  for (int i = 0; i < header->slot_num; i++) {
+    if (bitmap.get_bit(i) && slot_array[i].length > 0) {
+      live_slots.push_back(i);
+    }
+  }
+  sort(live_slots.begin(), live_slots.end(), [slot_array](int a, int b) {
+    return slot_array[a].offset > slot_array[b].offset;
+  });
+
+  int heap_offset = BP_PAGE_DATA_SIZE;
+  for (int i : live_slots) {
+    Slot &slot = slot_array[i];
+    heap_offset -= slot.length;
+    if (heap_offset != slot.offset) {
+      memmove(frame_->data() + heap_offset, frame_->data() + slot.offset, slot.length);
+      slot.offset = static_cast<uint16_t>(heap_offset);
+    }
+  }
+
+  LOG_TRACE("compact slotted page. page_num=%d, garbage bytes=%d", frame_->page_num(), header->garbage_bytes);
+  header->heap_offset   = heap_offset;
+  header->garbage_bytes = 0;
 }
 
-char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id)
+int SlottedRecordPageHandler::encode(const char *record, char *tuple) const
 {
-  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
-  if (col_id == 0) {
-    return frame_->data() + page_header_->data_offset + (get_field_len(col_id) * slot_num);
-  } else {
-    return frame_->data() + page_header_->data_offset + col_idx[col_id - 1] + (get_field_len(col_id) * slot_num);
+  const int *fields = var_fields();
+  int        pos    = 0;
+  int        length = 0;
+  for (int i = 0; i < page_header_->column_num; i++) {
+    const int field_offset = fields[i * 2];
+    const int field_len    = fields[i * 2 + 1];
+
+    memcpy(tuple + length, record + pos, field_offset - pos);
+    length += field_offset - pos;
+
+    uint16_t str_len = static_cast<uint16_t>(strnlen(record + field_offset, field_len));
+    memcpy(tuple + length, &str_len, sizeof(str_len));
+    length += sizeof(str_len);
+    memcpy(tuple + length, record + field_offset, str_len);
+    length += str_len;
+
+    pos = field_offset + field_len;
   }
+  memcpy(tuple + length, record + pos, page_header_->record_real_size - pos);
+  length += page_header_->record_real_size - pos;
+  return length;
 }
 
-int PaxRecordPageHandler::get_field_len(int col_id)
+void SlottedRecordPageHandler::decode(const char *tuple, char *record) const
 {
-  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
-  if (col_id == 0) {
-    return col_idx[col_id] / page_header_->record_capacity;
-  } else {
-    return (col_idx[col_id] - col_idx[col_id - 1]) / page_header_->record_capacity;
+  const int *fields = var_fields();
+  int        pos    = 0;
+  int        offset = 0;
+  for (int i = 0; i < page_header_->column_num; i++) {
+    const int field_offset = fields[i * 2];
+    const int field_len    = fields[i * 2 + 1];
+
+    memcpy(record + pos, tuple + offset, field_offset - pos);
+    offset += field_offset - pos;
+
+    uint16_t str_len = 0;
+    memcpy(&str_len, tuple + offset, sizeof(str_len));
+    offset += sizeof(str_len);
+    memcpy(record + field_offset, tuple + offset, str_len);
+    memset(record + field_offset + str_len, 0, field_len - str_len);
+    offset += str_len;
+
+    pos = field_offset + field_len;
   }
+  memcpy(record + pos, tuple + offset, page_header_->record_real_size - pos);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -501,52 +1597,43 @@ RC RecordFileHandler::init(DiskBufferPool &buffer_pool, LogHandler &log_handler,
   disk_buffer_pool_ = &buffer_pool;
   log_handler_      = &log_handler;
   table_meta_       = table_meta;
+  zone_map_.init(table_meta);
 
-  RC rc = init_free_pages();
-
-  LOG_INFO("open record file handle done. rc=%s", strrc(rc));
+  LOG_INFO("open record file handle done.");
   return RC::SUCCESS;
 }
 
+RC RecordFileHandler::init_free_space_map(DiskBufferPool &fsm_buffer_pool)
+{
+  RC rc = free_space_map_.init(fsm_buffer_pool, disk_buffer_pool_->page_count());
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init free space map. rc=%s", strrc(rc));
+  }
+  return rc;
+}
+
 void RecordFileHandler::close()
 {
   if (disk_buffer_pool_ != nullptr) {
-    free_pages_.clear();
+    free_space_map_.close();
     disk_buffer_pool_ = nullptr;
     log_handler_      = nullptr;
     table_meta_       = nullptr;
   }
 }
 
-RC RecordFileHandler::init_free_pages()
+void RecordFileHandler::update_free_space(const RecordPageHandler &page_handler)
 {
-  // 遍历当前文件上所有页面，找到没有满的页面
-  // 这个效率很低，会降低启动速度
-  // NOTE: 由于是初始化时的动作，所以不需要加锁控制并发
-
-  RC rc = RC::SUCCESS;
-
-  BufferPoolIterator bp_iterator;
-  bp_iterator.init(*disk_buffer_pool_, 1);
-  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
-  PageNum                       current_page_num = 0;
-
-  while (bp_iterator.has_next()) {
-    current_page_num = bp_iterator.next();
-
-    rc = record_page_handler->init(*disk_buffer_pool_, *log_handler_, current_page_num, ReadWriteMode::READ_ONLY);
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, rc, strrc(rc));
-      return rc;
-    }
+  uint8_t category = FreeSpaceMap::FULL;
+  if (!page_handler.is_full()) {
+    category = std::max<uint8_t>(1, FreeSpaceMap::category_of(page_handler.free_space()));
+  }
 
-    if (!record_page_handler->is_full()) {
-      free_pages_.insert(current_page_num);
-    }
-    record_page_handler->cleanup();
+  RC rc = free_space_map_.update(page_handler.get_page_num(), category);
+  if (OB_FAIL(rc)) {
+    // 空闲空间映射只是一个提示，不影响记录的修改
+    LOG_WARN("failed to update free space map. page num=%d, rc=%s", page_handler.get_page_num(), strrc(rc));
   }
-  LOG_INFO("record file handler init free pages done. free page num=%d, rc=%s", free_pages_.size(), strrc(rc));
-  return rc;
 }
 
 RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
@@ -557,28 +1644,32 @@ RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
   bool                          page_found       = false;
   PageNum                       current_page_num = 0;
 
-  // 当前要访问free_pages对象，所以需要加锁。在非并发编译模式下，不需要考虑这个锁
-  lock_.lock();
-
-  // 找到没有填满的页面
-  while (!free_pages_.empty()) {
-    current_page_num = *free_pages_.begin();
-
+  // 找到没有填满的页面。空闲空间映射中的信息可能是过时的，拿到页面写锁后还要再检查一次，
+  // 发现页面满了就修正空闲空间映射再重新查找。PAX 页面中的列是编码存放的，没有满的页面也可能放不下这条记录
+  while (OB_SUCC(ret = free_space_map_.search(1, current_page_num))) {
     ret = record_page_handler->init(*disk_buffer_pool_, *log_handler_, current_page_num, ReadWriteMode::READ_WRITE);
     if (OB_FAIL(ret)) {
-      lock_.unlock();
       LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, ret, strrc(ret));
-      return ret;
+    } else if (!record_page_handler->is_full()) {
+      ret = record_page_handler->insert_record(data, rid);
+      if (ret != RC::RECORD_NOMEM) {
+        page_found = true;
+        break;
+      }
+      record_page_handler->cleanup();
+    } else {
+      record_page_handler->cleanup();
     }
 
-    if (!record_page_handler->is_full()) {
-      page_found = true;
+    if (OB_FAIL(ret = free_space_map_.update(current_page_num, FreeSpaceMap::FULL))) {
       break;
     }
-    record_page_handler->cleanup();
-    free_pages_.erase(free_pages_.begin());
   }
-  lock_.unlock();  // 如果找到了一个有效的页面，那么此时已经拿到了页面的写锁
+
+  if (!page_found && ret != RC::SUCCESS && ret != RC::RECORD_EOF) {
+    LOG_WARN("failed to search free space map. rc=%s", strrc(ret));
+    return ret;
+  }
 
   // 找不到就分配一个新的页面
   if (!page_found) {
@@ -602,17 +1693,17 @@ RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
     // frame 在allocate_page的时候，是有一个pin的，在init_empty_page时又会增加一个，所以这里手动释放一个
     frame->unpin();
 
-    // 这里的加锁顺序看起来与上面是相反的，但是不会出现死锁
-    // 上面的逻辑是先加lock锁，然后加页面写锁，这里是先加上
-    // 了页面写锁，然后加lock的锁，但是不会引起死锁。
-    // 为什么？
-    lock_.lock();
-    free_pages_.insert(current_page_num);
-    lock_.unlock();
+    zone_map_.reset_page(current_page_num);
+
+    ret = record_page_handler->insert_record(data, rid);
   }
 
-  // 找到空闲位置
-  return record_page_handler->insert_record(data, rid);
+  if (OB_SUCC(ret)) {
+    // 这时还持有页面写锁，统计信息与页面内容一起修改
+    zone_map_.update(current_page_num, data);
+    update_free_space(*record_page_handler);
+  }
+  return ret;
 }
 
 RC RecordFileHandler::recover_insert_record(const char *data, int record_size, const RID &rid)
@@ -627,7 +1718,12 @@ RC RecordFileHandler::recover_insert_record(const char *data, int record_size, c
     return ret;
   }
 
-  return record_page_handler->recover_insert_record(data, rid);
+  ret = record_page_handler->recover_insert_record(data, rid);
+  if (OB_SUCC(ret)) {
+    zone_map_.update(rid.page_num, data);
+    update_free_space(*record_page_handler);
+  }
+  return ret;
 }
 
 RC RecordFileHandler::delete_record(const RID *rid)
@@ -643,18 +1739,11 @@ RC RecordFileHandler::delete_record(const RID *rid)
   }
 
   rc = record_page_handler->delete_record(rid);
-  // 📢 这里注意要清理掉资源，否则会与insert_record中的加锁顺序冲突而可能出现死锁
-  // delete record的加锁逻辑是拿到页面锁，删除指定记录，然后加上和释放record manager锁
-  // insert record是加上 record manager锁，然后拿到指定页面锁再释放record manager锁
-  record_page_handler->cleanup();
   if (OB_SUCC(rc)) {
-    // 因为这里已经释放了页面锁，并发时，其它线程可能又把该页面填满了，那就不应该再放入 free_pages_
-    // 中。但是这里可以不关心，因为在查找空闲页面时，会自动过滤掉已经满的页面
-    lock_.lock();
-    free_pages_.insert(rid->page_num);
-    LOG_TRACE("add free page %d to free page list", rid->page_num);
-    lock_.unlock();
+    // 还持有页面写锁，其它线程不会同时把这个页面填满
+    update_free_space(*record_page_handler);
   }
+  record_page_handler->cleanup();
   return rc;
 }
 
@@ -702,6 +1791,130 @@ RC RecordFileHandler::visit_record(const RID &rid, function<RC(Record &)> update
   if (rc == RC::SUCCESS) {
     rc = page_handler->update_record(rid, tmp_record.data());
   }
+  if (rc == RC::SUCCESS) {
+    zone_map_.update(rid.page_num, tmp_record.data());
+    // 变长记录的更新会改变页面的空闲空间
+    update_free_space(*page_handler);
+  }
+  return rc;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RecordFileBulkInserter::~RecordFileBulkInserter() { close(); }
+
+RC RecordFileBulkInserter::open(RecordFileHandler &file_handler, int record_size)
+{
+  close();
+
+  file_handler_ = &file_handler;
+  record_size_  = record_size;
+  page_count_   = 0;
+  return RC::SUCCESS;
+}
+
+RC RecordFileBulkInserter::insert_record(const char *data, RID *rid)
+{
+  if (page_handler_ != nullptr && page_handler_->is_full()) {
+    RC rc = finish_page();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  if (page_handler_ == nullptr) {
+    RC rc = new_page();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  RC rc = page_handler_->insert_record(data, rid);
+  if (rc == RC::RECORD_NOMEM) {
+    // PAX 页面中的列是编码存放的，没有满的页面也可能放不下这条记录
+    if (OB_FAIL(rc = finish_page()) || OB_FAIL(rc = new_page())) {
+      return rc;
+    }
+    rc = page_handler_->insert_record(data, rid);
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to insert record into new page. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (!page_zones_.empty()) {
+    file_handler_->zone_map_.add_record(page_zones_, data);
+  }
+  return RC::SUCCESS;
+}
+
+RC RecordFileBulkInserter::delete_record(const RID &rid)
+{
+  if (page_handler_ == nullptr || page_handler_->get_page_num() != rid.page_num) {
+    LOG_WARN("cannot delete record which is not in current page. rid=%s", rid.to_string().c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+  return page_handler_->delete_record(&rid);
+}
+
+RC RecordFileBulkInserter::close()
+{
+  RC rc = RC::SUCCESS;
+  if (page_handler_ != nullptr) {
+    rc = finish_page();
+  }
+  file_handler_ = nullptr;
+  return rc;
+}
+
+RC RecordFileBulkInserter::new_page()
+{
+  DiskBufferPool &buffer_pool = *file_handler_->disk_buffer_pool_;
+
+  Frame *frame = nullptr;
+  RC     rc    = buffer_pool.allocate_page(&frame);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to allocate page while bulk inserting records. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  // 页面初始化和写入记录都不记录日志，写满后一次记录整个页面
+  page_handler_.reset(RecordPageHandler::create(file_handler_->storage_format_));
+  rc = page_handler_->init_empty_page(
+      buffer_pool, vacuous_log_handler_, frame->page_num(), record_size_, file_handler_->table_meta_);
+  frame->unpin();
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page. rc=%s", strrc(rc));
+    page_handler_.reset();
+    return rc;
+  }
+
+  page_zones_.clear();
+  if (file_handler_->zone_map_.enabled()) {
+    file_handler_->zone_map_.init_zones(page_zones_);
+  }
+  return RC::SUCCESS;
+}
+
+RC RecordFileBulkInserter::finish_page()
+{
+  const PageNum page_num = page_handler_->get_page_num();
+
+  RC rc = page_handler_->log_page_image(*file_handler_->log_handler_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to log page image. page num=%d, rc=%s", page_num, strrc(rc));
+  } else {
+    // 还持有页面写锁，统计信息和空闲空间分类与页面内容一起发布
+    if (!page_zones_.empty()) {
+      file_handler_->zone_map_.set_page(page_num, std::move(page_zones_));
+    }
+    file_handler_->update_free_space(*page_handler_);
+    page_count_++;
+  }
+
+  page_zones_.clear();
+  page_handler_->cleanup();
+  page_handler_.reset();
   return rc;
 }
 
@@ -726,12 +1939,15 @@ RC RecordFileScanner::open_scan(Table *table, DiskBufferPool &buffer_pool, Trx *
     return rc;
   }
   condition_filter_ = condition_filter;
-  if (table == nullptr || table->table_meta().storage_format() == StorageFormat::ROW_FORMAT) {
-    record_page_handler_ = new RowRecordPageHandler();
-  } else {
-    record_page_handler_ = new PaxRecordPageHandler();
-  }
+  record_page_handler_ =
+      RecordPageHandler::create(table == nullptr ? StorageFormat::ROW_FORMAT : table->table_meta().storage_format());
 
+  zone_map_ = (table == nullptr || table->record_handler() == nullptr) ? nullptr : &table->record_handler()->zone_map();
+  if (zone_map_ != nullptr && !zone_map_->enabled()) {
+    zone_map_ = nullptr;
+  }
+  scanned_pages_ = 0;
+  skipped_pages_ = 0;
   return rc;
 }
 
@@ -756,31 +1972,97 @@ RC RecordFileScanner::fetch_next_record()
   }
 
   // 上个页面遍历完了，或者还没有开始遍历某个页面，那么就从一个新的页面开始遍历查找
+  while (OB_SUCC(rc = fetch_next_page())) {
+    record_page_iterator_.init(record_page_handler_);
+    rc = fetch_next_record_in_page();
+    if (rc == RC::SUCCESS || rc != RC::RECORD_EOF) {
+      // 有有效记录：RC::SUCCESS
+      // 或者出现了错误，rc != (RC::SUCCESS or RC::RECORD_EOF)
+      // RECORD_EOF 表示当前页面已经遍历完了
+      return rc;
+    }
+  }
+
+  if (rc == RC::RECORD_EOF) {
+    // 所有的页面都遍历完了，没有数据了
+    next_record_.rid().slot_num = -1;
+  }
+  return rc;
+}
+
+RC RecordFileScanner::fetch_next_page()
+{
   while (bp_iterator_.has_next()) {
     PageNum page_num = bp_iterator_.next();
     record_page_handler_->cleanup();
-    rc = record_page_handler_->init(*disk_buffer_pool_, *log_handler_, page_num, rw_mode_);
+    if (zone_map_ != nullptr && !zone_map_->may_match(page_num, zone_filter_)) {
+      skipped_pages_++;
+      continue;
+    }
+
+    RC rc = record_page_handler_->init(*disk_buffer_pool_, *log_handler_, page_num, rw_mode_);
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
     }
+    scanned_pages_++;
 
-    record_page_iterator_.init(record_page_handler_);
-    rc = fetch_next_record_in_page();
-    if (rc == RC::SUCCESS || rc != RC::RECORD_EOF) {
-      // 有有效记录：RC::SUCCESS
-      // 或者出现了错误，rc != (RC::SUCCESS or RC::RECORD_EOF)
-      // RECORD_EOF 表示当前页面已经遍历完了
-      return rc;
+    // 加上页面锁之后再检查，没有统计信息的页面在遍历的同时生成
+    build_zones_ = zone_map_ != nullptr && !zone_map_->has_page(page_num);
+    if (build_zones_) {
+      zone_map_->init_zones(page_zones_);
+      build_id_ = zone_map_->begin_build();
     }
+    return RC::SUCCESS;
   }
 
-  // 所有的页面都遍历完了，没有数据了
-  next_record_.rid().slot_num = -1;
   record_page_handler_->cleanup();
   return RC::RECORD_EOF;
 }
 
+RC RecordFileScanner::next_batch(vector<Record> &records)
+{
+  records.clear();
+
+  RC rc = RC::SUCCESS;
+  while (records.empty()) {
+    rc = fetch_next_page();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    rc = record_page_handler_->get_records(records, batch_buffer_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get records from page. page_num=%d, rc=%s", record_page_handler_->get_page_num(), strrc(rc));
+      return rc;
+    }
+
+    // 页面锁还没有释放，这时生成的统计信息是完整的
+    if (build_zones_) {
+      for (const Record &record : records) {
+        zone_map_->add_record(page_zones_, record.data());
+      }
+      zone_map_->finish_build(record_page_handler_->get_page_num(), std::move(page_zones_), build_id_);
+      build_zones_ = false;
+    }
+
+    if (condition_filter_ != nullptr) {
+      auto iter = std::remove_if(records.begin(), records.end(), [this](const Record &record) {
+        return !condition_filter_->filter(record);
+      });
+      records.erase(iter, records.end());
+    }
+
+    if (trx_ != nullptr && !records.empty()) {
+      rc = trx_->visit_records(table_, records, rw_mode_);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+  }
+  return rc;
+}
+
 /**
  * @brief 遍历当前页面，尝试找到一条有效的记录
  */
@@ -795,6 +2077,10 @@ RC RecordFileScanner::fetch_next_record_in_page()
       return rc;
     }
 
+    if (build_zones_) {
+      zone_map_->add_record(page_zones_, next_record_.data());
+    }
+
     // 如果有过滤条件，就用过滤条件过滤一下
     if (condition_filter_ != nullptr && !condition_filter_->filter(next_record_)) {
       continue;
@@ -816,6 +2102,12 @@ RC RecordFileScanner::fetch_next_record_in_page()
     return rc;
   }
 
+  // 整个页面都遍历过了，页面锁还没有释放，这时生成的统计信息是完整的
+  if (build_zones_) {
+    zone_map_->finish_build(record_page_handler_->get_page_num(), std::move(page_zones_), build_id_);
+    build_zones_ = false;
+  }
+
   next_record_.rid().slot_num = -1;
   return RC::RECORD_EOF;
 }
@@ -830,16 +2122,18 @@ RC RecordFileScanner::close_scan()
     condition_filter_ = nullptr;
   }
 
-  record_page_iterator_.clean_record_page_handler_();
-
-  // if (record_page_handler_ != nullptr) {
-  //   record_page_handler_->cleanup();
-  //   delete record_page_handler_;
-  //   record_page_handler_ = nullptr;
-  // }
+  zone_map_    = nullptr;
+  build_zones_ = false;
+  zone_filter_ = ZoneFilter();
 
-  // // SSQ 需要加上这个才能正常运行。但是不知道会不会导致 memory leak
-  // record_page_iterator_ = RecordPageIterator();
+  // 逐条遍历时 record_page_iterator_ 和扫描器共用 record_page_handler_，由 record_page_iterator_ 释放
+  if (record_page_iterator_.is_valid()) {
+    record_page_iterator_.clean_record_page_handler_();
+  } else if (record_page_handler_ != nullptr) {
+    record_page_handler_->cleanup();
+    delete record_page_handler_;
+  }
+  record_page_handler_ = nullptr;
 
   return RC::SUCCESS;
 }
@@ -861,7 +2155,11 @@ RC RecordFileScanner::update_current(const Record &record)
     return RC::INVALID_ARGUMENT;
   }
 
-  return record_page_handler_->update_record(record.rid(), record.data());
+  RC rc = record_page_handler_->update_record(record.rid(), record.data());
+  if (OB_SUCC(rc) && zone_map_ != nullptr) {
+    zone_map_->update(record.rid().page_num, record.data());
+  }
+  return rc;
 }
 
 ChunkFileScanner::~ChunkFileScanner() { close_scan(); }
@@ -878,6 +2176,8 @@ RC ChunkFileScanner::close_scan()
     record_page_handler_ = nullptr;
   }
 
+  zone_map_    = nullptr;
+  zone_filter_ = ZoneFilter();
   return RC::SUCCESS;
 }
 
@@ -896,12 +2196,15 @@ RC ChunkFileScanner::open_scan_chunk(
     LOG_WARN("failed to init bp iterator. rc=%d:%s", rc, strrc(rc));
     return rc;
   }
-  if (table == nullptr || table->table_meta().storage_format() == StorageFormat::ROW_FORMAT) {
-    record_page_handler_ = new RowRecordPageHandler();
-  } else {
-    record_page_handler_ = new PaxRecordPageHandler();
-  }
+  record_page_handler_ =
+      RecordPageHandler::create(table == nullptr ? StorageFormat::ROW_FORMAT : table->table_meta().storage_format());
 
+  zone_map_ = (table == nullptr || table->record_handler() == nullptr) ? nullptr : &table->record_handler()->zone_map();
+  if (zone_map_ != nullptr && !zone_map_->enabled()) {
+    zone_map_ = nullptr;
+  }
+  scanned_pages_ = 0;
+  skipped_pages_ = 0;
   return rc;
 }
 
@@ -912,11 +2215,17 @@ RC ChunkFileScanner::next_chunk(Chunk &chunk)
   while (bp_iterator_.has_next()) {
     PageNum page_num = bp_iterator_.next();
     record_page_handler_->cleanup();
+    if (zone_map_ != nullptr && !zone_map_->may_match(page_num, zone_filter_)) {
+      skipped_pages_++;
+      continue;
+    }
+
     rc = record_page_handler_->init(*disk_buffer_pool_, *log_handler_, page_num, rw_mode_);
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
     }
+    scanned_pages_++;
     rc = record_page_handler_->get_chunk(chunk);
     if (rc == RC::SUCCESS) {
       return rc;
@@ -931,3 +2240,12 @@ RC ChunkFileScanner::next_chunk(Chunk &chunk)
   record_page_handler_->cleanup();
   return RC::RECORD_EOF;
 }
+
+RC ChunkFileScanner::selected_chunk(Chunk &chunk, const vector<uint8_t> &select)
+{
+  if (record_page_handler_ == nullptr) {
+    LOG_WARN("chunk scanner is not opened");
+    return RC::INTERNAL;
+  }
+  return record_page_handler_->get_selected_chunk(chunk, select);
+}
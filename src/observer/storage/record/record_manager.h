@@ -17,9 +17,13 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/bitmap.h"
 #include "common/lang/sstream.h"
 #include "storage/buffer/disk_buffer_pool.h"
+#include "storage/clog/vacuous_log_handler.h"
 #include "storage/common/chunk.h"
+#include "storage/record/free_space_map.h"
 #include "storage/record/record.h"
 #include "storage/record/record_log.h"
+#include "storage/record/pax_encoding.h"
+#include "storage/record/zone_map.h"
 #include "common/types.h"
 
 class LogHandler;
@@ -156,7 +160,7 @@ public:
    * @param record_size 每个记录的大小
    * @param table_meta  表的元数据
    */
-  RC init_empty_page(
+  virtual RC init_empty_page(
       DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size, TableMeta *table_meta);
 
   /**
@@ -167,7 +171,7 @@ public:
    * @param col_num  表中包含的列数
    * @param col_idx_data 列索引数据
    */
-  RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
+  virtual RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
       int col_num, const char *col_idx_data);
 
   /**
@@ -175,6 +179,12 @@ public:
    */
   RC cleanup();
 
+  /**
+   * @brief 把整个页面的内容记录到日志中
+   * @details 批量插入时页面在内存中写满后调用，代替每条记录的日志，参考 RecordFileBulkInserter
+   */
+  RC log_page_image(LogHandler &log_handler);
+
   /**
    * @brief 插入一条记录
    *
@@ -212,6 +222,15 @@ public:
    */
   virtual RC get_record(const RID &rid, Record &record) { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 获取页面中所有的有效记录，按照槽位顺序放在 records 中
+   *
+   * @param records 获取到的记录
+   * @param buffer  需要拼装记录时用来存放记录数据，记录数据指向这里
+   * 行存格式的记录直接指向页面中的数据，不需要拷贝，在页面释放之前有效。
+   */
+  virtual RC get_records(vector<Record> &records, vector<char> &buffer) { return RC::UNIMPLEMENTED; }
+
   /**
    * @brief 获取整个页面中指定列的所有记录。
    *
@@ -220,6 +239,16 @@ public:
    */
   virtual RC get_chunk(Chunk &chunk) { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 以 Chunk 格式获取页面中被选中的记录
+   *
+   * @param chunk  由 chunk.column(i).col_id() 指定列。
+   * @param select 与 get_chunk 返回的记录一一对应，非 0 表示选中。
+   * @details 用于延迟物化，先用 get_chunk 获取过滤条件用到的列，再只获取满足条件的记录的其它列。
+   * 只需由 PaxRecordPageHandler 实现。
+   */
+  virtual RC get_selected_chunk(Chunk &chunk, const vector<uint8_t> &select) { return RC::UNIMPLEMENTED; }
+
   /**
    * @brief 返回该记录页的页号
    */
@@ -228,7 +257,12 @@ public:
   /**
    * @brief 当前页面是否已经没有空闲位置插入新的记录
    */
-  bool is_full() const;
+  virtual bool is_full() const;
+
+  /**
+   * @brief 页面中还能用来存放新记录的字节数，用来计算页面在空闲空间映射中的分类
+   */
+  virtual int free_space() const;
 
 protected:
   /**
@@ -289,6 +323,7 @@ public:
   RC delete_record(const RID *rid) override;
   RC update_record(const RID &rid, const char *data) override;
   RC get_record(const RID &rid, Record &record) override;
+  RC get_records(vector<Record> &records, vector<char> &buffer) override;
 };
 
 /**
@@ -300,6 +335,16 @@ public:
  * |------------|------------------------| ------------- |
  * | column1 | column2 | ..................... | columnN |
  * @endcode
+ * 每个字段是一列，列号就是字段的 field_id。记录中的 null 位图不是字段，作为最后一个伪列存放，
+ * 所以 page_header_->column_num 是字段数加一（没有 null 位图时就是字段数）。
+ * column index 是 column_num 个 PaxColumnIndex，记录每一列在数据区中的结束位置、在记录中的偏移量和编码方式。
+ *
+ * 每一列在页面内单独选择编码方式（参考 PaxEncoding）：字符串列使用字典编码，定长的数值列使用游程编码，
+ * 其它列不编码。页面的记录容量按照编码后每条记录占用的空间计算，所以编码后一个页面可以存放更多的记录。
+ * 写入的值放不下时（字典满了或者游程太多），先清理不再使用的字典项或者游程，还是放不下就换成更大的字典
+ * 或者不编码，重新计算页面布局。页面布局只取决于页面上操作的顺序，所以恢复时重做日志会得到相同的布局。
+ * @note 重新计算布局后页面容量可能变小，放不下已有的记录时插入和更新会返回 RECORD_NOMEM。插入时会换一个页面，
+ * 更新时当前还不支持把记录迁移到其它页面。
  * 更多细节可参考：docs/design/miniob-pax-storage.md
  */
 class PaxRecordPageHandler : public RecordPageHandler
@@ -307,6 +352,11 @@ class PaxRecordPageHandler : public RecordPageHandler
 public:
   PaxRecordPageHandler() : RecordPageHandler(StorageFormat::PAX_FORMAT) {}
 
+  RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
+      TableMeta *table_meta) override;
+  RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
+      int col_num, const char *col_idx_data) override;
+
   /**
    * @brief 插入一条记录
    *
@@ -316,8 +366,12 @@ public:
    */
   virtual RC insert_record(const char *data, RID *rid) override;
 
+  virtual RC recover_insert_record(const char *data, const RID &rid) override;
+
   virtual RC delete_record(const RID *rid) override;
 
+  virtual RC update_record(const RID &rid, const char *data) override;
+
   /**
    * @brief 获取指定位置的记录数据
    *
@@ -327,20 +381,191 @@ public:
    */
   virtual RC get_record(const RID &rid, Record &record) override;
 
+  /**
+   * @brief 获取页面中所有的有效记录，每条记录都需要从各列拼装，数据放在 buffer 中
+   */
+  RC get_records(vector<Record> &records, vector<char> &buffer) override;
+
   /**
    * @brief 以 Chunk 格式获取整个页面中指定列的所有记录。
    *
    * @param chunk 由 chunk.column(i).col_id() 指定列。
+   * @details 如果页面上的有效记录是从第一个槽位开始连续存放的，Column 直接引用页面上的列数据，不做拷贝，
+   * 这时 chunk 中的数据只在页面没有释放（即 RecordPageHandler::cleanup 之前）时有效。
+   * 否则按照位图跳过删除的记录，把连续的有效记录段拷贝到 Column 自己的内存中。
    */
   virtual RC get_chunk(Chunk &chunk) override;
 
+  /**
+   * @brief 以 Chunk 格式获取页面中被选中的记录，数据总是拷贝到 Column 自己的内存中
+   */
+  virtual RC get_selected_chunk(Chunk &chunk, const vector<uint8_t> &select) override;
+
+  /// 一个页面最多存放的记录数，所有列都编码后每条记录占用的空间可能很小
+  static constexpr int MAX_RECORD_CAPACITY = 4096;
+
+  /// 选择编码时字典最多占用的空间
+  static constexpr int MAX_DICTIONARY_SIZE = BP_PAGE_DATA_SIZE / 4;
+
+  /// 游程编码的列可以存放的游程个数
+  static int run_length_capacity(int field_len) { return (BP_PAGE_DATA_SIZE / 16) / (field_len + sizeof(uint16_t)); }
+
+private:
+  /**
+   * @brief 按照 columns 计算页面布局并初始化各列的数据区，记录的位图会清空
+   * @return 页面可以存放的记录数
+   */
+  int init_page_layout(int record_size, const vector<PaxColumnIndex> &columns);
+
+  /**
+   * @brief 按照 columns 计算页面可以存放的记录数
+   */
+  static int page_capacity(const vector<PaxColumnIndex> &columns);
+
+  /**
+   * @brief 确保一条记录可以写入指定的槽位，必要时清理编码或者换一种编码并重新布局
+   * @details 返回成功时，write_record_data 一定可以写入这条记录
+   */
+  RC reserve(SlotNum slot_num, const char *data);
+
+  /**
+   * @brief 使用新的列编码重新布局页面，已有的记录保持在原来的槽位上
+   * @details 新的布局放不下已有的记录或者指定的槽位时返回 RECORD_NOMEM，页面不会有任何修改
+   */
+  RC relayout(const vector<PaxColumnIndex> &columns, SlotNum slot_num);
+
+  /// 检查 Column 与页面上的列是否匹配
+  RC check_column(const Column &column, int col_id) const;
+
+  /// 准备好 Column 自己的内存用来存放 row_num 条记录，字典编码的列设置好字典
+  void prepare_column(Column &column, int col_id, int row_num) const;
+
+  /// 把槽位 [start, end) 中某一列的数据追加到 Column 中，这些槽位都需要是有效记录
+  RC append_column_data(Column &column, int col_id, SlotNum start, SlotNum end) const;
+
+  /**
+   * @brief 从 null 位图列中取出某一列在 ranges 中各个槽位的 null 标记，设置到 Column 的 null 位图中
+   * @details 游程编码的 null 位图列按游程整段设置，所有值都不为 null 时 Column 不会分配 null 位图
+   */
+  void append_column_nulls(Column &column, int col_id, const vector<pair<SlotNum, SlotNum>> &ranges) const;
+
+  /// 列在记录的 null 位图中对应的位，事务字段等没有对应的位时返回 -1
+  int null_bit(int col_id) const;
+
+  // split the record by columns and write them into the slot
+  void write_record_data(SlotNum slot_num, const char *data);
+
+  // assemble the record of the slot from columns
+  void read_record_data(SlotNum slot_num, char *data);
+
+  PaxColumnIndex *column_index() const
+  {
+    return reinterpret_cast<PaxColumnIndex *>(frame_->data() + page_header_->col_idx_offset);
+  }
+
+  // get the data area of the column by `column id`
+  char *get_column_area(int col_id) const;
+
+  // get the field data by `slot_num` and `column id`, only for columns without encoding
+  char *get_field_data(SlotNum slot_num, int col_id) const;
+};
+/**
+ * @brief 负责处理变长记录格式（slotted page）的页面中各种操作
+ * @ingroup RecordManager
+ * @details 定长记录格式下，CHAR(255) 的字段即使只存了3个字符，也要占用255字节。
+ * 这里在页面内把字符串字段按照实际长度存放，读取时再还原成定长的记录格式，上层看到的记录格式不变。
+ * 页面的组织大概是这样的：
+ * @code
+ * | PageHeader | record allocate bitmap | column index | SlottedPageHeader |
+ * |------------|------------------------|--------------|-------------------|
+ * | slot1 | slot2 | ... slotN | -> free space <- | tupleN | ... | tuple2 | tuple1 |
+ * @endcode
+ * - column index 中记录了变长字段在记录中的偏移量和长度，每个字段两个 int，page_header_->column_num
+ *   是变长字段的个数；
+ * - 槽位目录（slot directory）从前往后增长，每个槽位记录对应的数据在页面中的偏移量和长度；
+ * - 数据从页面末尾往前增长。字符串字段存放为2字节的长度加上实际的字符，其它字段原样存放。
+ * RID 中的 slot num 就是槽位目录中的下标，数据在页面内移动时只需要修改槽位，RID 保持不变。
+ * 删除或者更新变短后留下的空洞不会立即整理，在需要空间时再把所有数据紧凑到页面末尾。
+ * 页面中剩余的空间不足以放下一条最长的记录时就认为页面满了，所以插入一定能成功。
+ * 另外每个页面会额外预留 UPDATE_RESERVED_SPACE 的空间给原地更新使用，类似 InnoDB 在页面中留出 1/16 的空间。
+ * @note 更新时如果记录变长了而页面中空间不够，会返回 RECORD_NOMEM，当前还不支持把记录迁移到其它页面
+ */
+class SlottedRecordPageHandler : public RecordPageHandler
+{
+public:
+  SlottedRecordPageHandler() : RecordPageHandler(StorageFormat::SLOTTED_FORMAT) {}
+
+  RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
+      TableMeta *table_meta) override;
+  RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
+      int col_num, const char *col_idx_data) override;
+
+  RC insert_record(const char *data, RID *rid) override;
+  RC recover_insert_record(const char *data, const RID &rid) override;
+  RC delete_record(const RID *rid) override;
+  RC update_record(const RID &rid, const char *data) override;
+  RC get_record(const RID &rid, Record &record) override;
+  RC get_records(vector<Record> &records, vector<char> &buffer) override;
+
+  bool is_full() const override;
+  int  free_space() const override;
+
+  /// 插入时在页面中预留给记录变长的更新使用的空间
+  static constexpr int UPDATE_RESERVED_SPACE = BP_PAGE_DATA_SIZE / 16;
+
 private:
-  // get the field data by `slot_num` and `column id`
-  char *get_field_data(SlotNum slot_num, int col_id);
+  /**
+   * @brief 槽位目录中的一项
+   */
+  struct Slot
+  {
+    uint16_t offset;  ///< 数据在页面中的偏移量
+    uint16_t length;  ///< 数据长度
+  };
+
+  /**
+   * @brief 变长页面额外的页头信息
+   */
+  struct SlottedPageHeader
+  {
+    int32_t slot_num;       ///< 槽位目录中的槽位个数，包括空闲的槽位
+    int32_t heap_offset;    ///< 数据区的起始位置，数据从页面末尾往前增长
+    int32_t garbage_bytes;  ///< 删除或更新留下的空洞大小
+  };
+
+  RC init_page_layout(int record_size, int var_field_num, const int *var_fields);
+
+  SlottedPageHeader *slotted_header() const
+  {
+    return reinterpret_cast<SlottedPageHeader *>(frame_->data() + page_header_->data_offset) - 1;
+  }
+  Slot *slots() const { return reinterpret_cast<Slot *>(frame_->data() + page_header_->data_offset); }
+  const int *var_fields() const { return reinterpret_cast<const int *>(frame_->data() + page_header_->col_idx_offset); }
+
+  /// 槽位目录末尾与数据区之间连续的空闲空间
+  int contiguous_free_space() const;
+  /// 一条记录编码后的最大长度
+  int max_tuple_size() const { return page_header_->record_real_size + page_header_->column_num * sizeof(uint16_t); }
+
+  /**
+   * @brief 把记录编码后写入指定的槽位，槽位原来的数据会被覆盖
+   */
+  RC write_tuple(SlotNum slot_num, const char *data);
+
+  int  encode(const char *record, char *tuple) const;
+  void decode(const char *tuple, char *record) const;
+
+  /**
+   * @brief 在数据区分配指定长度的空间，空间不够时先整理页面
+   * @return 分配到的偏移量，空间不够返回 -1
+   */
+  int  allocate(int length);
+  void compact();
 
-  // get the field length by `column id`, all columns are fixed length.
-  int get_field_len(int col_id);
+  /// 在槽位目录末尾增加一个空的槽位
+  void grow_slots();
 };
+
 /**
  * @brief 管理整个文件中记录的增删改查
  * @ingroup RecordManager
@@ -359,6 +584,13 @@ public:
    */
   RC init(DiskBufferPool &buffer_pool, LogHandler &log_handler, TableMeta *table_meta);
 
+  /**
+   * @brief 打开空闲空间映射，插入记录之前必须打开
+   *
+   * @param fsm_buffer_pool 记录每个页面空闲空间的文件
+   */
+  RC init_free_space_map(DiskBufferPool &fsm_buffer_pool);
+
   /**
    * @brief 关闭，做一些资源清理的工作
    */
@@ -393,19 +625,85 @@ public:
 
   RC visit_record(const RID &rid, function<RC(Record &)> updater);
 
+  /**
+   * @brief 每个页面的统计信息，扫描时用来跳过页面
+   */
+  ZoneMap       &zone_map() { return zone_map_; }
+  const ZoneMap &zone_map() const { return zone_map_; }
+
+  /**
+   * @brief 每个页面的空闲空间，插入时用来查找没有满的页面
+   */
+  FreeSpaceMap &free_space_map() { return free_space_map_; }
+
 private:
+  friend class RecordFileBulkInserter;
+
   /**
-   * @brief 初始化当前没有填满记录的页面，初始化free_pages_成员
+   * @brief 页面修改后，在还持有页面写锁时更新页面在空闲空间映射中的分类
+   * @details 同一张表中所有记录的最大长度相同，所以没有满的页面一定能放下一条新记录，分类至少是1
    */
-  RC init_free_pages();
+  void update_free_space(const RecordPageHandler &page_handler);
 
 private:
-  DiskBufferPool        *disk_buffer_pool_ = nullptr;
-  LogHandler            *log_handler_      = nullptr;  ///< 记录日志的处理器
-  unordered_set<PageNum> free_pages_;                  ///< 没有填充满的页面集合
-  common::Mutex          lock_;  ///< 当编译时增加-DCONCURRENCY=ON 选项时，才会真正的支持并发
-  StorageFormat          storage_format_;
-  TableMeta             *table_meta_;
+  DiskBufferPool *disk_buffer_pool_ = nullptr;
+  LogHandler     *log_handler_      = nullptr;  ///< 记录日志的处理器
+  FreeSpaceMap    free_space_map_;
+  StorageFormat   storage_format_;
+  TableMeta      *table_meta_;
+  ZoneMap         zone_map_;
+};
+
+/**
+ * @brief 向记录文件中批量插入记录
+ * @ingroup RecordManager
+ * @details 记录只追加到新分配的页面中，不查找空闲空间映射。页面在内存中写满以后记录一条整页镜像日志，
+ * 而不是每条记录一条日志，同时生成页面的统计信息和空闲空间分类。
+ * 正在写入的页面一直持有写锁，其它线程的插入不会用到这个页面，扫描到这个页面时会等待页面写满。
+ * 记录不经过事务，也不维护索引，由调用者负责。适合导入数据等一次插入大量记录的场景。
+ */
+class RecordFileBulkInserter
+{
+public:
+  RecordFileBulkInserter() = default;
+  ~RecordFileBulkInserter();
+
+  /**
+   * @param file_handler 插入到哪个记录文件，需要已经打开了空闲空间映射
+   * @param record_size  记录大小
+   */
+  RC open(RecordFileHandler &file_handler, int record_size);
+
+  /**
+   * @brief 插入一条记录，当前页面写满以后换一个新的页面
+   */
+  RC insert_record(const char *data, RID *rid);
+
+  /**
+   * @brief 删除刚刚插入的记录，只能删除还在当前页面中的记录
+   * @details 插入索引失败时用来回滚，当前页面还没有记录日志，删除时也不需要记录
+   */
+  RC delete_record(const RID &rid);
+
+  /**
+   * @brief 写出最后一个页面，没有写满的页面可以继续用来插入普通的记录
+   */
+  RC close();
+
+  /// 插入过程中写满的页面个数
+  int64_t page_count() const { return page_count_; }
+
+private:
+  RC new_page();
+  RC finish_page();
+
+private:
+  RecordFileHandler            *file_handler_ = nullptr;
+  int                           record_size_  = 0;
+  VacuousLogHandler             vacuous_log_handler_;  ///< 写满之前不记录日志
+  unique_ptr<RecordPageHandler> page_handler_;         ///< 正在写入的页面，没有时为空
+  vector<ColumnZone>            page_zones_;           ///< 正在写入的页面的统计信息
+  int64_t                       page_count_ = 0;
 };
 
 /**
@@ -443,14 +741,37 @@ public:
    */
   RC next(Record &record);
 
+  /**
+   * @brief 获取下一个页面中所有满足条件并且对当前事务可见的记录
+   * @details 每次处理一个页面，过滤条件和事务可见性都在一个循环中批量判断，跳过没有满足条件记录的页面。
+   * 行存格式的记录直接指向页面中的数据，在下一次调用 next_batch 或者关闭扫描之前有效，需要保留记录的话要自己拷贝。
+   * 不要和 next 混合使用。
+   * @param records 返回的记录，没有更多记录时返回 RECORD_EOF
+   */
+  RC next_batch(vector<Record> &records);
+
   RC update_current(const Record &record);
 
+  /**
+   * @brief 设置跳过页面的条件，需要在 open_scan 之后调用
+   * @details 根据页面的统计信息判断页面中一定没有满足条件的记录时，直接跳过这个页面
+   */
+  void set_zone_filter(ZoneFilter &&zone_filter) { zone_filter_ = std::move(zone_filter); }
+
+  int64_t scanned_pages() const { return scanned_pages_; }
+  int64_t skipped_pages() const { return skipped_pages_; }
+
 private:
   /**
    * @brief 获取该文件中的下一条记录
    */
   RC fetch_next_record();
 
+  /**
+   * @brief 打开下一个需要遍历的页面，跳过 zone map 判断没有满足条件记录的页面
+   */
+  RC fetch_next_page();
+
   /**
    * @brief 获取一个页面内的下一条记录
    */
@@ -470,6 +791,15 @@ private:
   RecordPageHandler *record_page_handler_ = nullptr;  ///< 处理文件某页面的记录
   RecordPageIterator record_page_iterator_;           ///< 遍历某个页面上的所有record
   Record             next_record_;                    ///< 获取的记录放在这里缓存起来
+  vector<char>       batch_buffer_;                   ///< 批量获取记录时，需要拼装的记录数据放在这里
+
+  ZoneMap           *zone_map_ = nullptr;  ///< 表的 zone map，没有关联表时为空
+  ZoneFilter         zone_filter_;          ///< 用来跳过页面的条件
+  bool               build_zones_ = false;  ///< 当前页面没有统计信息，遍历完时生成
+  uint64_t           build_id_    = 0;
+  vector<ColumnZone> page_zones_;           ///< 当前页面正在生成的统计信息
+  int64_t            scanned_pages_ = 0;
+  int64_t            skipped_pages_ = 0;
 };
 
 /**
@@ -496,6 +826,21 @@ public:
    */
   RC next_chunk(Chunk &chunk);
 
+  /**
+   * @brief 获取上一次 next_chunk 返回的页面中被选中的记录的其它列
+   * @param select 与上一次 next_chunk 返回的记录一一对应，非 0 表示选中
+   */
+  RC selected_chunk(Chunk &chunk, const vector<uint8_t> &select);
+
+  /**
+   * @brief 设置跳过页面的条件，参考 RecordFileScanner::set_zone_filter
+   * @details 这里按列读取数据，不会为没有统计信息的页面生成统计信息
+   */
+  void set_zone_filter(ZoneFilter &&zone_filter) { zone_filter_ = std::move(zone_filter); }
+
+  int64_t scanned_pages() const { return scanned_pages_; }
+  int64_t skipped_pages() const { return skipped_pages_; }
+
 private:
   Table *table_ = nullptr;  ///< 当前遍历的是哪张表。
 
@@ -505,4 +850,9 @@ private:
 
   BufferPoolIterator bp_iterator_;                    ///< 遍历buffer pool的所有页面
   RecordPageHandler *record_page_handler_ = nullptr;  ///< 处理文件某页面的记录
+
+  const ZoneMap *zone_map_ = nullptr;
+  ZoneFilter     zone_filter_;
+  int64_t        scanned_pages_ = 0;
+  int64_t        skipped_pages_ = 0;
 };
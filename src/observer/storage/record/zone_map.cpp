@@ -0,0 +1,430 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/record/zone_map.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/bitmap.h"
+#include "common/lang/fstream.h"
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+#include "storage/record/record_manager.h"
+#include "storage/table/table.h"
+
+namespace {
+
+constexpr int32_t ZONE_MAP_MAGIC = 0x5a4d4150;  // "ZMAP"
+
+bool zone_supported_type(AttrType type)
+{
+  return type == AttrType::INTS || type == AttrType::FLOATS || type == AttrType::DATES || type == AttrType::CHARS;
+}
+
+/// 字段和常量比较的结果与字段值的大小顺序一致时，才能用最小值、最大值判断
+bool zone_comparable(AttrType field_type, AttrType value_type)
+{
+  if (field_type == value_type) {
+    return true;
+  }
+  auto numeric = [](AttrType type) { return type == AttrType::INTS || type == AttrType::FLOATS; };
+  return numeric(field_type) && numeric(value_type);
+}
+
+/// 把 `常量 op 字段` 转换成 `字段 op' 常量`
+CompOp reverse_comp(CompOp comp)
+{
+  switch (comp) {
+    case CompOp::LESS_THAN: return CompOp::GREAT_THAN;
+    case CompOp::LESS_EQUAL: return CompOp::GREAT_EQUAL;
+    case CompOp::GREAT_THAN: return CompOp::LESS_THAN;
+    case CompOp::GREAT_EQUAL: return CompOp::LESS_EQUAL;
+    default: return comp;
+  }
+}
+
+}  // namespace
+
+void ColumnZone::update(const Value &value)
+{
+  if (value.is_null()) {
+    null_count++;
+    return;
+  }
+
+  if (value_count == 0 || value.compare(min_value) < 0) {
+    min_value = value;
+  }
+  if (value_count == 0 || value.compare(max_value) > 0) {
+    max_value = value;
+  }
+  value_count++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ZoneFilter::init(const Table *table, const vector<unique_ptr<Expression>> &predicates, bool is_or_conjunction)
+{
+  predicates_.clear();
+  if (is_or_conjunction || table == nullptr || table->record_handler() == nullptr) {
+    return;
+  }
+
+  const ZoneMap &zone_map = table->record_handler()->zone_map();
+  if (!zone_map.enabled()) {
+    return;
+  }
+
+  auto field_column = [&zone_map, table](Expression *expr) -> int {
+    if (expr->type() != ExprType::FIELD) {
+      return -1;
+    }
+    const Field &field = static_cast<FieldExpr *>(expr)->field();
+    if (field.table() != table) {
+      return -1;
+    }
+    return zone_map.column_of(field.meta());
+  };
+
+  vector<Expression *> exprs;
+  for (const unique_ptr<Expression> &predicate : predicates) {
+    exprs.push_back(predicate.get());
+  }
+
+  while (!exprs.empty()) {
+    Expression *expr = exprs.back();
+    exprs.pop_back();
+
+    if (expr->type() == ExprType::CONJUNCTION) {
+      auto *conjunction = static_cast<ConjunctionExpr *>(expr);
+      if (conjunction->conjunction_type() == ConjunctionExpr::Type::AND) {
+        for (unique_ptr<Expression> &child : conjunction->children()) {
+          exprs.push_back(child.get());
+        }
+      }
+    } else if (expr->type() == ExprType::IS) {
+      auto *is_expr = static_cast<IsExpr *>(expr);
+      int   column  = field_column(is_expr->left().get());
+      if (column >= 0 && is_expr->right()->type() == ExprType::VALUE &&
+          static_cast<ValueExpr *>(is_expr->right().get())->get_value().is_null()) {
+        add(column, is_expr->comp(), Value::NullValue());
+      }
+    } else if (expr->type() == ExprType::COMPARISON) {
+      auto *comparison = static_cast<ComparisonExpr *>(expr);
+      CompOp comp      = comparison->comp();
+      if (comp != CompOp::EQUAL_TO && comp != CompOp::NOT_EQUAL && comp != CompOp::LESS_THAN &&
+          comp != CompOp::LESS_EQUAL && comp != CompOp::GREAT_THAN && comp != CompOp::GREAT_EQUAL) {
+        continue;
+      }
+
+      Expression *field_expr = comparison->left().get();
+      Expression *value_expr = comparison->right().get();
+      if (field_expr->type() == ExprType::VALUE) {
+        std::swap(field_expr, value_expr);
+        comp = reverse_comp(comp);
+      }
+
+      int column = field_column(field_expr);
+      if (column < 0 || value_expr->type() != ExprType::VALUE) {
+        continue;
+      }
+      const Value &value = static_cast<ValueExpr *>(value_expr)->get_value();
+      if (value.is_null() || !zone_comparable(static_cast<FieldExpr *>(field_expr)->field().attr_type(),
+                                 value.attr_type())) {
+        continue;
+      }
+      add(column, comp, value);
+    }
+  }
+}
+
+void ZoneFilter::add(int column, CompOp comp, const Value &value) { predicates_.push_back({column, comp, value}); }
+
+bool ZoneFilter::may_match(const vector<ColumnZone> &zones) const
+{
+  for (const Predicate &predicate : predicates_) {
+    if (predicate.column >= static_cast<int>(zones.size())) {
+      continue;
+    }
+    if (!may_match(zones[predicate.column], predicate)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ZoneFilter::may_match(const ColumnZone &zone, const Predicate &predicate)
+{
+  if (predicate.comp == CompOp::IS) {
+    return zone.null_count > 0;
+  }
+  if (predicate.comp == CompOp::NOT_IS) {
+    return zone.value_count > 0;
+  }
+
+  // 空值与任何值比较都不成立
+  if (zone.value_count == 0) {
+    return false;
+  }
+
+  const int cmp_min = zone.min_value.compare(predicate.value);
+  const int cmp_max = zone.max_value.compare(predicate.value);
+  if (cmp_min == INT32_MAX || cmp_max == INT32_MAX) {
+    return true;
+  }
+
+  switch (predicate.comp) {
+    case CompOp::EQUAL_TO: return cmp_min <= 0 && cmp_max >= 0;
+    case CompOp::NOT_EQUAL: return !(cmp_min == 0 && cmp_max == 0);
+    case CompOp::LESS_THAN: return cmp_min < 0;
+    case CompOp::LESS_EQUAL: return cmp_min <= 0;
+    case CompOp::GREAT_THAN: return cmp_max > 0;
+    case CompOp::GREAT_EQUAL: return cmp_max >= 0;
+    default: return true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ZoneMap::init(const TableMeta *table_meta)
+{
+  table_meta_ = table_meta;
+  fields_.clear();
+  pages_.clear();
+  if (table_meta == nullptr) {
+    return;
+  }
+
+  for (int i = 0; i < table_meta->field_num(); i++) {
+    const FieldMeta *field = table_meta->field(i);
+    if (field->visible() && zone_supported_type(field->type())) {
+      fields_.push_back(i);
+    }
+  }
+}
+
+int ZoneMap::column_of(const FieldMeta *field) const
+{
+  for (size_t i = 0; i < fields_.size(); i++) {
+    if (field_meta(static_cast<int>(i))->field_id() == field->field_id()) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+void ZoneMap::reset_page(PageNum page_num)
+{
+  if (!enabled()) {
+    return;
+  }
+
+  vector<ColumnZone> zones;
+  init_zones(zones);
+  set_page(page_num, std::move(zones));
+}
+
+void ZoneMap::update(PageNum page_num, const char *record)
+{
+  if (!enabled()) {
+    return;
+  }
+
+  lock_.lock();
+  auto iter = pages_.find(page_num);
+  if (iter != pages_.end()) {
+    add_record(iter->second, record);
+  } else {
+    unknown_updates_++;
+  }
+  lock_.unlock();
+}
+
+void ZoneMap::set_page(PageNum page_num, vector<ColumnZone> &&zones)
+{
+  lock_.lock();
+  pages_[page_num] = std::move(zones);
+  lock_.unlock();
+}
+
+uint64_t ZoneMap::begin_build() const
+{
+  lock_.lock_shared();
+  uint64_t build_id = unknown_updates_;
+  lock_.unlock_shared();
+  return build_id;
+}
+
+void ZoneMap::finish_build(PageNum page_num, vector<ColumnZone> &&zones, uint64_t build_id)
+{
+  lock_.lock();
+  if (build_id == unknown_updates_) {
+    pages_.emplace(page_num, std::move(zones));
+  }
+  lock_.unlock();
+}
+
+bool ZoneMap::has_page(PageNum page_num) const
+{
+  lock_.lock_shared();
+  bool found = pages_.find(page_num) != pages_.end();
+  lock_.unlock_shared();
+  return found;
+}
+
+bool ZoneMap::may_match(PageNum page_num, const ZoneFilter &filter) const
+{
+  if (filter.empty()) {
+    return true;
+  }
+
+  lock_.lock_shared();
+  auto iter   = pages_.find(page_num);
+  bool result = (iter == pages_.end()) || filter.may_match(iter->second);
+  lock_.unlock_shared();
+  return result;
+}
+
+void ZoneMap::add_record(vector<ColumnZone> &zones, const char *record) const
+{
+  for (size_t i = 0; i < fields_.size() && i < zones.size(); i++) {
+    Value value;
+    get_value(record, static_cast<int>(i), value);
+    zones[i].update(value);
+  }
+}
+
+const FieldMeta *ZoneMap::field_meta(int column) const { return table_meta_->field(fields_[column]); }
+
+void ZoneMap::get_value(const char *record, int column, Value &value) const
+{
+  const FieldMeta *field = field_meta(column);
+  if (field->nullable()) {
+    // 与 Table::set_value_to_record 中设置空值的方式保持一致
+    common::Bitmap null_bitmap(const_cast<char *>(record) + table_meta_->null_bitmap_start(), table_meta_->field_num());
+    if (null_bitmap.get_bit(field->field_id() - table_meta_->sys_field_num())) {
+      value.set_null();
+      return;
+    }
+  }
+
+  value.set_type(field->type());
+  value.set_data(record + field->offset(), field->len());
+}
+
+RC ZoneMap::load(const string &file_name)
+{
+  if (!enabled()) {
+    return RC::SUCCESS;
+  }
+
+  ifstream fs(file_name, ios::in | ios::binary);
+  if (!fs.is_open()) {
+    LOG_INFO("no zone map file, all pages will be summarized while scanning. file=%s", file_name.c_str());
+    return RC::SUCCESS;
+  }
+
+  auto read_int = [&fs](int32_t &value) { return static_cast<bool>(fs.read(reinterpret_cast<char *>(&value), sizeof(value))); };
+
+  unordered_map<PageNum, vector<ColumnZone>> pages;
+
+  int32_t magic = 0, column_num = 0, page_count = 0;
+  bool    ok    = read_int(magic) && read_int(column_num) && read_int(page_count) && magic == ZONE_MAP_MAGIC &&
+            column_num == static_cast<int32_t>(fields_.size());
+  vector<char> buffer;
+  for (int32_t p = 0; ok && p < page_count; p++) {
+    int32_t page_num = 0;
+    ok               = read_int(page_num);
+
+    vector<ColumnZone> zones(fields_.size());
+    for (size_t i = 0; ok && i < fields_.size(); i++) {
+      ColumnZone &zone = zones[i];
+      ok               = read_int(zone.value_count) && read_int(zone.null_count);
+      if (ok && zone.value_count > 0) {
+        const FieldMeta *field = field_meta(static_cast<int>(i));
+        buffer.resize(field->len() * 2);
+        ok = static_cast<bool>(fs.read(buffer.data(), buffer.size()));
+        zone.min_value.set_type(field->type());
+        zone.min_value.set_data(buffer.data(), field->len());
+        zone.max_value.set_type(field->type());
+        zone.max_value.set_data(buffer.data() + field->len(), field->len());
+      }
+    }
+    pages[page_num] = std::move(zones);
+  }
+  fs.close();
+
+  // 统计信息只在表正常关闭时写入，读取后就删除，异常退出后不会用到过时的统计信息
+  if (::remove(file_name.c_str()) != 0) {
+    LOG_WARN("failed to remove zone map file. file=%s, errmsg=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+
+  if (!ok) {
+    LOG_WARN("invalid zone map file, ignore it. file=%s", file_name.c_str());
+    return RC::SUCCESS;
+  }
+
+  lock_.lock();
+  pages_.swap(pages);
+  lock_.unlock();
+  LOG_INFO("load zone map done. file=%s, pages=%d", file_name.c_str(), page_count);
+  return RC::SUCCESS;
+}
+
+RC ZoneMap::save(const string &file_name) const
+{
+  if (!enabled()) {
+    return RC::SUCCESS;
+  }
+
+  string   tmp_file = file_name + ".tmp";
+  ofstream fs(tmp_file, ios::out | ios::binary | ios::trunc);
+  if (!fs.is_open()) {
+    LOG_WARN("failed to open zone map file. file=%s, errmsg=%s", tmp_file.c_str(), strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+
+  auto write_int = [&fs](int32_t value) { fs.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
+
+  lock_.lock_shared();
+  write_int(ZONE_MAP_MAGIC);
+  write_int(static_cast<int32_t>(fields_.size()));
+  write_int(static_cast<int32_t>(pages_.size()));
+  vector<char> buffer;
+  for (const auto &[page_num, zones] : pages_) {
+    write_int(page_num);
+    for (size_t i = 0; i < fields_.size(); i++) {
+      const ColumnZone &zone = zones[i];
+      write_int(zone.value_count);
+      write_int(zone.null_count);
+      if (zone.value_count > 0) {
+        const int len = field_meta(static_cast<int>(i))->len();
+        buffer.assign(len * 2, 0);
+        memcpy(buffer.data(), zone.min_value.data(), min(zone.min_value.length(), len));
+        memcpy(buffer.data() + len, zone.max_value.data(), min(zone.max_value.length(), len));
+        fs.write(buffer.data(), buffer.size());
+      }
+    }
+  }
+  const size_t page_count = pages_.size();
+  lock_.unlock_shared();
+
+  fs.close();
+  if (fs.fail()) {
+    LOG_WARN("failed to write zone map file. file=%s", tmp_file.c_str());
+    return RC::IOERR_WRITE;
+  }
+
+  if (rename(tmp_file.c_str(), file_name.c_str()) != 0) {
+    LOG_WARN("failed to rename zone map file. file=%s, errmsg=%s", file_name.c_str(), strerror(errno));
+    return RC::IOERR_WRITE;
+  }
+  LOG_INFO("save zone map done. file=%s, pages=%d", file_name.c_str(), page_count);
+  return RC::SUCCESS;
+}
@@ -0,0 +1,158 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
+#include "common/rc.h"
+#include "common/types.h"
+#include "common/value.h"
+#include "sql/parser/parse_defs.h"
+
+class Expression;
+class FieldMeta;
+class Table;
+class TableMeta;
+
+/**
+ * @brief 一个页面中某一列的统计信息
+ * @ingroup RecordManager
+ * @details 只会随着插入和更新变宽，删除记录时不会收缩，所以总是能覆盖页面上所有的记录，
+ * 包括已经删除但是还没有回收的多版本记录。
+ */
+struct ColumnZone
+{
+  Value   min_value;
+  Value   max_value;
+  int32_t value_count = 0;  ///< 非空值的个数，为0时 min_value/max_value 没有意义
+  int32_t null_count  = 0;  ///< 空值的个数
+
+  void update(const Value &value);
+};
+
+/**
+ * @brief 可以用 zone map 判断的过滤条件
+ * @ingroup RecordManager
+ * @details 只支持 `字段 比较运算 常量` 形式的条件，多个条件之间是 AND 关系。
+ * 其它条件不会放进来，所以页面被跳过只说明这里的条件一定不满足，不会影响原有的过滤逻辑。
+ */
+class ZoneFilter
+{
+public:
+  struct Predicate
+  {
+    int    column;  ///< 在 ZoneMap 中的列号
+    CompOp comp;
+    Value  value;
+  };
+
+public:
+  /**
+   * @brief 从表扫描算子上的过滤条件中找出能够用来跳过页面的条件
+   * @param is_or_conjunction 条件之间是否是 OR 关系，这时无法跳过任何页面
+   */
+  void init(const Table *table, const vector<unique_ptr<Expression>> &predicates, bool is_or_conjunction);
+
+  void add(int column, CompOp comp, const Value &value);
+
+  bool empty() const { return predicates_.empty(); }
+
+  /**
+   * @brief 根据页面的统计信息判断页面中是否可能有满足条件的记录
+   */
+  bool may_match(const vector<ColumnZone> &zones) const;
+
+private:
+  static bool may_match(const ColumnZone &zone, const Predicate &predicate);
+
+private:
+  vector<Predicate> predicates_;
+};
+
+/**
+ * @brief 记录文件中每个页面每一列的最小值、最大值和空值个数
+ * @ingroup RecordManager
+ * @details 表扫描时可以用来跳过那些一定没有满足条件的记录的页面。
+ * 插入、更新记录时在持有页面写锁的情况下更新统计信息，顺序扫描完整个页面时在持有页面读锁的情况下
+ * 重新生成统计信息，所以统计信息与页面内容的修改不会交错。没有统计信息的页面不能跳过。
+ *
+ * 统计信息只在表正常关闭时保存到数据文件旁边的文件中，打开表时读取后立即删除这个文件。
+ * 如果数据库异常退出，重启时没有这个文件，日志回放后的页面都没有统计信息，后面扫描时再逐渐生成。
+ * 只统计 INT、FLOAT、DATE 和 CHAR 类型的字段，事务字段不统计。
+ */
+class ZoneMap
+{
+public:
+  ZoneMap()  = default;
+  ~ZoneMap() = default;
+
+  void init(const TableMeta *table_meta);
+
+  /**
+   * @brief 字段在 zone map 中的列号，不统计的字段返回-1
+   */
+  int column_of(const FieldMeta *field) const;
+
+  /// 一个新的空页面，统计信息是已知的
+  void reset_page(PageNum page_num);
+
+  /// 页面中新增或修改了一条记录，没有统计信息的页面保持未知
+  void update(PageNum page_num, const char *record);
+
+  /// 直接设置页面的统计信息，调用者需要持有页面锁
+  void set_page(PageNum page_num, vector<ColumnZone> &&zones);
+
+  /**
+   * @brief 开始遍历一个没有统计信息的页面，返回的标识在发布统计信息时使用
+   */
+  uint64_t begin_build() const;
+
+  /**
+   * @brief 发布遍历整个页面生成的统计信息
+   * @details 调用者需要持有页面锁。遍历期间如果有没有统计信息的页面被修改了（比如同一个线程中
+   * 更新算子修改了刚刚遍历过的记录），生成的统计信息可能是不完整的，这时放弃，下次扫描时再生成。
+   */
+  void finish_build(PageNum page_num, vector<ColumnZone> &&zones, uint64_t build_id);
+
+  bool has_page(PageNum page_num) const;
+
+  /// 页面中是否可能有满足条件的记录，没有统计信息时总是返回 true
+  bool may_match(PageNum page_num, const ZoneFilter &filter) const;
+
+  /// 生成一个空页面的统计信息，然后可以通过 add_record 逐条加入记录
+  void init_zones(vector<ColumnZone> &zones) const { zones.assign(fields_.size(), ColumnZone()); }
+  void add_record(vector<ColumnZone> &zones, const char *record) const;
+
+  /**
+   * @brief 从文件中加载统计信息，加载后删除文件
+   * @details 文件不存在或者格式不对时，所有的页面都没有统计信息
+   */
+  RC load(const string &file_name);
+  RC save(const string &file_name) const;
+
+  bool enabled() const { return !fields_.empty(); }
+
+private:
+  void get_value(const char *record, int column, Value &value) const;
+
+  /// 创建索引等操作会替换 TableMeta 中的字段数组，所以每次都从 TableMeta 中取字段
+  const FieldMeta *field_meta(int column) const;
+
+private:
+  const TableMeta                           *table_meta_ = nullptr;
+  vector<int>                                fields_;  ///< 统计了哪些字段，是字段在 TableMeta 中的下标
+  mutable common::SharedMutex                lock_;
+  unordered_map<PageNum, vector<ColumnZone>> pages_;
+  uint64_t                                   unknown_updates_ = 0;  ///< 没有统计信息的页面被修改的次数
+};
@@ -21,6 +21,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/span.h"
 #include "common/lang/algorithm.h"
 #include "common/lang/bitmap.h"
+#include "common/lang/filesystem.h"
 #include "common/log/log.h"
 #include "common/global_context.h"
 #include "storage/db/db.h"
@@ -31,6 +32,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/index/index.h"
 #include "storage/record/record_manager.h"
 #include "storage/table/table.h"
+#include "storage/table/text_data_manager.h"
 #include "storage/table/vector_data_manager.h"
 #include "storage/index/vector_index_meta.h"
 #include "storage/index/vector_index.h"
@@ -40,6 +42,10 @@ See the Mulan PSL v2 for more details. */
 Table::~Table()
 {
   if (record_handler_ != nullptr) {
+    // 表被删除时 data_buffer_pool_ 已经关闭，不需要保存 zone map
+    if (data_buffer_pool_ != nullptr) {
+      record_handler_->zone_map().save(table_zone_map_file(base_dir_.c_str(), name()));
+    }
     delete record_handler_;
     record_handler_ = nullptr;
   }
@@ -49,6 +55,11 @@ Table::~Table()
     data_buffer_pool_ = nullptr;
   }
 
+  if (fsm_buffer_pool_ != nullptr) {
+    fsm_buffer_pool_->close_file();
+    fsm_buffer_pool_ = nullptr;
+  }
+
   for (vector<Index *>::iterator it = indexes_.begin(); it != indexes_.end(); ++it) {
     Index *index = *it;
     delete index;
@@ -114,21 +125,6 @@ RC Table::create(Db *db, int32_t table_id, const char *path, const char *name, c
   db_       = db;
   base_dir_ = base_dir;
 
-  bool has_text = std::any_of(
-      attributes.begin(), attributes.end(), [](AttrInfoSqlNode attr) { return attr.type == AttrType::TEXTS; });
-  if (has_text) {
-    std::string text_file = table_text_data_file(base_dir, name);
-    fd                    = ::open(text_file.c_str(), O_CREAT | O_EXCL | O_CLOEXEC, 0600);
-    if (fd < 0) {
-      if (EEXIST == errno) {
-        LOG_ERROR("Failed to create text data file, it has been created. %s, EEXIST, %s", text_file.c_str(), strerror(errno));
-        return RC::SCHEMA_TABLE_EXIST;
-      }
-      LOG_ERROR("Create text data file failed. filename=%s, errmsg=%d:%s", text_file.c_str(), errno, strerror(errno));
-      return RC::IOERR_OPEN;
-    }
-    close(fd);
-  }
   bool has_vector = std::any_of(
       attributes.begin(), attributes.end(), [](AttrInfoSqlNode attr) { return attr.type == AttrType::VECTORS; });
   if (has_vector) {
@@ -154,6 +150,25 @@ RC Table::create(Db *db, int32_t table_id, const char *path, const char *name, c
     return rc;
   }
 
+  string fsm_file = table_fsm_file(base_dir, name);
+  rc              = bpm.create_file(fsm_file.c_str());
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to create disk buffer pool of free space map file. file name=%s", fsm_file.c_str());
+    return rc;
+  }
+
+  bool has_text = std::any_of(
+      attributes.begin(), attributes.end(), [](AttrInfoSqlNode attr) { return attr.type == AttrType::TEXTS; });
+  if (has_text) {
+    string text_file     = table_text_data_file(base_dir, name);
+    string text_fsm_file = table_text_fsm_file(base_dir, name);
+    rc                   = TextDataManager::create(bpm, text_file.c_str(), text_fsm_file.c_str());
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to create text data file. file name=%s", text_file.c_str());
+      return rc;
+    }
+  }
+
   rc = init_record_handler(base_dir);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to create table %s due to init record handler failed.", data_file.c_str());
@@ -161,6 +176,13 @@ RC Table::create(Db *db, int32_t table_id, const char *path, const char *name, c
     return rc;
   }
 
+  if (has_text) {
+    rc = init_text_data_manager();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+
   LOG_INFO("Successfully create table %s:%s", base_dir, name);
   return rc;
 }
@@ -171,9 +193,20 @@ RC Table::drop(Db *db, const char *table_name, const char *base_dir)
   std::string meta_file_path = table_meta_file(base_dir, table_name);
   std::string text_file_path   = table_text_data_file(base_dir_.c_str(), table_meta_.name());
   std::string vector_file_path = table_vector_data_file(base_dir_.c_str(), table_meta_.name());
+  std::string zone_map_file_path = table_zone_map_file(base_dir_.c_str(), table_meta_.name());
+  std::string fsm_file_path      = table_fsm_file(base_dir_.c_str(), table_meta_.name());
+  std::string text_fsm_file_path = table_text_fsm_file(base_dir_.c_str(), table_meta_.name());
   // TODO: delete index
   data_buffer_pool_->close_file();
   data_buffer_pool_ = nullptr;  // 防止析构函数中再次尝试关闭文件
+  if (fsm_buffer_pool_ != nullptr) {
+    fsm_buffer_pool_->close_file();
+    fsm_buffer_pool_ = nullptr;
+  }
+  if (text_data_manager_ != nullptr) {
+    text_data_manager_->close();
+    text_data_manager_.reset();
+  }
   if (unlink(meta_file_path.c_str()) == -1) {
     LOG_ERROR("Failed to remove table metadata file for %s due to %s", meta_file_path.c_str(), strerror(errno));
     return RC::INTERNAL;
@@ -188,12 +221,30 @@ RC Table::drop(Db *db, const char *table_name, const char *base_dir)
       return RC::INTERNAL;
     }
   }
+  if (unlink(text_fsm_file_path.c_str()) == -1) {
+    if (errno != ENOENT) {
+      LOG_ERROR("Failed to remove text free space map file for %s due to %s", meta_file_path.c_str(), strerror(errno));
+      return RC::INTERNAL;
+    }
+  }
   if (unlink(vector_file_path.c_str()) == -1) {
     if (errno != ENOENT) {
       LOG_ERROR("Failed to remove vector data file for %s due to %s", meta_file_path.c_str(), strerror(errno));
       return RC::INTERNAL;
     }
   }
+  if (unlink(zone_map_file_path.c_str()) == -1) {
+    if (errno != ENOENT) {
+      LOG_ERROR("Failed to remove zone map file for %s due to %s", meta_file_path.c_str(), strerror(errno));
+      return RC::INTERNAL;
+    }
+  }
+  if (unlink(fsm_file_path.c_str()) == -1) {
+    if (errno != ENOENT) {
+      LOG_ERROR("Failed to remove free space map file for %s due to %s", meta_file_path.c_str(), strerror(errno));
+      return RC::INTERNAL;
+    }
+  }
   return RC::SUCCESS;
 }
 
@@ -245,6 +296,15 @@ RC Table::open(Db *db, const char *meta_file, const char *base_dir)
   }
 
   auto field_metas = table_meta_.field_metas();
+  bool has_text    = std::any_of(
+      field_metas->begin(), field_metas->end(), [](FieldMeta attr) { return attr.type() == AttrType::TEXTS; });
+  if (has_text) {
+    rc = init_text_data_manager();
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+  }
+
   bool has_vector  = std::any_of(
       field_metas->begin(), field_metas->end(), [](FieldMeta attr) { return attr.type() == AttrType::VECTORS; });
   if (has_vector) {
@@ -260,6 +320,7 @@ RC Table::insert_record(Record &record)
   rc    = record_handler_->insert_record(record.data(), table_meta_.record_size(), &record.rid());
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Insert record failed. table name=%s, rc=%s", table_meta_.name(), strrc(rc));
+    delete_texts(record.data());
     return rc;
   }
 
@@ -270,13 +331,131 @@ RC Table::insert_record(Record &record)
       LOG_PANIC("Failed to rollback record data when insert index entries failed. table name=%s, rc=%d:%s",
                 name(), rc2, strrc(rc2));
     }
+    delete_texts(record.data());
   }
   return rc;
 }
 
+RC Table::bulk_insert_records(function<RC(Record &)> next_record, bool defer_index, int64_t &record_count)
+{
+  record_count = 0;
+
+  RecordFileBulkInserter inserter;
+  RC                     rc = inserter.open(*record_handler_, table_meta_.record_size());
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  const bool  maintain_index = !indexes_.empty() && !defer_index;
+  vector<RID> deferred_rids;
+  Record      record;
+  while (OB_SUCC(rc = next_record(record))) {
+    rc = inserter.insert_record(record.data(), &record.rid());
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Bulk insert record failed. table name=%s, rc=%s", table_meta_.name(), strrc(rc));
+      delete_texts(record.data());
+      break;
+    }
+
+    if (maintain_index) {
+      rc = insert_entry_of_indexes(record.data(), record.rid());
+      if (OB_FAIL(rc)) {  // 可能出现了键值重复
+        RC rc2 = delete_entry_of_indexes(record.data(), record.rid(), false /*error_on_not_exists*/);
+        if (OB_FAIL(rc2)) {
+          LOG_ERROR("Failed to rollback index data when insert index entries failed. table name=%s, rc=%s",
+                    name(), strrc(rc2));
+        }
+        rc2 = inserter.delete_record(record.rid());
+        if (OB_FAIL(rc2)) {
+          LOG_PANIC("Failed to rollback record data when insert index entries failed. table name=%s, rc=%s",
+                    name(), strrc(rc2));
+        }
+        delete_texts(record.data());
+        break;
+      }
+    } else if (!indexes_.empty()) {
+      deferred_rids.push_back(record.rid());
+    }
+    record_count++;
+  }
+
+  RC close_rc = inserter.close();
+  if (rc == RC::RECORD_EOF) {
+    rc = close_rc;
+  }
+
+  // 页面都已经写出，逐条补上索引项。某条记录插入索引失败时，它和之后的记录都会被删除
+  RC index_rc = RC::SUCCESS;
+  for (size_t i = 0; i < deferred_rids.size(); i++) {
+    const RID &rid = deferred_rids[i];
+    if (OB_SUCC(index_rc)) {
+      Record loaded_record;
+      index_rc = record_handler_->get_record(rid, loaded_record);
+      if (OB_SUCC(index_rc)) {
+        index_rc = insert_entry_of_indexes(loaded_record.data(), rid);
+        if (OB_FAIL(index_rc)) {
+          delete_entry_of_indexes(loaded_record.data(), rid, false /*error_on_not_exists*/);
+        }
+      }
+      if (OB_SUCC(index_rc)) {
+        continue;
+      }
+      LOG_WARN("failed to insert index entries of bulk inserted record. table=%s, rid=%s, rc=%s",
+               name(), rid.to_string().c_str(), strrc(index_rc));
+      record_count = static_cast<int64_t>(i);
+    }
+
+    RC rc2 = record_handler_->delete_record(&rid);
+    if (OB_FAIL(rc2)) {
+      LOG_PANIC("Failed to rollback record data when insert index entries failed. table name=%s, rc=%s",
+                name(), strrc(rc2));
+    }
+  }
+  return OB_SUCC(rc) ? index_rc : rc;
+}
+
 RC Table::visit_record(const RID &rid, function<RC(Record &)> visitor)
 {
-  return record_handler_->visit_record(rid, visitor);
+  if (text_data_manager_ == nullptr) {
+    return record_handler_->visit_record(rid, visitor);
+  }
+
+  // 原地更新 text 字段时新的文本已经写入了 text 数据文件，根据更新的结果释放旧的或者新的文本
+  vector<char> old_data;
+  vector<char> new_data;
+  RC rc = record_handler_->visit_record(rid, [&visitor, &old_data, &new_data](Record &record) {
+    old_data.assign(record.data(), record.data() + record.len());
+    RC rc = visitor(record);
+    new_data.assign(record.data(), record.data() + record.len());
+    return rc;
+  });
+  if (old_data.empty() || new_data.empty()) {
+    return rc;
+  }
+
+  common::Bitmap old_bitmap(old_data.data() + table_meta_.null_bitmap_start(), table_meta_.field_num());
+  common::Bitmap new_bitmap(new_data.data() + table_meta_.null_bitmap_start(), table_meta_.field_num());
+  for (const FieldMeta &field : *table_meta_.field_metas()) {
+    if (field.type() != AttrType::TEXTS) {
+      continue;
+    }
+    const int null_bit = field.field_id() - table_meta_.sys_field_num();
+    TextData  old_text, new_text;
+    memcpy(&old_text, old_data.data() + field.offset(), field.len());
+    memcpy(&new_text, new_data.data() + field.offset(), field.len());
+    const bool old_valid = !old_bitmap.get_bit(null_bit);
+    const bool new_valid = !new_bitmap.get_bit(null_bit);
+    if (old_valid && new_valid && old_text.offset == new_text.offset && old_text.len == new_text.len) {
+      continue;
+    }
+
+    if (OB_SUCC(rc) && old_valid) {
+      text_data_manager_->delete_text(old_text);
+    } else if (OB_FAIL(rc) && new_valid) {
+      text_data_manager_->delete_text(new_text);
+    }
+  }
+  return rc;
 }
 
 RC Table::get_record(const RID &rid, Record &record)
@@ -410,6 +589,60 @@ RC Table::init_record_handler(const char *base_dir)
     return rc;
   }
 
+  // zone map 只是用来加速扫描的，加载失败时所有页面都没有统计信息，不影响表的打开
+  record_handler_->zone_map().load(table_zone_map_file(base_dir, table_meta_.name()));
+
+  // 以前创建的表没有空闲空间映射文件，等所有的表都打开后再创建
+  if (filesystem::exists(table_fsm_file(base_dir, table_meta_.name()))) {
+    rc = init_free_space_map();
+  }
+  return rc;
+}
+
+RC Table::init_free_space_map()
+{
+  if (fsm_buffer_pool_ != nullptr || record_handler_ == nullptr) {
+    return RC::SUCCESS;
+  }
+
+  string             fsm_file = table_fsm_file(base_dir_.c_str(), table_meta_.name());
+  BufferPoolManager &bpm      = db_->buffer_pool_manager();
+  RC                 rc       = RC::SUCCESS;
+  if (!filesystem::exists(fsm_file)) {
+    LOG_INFO("create free space map file for table %s", name());
+    rc = bpm.create_file(fsm_file.c_str());
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to create free space map file. file name=%s, rc=%s", fsm_file.c_str(), strrc(rc));
+      return rc;
+    }
+  }
+
+  rc = bpm.open_file(db_->log_handler(), fsm_file.c_str(), fsm_buffer_pool_);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to open disk buffer pool for file:%s. rc=%s", fsm_file.c_str(), strrc(rc));
+    return rc;
+  }
+
+  rc = record_handler_->init_free_space_map(*fsm_buffer_pool_);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init free space map. table=%s, rc=%s", name(), strrc(rc));
+    fsm_buffer_pool_->close_file();
+    fsm_buffer_pool_ = nullptr;
+  }
+  return rc;
+}
+
+RC Table::init_text_data_manager()
+{
+  string text_file     = table_text_data_file(base_dir_.c_str(), table_meta_.name());
+  string text_fsm_file = table_text_fsm_file(base_dir_.c_str(), table_meta_.name());
+
+  text_data_manager_ = make_unique<TextDataManager>();
+  RC rc = text_data_manager_->open(db_->buffer_pool_manager(), db_->log_handler(), text_file.c_str(), text_fsm_file.c_str());
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to open text data file. table=%s, file=%s, rc=%s", name(), text_file.c_str(), strrc(rc));
+    text_data_manager_.reset();
+  }
   return rc;
 }
 
@@ -566,9 +799,32 @@ RC Table::delete_record(const Record &record)
            name(), index->index_meta().name().c_str(), record.rid().to_string().c_str(), strrc(rc));
   }
   rc = record_handler_->delete_record(&record.rid());
+  if (OB_SUCC(rc)) {
+    delete_texts(record.data());
+  }
   return rc;
 }
 
+void Table::delete_texts(const char *record_data)
+{
+  if (text_data_manager_ == nullptr) {
+    return;
+  }
+
+  common::Bitmap bitmap(record_data + table_meta_.null_bitmap_start(), table_meta_.field_num());
+  for (const FieldMeta &field : *table_meta_.field_metas()) {
+    if (field.type() != AttrType::TEXTS || bitmap.get_bit(field.field_id() - table_meta_.sys_field_num())) {
+      continue;
+    }
+    TextData text_data;
+    memcpy(&text_data, record_data + field.offset(), field.len());
+    RC rc = text_data_manager_->delete_text(text_data);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to delete text data. table=%s, field=%s, rc=%s", name(), field.name(), strrc(rc));
+    }
+  }
+}
+
 RC Table::insert_entry_of_indexes(const char *record, const RID &rid)
 {
   RC rc = RC::SUCCESS;
@@ -633,6 +889,12 @@ RC Table::sync()
   }
 
   rc = data_buffer_pool_->flush_all_pages();
+  if (OB_SUCC(rc) && fsm_buffer_pool_ != nullptr) {
+    rc = fsm_buffer_pool_->flush_all_pages();
+  }
+  if (OB_SUCC(rc) && text_data_manager_ != nullptr) {
+    rc = text_data_manager_->sync();
+  }
   LOG_INFO("Sync table over. table=%s", name());
   return rc;
 }
@@ -666,49 +928,13 @@ RC Table::update_index(const Record &old_record, const Record &new_record, const
 
 RC Table::load_text(TextData *data) const
 {
-  std::string text_file = text_data_file();
-  int         fd        = ::open(text_file.c_str(), O_RDONLY);
-  if (fd < 0) {
-    LOG_WARN("failed to open table text data file %s: %s", text_file.c_str(), strerror(errno));
-    return RC::IOERR_OPEN;
-  }
-  lseek(fd, data->offset, SEEK_SET);
-  size_t offset = 0;
-  auto   buffer = new char[data->len + 1];
-  while (offset < data->len) {
-    size_t readed = read(fd, buffer + offset, data->len - offset);
-    if (readed < 0) {
-      LOG_WARN("failed to read text data: %s", strerror(errno));
-    }
-    offset += readed;
-  }
-  close(fd);
-  buffer[data->len] = '\0';
-  data->str         = buffer;
-  return RC::SUCCESS;
+  ASSERT(text_data_manager_ != nullptr, "table %s has no text attribute", this->name());
+  return text_data_manager_->load_text(data);
 }
 RC Table::dump_text(TextData *data) const
 {
-  // 在文件末尾追加写入 text
-  std::string text_file = text_data_file();
-  int         fd        = ::open(text_file.c_str(), O_RDWR);
-  if (fd < 0) {
-    LOG_WARN("failed to open table text data file %s: %s", text_file.c_str(), strerror(errno));
-    return RC::IOERR_OPEN;
-  }
-  size_t end    = lseek(fd, 0, SEEK_END);
-  size_t offset = 0;
-  while (offset < data->len) {
-    size_t writed = write(fd, data->str + offset, data->len - offset);
-    if (writed < 0) {
-      LOG_WARN("failed to write text data %s", strerror(errno));
-      return RC::IOERR_WRITE;
-    }
-    offset += writed;
-  }
-  close(fd);
-  data->offset = end;
-  return RC::SUCCESS;
+  ASSERT(text_data_manager_ != nullptr, "table %s has no text attribute", this->name());
+  return text_data_manager_->dump_text(data);
 }
 
 RC Table::load_vector(VectorData *data) const
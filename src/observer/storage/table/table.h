@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "storage/table/text_data_manager.h"
 #include "storage/table/vector_data_manager.h"
 #include "storage/table/table_meta.h"
 #include "common/types.h"
@@ -66,6 +67,13 @@ public:
    */
   RC open(Db *db, const char *meta_file, const char *base_dir);
 
+  /**
+   * @brief 打开空闲空间映射文件，文件不存在时创建
+   * @details 以前创建的表没有这个文件。创建文件时会分配新的 buffer pool 编号，
+   * 为了不与还没有打开的文件冲突，需要在所有的表都打开之后再调用
+   */
+  RC init_free_space_map();
+
   /**
    * @brief 根据给定的字段生成一个记录/行
    * @details 通常是由用户传过来的字段，按照schema信息组装成一个record。
@@ -81,6 +89,16 @@ public:
    * @param record[in/out] 传入的数据包含具体的数据，插入成功会通过此字段返回RID
    */
   RC insert_record(Record &record);
+
+  /**
+   * @brief 批量插入记录
+   * @details 记录追加到新分配的页面中，每个页面写满后记录一条整页镜像日志，参考 RecordFileBulkInserter。
+   * 与 insert_record 一样不关心事务。任何一条记录插入失败都会停止插入，之前插入的记录会保留下来。
+   * @param next_record   生成下一条要插入的记录，没有更多记录时返回 RC::RECORD_EOF
+   * @param defer_index   是否在所有记录插入完成以后再统一插入索引项，而不是每插入一条记录就插入一次
+   * @param record_count  返回成功插入的记录数
+   */
+  RC bulk_insert_records(function<RC(Record &)> next_record, bool defer_index, int64_t &record_count);
   RC delete_record(const Record &record);
 
   RC delete_record(const RID &rid);
@@ -104,7 +122,8 @@ public:
 
   /**
    * @brief 可以在页面锁保护的情况下访问记录
-   * @details 当前是在事务中访问记录，为了提供一个“原子性”的访问模式
+   * @details 当前是在事务中访问记录，为了提供一个“原子性”的访问模式。
+   * visitor 修改了 text 字段时，记录更新成功后会释放旧的文本，失败时释放新写入的文本
    * @param rid
    * @param visitor
    * @return RC
@@ -126,8 +145,12 @@ private:
   RC delete_entry_of_indexes(const char *record, const RID &rid, bool error_on_not_exists);
   RC set_value_to_record(char *record_data, const Value &value, const FieldMeta *field);
 
+  /// 释放记录中 text 字段占用的空间，记录被物理删除或者插入失败时调用
+  void delete_texts(const char *record_data);
+
 private:
   RC init_record_handler(const char *base_dir);
+  RC init_text_data_manager();
 
 public:
   Index *find_index(const char *index_name) const;
@@ -161,10 +184,12 @@ protected:
   string             base_dir_;
   TableMeta          table_meta_;
   DiskBufferPool    *data_buffer_pool_ = nullptr;  /// 数据文件关联的buffer pool
+  DiskBufferPool    *fsm_buffer_pool_  = nullptr;  /// 空闲空间映射文件关联的buffer pool
   RecordFileHandler *record_handler_   = nullptr;  /// 记录操作
   vector<Index *>    indexes_;
   std::vector<VectorIndex *> vector_indexes_;
 
+  std::unique_ptr<TextDataManager>   text_data_manager_;
   std::unique_ptr<VectorDataManager> vector_data_manager_;
 
   bool is_outer_table_ = false; // 子查询用。判断是否是外层查询的表
@@ -0,0 +1,242 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/table/text_data_manager.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/vector.h"
+#include "common/log/log.h"
+#include "sql/parser/parse_defs.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/record/record_manager.h"
+
+using namespace common;
+
+namespace {
+// 分片记录中各个字段的下标
+constexpr int NEXT_PAGE_FIELD = 0;
+constexpr int NEXT_SLOT_FIELD = 1;
+constexpr int DATA_FIELD      = 2;
+}  // namespace
+
+TextDataManager::~TextDataManager() { close(); }
+
+RC TextDataManager::create(BufferPoolManager &bpm, const char *data_file, const char *fsm_file)
+{
+  RC rc = bpm.create_file(data_file);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to create text data file. file name=%s, rc=%s", data_file, strrc(rc));
+    return rc;
+  }
+  rc = bpm.create_file(fsm_file);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to create free space map file of text data. file name=%s, rc=%s", fsm_file, strrc(rc));
+  }
+  return rc;
+}
+
+RC TextDataManager::open(BufferPoolManager &bpm, LogHandler &log_handler, const char *data_file, const char *fsm_file)
+{
+  if (record_handler_ != nullptr) {
+    LOG_ERROR("text data file has been opened. file name=%s", data_file);
+    return RC::RECORD_OPENNED;
+  }
+
+  vector<AttrInfoSqlNode> attributes = {
+      {AttrType::INTS, "next_page", 1, 0, false},
+      {AttrType::INTS, "next_slot", 1, 0, false},
+      {AttrType::CHARS, "data", CHUNK_SIZE, 0, false},
+  };
+  RC rc = chunk_meta_.init(-1, "text_chunk", nullptr /*trx_fields*/, attributes, StorageFormat::SLOTTED_FORMAT);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init meta of text chunk. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = bpm.open_file(log_handler, data_file, data_buffer_pool_);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to open text data file. file name=%s, rc=%s", data_file, strrc(rc));
+    return rc;
+  }
+
+  rc = bpm.open_file(log_handler, fsm_file, fsm_buffer_pool_);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to open free space map file of text data. file name=%s, rc=%s", fsm_file, strrc(rc));
+    close();
+    return rc;
+  }
+
+  log_handler_    = &log_handler;
+  record_handler_ = make_unique<RecordFileHandler>(StorageFormat::SLOTTED_FORMAT);
+  rc              = record_handler_->init(*data_buffer_pool_, log_handler, &chunk_meta_);
+  if (OB_SUCC(rc)) {
+    rc = record_handler_->init_free_space_map(*fsm_buffer_pool_);
+  }
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init record handler of text data. file name=%s, rc=%s", data_file, strrc(rc));
+    close();
+    return rc;
+  }
+
+  LOG_INFO("open text data file done. file name=%s", data_file);
+  return RC::SUCCESS;
+}
+
+void TextDataManager::close()
+{
+  if (record_handler_ != nullptr) {
+    record_handler_->close();
+    record_handler_.reset();
+  }
+  if (data_buffer_pool_ != nullptr) {
+    data_buffer_pool_->close_file();
+    data_buffer_pool_ = nullptr;
+  }
+  if (fsm_buffer_pool_ != nullptr) {
+    fsm_buffer_pool_->close_file();
+    fsm_buffer_pool_ = nullptr;
+  }
+  log_handler_ = nullptr;
+}
+
+RC TextDataManager::sync()
+{
+  RC rc = data_buffer_pool_->flush_all_pages();
+  if (OB_SUCC(rc)) {
+    rc = fsm_buffer_pool_->flush_all_pages();
+  }
+  return rc;
+}
+
+size_t TextDataManager::rid_to_offset(const RID &rid)
+{
+  return (static_cast<size_t>(rid.page_num) << 32) | static_cast<uint32_t>(rid.slot_num);
+}
+
+RID TextDataManager::offset_to_rid(size_t offset)
+{
+  return RID(static_cast<PageNum>(offset >> 32), static_cast<SlotNum>(offset & 0xFFFFFFFF));
+}
+
+RC TextDataManager::load_text(TextData *data)
+{
+  auto buffer       = new char[data->len + 1];
+  buffer[data->len] = '\0';
+
+  // 顺序写入的分片通常在同一个页面中，页面相同时不需要重新加锁
+  const int next_page_offset = chunk_meta_.field(NEXT_PAGE_FIELD)->offset();
+  const int next_slot_offset = chunk_meta_.field(NEXT_SLOT_FIELD)->offset();
+  const int data_offset      = chunk_meta_.field(DATA_FIELD)->offset();
+
+  unique_ptr<RecordPageHandler> page_handler(RecordPageHandler::create(StorageFormat::SLOTTED_FORMAT));
+  PageNum current_page = BP_INVALID_PAGE_NUM;
+  RID     rid          = offset_to_rid(data->offset);
+  RC      rc           = RC::SUCCESS;
+  Record  chunk;
+  for (size_t pos = 0; pos < data->len; pos += CHUNK_SIZE) {
+    if (rid.page_num != current_page) {
+      page_handler->cleanup();
+      rc = page_handler->init(*data_buffer_pool_, *log_handler_, rid.page_num, ReadWriteMode::READ_ONLY);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to init page handler of text data. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+        break;
+      }
+      current_page = rid.page_num;
+    }
+
+    rc = page_handler->get_record(rid, chunk);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get text chunk. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+      break;
+    }
+
+    const size_t chunk_len = std::min<size_t>(CHUNK_SIZE, data->len - pos);
+    memcpy(buffer + pos, chunk.data() + data_offset, chunk_len);
+    memcpy(&rid.page_num, chunk.data() + next_page_offset, sizeof(rid.page_num));
+    memcpy(&rid.slot_num, chunk.data() + next_slot_offset, sizeof(rid.slot_num));
+  }
+
+  if (OB_FAIL(rc)) {
+    delete[] buffer;
+    return rc;
+  }
+  data->str = buffer;
+  return RC::SUCCESS;
+}
+
+RC TextDataManager::dump_text(TextData *data)
+{
+  data->offset = 0;
+  if (data->len == 0) {
+    return RC::SUCCESS;
+  }
+
+  const int next_page_offset = chunk_meta_.field(NEXT_PAGE_FIELD)->offset();
+  const int next_slot_offset = chunk_meta_.field(NEXT_SLOT_FIELD)->offset();
+  const int data_offset      = chunk_meta_.field(DATA_FIELD)->offset();
+
+  // 从最后一个分片开始插入，这样每个分片插入时都已经知道下一个分片的位置
+  vector<char> chunk(chunk_meta_.record_size());
+  RID          next_rid(BP_INVALID_PAGE_NUM, -1);
+  const size_t chunk_num = (data->len + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  for (size_t i = chunk_num; i > 0; i--) {
+    const size_t pos       = (i - 1) * CHUNK_SIZE;
+    const size_t chunk_len = std::min<size_t>(CHUNK_SIZE, data->len - pos);
+
+    memset(chunk.data(), 0, chunk.size());
+    memcpy(chunk.data() + next_page_offset, &next_rid.page_num, sizeof(next_rid.page_num));
+    memcpy(chunk.data() + next_slot_offset, &next_rid.slot_num, sizeof(next_rid.slot_num));
+    memcpy(chunk.data() + data_offset, data->str + pos, chunk_len);
+
+    RID rid;
+    RC  rc = record_handler_->insert_record(chunk.data(), chunk_meta_.record_size(), &rid);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to insert text chunk. rc=%s", strrc(rc));
+      if (next_rid.page_num != BP_INVALID_PAGE_NUM) {
+        delete_chunks(next_rid);
+      }
+      return rc;
+    }
+    next_rid = rid;
+  }
+
+  data->offset = rid_to_offset(next_rid);
+  return RC::SUCCESS;
+}
+
+RC TextDataManager::delete_text(const TextData &data)
+{
+  if (data.len == 0) {
+    return RC::SUCCESS;
+  }
+  return delete_chunks(offset_to_rid(data.offset));
+}
+
+RC TextDataManager::delete_chunks(RID rid)
+{
+  const int next_page_offset = chunk_meta_.field(NEXT_PAGE_FIELD)->offset();
+  const int next_slot_offset = chunk_meta_.field(NEXT_SLOT_FIELD)->offset();
+
+  RC     rc = RC::SUCCESS;
+  Record chunk;
+  while (rid.page_num != BP_INVALID_PAGE_NUM) {
+    rc = record_handler_->get_record(rid, chunk);
+    if (OB_SUCC(rc)) {
+      rc = record_handler_->delete_record(&rid);
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to delete text chunk. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+
+    memcpy(&rid.page_num, chunk.data() + next_page_offset, sizeof(rid.page_num));
+    memcpy(&rid.slot_num, chunk.data() + next_slot_offset, sizeof(rid.slot_num));
+  }
+  return rc;
+}
@@ -0,0 +1,89 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/memory.h"
+#include "common/rc.h"
+#include "common/type/attr_type.h"
+#include "storage/index/vector_index_meta.h"
+#include "storage/record/record_manager.h"
+#include "storage/table/table_meta.h"
+
+class BufferPoolManager;
+class DiskBufferPool;
+class LogHandler;
+
+/**
+ * @brief 管理表中 text 字段的数据
+ * @ingroup RecordManager
+ * @details 记录中只保存 TextData 的 offset 和 len，文本内容存放在单独的 text 数据文件中。
+ * 参考 PostgreSQL 的 TOAST，文本按照 CHUNK_SIZE 切分成多个分片，每个分片作为一条记录存放在变长记录格式
+ * （SLOTTED_FORMAT）的记录文件中，分片之间通过 RID 串成链表，TextData.offset 就是第一个分片的 RID。
+ * 这样 text 数据文件和表的数据文件一样通过 buffer pool 读写并记录 WAL，
+ * 删除文本后留下的空间也会通过空闲空间映射重新利用。
+ * 分片记录的格式是 (next_page int, next_slot int, data char(CHUNK_SIZE))，最后一个分片的 next_page 是 -1。
+ * 字符串字段在页面中按照实际长度存放，所以很短的文本也只占用很少的空间。
+ * @note 文本中不能包含 '\0'，变长记录格式按照 C 字符串计算字段的实际长度
+ */
+class TextDataManager
+{
+public:
+  /// 每个分片存放的文本长度，与 PostgreSQL 类似，一个页面可以放下多个完整的分片
+  static constexpr int CHUNK_SIZE = 2000;
+
+  TextDataManager() = default;
+  ~TextDataManager();
+
+  /**
+   * @brief 创建 text 数据文件和它的空闲空间映射文件
+   */
+  static RC create(BufferPoolManager &bpm, const char *data_file, const char *fsm_file);
+
+  /**
+   * @brief 打开 text 数据文件，文件会一直保持打开直到调用 close
+   */
+  RC open(BufferPoolManager &bpm, LogHandler &log_handler, const char *data_file, const char *fsm_file);
+  void close();
+
+  /// 把 text 数据文件中的脏页刷到磁盘
+  RC sync();
+
+  /**
+   * @brief 读取文本
+   * @details 根据 data->offset 和 data->len 读取文本，data->str 指向新分配的内存，以 '\0' 结尾，由调用者释放
+   */
+  RC load_text(TextData *data);
+
+  /**
+   * @brief 保存文本
+   * @details 保存 data->str 开始的 data->len 个字符，成功后 data->offset 记录文本的位置
+   */
+  RC dump_text(TextData *data);
+
+  /**
+   * @brief 删除文本，释放它占用的空间
+   */
+  RC delete_text(const TextData &data);
+
+  /// 文本的位置和第一个分片的 RID 相互转换
+  static size_t rid_to_offset(const RID &rid);
+  static RID    offset_to_rid(size_t offset);
+
+private:
+  RC delete_chunks(RID rid);
+
+private:
+  DiskBufferPool               *data_buffer_pool_ = nullptr;
+  DiskBufferPool               *fsm_buffer_pool_  = nullptr;
+  LogHandler                   *log_handler_      = nullptr;
+  TableMeta                     chunk_meta_;  ///< 分片记录的格式
+  unique_ptr<RecordFileHandler> record_handler_;
+};
@@ -0,0 +1,57 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/trx/commit_table.h"
+
+void CommitTable::set_committed(int32_t trx_id, int32_t commit_id)
+{
+  Shard &s = shard(trx_id);
+  lock_guard guard(s.lock);
+  s.commit_ids[trx_id] = commit_id;
+}
+
+bool CommitTable::is_committed(int32_t trx_id, int32_t &commit_id) const
+{
+  const Shard &s = shard(trx_id);
+  lock_guard guard(s.lock);
+  auto iter = s.commit_ids.find(trx_id);
+  if (iter == s.commit_ids.end()) {
+    return false;
+  }
+  commit_id = iter->second;
+  return true;
+}
+
+int64_t CommitTable::remove_below(int32_t commit_id)
+{
+  int64_t removed = 0;
+  for (Shard &s : shards_) {
+    lock_guard guard(s.lock);
+    for (auto iter = s.commit_ids.begin(); iter != s.commit_ids.end();) {
+      if (iter->second < commit_id) {
+        iter = s.commit_ids.erase(iter);
+        removed++;
+      } else {
+        ++iter;
+      }
+    }
+  }
+  return removed;
+}
+
+int64_t CommitTable::size() const
+{
+  int64_t count = 0;
+  for (const Shard &s : shards_) {
+    lock_guard guard(s.lock);
+    count += s.commit_ids.size();
+  }
+  return count;
+}
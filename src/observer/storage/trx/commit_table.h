@@ -0,0 +1,66 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/mutex.h"
+#include "common/lang/unordered_map.h"
+
+/**
+ * @brief 事务提交状态表
+ * @ingroup Transaction
+ * @details 记录已经提交的事务的事务号到提交号的映射。
+ * 事务提交时只需要在这里登记一下，不再逐条修改记录上的事务字段。
+ * 访问数据时，看到记录上还是负的事务号，就到这里查询这个事务是否已经提交。
+ * 事务字段会在后续写入或垃圾回收时再修改成提交号，修改后就不再需要这里的信息。
+ * 按照事务号分片，每个分片一把锁。
+ */
+class CommitTable
+{
+public:
+  static constexpr int SHARD_NUM = 16;
+
+public:
+  CommitTable()  = default;
+  ~CommitTable() = default;
+
+  /**
+   * @brief 登记一个已经提交的事务
+   */
+  void set_committed(int32_t trx_id, int32_t commit_id);
+
+  /**
+   * @brief 查询事务是否已经提交
+   * @param[out] commit_id 提交了的话返回提交号
+   */
+  bool is_committed(int32_t trx_id, int32_t &commit_id) const;
+
+  /**
+   * @brief 删除提交号小于指定值的事务
+   * @details 调用者需要保证这些事务在记录上留下的事务字段都已经清理过了
+   * @return 删除的事务个数
+   */
+  int64_t remove_below(int32_t commit_id);
+
+  int64_t size() const;
+
+private:
+  struct alignas(64) Shard
+  {
+    mutable common::Mutex           lock;
+    unordered_map<int32_t, int32_t> commit_ids;
+  };
+
+  Shard       &shard(int32_t trx_id) { return shards_[static_cast<uint32_t>(trx_id) % SHARD_NUM]; }
+  const Shard &shard(int32_t trx_id) const { return shards_[static_cast<uint32_t>(trx_id) % SHARD_NUM]; }
+
+private:
+  Shard shards_[SHARD_NUM];
+};
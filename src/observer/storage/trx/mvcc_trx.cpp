@@ -15,13 +15,17 @@ See the Mulan PSL v2 for more details. */
 #include "storage/trx/mvcc_trx.h"
 #include "storage/db/db.h"
 #include "storage/field/field.h"
+#include "storage/record/record_manager.h"
+#include "storage/table/table.h"
 #include "storage/trx/mvcc_trx_log.h"
 #include "common/lang/algorithm.h"
 
 MvccTrxKit::~MvccTrxKit()
 {
+  vacuum_.stop();
+
   vector<Trx *> tmp_trxes;
-  tmp_trxes.swap(trxes_);
+  trx_registry_.drain(tmp_trxes);
 
   for (Trx *trx : tmp_trxes) {
     delete trx;
@@ -42,17 +46,69 @@ RC MvccTrxKit::init()
 
 const vector<FieldMeta> *MvccTrxKit::trx_fields() const { return &fields_; }
 
-int32_t MvccTrxKit::next_trx_id() { return ++current_trx_id_; }
+int32_t MvccTrxKit::next_trx_id() { return allocate_trx_id(nullptr); }
 
 int32_t MvccTrxKit::max_trx_id() const { return numeric_limits<int32_t>::max(); }
 
+int32_t MvccTrxKit::allocate_trx_id(Trx *trx)
+{
+  int32_t trx_id = ++current_trx_id_;
+  if (trx != nullptr) {
+    trx_registry_.activate(trx_id, trx);
+  }
+  publish_trx_id(trx_id);
+  return trx_id;
+}
+
+void MvccTrxKit::publish_trx_id(int32_t trx_id)
+{
+  // 等待前面的事务号都发布后再发布自己，通常只需要等待很短的时间
+  int32_t expected = trx_id - 1;
+  while (!published_trx_id_.compare_exchange_weak(expected, trx_id)) {
+    if (expected >= trx_id) {
+      return;  // 恢复时可能直接推进了事务号
+    }
+    expected = trx_id - 1;
+    this_thread::yield();
+  }
+}
+
+int32_t MvccTrxKit::begin_trx(Trx *trx) { return allocate_trx_id(trx); }
+
+void MvccTrxKit::advance_trx_id(int32_t trx_id)
+{
+  int32_t current_trx_id = current_trx_id_.load();
+  while (current_trx_id < trx_id && !current_trx_id_.compare_exchange_weak(current_trx_id, trx_id)) {
+  }
+  int32_t published_trx_id = published_trx_id_.load();
+  while (published_trx_id < trx_id && !published_trx_id_.compare_exchange_weak(published_trx_id, trx_id)) {
+  }
+}
+
+void MvccTrxKit::recover_commit(int32_t trx_id, int32_t commit_id)
+{
+  commit_table_.set_committed(trx_id, commit_id);
+  advance_trx_id(commit_id);
+}
+
+void MvccTrxKit::end_trx(int32_t trx_id, Trx *trx) { trx_registry_.deactivate(trx_id, trx); }
+
+void MvccTrxKit::active_trx_ids(vector<int32_t> &trx_ids) const { trx_registry_.active_trx_ids(trx_ids); }
+
+void MvccTrxKit::create_read_view(int32_t creator_trx_id, ReadView &read_view) const
+{
+  // 先获取高水位再获取活跃事务，在这中间结束的事务当作已经结束了，是正确的
+  int32_t         high_watermark = published_trx_id_.load() + 1;
+  vector<int32_t> active_trx_ids;
+  trx_registry_.active_trx_ids(active_trx_ids);
+  read_view = ReadView(creator_trx_id, high_watermark, std::move(active_trx_ids));
+}
+
 Trx *MvccTrxKit::create_trx(LogHandler &log_handler)
 {
   Trx *trx = new MvccTrx(*this, log_handler);
   if (trx != nullptr) {
-    lock_.lock();
-    trxes_.push_back(trx);
-    lock_.unlock();
+    trx_registry_.add(trx);
   }
   return trx;
 }
@@ -61,54 +117,118 @@ Trx *MvccTrxKit::create_trx(LogHandler &log_handler, int32_t trx_id)
 {
   Trx *trx = new MvccTrx(*this, log_handler, trx_id);
   if (trx != nullptr) {
-    lock_.lock();
-    trxes_.push_back(trx);
-    if (current_trx_id_ < trx_id) {
-      current_trx_id_ = trx_id;
-    }
-    lock_.unlock();
+    trx_registry_.add(trx);
+    trx_registry_.activate(trx_id, trx);
+    advance_trx_id(trx_id);
   }
   return trx;
 }
 
 void MvccTrxKit::destroy_trx(Trx *trx)
 {
-  lock_.lock();
-  for (auto iter = trxes_.begin(), itend = trxes_.end(); iter != itend; ++iter) {
-    if (*iter == trx) {
-      trxes_.erase(iter);
-      break;
-    }
+  if (nullptr == trx) {
+    return;
   }
-  lock_.unlock();
+
+  trx_registry_.deactivate(trx->id(), trx);
+  trx_registry_.remove(trx);
 
   delete trx;
 }
 
-Trx *MvccTrxKit::find_trx(int32_t trx_id)
+Trx *MvccTrxKit::find_trx(int32_t trx_id) { return trx_registry_.find(trx_id); }
+
+void MvccTrxKit::all_trxes(vector<Trx *> &trxes) { trx_registry_.all_trxes(trxes); }
+
+LogReplayer *MvccTrxKit::create_log_replayer(Db &db, LogHandler &log_handler)
 {
-  lock_.lock();
-  for (Trx *trx : trxes_) {
-    if (trx->id() == trx_id) {
-      lock_.unlock();
-      return trx;
+  return new MvccTrxLogReplayer(db, *this, log_handler);
+}
+
+RC MvccTrxKit::checkpoint(Db &db) { return vacuum_.run_once(db, -1 /*reclaim_limit*/); }
+
+RC MvccTrxKit::start_background_tasks(Db &db)
+{
+#ifdef CONCURRENCY
+  return vacuum_.start(db);
+#else
+  return RC::SUCCESS;
+#endif
+}
+
+void MvccTrxKit::stop_background_tasks() { vacuum_.stop(); }
+
+RC MvccTrxKit::recover_trx_id(Db &db)
+{
+  int32_t max_xid = 0;
+
+  vector<string> table_names;
+  db.all_tables(table_names);
+  for (const string &table_name : table_names) {
+    Table *table = db.find_table(table_name.c_str());
+    if (nullptr == table) {
+      continue;
+    }
+
+    Field begin_xid_field;
+    Field end_xid_field;
+    trx_fields(table, begin_xid_field, end_xid_field);
+
+    RecordFileScanner scanner;
+    RC rc = table->get_record_scanner(scanner, nullptr /*trx*/, ReadWriteMode::READ_ONLY);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to open scanner. table=%s, rc=%s", table->name(), strrc(rc));
+      return rc;
+    }
+
+    Record record;
+    while (OB_SUCC(rc = scanner.next(record))) {
+      int32_t begin_xid = begin_xid_field.get_int(record);
+      int32_t end_xid   = end_xid_field.get_int(record);
+      max_xid           = max(max_xid, abs(begin_xid));
+      if (end_xid != max_trx_id()) {
+        max_xid = max(max_xid, abs(end_xid));
+      }
+    }
+    scanner.close_scan();
+
+    if (rc != RC::RECORD_EOF) {
+      return rc;
     }
   }
-  lock_.unlock();
 
-  return nullptr;
+  advance_trx_id(max_xid);
+  LOG_INFO("recover trx id done. max xid in data=%d, current trx id=%d", max_xid, current_trx_id_.load());
+  return RC::SUCCESS;
 }
 
-void MvccTrxKit::all_trxes(vector<Trx *> &trxes)
+void MvccTrxKit::trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_field) const
 {
-  lock_.lock();
-  trxes = trxes_;
-  lock_.unlock();
+  const TableMeta      &table_meta = table->table_meta();
+  span<const FieldMeta> trx_fields = table_meta.trx_fields();
+  ASSERT(trx_fields.size() >= 2, "invalid trx fields number. %d", trx_fields.size());
+
+  begin_xid_field.set_table(table);
+  begin_xid_field.set_field(&trx_fields[0]);
+  end_xid_field.set_table(table);
+  end_xid_field.set_field(&trx_fields[1]);
 }
 
-LogReplayer *MvccTrxKit::create_log_replayer(Db &db, LogHandler &log_handler)
+bool MvccTrxKit::cleanup_trx_fields(Field &begin_xid_field, Field &end_xid_field, Record &record, int32_t horizon) const
 {
-  return new MvccTrxLogReplayer(db, *this, log_handler);
+  auto cleanup = [this, &record, horizon](Field &field) -> bool {
+    int32_t xid       = field.get_int(record);
+    int32_t commit_id = 0;
+    if (xid >= 0 || !commit_table_.is_committed(-xid, commit_id) || commit_id >= horizon) {
+      return false;
+    }
+    field.set_int(record, commit_id);
+    return true;
+  };
+
+  bool begin_cleaned = cleanup(begin_xid_field);
+  bool end_cleaned   = cleanup(end_xid_field);
+  return begin_cleaned || end_cleaned;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -154,9 +274,17 @@ RC MvccTrx::delete_record(Table *table, Record &record)
   Field end_field;
   trx_fields(table, begin_field, end_field);
 
+  RC rc = lock_record(table, record.rid());
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
   RC delete_result = RC::SUCCESS;
 
-  RC rc = table->visit_record(record.rid(), [this, table, &delete_result, &end_field](Record &inplace_record) -> RC {
+  rc = table->visit_record(record.rid(), [this, table, &delete_result, &begin_field, &end_field](Record &inplace_record) -> RC {
+    // 反正要修改这条记录，顺便把已经提交的事务字段清理掉
+    trx_kit_.cleanup_trx_fields(begin_field, end_field, inplace_record, read_view_.low_watermark());
+
     RC rc = this->visit_record(table, inplace_record, ReadWriteMode::READ_WRITE);
     if (OB_FAIL(rc)) {
       delete_result = rc;
@@ -188,84 +316,151 @@ RC MvccTrx::delete_record(Table *table, Record &record)
 
 RC MvccTrx::visit_record(Table *table, Record &record, ReadWriteMode mode)
 {
+  ReadView        temp_read_view;
+  const ReadView &read_view = visit_read_view(temp_read_view);
+
   Field begin_field;
   Field end_field;
   trx_fields(table, begin_field, end_field);
 
-  int32_t begin_xid = begin_field.get_int(record);
-  int32_t end_xid   = end_field.get_int(record);
+  return visit_record(read_view, begin_field.get_int(record), end_field.get_int(record), mode);
+}
 
-  RC rc = RC::SUCCESS;
-  if (begin_xid > 0 && end_xid > 0) {
-    if (trx_id_ >= begin_xid && trx_id_ <= end_xid) {
-      rc = RC::SUCCESS;
-    } else {
-      LOG_TRACE("record invisible. trx id=%d, begin xid=%d, end xid=%d", trx_id_, begin_xid, end_xid);
-      rc = RC::RECORD_INVISIBLE;
+RC MvccTrx::visit_records(Table *table, vector<Record> &records, ReadWriteMode mode)
+{
+  ReadView        temp_read_view;
+  const ReadView &read_view = visit_read_view(temp_read_view);
+
+  Field begin_field;
+  Field end_field;
+  trx_fields(table, begin_field, end_field);
+
+  size_t visible_num = 0;
+  for (size_t i = 0; i < records.size(); i++) {
+    RC rc = visit_record(read_view, begin_field.get_int(records[i]), end_field.get_int(records[i]), mode);
+    if (rc == RC::RECORD_INVISIBLE) {
+      continue;
+    }
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    if (visible_num != i) {
+      records[visible_num] = std::move(records[i]);
     }
-  } else if (begin_xid < 0) {
-    // begin xid 小于0说明是刚插入而且没有提交的数据
-    if (-begin_xid == trx_id_) {
-      rc = RC::SUCCESS;
-    } else {
-      LOG_TRACE("record invisible. someone is updating this record right now. trx id=%d, begin xid=%d, end xid=%d",
+    visible_num++;
+  }
+  records.erase(records.begin() + visible_num, records.end());
+  return RC::SUCCESS;
+}
+
+const ReadView &MvccTrx::visit_read_view(ReadView &temp_read_view) const
+{
+  if (read_view_.valid()) {
+    return read_view_;
+  }
+
+  // 没有开始的事务，看到的是最新提交的数据
+  trx_kit_.create_read_view(trx_id_, temp_read_view);
+  return temp_read_view;
+}
+
+RC MvccTrx::visit_record(const ReadView &read_view, int32_t begin_xid, int32_t end_xid, ReadWriteMode mode) const
+{
+  // 先看创建这条记录的事务
+  if (begin_xid < 0) {
+    // begin xid 小于0说明事务插入这条记录后还没有清理事务字段，可能还没有提交
+    if (-begin_xid != trx_id_ && !committed_before(read_view, -begin_xid)) {
+      LOG_TRACE("record invisible. inserted by an uncommitted trx. trx id=%d, begin xid=%d, end xid=%d",
                 trx_id_, begin_xid, end_xid);
-      rc = RC::RECORD_INVISIBLE;
+      return RC::RECORD_INVISIBLE;
     }
+  } else if (!read_view.is_visible(begin_xid)) {
+    LOG_TRACE("record invisible. inserted after read view created. trx id=%d, begin xid=%d, end xid=%d, read view=%s",
+              trx_id_, begin_xid, end_xid, read_view.to_string().c_str());
+    return RC::RECORD_INVISIBLE;
+  }
+
+  // 再看删除这条记录的事务
+  bool deleted_in_view = false;  // 读视图中这条记录是否已经删除了
+  if (end_xid == trx_kit_.max_trx_id()) {
+    return RC::SUCCESS;
   } else if (end_xid < 0) {
-    // end xid 小于0 说明是正在删除但是还没有提交的数据
-    if (mode == ReadWriteMode::READ_ONLY) {
+    // end xid 小于0 说明是正在删除或者删除后还没有清理事务字段的数据
+    if (-end_xid == trx_id_) {
       // 如果 -end_xid 就是当前事务的事务号，说明是当前事务删除的
-      if (-end_xid != trx_id_) {
-        rc = RC::SUCCESS;
-      } else {
-        LOG_TRACE("record invisible. self has deleted this record. trx id=%d, begin xid=%d, end xid=%d",
-                  trx_id_, begin_xid, end_xid);
-        rc = RC::RECORD_INVISIBLE;
-      }
-    } else {
-      // 如果当前想要修改此条数据，并且不是当前事务删除的，简单的报错
-      // 这是事务并发处理的一种方式，非常简单粗暴。其它的并发处理方法，可以等待，或者让客户端重试
-      // 或者等事务结束后，再检测修改的数据是否有冲突
-      if (-end_xid != trx_id_) {
-        LOG_TRACE("concurrency conflit. someone is deleting this record right now. trx id=%d, begin xid=%d, end xid=%d",
-                  trx_id_, begin_xid, end_xid);
-        rc = RC::LOCKED_CONCURRENCY_CONFLICT;
-      } else {
-        LOG_TRACE("record invisible. self has deleted this record. trx id=%d, begin xid=%d, end xid=%d",
-                  trx_id_, begin_xid, end_xid);
-        rc = RC::RECORD_INVISIBLE;
+      LOG_TRACE("record invisible. self has deleted this record. trx id=%d, begin xid=%d, end xid=%d",
+                trx_id_, begin_xid, end_xid);
+      return RC::RECORD_INVISIBLE;
+    }
+
+    if (read_view.is_visible(-end_xid)) {
+      // 删除的事务在读视图创建前就结束了，没有提交的话就是回滚了，记录依然存在
+      int32_t commit_id = 0;
+      if (!trx_kit_.commit_table().is_committed(-end_xid, commit_id)) {
+        return RC::SUCCESS;
       }
+      deleted_in_view = true;
     }
+  } else {
+    deleted_in_view = read_view.is_visible(end_xid);
+  }
+
+  RC rc = RC::SUCCESS;
+  if (deleted_in_view) {
+    LOG_TRACE("record invisible. deleted before read view created. trx id=%d, begin xid=%d, end xid=%d",
+              trx_id_, begin_xid, end_xid);
+    rc = RC::RECORD_INVISIBLE;
+  } else if (mode == ReadWriteMode::READ_ONLY) {
+    // 读视图创建之后才删除或者正在删除的，依然可以看到
+    rc = RC::SUCCESS;
+  } else {
+    // 如果当前想要修改此条数据，并且其它事务正在删除或者在读视图之后删除了，简单的报错
+    // 这是事务并发处理的一种方式，非常简单粗暴。其它的并发处理方法，可以等待，或者让客户端重试
+    // 或者等事务结束后，再检测修改的数据是否有冲突
+    LOG_TRACE("concurrency conflit. someone has deleted this record. trx id=%d, begin xid=%d, end xid=%d",
+              trx_id_, begin_xid, end_xid);
+    rc = RC::LOCKED_CONCURRENCY_CONFLICT;
   }
   return rc;
 }
 
-/**
- * @brief 获取指定表上的事务使用的字段
- *
- * @param table 指定的表
- * @param begin_xid_field 返回处理begin_xid的字段
- * @param end_xid_field   返回处理end_xid的字段
- */
+bool MvccTrx::committed_before(const ReadView &read_view, int32_t trx_id) const
+{
+  int32_t commit_id = 0;
+  return read_view.is_visible(trx_id) && trx_kit_.commit_table().is_committed(trx_id, commit_id);
+}
+
 void MvccTrx::trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_field) const
 {
-  const TableMeta      &table_meta = table->table_meta();
-  span<const FieldMeta> trx_fields = table_meta.trx_fields();
-  ASSERT(trx_fields.size() >= 2, "invalid trx fields number. %d", trx_fields.size());
+  trx_kit_.trx_fields(table, begin_xid_field, end_xid_field);
+}
 
-  begin_xid_field.set_table(table);
-  begin_xid_field.set_field(&trx_fields[0]);
-  end_xid_field.set_table(table);
-  end_xid_field.set_field(&trx_fields[1]);
+RC MvccTrx::lock_record(Table *table, const RID &rid)
+{
+  RC rc = start_if_need();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = trx_kit_.row_lock_table().lock(trx_id_, table->table_id(), rid);
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("failed to lock record. trx id=%d, table=%s, rid=%s, rc=%s",
+              trx_id_, table->name(), rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  locked_rows_.emplace_back(table->table_id(), rid);
+  return RC::SUCCESS;
 }
 
 RC MvccTrx::start_if_need()
 {
   if (!started_) {
     ASSERT(operations_.empty(), "try to start a new trx while operations is not empty");
-    trx_id_ = trx_kit_.next_trx_id();
-    LOG_DEBUG("current thread change to new trx with %d", trx_id_);
+    trx_id_ = trx_kit_.begin_trx(this);
+    trx_kit_.create_read_view(trx_id_, read_view_);
+    LOG_DEBUG("current thread change to new trx with %d, read view=%s", trx_id_, read_view_.to_string().c_str());
     started_ = true;
   }
   return RC::SUCCESS;
@@ -279,67 +474,17 @@ RC MvccTrx::commit()
 
 RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
 {
-  // TODO 原子性提交BUG：这里存在一个很大的问题，不能让其他事务一次性看到当前事务更新到的数据或同时看不到
-  RC rc    = RC::SUCCESS;
-  started_ = false;
-
-  for (const Operation &operation : operations_) {
-    switch (operation.type()) {
-      case Operation::Type::INSERT: {
-        RID    rid(operation.page_num(), operation.slot_num());
-        Table *table = operation.table();
-        Field  begin_xid_field, end_xid_field;
-        trx_fields(table, begin_xid_field, end_xid_field);
-
-        auto record_updater = [this, &begin_xid_field, commit_xid](Record &record) -> RC {
-          LOG_DEBUG("before commit insert record. trx id=%d, begin xid=%d, commit xid=%d, lbt=%s",
-                    trx_id_, begin_xid_field.get_int(record), commit_xid, lbt());
-          ASSERT(begin_xid_field.get_int(record) == -this->trx_id_ && (!recovering_), 
-                 "got an invalid record while committing. begin xid=%d, this trx id=%d", 
-                 begin_xid_field.get_int(record), trx_id_);
-
-          begin_xid_field.set_int(record, commit_xid);
-          return RC::SUCCESS;
-        };
-
-        rc = operation.table()->visit_record(rid, record_updater);
-        ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
-               rid.to_string().c_str(), strrc(rc));
-      } break;
-
-      case Operation::Type::DELETE: {
-        Table *table = operation.table();
-        RID    rid(operation.page_num(), operation.slot_num());
-
-        Field begin_xid_field, end_xid_field;
-        trx_fields(table, begin_xid_field, end_xid_field);
-
-        auto record_updater = [this, &end_xid_field, commit_xid](Record &record) -> RC {
-          (void)this;
-          ASSERT(end_xid_field.get_int(record) == -trx_id_, 
-                 "got an invalid record while committing. end xid=%d, this trx id=%d", 
-                 end_xid_field.get_int(record), trx_id_);
-
-          end_xid_field.set_int(record, commit_xid);
-          return RC::SUCCESS;
-        };
-
-        rc = operation.table()->visit_record(rid, record_updater);
-        ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
-               rid.to_string().c_str(), strrc(rc));
-      } break;
-
-      default: {
-        ASSERT(false, "unsupported operation. type=%d", static_cast<int>(operation.type()));
-      }
-    }
-  }
-
+  // 不再逐条修改记录上的事务字段，只需要在提交状态表中登记一下。
+  // 登记之后再从活跃事务中删除，其它事务的读视图要么能看到全部修改，要么都看不到
+  RC rc = RC::SUCCESS;
   if (!recovering_) {
     rc = log_handler_.commit(trx_id_, commit_xid);
   }
 
+  trx_kit_.commit_table().set_committed(trx_id_, commit_xid);
+
   operations_.clear();
+  finish();
 
   LOG_TRACE("append trx commit log. trx id=%d, commit_xid=%d, rc=%s", trx_id_, commit_xid, strrc(rc));
   return rc;
@@ -347,8 +492,7 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
 
 RC MvccTrx::rollback()
 {
-  RC rc    = RC::SUCCESS;
-  started_ = false;
+  RC rc = RC::SUCCESS;
 
   for (auto iter = operations_.rbegin(), itend = operations_.rend(); iter != itend; ++iter) {
     const Operation &operation = *iter;
@@ -419,10 +563,28 @@ RC MvccTrx::rollback()
   if (!recovering_) {
     rc = log_handler_.rollback(trx_id_);
   }
+  finish();
   LOG_TRACE("append trx rollback log. trx id=%d, rc=%s", trx_id_, strrc(rc));
   return rc;
 }
 
+void MvccTrx::finish()
+{
+  started_   = false;
+  read_view_ = ReadView();
+  trx_kit_.end_trx(trx_id_, this);
+  release_row_locks();
+}
+
+void MvccTrx::release_row_locks()
+{
+  RowLockTable &row_lock_table = trx_kit_.row_lock_table();
+  for (const auto &[table_id, rid] : locked_rows_) {
+    row_lock_table.unlock(trx_id_, table_id, rid);
+  }
+  locked_rows_.clear();
+}
+
 RC find_table(Db *db, const LogEntry &log_entry, Table *&table)
 {
   auto *trx_log_header = reinterpret_cast<const MvccTrxLogHeader *>(log_entry.data());
@@ -464,9 +626,11 @@ RC MvccTrx::redo(Db *db, const LogEntry &log_entry)
     } break;
 
     case MvccTrxLogOperation::Type::COMMIT: {
-      // auto *trx_log_record = reinterpret_cast<const MvccTrxCommitLogEntry *>(log_entry.data());
-      // commit_with_trx_id(trx_log_record->commit_trx_id);
       // 遇到了提交日志，说明前面的记录都已经提交成功了
+      // 记录上的事务字段不需要修改，只需要恢复提交状态表
+      auto *trx_log_record = reinterpret_cast<const MvccTrxCommitLogEntry *>(log_entry.data());
+      trx_kit_.recover_commit(trx_id_, trx_log_record->commit_trx_id);
+      operations_.clear();
     } break;
 
     case MvccTrxLogOperation::Type::ROLLBACK: {
@@ -16,11 +16,19 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/vector.h"
 #include "storage/trx/trx.h"
+#include "storage/trx/commit_table.h"
 #include "storage/trx/mvcc_trx_log.h"
+#include "storage/trx/mvcc_vacuum.h"
+#include "storage/trx/read_view.h"
+#include "storage/trx/row_lock_table.h"
+#include "storage/trx/trx_registry.h"
 
 class CLogManager;
 class LogHandler;
 class MvccTrxLogHandler;
+class Field;
+class Record;
+class Table;
 
 class MvccTrxKit : public TrxKit
 {
@@ -37,32 +45,115 @@ public:
 
   /**
    * @brief 找到对应事务号的事务
-   * @details 当前仅在recover场景下使用
+   * @details 只能找到已经开始的事务，当前仅在recover场景下使用
    */
   Trx *find_trx(int32_t trx_id) override;
   void all_trxes(vector<Trx *> &trxes) override;
 
   LogReplayer *create_log_replayer(Db &db, LogHandler &log_handler) override;
 
+  /**
+   * @brief 做一轮完整的垃圾回收
+   * @details 提交状态表只在内存中，检查点之后恢复时也不会重放之前的提交日志，
+   * 所以需要把所有表中已经提交的事务字段清理成提交号
+   */
+  RC checkpoint(Db &db) override;
+
+  /**
+   * @brief 启动后台垃圾回收
+   * @details 只有打开 CONCURRENCY 编译选项时才会启动后台线程
+   */
+  RC   start_background_tasks(Db &db) override;
+  void stop_background_tasks() override;
+
 public:
   int32_t next_trx_id();
 
+  /**
+   * @brief 开始一个事务，分配事务号并登记为活跃事务
+   */
+  int32_t begin_trx(Trx *trx);
+
+  /**
+   * @brief 事务提交或回滚完成后，从活跃事务中删除
+   */
+  void end_trx(int32_t trx_id, Trx *trx);
+
+  /**
+   * @brief 恢复时重放提交日志
+   * @details 登记事务的提交号，并保证之后分配的事务号都比它大
+   */
+  void recover_commit(int32_t trx_id, int32_t commit_id);
+
+  /**
+   * @brief 日志回放完成后，根据数据中的事务字段推进事务号
+   * @details 检查点之前的日志不会重放，事务号只能从数据中恢复，
+   * 新分配的事务号必须比数据中已有的提交号都大，否则会看不到这些数据
+   */
+  RC recover_trx_id(Db &db);
+
+  /**
+   * @brief 当前活跃事务的事务号快照
+   */
+  void active_trx_ids(vector<int32_t> &trx_ids) const;
+
+  /**
+   * @brief 创建一致性读视图
+   * @param creator_trx_id 创建读视图的事务，没有开始的事务使用-1
+   */
+  void create_read_view(int32_t creator_trx_id, ReadView &read_view) const;
+
+  /**
+   * @brief 获取表上的事务字段
+   */
+  void trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_field) const;
+
+  /**
+   * @brief 把记录上已经提交的事务号清理成提交号
+   * @details 只有提交号小于 horizon 时才清理。horizon 不超过所有活跃事务的事务号，
+   * 提交号对所有活跃的读视图都可见，这样清理前后可见性不变
+   * @return 是否修改了记录
+   */
+  bool cleanup_trx_fields(Field &begin_xid_field, Field &end_xid_field, Record &record, int32_t horizon) const;
+
 public:
   int32_t max_trx_id() const;
 
+  CommitTable       &commit_table() { return commit_table_; }
+  const CommitTable &commit_table() const { return commit_table_; }
+  MvccVacuum        &vacuum() { return vacuum_; }
+  RowLockTable      &row_lock_table() { return row_lock_table_; }
+
+private:
+  /**
+   * @brief 分配一个新的事务号或提交号
+   * @details 事务号按照分配的顺序发布，发布之前已经登记到了活跃事务中(如果需要)。
+   * 读视图使用已发布的最大事务号作为高水位，就不会把刚分配还没有登记的事务当作已经结束的事务。
+   */
+  int32_t allocate_trx_id(Trx *trx);
+  void    publish_trx_id(int32_t trx_id);
+  void    advance_trx_id(int32_t trx_id);
+
 private:
   vector<FieldMeta> fields_;  // 存储事务数据需要用到的字段元数据，所有表结构都需要带的
 
   atomic<int32_t> current_trx_id_{0};
+  atomic<int32_t> published_trx_id_{0};  ///< 小于等于这个值的事务号都已经登记过了
 
-  common::Mutex lock_;
-  vector<Trx *> trxes_;
+  TrxRegistry  trx_registry_;
+  CommitTable  commit_table_;
+  RowLockTable row_lock_table_;
+  MvccVacuum   vacuum_{*this};
 };
 
 /**
  * @brief 多版本并发事务
  * @ingroup Transaction
- * TODO 没有垃圾回收
+ * @details 每条记录上有两个事务字段，begin_xid 和 end_xid，分别表示创建和删除这条记录的事务。
+ * 修改记录时，字段中记录的是负的事务号。事务提交时只在提交状态表(CommitTable)中登记提交号，
+ * 不会逐条修改记录，后续写入这条记录时再把事务字段清理成提交号。
+ * 事务开始时创建读视图(ReadView)，使用读视图和提交状态表判断记录是否可见。
+ * 已经删除并且对所有读视图都不可见的记录，由垃圾回收(MvccVacuum)从页面和索引中删除。
  */
 class MvccTrx : public Trx
 {
@@ -91,6 +182,17 @@ public:
    */
   RC visit_record(Table *table, Record &record, ReadWriteMode mode) override;
 
+  /**
+   * @brief 批量判断同一个页面上记录的可见性，读视图和事务字段只需要准备一次
+   */
+  RC visit_records(Table *table, vector<Record> &records, ReadWriteMode mode) override;
+
+  /**
+   * @brief 在行锁表中给记录加锁，先修改记录的事务获胜
+   * @details 其它事务持有锁时不需要读取记录就能发现冲突
+   */
+  RC lock_record(Table *table, const RID &rid) override;
+
   RC start_if_need() override;
   RC commit() override;
   RC rollback() override;
@@ -101,8 +203,25 @@ public:
 
 private:
   RC   commit_with_trx_id(int32_t commit_id);
+  void finish();
+  void release_row_locks();
   void trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_field) const;
 
+  /**
+   * @brief 记录上负的事务号对应的事务，在读视图创建之前是否已经提交
+   */
+  bool committed_before(const ReadView &read_view, int32_t trx_id) const;
+
+  /**
+   * @brief 当前事务访问的读视图，事务还没有开始时创建一个临时的读视图，看到最新提交的数据
+   */
+  const ReadView &visit_read_view(ReadView &temp_read_view) const;
+
+  /**
+   * @brief 根据记录上的事务号判断可见性，参考 visit_record
+   */
+  RC visit_record(const ReadView &read_view, int32_t begin_xid, int32_t end_xid, ReadWriteMode mode) const;
+
 private:
   static const int32_t MAX_TRX_ID = numeric_limits<int32_t>::max();
 
@@ -113,7 +232,10 @@ private:
   MvccTrxKit       &trx_kit_;
   MvccTrxLogHandler log_handler_;
   int32_t           trx_id_     = -1;
+  ReadView          read_view_;
   bool              started_    = false;
   bool              recovering_ = false;
   OperationSet      operations_;
+
+  vector<pair<int32_t, RID>> locked_rows_;  ///< 持有的行锁，表ID和RID
 };
@@ -0,0 +1,208 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/trx/mvcc_vacuum.h"
+#include "common/lang/chrono.h"
+#include "common/lang/sstream.h"
+#include "common/lang/vector.h"
+#include "common/log/log.h"
+#include "common/thread/thread_util.h"
+#include "storage/db/db.h"
+#include "storage/field/field.h"
+#include "storage/record/record_manager.h"
+#include "storage/table/table.h"
+#include "storage/trx/mvcc_trx.h"
+
+string MvccVacuumStats::to_string() const
+{
+  stringstream ss;
+  ss << "rounds=" << rounds.load() << ", scanned_records=" << scanned_records.load()
+     << ", reclaimed_records=" << reclaimed_records.load() << ", reclaimed_bytes=" << reclaimed_bytes.load()
+     << ", cleaned_records=" << cleaned_records.load() << ", pruned_commits=" << pruned_commits.load()
+     << ", dead_versions=" << dead_versions.load();
+  return ss.str();
+}
+
+MvccVacuum::MvccVacuum(MvccTrxKit &trx_kit) : trx_kit_(trx_kit) {}
+
+MvccVacuum::~MvccVacuum() { stop(); }
+
+RC MvccVacuum::start(Db &db)
+{
+  if (thread_) {
+    LOG_ERROR("vacuum thread has already been started");
+    return RC::INTERNAL;
+  }
+
+  running_.store(true);
+  thread_ = make_unique<thread>(&MvccVacuum::thread_func, this, &db);
+  LOG_INFO("vacuum thread started. db=%s, interval=%dms, reclaim limit=%ld", db.name(), interval_ms_, reclaim_limit_);
+  return RC::SUCCESS;
+}
+
+void MvccVacuum::stop()
+{
+  if (!thread_) {
+    return;
+  }
+
+  {
+    lock_guard guard(wait_lock_);
+    running_.store(false);
+  }
+  wait_cond_.notify_all();
+
+  thread_->join();
+  thread_.reset();
+  LOG_INFO("vacuum thread stopped. stats: %s", stats_.to_string().c_str());
+}
+
+void MvccVacuum::thread_func(Db *db)
+{
+  common::thread_set_name("Vacuum");
+
+  while (running_.load()) {
+    {
+      unique_lock lock(wait_lock_);
+      wait_cond_.wait_for(lock, chrono::milliseconds(interval_ms_), [this]() { return !running_.load(); });
+    }
+    if (!running_.load()) {
+      break;
+    }
+
+    RC rc = run_once(*db, reclaim_limit_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to vacuum db. db=%s, rc=%s", db->name(), strrc(rc));
+    }
+  }
+}
+
+RC MvccVacuum::run_once(Db &db, int64_t reclaim_limit)
+{
+  lock_guard guard(round_lock_);
+
+  // 比所有活跃事务都小的提交号，对所有读视图都是可见的
+  ReadView read_view;
+  trx_kit_.create_read_view(-1, read_view);
+  const int32_t horizon = read_view.low_watermark();
+
+  const int64_t reclaimed_before = stats_.reclaimed_records.load();
+  int64_t       dead_versions    = 0;
+
+  vector<string> table_names;
+  db.all_tables(table_names);
+  for (const string &table_name : table_names) {
+    Table *table = db.find_table(table_name.c_str());
+    if (nullptr == table) {
+      continue;
+    }
+
+    RC rc = vacuum_table(table, horizon, reclaim_limit, dead_versions);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to vacuum table. table=%s, rc=%s", table->name(), strrc(rc));
+      return rc;
+    }
+  }
+
+  // 所有表中提交号小于 horizon 的事务字段都已经清理过了
+  int64_t pruned = trx_kit_.commit_table().remove_below(horizon);
+  stats_.pruned_commits += pruned;
+  stats_.dead_versions.store(dead_versions);
+  stats_.rounds++;
+
+  const int64_t reclaimed = stats_.reclaimed_records.load() - reclaimed_before;
+  if (reclaimed > 0 || pruned > 0) {
+    LOG_INFO("vacuum round done. db=%s, horizon=%d, reclaimed=%ld, pruned=%ld, stats: %s",
+             db.name(), horizon, reclaimed, pruned, stats_.to_string().c_str());
+  }
+  return RC::SUCCESS;
+}
+
+RC MvccVacuum::vacuum_table(Table *table, int32_t horizon, int64_t reclaim_limit, int64_t &dead_versions)
+{
+  Field begin_xid_field;
+  Field end_xid_field;
+  trx_kit_.trx_fields(table, begin_xid_field, end_xid_field);
+
+  const CommitTable &commit_table = trx_kit_.commit_table();
+  const int32_t      max_trx_id   = trx_kit_.max_trx_id();
+
+  // 扫描时持有页面锁，先把要回收的记录收集起来，扫描结束后再删除
+  vector<Record> dead_records;
+
+  RecordFileScanner scanner;
+  RC rc = table->get_record_scanner(scanner, nullptr /*trx*/, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open scanner. table=%s, rc=%s", table->name(), strrc(rc));
+    return rc;
+  }
+
+  Record record;
+  while (OB_SUCC(rc = scanner.next(record))) {
+    stats_.scanned_records++;
+
+    if (trx_kit_.cleanup_trx_fields(begin_xid_field, end_xid_field, record, horizon)) {
+      rc = scanner.update_current(record);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to update record. table=%s, rid=%s, rc=%s",
+                 table->name(), record.rid().to_string().c_str(), strrc(rc));
+        break;
+      }
+      stats_.cleaned_records++;
+    }
+
+    int32_t end_xid = end_xid_field.get_int(record);
+    if (end_xid == max_trx_id) {
+      continue;
+    }
+
+    int32_t commit_id = end_xid;
+    if (end_xid < 0 && !commit_table.is_committed(-end_xid, commit_id)) {
+      continue;  // 正在删除
+    }
+
+    if (commit_id >= horizon) {
+      dead_versions++;  // 还有读视图可能看到
+      continue;
+    }
+
+    if (reclaim_limit < 0 || static_cast<int64_t>(dead_records.size()) < reclaim_limit) {
+      Record dead_record;
+      dead_record.set_rid(record.rid());
+      rc = dead_record.copy_data(record.data(), record.len());
+      if (OB_FAIL(rc)) {
+        break;
+      }
+      dead_records.push_back(std::move(dead_record));
+    } else {
+      dead_versions++;  // 留给下一轮
+    }
+  }
+  scanner.close_scan();
+
+  if (rc != RC::RECORD_EOF) {
+    return rc;
+  }
+
+  // 删除记录时会同时删除索引，并把页面放回空闲页面中
+  for (const Record &dead_record : dead_records) {
+    rc = table->delete_record(dead_record);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to reclaim record. table=%s, rid=%s, rc=%s",
+               table->name(), dead_record.rid().to_string().c_str(), strrc(rc));
+      return rc;
+    }
+
+    stats_.reclaimed_records++;
+    stats_.reclaimed_bytes += dead_record.len();
+  }
+
+  return RC::SUCCESS;
+}
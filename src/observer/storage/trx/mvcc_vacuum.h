@@ -0,0 +1,104 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/atomic.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/thread.h"
+#include "common/rc.h"
+
+class Db;
+class Table;
+class MvccTrxKit;
+
+/**
+ * @brief 垃圾回收的统计信息
+ * @ingroup Transaction
+ */
+struct MvccVacuumStats
+{
+  atomic<int64_t> rounds{0};             ///< 完成了多少轮回收
+  atomic<int64_t> scanned_records{0};    ///< 扫描过的记录数
+  atomic<int64_t> reclaimed_records{0};  ///< 回收的记录数
+  atomic<int64_t> reclaimed_bytes{0};    ///< 回收的记录占用的空间
+  atomic<int64_t> cleaned_records{0};    ///< 清理过事务字段的记录数
+  atomic<int64_t> pruned_commits{0};     ///< 从提交状态表中删除的事务数
+  atomic<int64_t> dead_versions{0};      ///< 最近一轮中已经删除但是还有读视图可能看到的版本数
+
+  string to_string() const;
+};
+
+/**
+ * @brief 多版本数据的垃圾回收
+ * @ingroup Transaction
+ * @details 删除的记录只是设置了 end_xid，数据一直留在页面中。
+ * 垃圾回收使用所有活跃事务中最小的事务号作为 horizon，删除提交号小于 horizon 的记录
+ * 对所有读视图都不可见，可以从索引和数据页面中真正删除掉，腾出的空间会记录到空闲空间映射中。
+ * 扫描的同时把已经提交的事务字段清理成提交号，全部清理完后再删除提交状态表中不需要的信息。
+ * 当前的更新是原地修改记录，不会生成新版本，所以没有版本链，每条记录最多只有一个已经删除的版本。
+ *
+ * 后台线程每隔一段时间做一轮回收，每轮每张表最多回收一定数量的记录，避免长时间占用页面锁。
+ * 只有在编译时打开 CONCURRENCY 选项，页面锁才会生效，所以不打开时不会启动后台线程，
+ * 只在数据库做检查点时回收。
+ * @note 与 Db::sync 一样，回收时不允许并发的删除表
+ */
+class MvccVacuum
+{
+public:
+  static constexpr int     DEFAULT_INTERVAL_MS  = 1000;
+  static constexpr int64_t DEFAULT_RECLAIM_LIMIT = 1024;
+
+public:
+  explicit MvccVacuum(MvccTrxKit &trx_kit);
+  ~MvccVacuum();
+
+  /**
+   * @brief 启动后台回收线程
+   */
+  RC start(Db &db);
+
+  /**
+   * @brief 停止后台回收线程并等待它退出
+   */
+  void stop();
+
+  /**
+   * @brief 对数据库中的所有表做一轮回收
+   * @param reclaim_limit 每张表最多回收多少条记录，小于0表示不限制
+   */
+  RC run_once(Db &db, int64_t reclaim_limit);
+
+  void set_interval_ms(int interval_ms) { interval_ms_ = interval_ms; }
+  void set_reclaim_limit(int64_t reclaim_limit) { reclaim_limit_ = reclaim_limit; }
+
+  const MvccVacuumStats &stats() const { return stats_; }
+
+private:
+  RC vacuum_table(Table *table, int32_t horizon, int64_t reclaim_limit, int64_t &dead_versions);
+
+  void thread_func(Db *db);
+
+private:
+  MvccTrxKit &trx_kit_;
+
+  mutex              round_lock_;  ///< 同一时间只能有一轮回收，后台线程与检查点可能同时触发
+  unique_ptr<thread> thread_;
+  atomic_bool        running_{false};
+  mutex              wait_lock_;
+  condition_variable wait_cond_;
+
+  int     interval_ms_   = DEFAULT_INTERVAL_MS;
+  int64_t reclaim_limit_ = DEFAULT_RECLAIM_LIMIT;
+
+  MvccVacuumStats stats_;
+};
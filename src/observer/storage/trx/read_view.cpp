@@ -0,0 +1,38 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/trx/read_view.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/sstream.h"
+
+ReadView::ReadView(int32_t creator_trx_id, int32_t high_watermark, vector<int32_t> &&active_trx_ids)
+    : creator_trx_id_(creator_trx_id), high_watermark_(high_watermark), active_trx_ids_(std::move(active_trx_ids))
+{
+  auto new_end = remove_if(active_trx_ids_.begin(), active_trx_ids_.end(), [high_watermark](int32_t xid) {
+    return xid >= high_watermark;
+  });
+  active_trx_ids_.erase(new_end, active_trx_ids_.end());
+  sort(active_trx_ids_.begin(), active_trx_ids_.end());
+
+  low_watermark_ = active_trx_ids_.empty() ? high_watermark_ : active_trx_ids_.front();
+}
+
+bool ReadView::is_active(int32_t xid) const
+{
+  return binary_search(active_trx_ids_.begin(), active_trx_ids_.end(), xid);
+}
+
+string ReadView::to_string() const
+{
+  stringstream ss;
+  ss << "creator=" << creator_trx_id_ << ", low=" << low_watermark_ << ", high=" << high_watermark_
+     << ", active=" << active_trx_ids_.size();
+  return ss.str();
+}
@@ -0,0 +1,62 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+
+/**
+ * @brief 一致性读视图
+ * @ingroup Transaction
+ * @details 事务开始时创建，记录当时所有活跃的事务号(包括正在提交的事务的提交号)以及高低水位：
+ * - 小于低水位的事务号，在视图创建时都已经结束了；
+ * - 大于等于高水位的事务号，是在视图创建之后才分配的；
+ * - 介于两者之间的，如果不在活跃列表中，也是已经结束了的。
+ * 记录对当前事务是否可见，只依赖于读视图和记录上的事务字段，访问数据时不需要再访问事务管理器。
+ */
+class ReadView
+{
+public:
+  ReadView() = default;
+  ReadView(int32_t creator_trx_id, int32_t high_watermark, vector<int32_t> &&active_trx_ids);
+
+  /**
+   * @brief 视图创建时，xid(事务号或提交号)对应的事务是否已经结束
+   */
+  bool is_visible(int32_t xid) const
+  {
+    if (xid < low_watermark_) {
+      return true;
+    }
+    if (xid >= high_watermark_) {
+      return false;
+    }
+    return !is_active(xid);
+  }
+
+  /**
+   * @brief 视图创建时，xid是否还是活跃的
+   */
+  bool is_active(int32_t xid) const;
+
+  bool    valid() const { return high_watermark_ > 0; }
+  int32_t creator_trx_id() const { return creator_trx_id_; }
+  int32_t low_watermark() const { return low_watermark_; }
+  int32_t high_watermark() const { return high_watermark_; }
+
+  string to_string() const;
+
+private:
+  int32_t         creator_trx_id_ = -1;
+  int32_t         low_watermark_  = 0;
+  int32_t         high_watermark_ = 0;
+  vector<int32_t> active_trx_ids_;  ///< 有序的活跃事务号，不包含大于等于高水位的
+};
@@ -0,0 +1,91 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/trx/row_lock_table.h"
+#include "common/lang/chrono.h"
+#include "common/lang/sstream.h"
+#include "common/log/log.h"
+
+string RowLockStats::to_string() const
+{
+  stringstream ss;
+  ss << "lock_requests=" << lock_requests.load() << ", lock_conflicts=" << lock_conflicts.load()
+     << ", lock_waits=" << lock_waits.load() << ", wait_timeouts=" << wait_timeouts.load()
+     << ", wait_time_us=" << wait_time_us.load();
+  return ss.str();
+}
+
+RC RowLockTable::lock(int32_t trx_id, int32_t table_id, const RID &rid)
+{
+  stats_.lock_requests++;
+
+  RowKey       key{table_id, rid};
+  Stripe      &s = stripe(key);
+  unique_lock  guard(s.lock);
+
+  auto try_lock = [&s, &key, trx_id]() -> bool {
+    auto iter = s.owners.find(key);
+    if (iter == s.owners.end()) {
+      s.owners.emplace(key, trx_id);
+      return true;
+    }
+    return iter->second == trx_id;
+  };
+
+  if (try_lock()) {
+    return RC::SUCCESS;
+  }
+
+  const int wait_timeout_ms = wait_timeout_ms_.load();
+  if (wait_timeout_ms <= 0) {
+    stats_.lock_conflicts++;
+    LOG_TRACE("row lock conflict. trx id=%d, table id=%d, rid=%s", trx_id, table_id, rid.to_string().c_str());
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+
+  stats_.lock_waits++;
+  auto begin_time = chrono::steady_clock::now();
+  bool locked     = s.cond.wait_for(guard, chrono::milliseconds(wait_timeout_ms), try_lock);
+  stats_.wait_time_us +=
+      chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - begin_time).count();
+
+  if (!locked) {
+    stats_.wait_timeouts++;
+    stats_.lock_conflicts++;
+    LOG_TRACE("row lock wait timeout. trx id=%d, table id=%d, rid=%s, timeout=%dms",
+              trx_id, table_id, rid.to_string().c_str(), wait_timeout_ms);
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+  return RC::SUCCESS;
+}
+
+void RowLockTable::unlock(int32_t trx_id, int32_t table_id, const RID &rid)
+{
+  RowKey  key{table_id, rid};
+  Stripe &s = stripe(key);
+  {
+    lock_guard guard(s.lock);
+    auto       iter = s.owners.find(key);
+    if (iter == s.owners.end() || iter->second != trx_id) {
+      return;
+    }
+    s.owners.erase(iter);
+  }
+  s.cond.notify_all();
+}
+
+int32_t RowLockTable::owner(int32_t table_id, const RID &rid) const
+{
+  RowKey        key{table_id, rid};
+  const Stripe &s = stripe(key);
+  lock_guard    guard(s.lock);
+  auto          iter = s.owners.find(key);
+  return iter == s.owners.end() ? -1 : iter->second;
+}
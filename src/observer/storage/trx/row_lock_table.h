@@ -0,0 +1,109 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/atomic.h"
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/unordered_map.h"
+#include "common/rc.h"
+#include "storage/record/record.h"
+
+/**
+ * @brief 行锁的统计信息
+ * @ingroup Transaction
+ */
+struct RowLockStats
+{
+  atomic<int64_t> lock_requests{0};   ///< 加锁请求次数
+  atomic<int64_t> lock_conflicts{0};  ///< 最终没有拿到锁的次数
+  atomic<int64_t> lock_waits{0};      ///< 需要等待的次数
+  atomic<int64_t> wait_timeouts{0};   ///< 等待超时的次数
+  atomic<int64_t> wait_time_us{0};    ///< 等待的总时间
+
+  string to_string() const;
+};
+
+/**
+ * @brief 内存中的行锁表
+ * @ingroup Transaction
+ * @details 事务修改记录之前先在这里加锁，锁一直持有到事务结束。其它事务想修改同一条记录时，
+ * 不需要再锁住页面读取记录上的事务字段，就能发现写写冲突，先修改的事务获胜。
+ * 按照表和RID的哈希值分片，每个分片有自己的锁和条件变量。
+ * 默认不等待，直接返回冲突，与之前的行为一致；可以设置一个等待超时时间，在这段时间内等待持有锁的事务结束。
+ * @note 等待需要真正的互斥锁，所以这里没有使用 common::Mutex
+ */
+class RowLockTable
+{
+public:
+  static constexpr int STRIPE_NUM = 64;
+
+public:
+  RowLockTable()  = default;
+  ~RowLockTable() = default;
+
+  /**
+   * @brief 给一条记录加锁
+   * @details 已经持有这把锁的话直接返回成功
+   * @return SUCCESS 成功；LOCKED_CONCURRENCY_CONFLICT 其它事务持有这把锁并且等待超时
+   */
+  RC lock(int32_t trx_id, int32_t table_id, const RID &rid);
+
+  /**
+   * @brief 释放锁，只有持有者才能释放
+   */
+  void unlock(int32_t trx_id, int32_t table_id, const RID &rid);
+
+  /**
+   * @brief 当前持有锁的事务，没有的话返回-1
+   */
+  int32_t owner(int32_t table_id, const RID &rid) const;
+
+  /**
+   * @brief 设置等待锁的超时时间
+   * @param wait_timeout_ms 0表示不等待
+   */
+  void set_wait_timeout_ms(int wait_timeout_ms) { wait_timeout_ms_ = wait_timeout_ms; }
+
+  const RowLockStats &stats() const { return stats_; }
+
+private:
+  struct RowKey
+  {
+    int32_t table_id;
+    RID     rid;
+
+    bool operator==(const RowKey &other) const { return table_id == other.table_id && rid == other.rid; }
+  };
+
+  struct RowKeyHash
+  {
+    size_t operator()(const RowKey &key) const noexcept
+    {
+      return RIDHash()(key.rid) * 31 + static_cast<size_t>(key.table_id);
+    }
+  };
+
+  struct alignas(64) Stripe
+  {
+    mutable mutex                             lock;
+    condition_variable                        cond;
+    unordered_map<RowKey, int32_t, RowKeyHash> owners;
+  };
+
+  Stripe       &stripe(const RowKey &key) { return stripes_[RowKeyHash()(key) % STRIPE_NUM]; }
+  const Stripe &stripe(const RowKey &key) const { return stripes_[RowKeyHash()(key) % STRIPE_NUM]; }
+
+private:
+  Stripe       stripes_[STRIPE_NUM];
+  atomic<int>  wait_timeout_ms_{0};
+  RowLockStats stats_;
+};
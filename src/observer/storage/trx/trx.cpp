@@ -45,3 +45,24 @@ TrxKit *TrxKit::create(const char *name)
   
   return trx_kit;
 }
+
+RC Trx::visit_records(Table *table, vector<Record> &records, ReadWriteMode mode)
+{
+  size_t visible_num = 0;
+  for (size_t i = 0; i < records.size(); i++) {
+    RC rc = visit_record(table, records[i], mode);
+    if (rc == RC::RECORD_INVISIBLE) {
+      continue;
+    }
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    if (visible_num != i) {
+      records[visible_num] = std::move(records[i]);
+    }
+    visible_num++;
+  }
+  records.erase(records.begin() + visible_num, records.end());
+  return RC::SUCCESS;
+}
@@ -129,6 +129,22 @@ public:
 
   virtual LogReplayer *create_log_replayer(Db &db, LogHandler &log_handler) = 0;
 
+  /**
+   * @brief 数据库做检查点之前调用
+   * @details 检查点之前的日志在恢复时不会再重放，事务模块依赖这些日志重建的内存状态需要先落到数据中
+   */
+  virtual RC checkpoint(Db &db) { return RC::SUCCESS; }
+
+  /**
+   * @brief 数据库打开并完成恢复后调用，启动事务模块的后台任务，比如垃圾回收
+   */
+  virtual RC start_background_tasks(Db &db) { return RC::SUCCESS; }
+
+  /**
+   * @brief 数据库关闭前调用，停止后台任务
+   */
+  virtual void stop_background_tasks() {}
+
 public:
   static TrxKit *create(const char *name);
 };
@@ -147,6 +163,20 @@ public:
   virtual RC delete_record(Table *table, Record &record)                    = 0;
   virtual RC visit_record(Table *table, Record &record, ReadWriteMode mode) = 0;
 
+  /**
+   * @brief 批量访问同一个页面上的记录，不可见的记录从 records 中移除
+   * @details 默认逐条调用 visit_record，事务可以重载这个函数，把每条记录都要做的准备工作提到循环外面
+   * @return RC 除了 RECORD_INVISIBLE 以外，visit_record 返回的错误都直接返回
+   */
+  virtual RC visit_records(Table *table, vector<Record> &records, ReadWriteMode mode);
+
+  /**
+   * @brief 原地修改记录之前给记录加锁，用来检测写写冲突
+   * @details 锁在事务结束时释放
+   * @return LOCKED_CONCURRENCY_CONFLICT 其它事务正在修改这条记录
+   */
+  virtual RC lock_record(Table *table, const RID &rid) { return RC::SUCCESS; }
+
   virtual RC start_if_need() = 0;
   virtual RC commit()        = 0;
   virtual RC rollback()      = 0;
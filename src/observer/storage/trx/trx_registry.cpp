@@ -0,0 +1,97 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/trx/trx_registry.h"
+
+TrxRegistry::Shard &TrxRegistry::trx_shard(const Trx *trx)
+{
+  // 对象地址的低位基本都是0，移掉后再取模
+  return shards_[(reinterpret_cast<uintptr_t>(trx) >> 6) % SHARD_NUM];
+}
+
+TrxRegistry::Shard &TrxRegistry::id_shard(int32_t trx_id)
+{
+  return shards_[static_cast<uint32_t>(trx_id) % SHARD_NUM];
+}
+
+const TrxRegistry::Shard &TrxRegistry::id_shard(int32_t trx_id) const
+{
+  return shards_[static_cast<uint32_t>(trx_id) % SHARD_NUM];
+}
+
+void TrxRegistry::add(Trx *trx)
+{
+  Shard &shard = trx_shard(trx);
+  lock_guard guard(shard.lock);
+  shard.trxes.insert(trx);
+}
+
+void TrxRegistry::remove(Trx *trx)
+{
+  Shard &shard = trx_shard(trx);
+  lock_guard guard(shard.lock);
+  shard.trxes.erase(trx);
+}
+
+void TrxRegistry::activate(int32_t trx_id, Trx *trx)
+{
+  Shard &shard = id_shard(trx_id);
+  lock_guard guard(shard.lock);
+  shard.active_trxes[trx_id] = trx;
+}
+
+void TrxRegistry::deactivate(int32_t trx_id, Trx *trx)
+{
+  Shard &shard = id_shard(trx_id);
+  lock_guard guard(shard.lock);
+  auto iter = shard.active_trxes.find(trx_id);
+  if (iter != shard.active_trxes.end() && iter->second == trx) {
+    shard.active_trxes.erase(iter);
+  }
+}
+
+Trx *TrxRegistry::find(int32_t trx_id) const
+{
+  const Shard &shard = id_shard(trx_id);
+  lock_guard guard(shard.lock);
+  auto iter = shard.active_trxes.find(trx_id);
+  return iter == shard.active_trxes.end() ? nullptr : iter->second;
+}
+
+void TrxRegistry::all_trxes(vector<Trx *> &trxes) const
+{
+  trxes.clear();
+  for (const Shard &shard : shards_) {
+    lock_guard guard(shard.lock);
+    trxes.insert(trxes.end(), shard.trxes.begin(), shard.trxes.end());
+  }
+}
+
+void TrxRegistry::active_trx_ids(vector<int32_t> &trx_ids) const
+{
+  trx_ids.clear();
+  for (const Shard &shard : shards_) {
+    lock_guard guard(shard.lock);
+    for (const auto &[trx_id, trx] : shard.active_trxes) {
+      trx_ids.push_back(trx_id);
+    }
+  }
+}
+
+void TrxRegistry::drain(vector<Trx *> &trxes)
+{
+  trxes.clear();
+  for (Shard &shard : shards_) {
+    lock_guard guard(shard.lock);
+    trxes.insert(trxes.end(), shard.trxes.begin(), shard.trxes.end());
+    shard.trxes.clear();
+    shard.active_trxes.clear();
+  }
+}
@@ -0,0 +1,83 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/mutex.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/unordered_set.h"
+#include "common/lang/vector.h"
+
+class Trx;
+
+/**
+ * @brief 分片的事务注册表
+ * @ingroup Transaction
+ * @details 事务管理器需要记录两类信息：
+ * 1. 所有创建出来还没有销毁的事务对象，按照对象地址分片；
+ * 2. 已经开始(分配了事务号)还没有结束的事务，按照事务号分片，用来查找事务和生成活跃事务快照。
+ * 每个分片有自己的锁，插入、删除和查找都是O(1)的，不同会话之间基本不会竞争同一把锁。
+ */
+class TrxRegistry
+{
+public:
+  static constexpr int SHARD_NUM = 16;
+
+public:
+  TrxRegistry()  = default;
+  ~TrxRegistry() = default;
+
+  void add(Trx *trx);
+  void remove(Trx *trx);
+
+  /**
+   * @brief 记录一个开始了的事务
+   */
+  void activate(int32_t trx_id, Trx *trx);
+
+  /**
+   * @brief 事务结束时调用
+   * @details 只有当前登记的事务对象就是trx时才删除，防止误删恢复时同事务号的其它对象
+   */
+  void deactivate(int32_t trx_id, Trx *trx);
+
+  /**
+   * @brief 按照事务号查找活跃事务
+   */
+  Trx *find(int32_t trx_id) const;
+
+  void all_trxes(vector<Trx *> &trxes) const;
+
+  /**
+   * @brief 获取当前所有活跃事务的事务号
+   * @details 每个分片单独加锁，不会阻塞其它分片上的事务开始和结束
+   */
+  void active_trx_ids(vector<int32_t> &trx_ids) const;
+
+  /**
+   * @brief 取出所有的事务对象，注册表清空
+   */
+  void drain(vector<Trx *> &trxes);
+
+private:
+  struct alignas(64) Shard
+  {
+    mutable common::Mutex         lock;
+    unordered_set<Trx *>          trxes;
+    unordered_map<int32_t, Trx *> active_trxes;
+  };
+
+  Shard       &trx_shard(const Trx *trx);
+  Shard       &id_shard(int32_t trx_id);
+  const Shard &id_shard(int32_t trx_id) const;
+
+private:
+  Shard shards_[SHARD_NUM];
+};
@@ -0,0 +1,127 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+
+#include "gtest/gtest.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/index/bplus_tree.h"
+#include "storage/index/bplus_tree_index.h"
+
+using namespace std;
+
+const int KEY_NUM       = 100;
+const int ENTRY_PER_KEY = 10;
+const int LEAF_MAX_SIZE = 8;  // 叶子节点小一些，让相同的键分布在多个页面上
+
+class BplusTreeScannerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    filesystem::remove_all(directory_);
+    filesystem::create_directories(directory_);
+
+    ASSERT_EQ(RC::SUCCESS, buffer_pool_manager_.init(make_unique<VacuousDoubleWriteBuffer>()));
+    const string file_name = (directory_ / "scanner.index").string();
+    ASSERT_EQ(RC::SUCCESS,
+        handler_.create(log_handler_, buffer_pool_manager_, file_name, {AttrType::INTS}, {4}, false /*is_unique*/,
+            LEAF_MAX_SIZE, LEAF_MAX_SIZE));
+
+    for (int i = 0; i < KEY_NUM * ENTRY_PER_KEY; i++) {
+      ASSERT_EQ(RC::SUCCESS, insert(i % KEY_NUM, i));
+    }
+  }
+
+  void TearDown() override
+  {
+    handler_.close();
+    filesystem::remove_all(directory_);
+  }
+
+  RC insert(int key, int slot_num)
+  {
+    RID rid(1, slot_num);
+    return handler_.insert_entry({IndexUserKey(Value(key))}, &rid);
+  }
+
+protected:
+  filesystem::path  directory_{"bplus_tree_scanner"};
+  BufferPoolManager buffer_pool_manager_;
+  VacuousLogHandler log_handler_;
+  BplusTreeHandler  handler_;
+};
+
+static int count_entries(IndexScanner &scanner)
+{
+  int count = 0;
+  RID rid;
+  while (scanner.next_entry(&rid) == RC::SUCCESS) {
+    count++;
+  }
+  return count;
+}
+
+TEST_F(BplusTreeScannerTest, rescan)
+{
+  BplusTreeIndexScanner scanner(handler_);
+  for (int key = KEY_NUM - 1; key >= 0; key--) {
+    vector<IndexUserKey> keys{IndexUserKey(Value(key))};
+    ASSERT_EQ(RC::SUCCESS, scanner.rescan(keys, true, keys, true));
+    ASSERT_EQ(ENTRY_PER_KEY, count_entries(scanner));
+  }
+
+  // 不存在的键
+  vector<IndexUserKey> keys{IndexUserKey(Value(KEY_NUM))};
+  ASSERT_EQ(RC::SUCCESS, scanner.rescan(keys, true, keys, true));
+  ASSERT_EQ(0, count_entries(scanner));
+
+  // 范围扫描
+  vector<IndexUserKey> left_keys{IndexUserKey(Value(10))};
+  vector<IndexUserKey> right_keys{IndexUserKey(Value(19))};
+  ASSERT_EQ(RC::SUCCESS, scanner.rescan(left_keys, true, right_keys, false));
+  ASSERT_EQ(9 * ENTRY_PER_KEY, count_entries(scanner));
+}
+
+TEST_F(BplusTreeScannerTest, close_releases_latches)
+{
+  BplusTreeScanner scanner(handler_);
+  for (int key = 0; key < KEY_NUM; key++) {
+    vector<IndexUserKey> keys{IndexUserKey(Value(key))};
+    ASSERT_EQ(RC::SUCCESS, scanner.open(keys, true, keys, true));
+
+    // 只读一条就关闭，扫描器停在某个叶子页面上
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, scanner.next_entry(rid));
+    ASSERT_EQ(RC::SUCCESS, scanner.close());
+  }
+
+  // 扫描器关闭后不再持有页面的锁，可以修改这些页面
+  for (int key = 0; key < KEY_NUM; key++) {
+    ASSERT_EQ(RC::SUCCESS, insert(key, KEY_NUM * ENTRY_PER_KEY + key));
+  }
+
+  vector<IndexUserKey> keys{IndexUserKey(Value(0))};
+  ASSERT_EQ(RC::SUCCESS, scanner.open(keys, true, keys, true));
+  int count = 0;
+  RID rid;
+  while (scanner.next_entry(rid) == RC::SUCCESS) {
+    count++;
+  }
+  ASSERT_EQ(ENTRY_PER_KEY + 1, count);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,167 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/lang/filesystem.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/record/free_space_map.h"
+#include "gtest/gtest.h"
+
+class FreeSpaceMapTest : public testing::Test
+{
+public:
+  void SetUp() override
+  {
+    filesystem::remove(file_name_);
+    ASSERT_EQ(RC::SUCCESS, bpm_.init(make_unique<VacuousDoubleWriteBuffer>()));
+    ASSERT_EQ(RC::SUCCESS, bpm_.create_file(file_name_));
+    open();
+  }
+
+  void TearDown() override
+  {
+    close();
+    filesystem::remove(file_name_);
+  }
+
+  void open() { ASSERT_EQ(RC::SUCCESS, bpm_.open_file(log_handler_, file_name_, buffer_pool_)); }
+
+  void close()
+  {
+    if (buffer_pool_ != nullptr) {
+      fsm_.close();
+      buffer_pool_->close_file();
+      buffer_pool_ = nullptr;
+    }
+  }
+
+  uint8_t category(PageNum page_num)
+  {
+    uint8_t category = FreeSpaceMap::MAX_CATEGORY;
+    EXPECT_EQ(RC::SUCCESS, fsm_.get(page_num, category));
+    return category;
+  }
+
+protected:
+  const char       *file_name_ = "free_space_map_test.fsm";
+  VacuousLogHandler log_handler_;
+  BufferPoolManager bpm_;
+  DiskBufferPool   *buffer_pool_ = nullptr;
+  FreeSpaceMap      fsm_;
+};
+
+TEST(FreeSpaceMap, category)
+{
+  ASSERT_EQ(FreeSpaceMap::FULL, FreeSpaceMap::category_of(0));
+  ASSERT_EQ(FreeSpaceMap::FULL, FreeSpaceMap::category_of(-1));
+  ASSERT_EQ(FreeSpaceMap::MAX_CATEGORY, FreeSpaceMap::category_of(BP_PAGE_DATA_SIZE));
+  ASSERT_EQ(FreeSpaceMap::MAX_CATEGORY / 2, FreeSpaceMap::category_of(BP_PAGE_DATA_SIZE / 2));
+  ASSERT_LE(FreeSpaceMap::category_of(100), FreeSpaceMap::category_of(200));
+}
+
+TEST_F(FreeSpaceMapTest, search)
+{
+  ASSERT_EQ(RC::SUCCESS, fsm_.init(*buffer_pool_, 1));
+
+  PageNum page_num = 0;
+  ASSERT_EQ(RC::RECORD_EOF, fsm_.search(1, page_num));
+
+  ASSERT_EQ(RC::SUCCESS, fsm_.update(1, 10));
+  ASSERT_EQ(RC::SUCCESS, fsm_.update(2, 200));
+  ASSERT_EQ(RC::SUCCESS, fsm_.update(3, FreeSpaceMap::FULL));
+  ASSERT_EQ(10, category(1));
+  ASSERT_EQ(200, category(2));
+  ASSERT_EQ(FreeSpaceMap::FULL, category(4));
+
+  ASSERT_EQ(RC::SUCCESS, fsm_.search(1, 0, page_num));
+  ASSERT_EQ(1, page_num);
+  ASSERT_EQ(RC::SUCCESS, fsm_.search(100, 0, page_num));
+  ASSERT_EQ(2, page_num);
+
+  // 从不同的位置开始查找，找到不同的页面，查找到末尾后从头开始
+  ASSERT_EQ(RC::SUCCESS, fsm_.search(1, 2, page_num));
+  ASSERT_EQ(2, page_num);
+  ASSERT_EQ(RC::SUCCESS, fsm_.search(1, 3, page_num));
+  ASSERT_EQ(1, page_num);
+  ASSERT_EQ(RC::SUCCESS, fsm_.search(1, page_num));
+
+  ASSERT_EQ(RC::SUCCESS, fsm_.update(2, FreeSpaceMap::FULL));
+  ASSERT_EQ(RC::RECORD_EOF, fsm_.search(100, 0, page_num));
+  ASSERT_EQ(RC::SUCCESS, fsm_.update(1, FreeSpaceMap::FULL));
+  ASSERT_EQ(RC::RECORD_EOF, fsm_.search(1, 0, page_num));
+}
+
+TEST_F(FreeSpaceMapTest, multiple_leaves)
+{
+  ASSERT_EQ(RC::SUCCESS, fsm_.init(*buffer_pool_, 1));
+
+  const PageNum far_page = FreeSpaceMap::LEAF_SLOTS * 2 + 5;
+  ASSERT_EQ(RC::SUCCESS, fsm_.update(far_page, 50));
+  ASSERT_EQ(RC::SUCCESS, fsm_.update(7, 20));
+
+  // 中间没有记录过的页面都是满的
+  ASSERT_EQ(FreeSpaceMap::FULL, category(FreeSpaceMap::LEAF_SLOTS));
+
+  PageNum page_num = 0;
+  ASSERT_EQ(RC::SUCCESS, fsm_.search(40, 1, page_num));
+  ASSERT_EQ(far_page, page_num);
+  ASSERT_EQ(RC::SUCCESS, fsm_.search(10, FreeSpaceMap::LEAF_SLOTS, page_num));
+  ASSERT_EQ(far_page, page_num);
+  ASSERT_EQ(RC::SUCCESS, fsm_.search(10, far_page + 1, page_num));
+  ASSERT_EQ(7, page_num);
+  ASSERT_EQ(RC::RECORD_EOF, fsm_.search(60, 1, page_num));
+
+  // 页面变满后，根页面上的上界在查找时修正
+  ASSERT_EQ(RC::SUCCESS, fsm_.update(far_page, FreeSpaceMap::FULL));
+  ASSERT_EQ(RC::SUCCESS, fsm_.search(10, FreeSpaceMap::LEAF_SLOTS, page_num));
+  ASSERT_EQ(7, page_num);
+  ASSERT_EQ(RC::SUCCESS, fsm_.update(far_page, 30));
+  ASSERT_EQ(RC::SUCCESS, fsm_.search(10, FreeSpaceMap::LEAF_SLOTS, page_num));
+  ASSERT_EQ(far_page, page_num);
+}
+
+TEST_F(FreeSpaceMapTest, reopen)
+{
+  ASSERT_EQ(RC::SUCCESS, fsm_.init(*buffer_pool_, 1));
+  ASSERT_EQ(RC::SUCCESS, fsm_.update(1, FreeSpaceMap::FULL));
+  ASSERT_EQ(RC::SUCCESS, fsm_.update(2, 30));
+
+  close();
+  open();
+
+  // 重新打开后，记录过的页面保持原来的分类，数据文件中新增的页面当作有空闲空间
+  ASSERT_EQ(RC::SUCCESS, fsm_.init(*buffer_pool_, 5));
+  ASSERT_EQ(FreeSpaceMap::FULL, category(1));
+  ASSERT_EQ(30, category(2));
+  ASSERT_EQ(FreeSpaceMap::MAX_CATEGORY, category(3));
+  ASSERT_EQ(FreeSpaceMap::MAX_CATEGORY, category(4));
+  ASSERT_EQ(FreeSpaceMap::FULL, category(5));
+
+  PageNum page_num = 0;
+  ASSERT_EQ(RC::SUCCESS, fsm_.search(100, 1, page_num));
+  ASSERT_EQ(3, page_num);
+}
+
+TEST_F(FreeSpaceMapTest, new_map_for_existing_data)
+{
+  // 以前创建的表没有空闲空间映射，所有的数据页面都当作有空闲空间
+  ASSERT_EQ(RC::SUCCESS, fsm_.init(*buffer_pool_, 4));
+  ASSERT_EQ(FreeSpaceMap::FULL, category(0));
+  for (PageNum page_num = 1; page_num < 4; page_num++) {
+    ASSERT_EQ(FreeSpaceMap::MAX_CATEGORY, category(page_num));
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,110 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#include "common/lang/memory.h"
+#include "common/lang/vector.h"
+#include "sql/operator/limit_physical_operator.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+/**
+ * @brief 依次输出 0 到 row_num - 1 的算子，记录被读取了多少行
+ */
+class CountingPhysicalOperator : public PhysicalOperator
+{
+public:
+  explicit CountingPhysicalOperator(int row_num) : row_num_(row_num) { tuple_.set_names({TupleCellSpec("id")}); }
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::STRING_LIST; }
+
+  RC open(Trx *) override
+  {
+    current_ = -1;
+    return RC::SUCCESS;
+  }
+
+  RC next() override
+  {
+    if (current_ + 1 >= row_num_) {
+      return RC::RECORD_EOF;
+    }
+    current_++;
+    pulled_++;
+    cells_[0].set_int(current_);
+    tuple_.set_cells(cells_);
+    return RC::SUCCESS;
+  }
+
+  RC     close() override { return RC::SUCCESS; }
+  Tuple *current_tuple() override { return &tuple_; }
+
+  int pulled() const { return pulled_; }
+
+private:
+  int            row_num_;
+  int            current_ = -1;
+  int            pulled_  = 0;
+  vector<Value>  cells_{Value(0)};
+  ValueListTuple tuple_;
+};
+
+vector<int> run_limit(int row_num, int limit, int offset, int &pulled)
+{
+  LimitPhysicalOperator limit_oper(limit, offset);
+  auto                  child     = make_unique<CountingPhysicalOperator>(row_num);
+  auto                  child_ptr = child.get();
+  limit_oper.add_child(std::move(child));
+
+  vector<int> ids;
+  EXPECT_EQ(RC::SUCCESS, limit_oper.open(nullptr));
+  while (limit_oper.next() == RC::SUCCESS) {
+    Value value;
+    EXPECT_EQ(RC::SUCCESS, limit_oper.current_tuple()->cell_at(0, value));
+    ids.push_back(value.get_int());
+  }
+  // 返回 EOF 之后再调用 next 也不会继续读取子算子
+  EXPECT_EQ(RC::RECORD_EOF, limit_oper.next());
+  EXPECT_EQ(RC::SUCCESS, limit_oper.close());
+  pulled = child_ptr->pulled();
+  return ids;
+}
+
+}  // namespace
+
+TEST(LimitPhysicalOperator, limit_and_offset)
+{
+  int pulled = 0;
+  EXPECT_EQ((vector<int>{0, 1, 2}), run_limit(1000, 3, 0, pulled));
+  EXPECT_EQ(3, pulled);
+
+  EXPECT_EQ((vector<int>{10, 11}), run_limit(1000, 2, 10, pulled));
+  EXPECT_EQ(12, pulled);
+
+  EXPECT_EQ((vector<int>{8, 9}), run_limit(10, 5, 8, pulled));
+  EXPECT_EQ(10, pulled);
+}
+
+TEST(LimitPhysicalOperator, empty_result)
+{
+  int pulled = 0;
+  EXPECT_TRUE(run_limit(1000, 0, 5, pulled).empty());
+  EXPECT_EQ(0, pulled);
+
+  EXPECT_TRUE(run_limit(10, 5, 20, pulled).empty());
+  EXPECT_EQ(10, pulled);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,139 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "gtest/gtest.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/trx/commit_table.h"
+#include "storage/trx/mvcc_trx.h"
+#include "storage/trx/read_view.h"
+
+using namespace std;
+
+TEST(ReadView, watermark)
+{
+  ReadView read_view(5, 10, vector<int32_t>{12, 7, 3, 5});
+  ASSERT_TRUE(read_view.valid());
+  ASSERT_EQ(3, read_view.low_watermark());
+  ASSERT_EQ(10, read_view.high_watermark());
+
+  ASSERT_TRUE(read_view.is_visible(1));
+  ASSERT_TRUE(read_view.is_visible(2));
+  ASSERT_FALSE(read_view.is_visible(3));
+  ASSERT_TRUE(read_view.is_visible(4));
+  ASSERT_FALSE(read_view.is_visible(5));
+  ASSERT_TRUE(read_view.is_visible(6));
+  ASSERT_FALSE(read_view.is_visible(7));
+  ASSERT_TRUE(read_view.is_visible(9));
+  ASSERT_FALSE(read_view.is_visible(10));
+  ASSERT_FALSE(read_view.is_visible(12));
+  ASSERT_FALSE(read_view.is_visible(100));
+
+  ReadView empty_view(-1, 10, vector<int32_t>{});
+  ASSERT_EQ(10, empty_view.low_watermark());
+  ASSERT_TRUE(empty_view.is_visible(9));
+  ASSERT_FALSE(empty_view.is_visible(10));
+
+  ASSERT_FALSE(ReadView().valid());
+}
+
+TEST(ReadView, concurrent_commit)
+{
+  MvccTrxKit kit;
+  ASSERT_EQ(RC::SUCCESS, kit.init());
+
+  VacuousLogHandler log_handler;
+
+  Trx *trx1 = kit.create_trx(log_handler);
+  Trx *trx2 = kit.create_trx(log_handler);
+  ASSERT_EQ(RC::SUCCESS, trx1->start_if_need());
+  ASSERT_EQ(RC::SUCCESS, trx2->start_if_need());
+
+  ReadView view1;
+  kit.create_read_view(trx1->id(), view1);
+  ASSERT_TRUE(view1.is_active(trx1->id()));
+  ASSERT_TRUE(view1.is_active(trx2->id()));
+
+  int32_t trx2_id = trx2->id();
+  ASSERT_EQ(RC::SUCCESS, trx2->commit());
+
+  // trx2 的提交号在 view1 创建之后才分配，view1 看不到
+  ReadView view3;
+  kit.create_read_view(-1, view3);
+  int32_t commit_id = view3.high_watermark() - 1;
+  ASSERT_GT(commit_id, trx2_id);
+  ASSERT_FALSE(view1.is_visible(commit_id));
+  ASSERT_TRUE(view3.is_visible(commit_id));
+  ASSERT_TRUE(view3.is_visible(trx2_id));
+  ASSERT_FALSE(view3.is_visible(trx1->id()));
+
+  ASSERT_EQ(RC::SUCCESS, trx1->commit());
+
+  kit.destroy_trx(trx1);
+  kit.destroy_trx(trx2);
+}
+
+TEST(CommitTable, commit_without_rewrite)
+{
+  CommitTable commit_table;
+  int32_t     commit_id = 0;
+  ASSERT_FALSE(commit_table.is_committed(3, commit_id));
+
+  commit_table.set_committed(3, 8);
+  commit_table.set_committed(5, 6);
+  commit_table.set_committed(20, 21);
+  ASSERT_EQ(3, commit_table.size());
+  ASSERT_TRUE(commit_table.is_committed(3, commit_id));
+  ASSERT_EQ(8, commit_id);
+
+  ASSERT_EQ(2, commit_table.remove_below(10));
+  ASSERT_FALSE(commit_table.is_committed(3, commit_id));
+  ASSERT_FALSE(commit_table.is_committed(5, commit_id));
+  ASSERT_TRUE(commit_table.is_committed(20, commit_id));
+  ASSERT_EQ(21, commit_id);
+  ASSERT_EQ(1, commit_table.size());
+}
+
+TEST(CommitTable, trx_commit)
+{
+  MvccTrxKit kit;
+  ASSERT_EQ(RC::SUCCESS, kit.init());
+
+  VacuousLogHandler log_handler;
+
+  Trx *trx = kit.create_trx(log_handler);
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  int32_t trx_id    = trx->id();
+  int32_t commit_id = 0;
+  ASSERT_FALSE(kit.commit_table().is_committed(trx_id, commit_id));
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  ASSERT_TRUE(kit.commit_table().is_committed(trx_id, commit_id));
+  ASSERT_GT(commit_id, trx_id);
+
+  // 回滚的事务不会登记
+  Trx *trx2 = kit.create_trx(log_handler);
+  ASSERT_EQ(RC::SUCCESS, trx2->start_if_need());
+  ASSERT_EQ(RC::SUCCESS, trx2->rollback());
+  ASSERT_FALSE(kit.commit_table().is_committed(trx2->id(), commit_id));
+
+  // 恢复时根据提交日志重建提交状态，并推进事务号
+  kit.recover_commit(100, 101);
+  ASSERT_TRUE(kit.commit_table().is_committed(100, commit_id));
+  ASSERT_EQ(101, commit_id);
+  ASSERT_GT(kit.next_trx_id(), 101);
+
+  kit.destroy_trx(trx);
+  kit.destroy_trx(trx2);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
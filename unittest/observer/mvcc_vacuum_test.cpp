@@ -0,0 +1,134 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+
+#include "gtest/gtest.h"
+#include "storage/db/db.h"
+#include "storage/record/record_manager.h"
+#include "storage/table/table.h"
+#include "storage/trx/mvcc_trx.h"
+
+using namespace std;
+
+static int count_records(Table *table, Trx *trx)
+{
+  RecordFileScanner scanner;
+  EXPECT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, trx, ReadWriteMode::READ_ONLY));
+  int    count = 0;
+  Record record;
+  while (OB_SUCC(scanner.next(record))) {
+    count++;
+  }
+  return count;
+}
+
+TEST(MvccVacuum, reclaim_below_horizon)
+{
+  filesystem::path test_directory("mvcc_vacuum_test");
+  filesystem::remove_all(test_directory);
+  filesystem::create_directories(test_directory / "test_db");
+
+  auto db = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db->init("test_db", (test_directory / "test_db").c_str(), "mvcc", "vacuous"));
+
+  vector<AttrInfoSqlNode> attr_infos;
+  for (const char *name : {"id", "v"}) {
+    AttrInfoSqlNode attr_info;
+    attr_info.name     = name;
+    attr_info.type     = AttrType::INTS;
+    attr_info.arr_len  = 1;
+    attr_info.dim      = 0;
+    attr_info.nullable = false;
+    attr_infos.push_back(attr_info);
+  }
+  ASSERT_EQ(RC::SUCCESS, db->create_table("t", attr_infos));
+  Table *table = db->find_table("t");
+  ASSERT_NE(nullptr, table);
+
+  MvccTrxKit &trx_kit = static_cast<MvccTrxKit &>(db->trx_kit());
+  LogHandler &log_handler = db->log_handler();
+
+  Trx *trx = trx_kit.create_trx(log_handler);
+  ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  vector<const FieldMeta *> index_fields{table->table_meta().field("id")};
+  ASSERT_EQ(RC::SUCCESS, table->create_index(trx, index_fields, "t_id", false));
+
+  const int record_num = 100;
+  for (int i = 0; i < record_num; i++) {
+    Value  values[2] = {Value(i), Value(i)};
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table->make_record(2, values, record));
+    ASSERT_EQ(RC::SUCCESS, trx->insert_record(table, record));
+  }
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+
+  // 读事务在删除之前开始，它的读视图还能看到删除的记录
+  Trx *reader = trx_kit.create_trx(log_handler);
+  ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+
+  vector<Record> records;
+  {
+    RecordFileScanner scanner;
+    ASSERT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, trx, ReadWriteMode::READ_WRITE));
+    Record record;
+    while (OB_SUCC(scanner.next(record))) {
+      records.push_back(record);
+    }
+  }
+  ASSERT_EQ(record_num, static_cast<int>(records.size()));
+
+  Trx *deleter = trx_kit.create_trx(log_handler);
+  ASSERT_EQ(RC::SUCCESS, deleter->start_if_need());
+  for (int i = 0; i < record_num; i += 2) {
+    ASSERT_EQ(RC::SUCCESS, deleter->delete_record(table, records[i]));
+  }
+  ASSERT_EQ(RC::SUCCESS, deleter->commit());
+
+  MvccVacuum            &vacuum = trx_kit.vacuum();
+  const MvccVacuumStats &stats  = vacuum.stats();
+  ASSERT_EQ(RC::SUCCESS, vacuum.run_once(*db, -1));
+  ASSERT_EQ(0, stats.reclaimed_records.load());
+  ASSERT_EQ(record_num / 2, stats.dead_versions.load());
+  ASSERT_EQ(record_num, count_records(table, reader));
+  ASSERT_EQ(record_num, count_records(table, nullptr));
+
+  ASSERT_EQ(RC::SUCCESS, reader->commit());
+
+  // 每轮最多回收10条
+  ASSERT_EQ(RC::SUCCESS, vacuum.run_once(*db, 10));
+  ASSERT_EQ(10, stats.reclaimed_records.load());
+  ASSERT_EQ(record_num / 2 - 10, stats.dead_versions.load());
+
+  ASSERT_EQ(RC::SUCCESS, vacuum.run_once(*db, -1));
+  ASSERT_EQ(record_num / 2, stats.reclaimed_records.load());
+  ASSERT_GT(stats.reclaimed_bytes.load(), 0);
+  ASSERT_EQ(0, stats.dead_versions.load());
+  ASSERT_EQ(0, trx_kit.commit_table().size());
+
+  ASSERT_EQ(record_num / 2, count_records(table, nullptr));
+  Trx *checker = trx_kit.create_trx(log_handler);
+  ASSERT_EQ(RC::SUCCESS, checker->start_if_need());
+  ASSERT_EQ(record_num / 2, count_records(table, checker));
+  ASSERT_EQ(RC::SUCCESS, checker->commit());
+
+  trx_kit.destroy_trx(trx);
+  trx_kit.destroy_trx(reader);
+  trx_kit.destroy_trx(deleter);
+  trx_kit.destroy_trx(checker);
+  db.reset();
+  filesystem::remove_all(test_directory);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
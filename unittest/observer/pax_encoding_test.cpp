@@ -0,0 +1,455 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <cstring>
+#include "common/lang/filesystem.h"
+#include <random>
+
+#define protected public
+#define private public
+#include "storage/table/table.h"
+#undef protected
+#undef private
+
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/record/pax_encoding.h"
+#include "storage/record/record_manager.h"
+#include "sql/expr/aggregate_state.h"
+#include "sql/expr/expression.h"
+#include "gtest/gtest.h"
+
+using namespace common;
+
+TEST(PaxEncoding, dictionary)
+{
+  const int      record_capacity = 16;
+  PaxColumnIndex index{0, 0, 4, PaxEncoding::DICTIONARY, 4};
+  vector<char>   area(index.area_size(record_capacity));
+  PaxDictionary  dictionary(area.data(), index);
+  dictionary.init();
+
+  vector<char> bits(4, 0);
+  Bitmap       bitmap(bits.data(), record_capacity);
+
+  const char *values[] = {"aaaa", "bbbb", "cccc", "dddd", "eeee"};
+  for (int i = 0; i < 8; i++) {
+    ASSERT_TRUE(dictionary.can_set(values[i % 4]));
+    dictionary.set(i, values[i % 4]);
+    bitmap.set_bit(i);
+  }
+  ASSERT_EQ(4, dictionary.entry_num());
+  ASSERT_EQ(2, dictionary.find("cccc"));
+  ASSERT_EQ(-1, dictionary.find("eeee"));
+  ASSERT_FALSE(dictionary.can_set("eeee"));
+  for (int i = 0; i < 8; i++) {
+    ASSERT_EQ(0, memcmp(values[i % 4], dictionary.get(i), 4));
+  }
+
+  // 删除所有 "bbbb" 后清理字典，腾出一个字典项
+  bitmap.clear_bit(1);
+  bitmap.clear_bit(5);
+  dictionary.shrink(bitmap, record_capacity);
+  ASSERT_EQ(3, dictionary.entry_num());
+  ASSERT_TRUE(dictionary.can_set("eeee"));
+  dictionary.set(1, "eeee");
+  bitmap.set_bit(1);
+  ASSERT_EQ(0, memcmp("eeee", dictionary.get(1), 4));
+  for (int i : {0, 2, 3, 4, 6, 7}) {
+    ASSERT_EQ(0, memcmp(values[i % 4], dictionary.get(i), 4));
+  }
+}
+
+TEST(PaxEncoding, run_length)
+{
+  const int      record_capacity = 512;
+  PaxColumnIndex index{0, 0, sizeof(int), PaxEncoding::RLE, 64};
+  vector<char>   area(index.area_size(record_capacity));
+  PaxRunLength   run_length(area.data(), index);
+  run_length.init();
+
+  vector<char> bits(record_capacity / 8, 0);
+  Bitmap       bitmap(bits.data(), record_capacity);
+
+  // 连续相同的值只占用一个游程
+  for (int i = 0; i < 300; i++) {
+    int value = i / 100;
+    ASSERT_TRUE(run_length.can_set(i, reinterpret_cast<const char *>(&value)));
+    run_length.set(i, reinterpret_cast<const char *>(&value));
+    bitmap.set_bit(i);
+  }
+  ASSERT_EQ(3, run_length.run_num());
+
+  // 与参照的数组比较，随机修改会拆分和合并游程
+  vector<int>  expected(300);
+  std::mt19937 random(1);
+  for (int i = 0; i < 300; i++) {
+    expected[i] = i / 100;
+  }
+  for (int n = 0; n < 2000; n++) {
+    const int slot  = random() % 300;
+    const int value = random() % 3;
+    if (!run_length.can_set(slot, reinterpret_cast<const char *>(&value))) {
+      run_length.shrink(bitmap, record_capacity);
+      if (!run_length.can_set(slot, reinterpret_cast<const char *>(&value))) {
+        continue;
+      }
+    }
+    run_length.set(slot, reinterpret_cast<const char *>(&value));
+    expected[slot] = value;
+    ASSERT_LE(run_length.run_num(), index.entry_capacity);
+  }
+
+  vector<int> decoded(300);
+  run_length.decode(0, 300, reinterpret_cast<char *>(decoded.data()));
+  for (int i = 0; i < 300; i++) {
+    ASSERT_EQ(expected[i], decoded[i]) << "slot " << i;
+    ASSERT_EQ(0, memcmp(&expected[i], run_length.get(i), sizeof(int)));
+  }
+
+  // 只保留前 100 条记录，清理后只剩下这些记录需要的游程
+  for (int i = 100; i < 300; i++) {
+    bitmap.clear_bit(i);
+  }
+  run_length.shrink(bitmap, record_capacity);
+  int runs = 1;
+  for (int i = 1; i < 100; i++) {
+    runs += expected[i] != expected[i - 1] ? 1 : 0;
+  }
+  ASSERT_EQ(runs, run_length.run_num());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(0, memcmp(&expected[i], run_length.get(i), sizeof(int)));
+  }
+}
+
+class PaxEncodingPageTest : public testing::Test
+{
+public:
+  static constexpr int RECORD_SIZE = 4 + 16 + 4;  // id int, status char(16), score int
+
+  void SetUp() override
+  {
+    filesystem::remove(file_name_);
+    ASSERT_EQ(RC::SUCCESS, bpm_.init(make_unique<VacuousDoubleWriteBuffer>()));
+    ASSERT_EQ(RC::SUCCESS, bpm_.create_file(file_name_));
+    ASSERT_EQ(RC::SUCCESS, bpm_.open_file(log_handler_, file_name_, buffer_pool_));
+
+    table_meta_.fields_.resize(3);
+    init_field(0, "id", AttrType::INTS, 0, 4);
+    init_field(1, "status", AttrType::CHARS, 4, 16);
+    init_field(2, "score", AttrType::INTS, 20, 4);
+  }
+
+  void TearDown() override
+  {
+    bpm_.close_file(file_name_);
+    filesystem::remove(file_name_);
+  }
+
+  void init_field(int i, const char *name, AttrType type, int offset, int len)
+  {
+    table_meta_.fields_[i].init(name, type, offset, len, true /*visible*/, i);
+  }
+
+  static void make_record(char *record, int id, const char *status, int score)
+  {
+    memset(record, 0, RECORD_SIZE);
+    memcpy(record, &id, sizeof(id));
+    strncpy(record + 4, status, 16);
+    memcpy(record + 20, &score, sizeof(score));
+  }
+
+  /**
+   * @brief 在一个新的页面中插入记录，直到页面放不下，返回插入的记录数
+   */
+  int fill_page(PaxRecordPageHandler &handler, std::function<string(int)> status)
+  {
+    Frame *frame = nullptr;
+    EXPECT_EQ(RC::SUCCESS, buffer_pool_->allocate_page(&frame));
+    EXPECT_EQ(RC::SUCCESS, handler.init_empty_page(*buffer_pool_, log_handler_, frame->page_num(), RECORD_SIZE, &table_meta_));
+    frame->unpin();
+
+    char record[RECORD_SIZE];
+    int  count = 0;
+    while (!handler.is_full()) {
+      make_record(record, count, status(count).c_str(), count / 64);
+      RID rid;
+      RC  rc = handler.insert_record(record, &rid);
+      if (rc == RC::RECORD_NOMEM) {
+        break;
+      }
+      EXPECT_EQ(RC::SUCCESS, rc);
+      count++;
+    }
+    return count;
+  }
+
+protected:
+  const char       *file_name_ = "pax_encoding_test.bp";
+  VacuousLogHandler log_handler_;
+  BufferPoolManager bpm_;
+  DiskBufferPool   *buffer_pool_ = nullptr;
+  TableMeta         table_meta_;
+};
+
+TEST_F(PaxEncodingPageTest, low_cardinality)
+{
+  const char *statuses[] = {"new", "paid", "shipped", "done"};
+
+  PaxRecordPageHandler handler;
+  const int            count = fill_page(handler, [&statuses](int i) { return string(statuses[i % 4]); });
+
+  // 不编码时每条记录占用 24 字节，编码后只有 id 列是原样存放的
+  const int plain_capacity = BP_PAGE_DATA_SIZE / RECORD_SIZE;
+  ASSERT_GT(count, plain_capacity * 3);
+
+  Record record;
+  for (int i = 0; i < count; i += 97) {
+    ASSERT_EQ(RC::SUCCESS, handler.get_record(RID(handler.get_page_num(), i), record));
+    ASSERT_EQ(i, *reinterpret_cast<const int *>(record.data()));
+    ASSERT_STREQ(statuses[i % 4], record.data() + 4);
+  }
+
+  // status 列以字典编号的形式返回，score 列解码后返回
+  Chunk chunk;
+  chunk.add_column(make_unique<Column>(*table_meta_.field(1)), 1);
+  chunk.add_column(make_unique<Column>(*table_meta_.field(2)), 2);
+  ASSERT_EQ(RC::SUCCESS, handler.get_chunk(chunk));
+  ASSERT_EQ(count, chunk.rows());
+  ASSERT_EQ(Column::Type::DICTIONARY_COLUMN, chunk.column(0).column_type());
+  ASSERT_EQ(4, chunk.column(0).dictionary_size());
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(string(statuses[i % 4]), chunk.get_value(0, i).get_string());
+    ASSERT_EQ(i / 64, chunk.get_value(1, i).get_int());
+  }
+
+  // 在字典编号上比较，不需要解码
+  ComparisonExpr  expr(CompOp::EQUAL_TO,
+      make_unique<FieldExpr>(Field(nullptr, table_meta_.field(1))),
+      make_unique<ValueExpr>(Value("paid")));
+  vector<uint8_t> select(count, 1);
+  static_cast<FieldExpr *>(expr.left().get())->set_pos(0);
+  ASSERT_EQ(RC::SUCCESS, expr.eval(chunk, select));
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(i % 4 == 1 ? 1 : 0, select[i]);
+  }
+
+  // 删除记录后列数据不再连续，拷贝出来的仍然是字典编号
+  for (int i = 0; i < count; i += 2) {
+    RID rid(handler.get_page_num(), i);
+    ASSERT_EQ(RC::SUCCESS, handler.delete_record(&rid));
+  }
+  chunk.reset_data();
+  ASSERT_EQ(RC::SUCCESS, handler.get_chunk(chunk));
+  ASSERT_EQ(count / 2, chunk.rows());
+  ASSERT_EQ(Column::Type::DICTIONARY_COLUMN, chunk.column(0).column_type());
+  for (int i = 0; i < chunk.rows(); i++) {
+    ASSERT_EQ(string(statuses[(i * 2 + 1) % 4]), chunk.get_value(0, i).get_string());
+  }
+  handler.cleanup();
+}
+
+TEST_F(PaxEncodingPageTest, selected_chunk)
+{
+  // id 列不编码，status 列字典编码，score 列游程编码
+  const char *statuses[] = {"new", "paid", "shipped", "done"};
+
+  PaxRecordPageHandler handler;
+  const int            count = fill_page(handler, [&statuses](int i) { return string(statuses[i % 4]); });
+  for (int i = 0; i < count; i += 3) {
+    RID rid(handler.get_page_num(), i);
+    ASSERT_EQ(RC::SUCCESS, handler.delete_record(&rid));
+  }
+
+  // 先取出 id 列，再只取 id 是 5 的倍数的记录的其它列
+  Chunk id_chunk;
+  id_chunk.add_column(make_unique<Column>(*table_meta_.field(0)), 0);
+  ASSERT_EQ(RC::SUCCESS, handler.get_chunk(id_chunk));
+
+  vector<uint8_t> select(id_chunk.rows());
+  vector<int>     expected_ids;
+  for (int i = 0; i < id_chunk.rows(); i++) {
+    const int id = id_chunk.get_value(0, i).get_int();
+    select[i]    = id % 5 == 0 ? 1 : 0;
+    if (select[i]) {
+      expected_ids.push_back(id);
+    }
+  }
+
+  Chunk chunk;
+  chunk.add_column(make_unique<Column>(*table_meta_.field(1)), 1);
+  chunk.add_column(make_unique<Column>(*table_meta_.field(2)), 2);
+  ASSERT_EQ(RC::SUCCESS, handler.get_selected_chunk(chunk, select));
+  ASSERT_EQ(static_cast<int>(expected_ids.size()), chunk.rows());
+  ASSERT_EQ(Column::Type::DICTIONARY_COLUMN, chunk.column(0).column_type());
+  for (int i = 0; i < chunk.rows(); i++) {
+    const int id = expected_ids[i];
+    ASSERT_EQ(string(statuses[id % 4]), chunk.get_value(0, i).get_string());
+    ASSERT_EQ(id / 64, chunk.get_value(1, i).get_int());
+  }
+  handler.cleanup();
+}
+
+TEST_F(PaxEncodingPageTest, high_cardinality)
+{
+  // 每条记录的 status 都不一样，字典放不下以后换成不编码的方式，已有的记录保持不变
+  PaxRecordPageHandler handler;
+  const int            count = fill_page(handler, [](int i) { return "status-" + std::to_string(i); });
+  ASSERT_GT(count, PaxDictionary::MAX_ENTRY_NUM);
+
+  Record record;
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(RC::SUCCESS, handler.get_record(RID(handler.get_page_num(), i), record));
+    ASSERT_EQ(i, *reinterpret_cast<const int *>(record.data()));
+    ASSERT_EQ("status-" + std::to_string(i), string(record.data() + 4));
+    ASSERT_EQ(i / 64, *reinterpret_cast<const int *>(record.data() + 20));
+  }
+
+  Chunk chunk;
+  chunk.add_column(make_unique<Column>(*table_meta_.field(1)), 1);
+  ASSERT_EQ(RC::SUCCESS, handler.get_chunk(chunk));
+  ASSERT_EQ(Column::Type::NORMAL_COLUMN, chunk.column(0).column_type());
+  ASSERT_EQ(count, chunk.rows());
+  handler.cleanup();
+}
+
+TEST_F(PaxEncodingPageTest, update)
+{
+  const char          *statuses[] = {"a", "b"};
+  PaxRecordPageHandler handler;
+  const int            count = fill_page(handler, [&statuses](int i) { return string(statuses[i % 2]); });
+
+  // 更新会拆分游程和增加字典项，放不下时重新布局，放不下已有的记录时返回 RECORD_NOMEM
+  char record_data[RECORD_SIZE];
+  int  updated = 0;
+  for (int i = 0; i < count; i += 7) {
+    make_record(record_data, i, ("u" + std::to_string(i)).c_str(), i);
+    RC rc = handler.update_record(RID(handler.get_page_num(), i), record_data);
+    if (rc == RC::RECORD_NOMEM) {
+      break;
+    }
+    ASSERT_EQ(RC::SUCCESS, rc);
+    updated = i + 1;
+  }
+  ASSERT_GT(updated, 0);
+
+  Record record;
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(RC::SUCCESS, handler.get_record(RID(handler.get_page_num(), i), record));
+    ASSERT_EQ(i, *reinterpret_cast<const int *>(record.data()));
+    if (i < updated && i % 7 == 0) {
+      ASSERT_EQ("u" + std::to_string(i), string(record.data() + 4));
+      ASSERT_EQ(i, *reinterpret_cast<const int *>(record.data() + 20));
+    } else {
+      ASSERT_STREQ(statuses[i % 2], record.data() + 4);
+      ASSERT_EQ(i / 64, *reinterpret_cast<const int *>(record.data() + 20));
+    }
+  }
+  handler.cleanup();
+}
+
+TEST_F(PaxEncodingPageTest, null_bitmap)
+{
+  // 记录的格式是 null 位图(1字节) | id int | score int，score 可以是 null
+  constexpr int record_size = 1 + 4 + 4;
+  table_meta_.fields_.resize(2);
+  init_field(0, "id", AttrType::INTS, 1, 4);
+  init_field(1, "score", AttrType::INTS, 5, 4);
+  table_meta_.null_bitmap_start_ = 0;
+
+  // 连续的一段 null 只占一个游程；间隔出现的 null 游程太多，null 位图列会换成不编码
+  vector<std::function<bool(int)>> null_patterns = {
+      [](int i) { return i >= 100 && i < 200; },
+      [](int i) { return i % 10 == 0; },
+  };
+  for (auto &is_null : null_patterns) {
+    PaxRecordPageHandler handler;
+    Frame               *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool_->allocate_page(&frame));
+    ASSERT_EQ(RC::SUCCESS,
+        handler.init_empty_page(*buffer_pool_, log_handler_, frame->page_num(), record_size, &table_meta_));
+    frame->unpin();
+
+    const int count = 600;
+    char      record[record_size];
+    for (int i = 0; i < count; i++) {
+      const int score = i;
+      record[0]       = is_null(i) ? 0x02 : 0;
+      memcpy(record + 1, &i, sizeof(i));
+      memcpy(record + 5, &score, sizeof(score));
+      RID rid;
+      ASSERT_EQ(RC::SUCCESS, handler.insert_record(record, &rid));
+    }
+
+    // 没有 null 的列不分配 null 位图
+    Chunk chunk;
+    chunk.add_column(make_unique<Column>(*table_meta_.field(0)), 0);
+    chunk.add_column(make_unique<Column>(*table_meta_.field(1)), 1);
+    ASSERT_EQ(RC::SUCCESS, handler.get_chunk(chunk));
+    ASSERT_EQ(count, chunk.rows());
+    ASSERT_FALSE(chunk.column(0).has_null());
+    ASSERT_TRUE(chunk.column(1).has_null());
+    for (int i = 0; i < count; i++) {
+      ASSERT_EQ(is_null(i), chunk.column(1).is_null(i));
+      ASSERT_EQ(is_null(i), chunk.get_value(1, i).is_null());
+    }
+
+    // 比较时 null 的行不满足条件
+    ComparisonExpr comparison(CompOp::GREAT_EQUAL,
+        make_unique<FieldExpr>(Field(nullptr, table_meta_.field(1))),
+        make_unique<ValueExpr>(Value(0)));
+    static_cast<FieldExpr *>(comparison.left().get())->set_pos(1);
+    vector<uint8_t> select(count, 1);
+    ASSERT_EQ(RC::SUCCESS, comparison.eval(chunk, select));
+    for (int i = 0; i < count; i++) {
+      ASSERT_EQ(is_null(i) ? 0 : 1, select[i]);
+    }
+
+    // 计算的结果合并两边的 null 位图，累加时跳过 null
+    ArithmeticExpr arithmetic(ArithmeticExpr::Type::ADD,
+        make_unique<FieldExpr>(Field(nullptr, table_meta_.field(0))),
+        make_unique<FieldExpr>(Field(nullptr, table_meta_.field(1))));
+    static_cast<FieldExpr *>(arithmetic.left().get())->set_pos(0);
+    static_cast<FieldExpr *>(arithmetic.right().get())->set_pos(1);
+    Column sum_column;
+    ASSERT_EQ(RC::SUCCESS, arithmetic.get_column(chunk, sum_column));
+    SumState<int> state;
+    int           expected_sum = 0;
+    for (int i = 0; i < count; i++) {
+      ASSERT_EQ(is_null(i), sum_column.is_null(i));
+      expected_sum += is_null(i) ? 0 : i * 2;
+    }
+    state.update(reinterpret_cast<const int *>(sum_column.data()), sum_column.count(), sum_column.null_bitmap());
+    ASSERT_EQ(expected_sum, state.value);
+
+    // 删除记录后按照有效记录区间取出 null 标记
+    for (int i = 0; i < count; i += 3) {
+      RID rid(handler.get_page_num(), i);
+      ASSERT_EQ(RC::SUCCESS, handler.delete_record(&rid));
+    }
+    chunk.reset_data();
+    ASSERT_EQ(RC::SUCCESS, handler.get_chunk(chunk));
+    ASSERT_EQ(count - (count + 2) / 3, chunk.rows());
+    for (int i = 0; i < chunk.rows(); i++) {
+      const int id = chunk.get_value(0, i).get_int();
+      ASSERT_EQ(is_null(id), chunk.column(1).is_null(i));
+    }
+    handler.cleanup();
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  filesystem::path log_filename = filesystem::path(argv[0]).filename();
+  LoggerFactory::init_default(log_filename.string() + ".log", LOG_LEVEL_INFO);
+  return RUN_ALL_TESTS();
+}
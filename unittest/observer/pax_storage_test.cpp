@@ -35,13 +35,15 @@ using namespace common;
 class PaxRecordFileScannerWithParam : public testing::TestWithParam<int>
 {};
 
-TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
+TEST_P(PaxRecordFileScannerWithParam, test_file_iterator)
 {
   int               record_insert_num = GetParam();
   VacuousLogHandler log_handler;
 
   const char *record_manager_file = "record_manager.bp";
+  const char *fsm_file            = "record_manager.fsm";
   filesystem::remove(record_manager_file);
+  filesystem::remove(fsm_file);
 
   BufferPoolManager *bpm = new BufferPoolManager();
   ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
@@ -52,6 +54,10 @@ TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
   rc = bpm->open_file(log_handler, record_manager_file, bp);
   ASSERT_EQ(rc, RC::SUCCESS);
 
+  DiskBufferPool *fsm_bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(fsm_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, fsm_file, fsm_bp));
+
   TableMeta table_meta;
   table_meta.fields_.resize(2);
   table_meta.fields_[0].attr_type_ = AttrType::INTS;
@@ -64,6 +70,7 @@ TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
   RecordFileHandler file_handler(StorageFormat::PAX_FORMAT);
   rc = file_handler.init(*bp, log_handler, &table_meta);
   ASSERT_EQ(rc, RC::SUCCESS);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init_free_space_map(*fsm_bp));
 
   VacuousTrx        trx;
   ChunkFileScanner chunk_scanner;
@@ -169,13 +176,14 @@ TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
   ASSERT_EQ(count, rids.size() / 2);
 
   bpm->close_file(record_manager_file);
+  bpm->close_file(fsm_file);
   delete bpm;
 }
 
 class PaxPageHandlerTestWithParam : public testing::TestWithParam<int>
 {};
 
-TEST_P(PaxPageHandlerTestWithParam, DISABLED_PaxPageHandler)
+TEST_P(PaxPageHandlerTestWithParam, PaxPageHandler)
 {
   int               record_num = GetParam();
   VacuousLogHandler log_handler;
@@ -18,7 +18,9 @@ See the Mulan PSL v2 for more details. */
 #include <utility>
 
 #include "storage/buffer/disk_buffer_pool.h"
+#include "storage/common/condition_filter.h"
 #include "storage/record/record_manager.h"
+#include "storage/table/table_meta.h"
 #include "storage/trx/vacuous_trx.h"
 #include "storage/clog/vacuous_log_handler.h"
 #include "storage/clog/disk_log_handler.h"
@@ -138,9 +140,16 @@ TEST(RecordFileScanner, test_record_file_iterator)
   rc = bpm->open_file(log_handler, record_manager_file, bp);
   ASSERT_EQ(rc, RC::SUCCESS);
 
+  const char *fsm_file = "record_manager.fsm";
+  filesystem::remove(fsm_file);
+  DiskBufferPool *fsm_bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(fsm_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, fsm_file, fsm_bp));
+
   RecordFileHandler file_handler(StorageFormat::ROW_FORMAT);
   rc = file_handler.init(*bp, log_handler, nullptr);
   ASSERT_EQ(rc, RC::SUCCESS);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init_free_space_map(*fsm_bp));
 
   VacuousTrx        trx;
   RecordFileScanner file_scanner;
@@ -200,6 +209,202 @@ TEST(RecordFileScanner, test_record_file_iterator)
   file_scanner.close_scan();
   ASSERT_EQ(count, rids.size() / 2);
 
+  bpm->close_file(fsm_file);
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+class ModFilter : public ConditionFilter
+{
+public:
+  explicit ModFilter(int mod) : mod_(mod) {}
+
+  bool filter(const Record &rec) const override { return *reinterpret_cast<const int *>(rec.data()) % mod_ == 0; }
+
+private:
+  int mod_;
+};
+
+TEST(RecordFileScanner, next_batch)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager_batch.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file, bp));
+
+  const char *fsm_file = "record_manager_batch.fsm";
+  filesystem::remove(fsm_file);
+  DiskBufferPool *fsm_bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(fsm_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, fsm_file, fsm_bp));
+
+  RecordFileHandler file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, nullptr));
+  ASSERT_EQ(RC::SUCCESS, file_handler.init_free_space_map(*fsm_bp));
+
+  const int        record_insert_num = 1000;
+  char             record_data[20]   = {0};
+  std::vector<RID> rids;
+  for (int i = 0; i < record_insert_num; i++) {
+    memcpy(record_data, &i, sizeof(i));
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, sizeof(record_data), &rid));
+    rids.push_back(rid);
+  }
+  for (int i = 0; i < record_insert_num; i += 2) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+  }
+
+  // 每次返回一个页面中满足条件的记录，数据直接引用页面
+  VacuousTrx        trx;
+  ModFilter         filter(3);
+  RecordFileScanner file_scanner;
+  ASSERT_EQ(RC::SUCCESS, file_scanner.open_scan(nullptr /*table*/, *bp, &trx, log_handler, ReadWriteMode::READ_ONLY, &filter));
+
+  std::vector<Record> records;
+  std::vector<int>    ids;
+  RC                  rc = RC::SUCCESS;
+  int                 batch_num = 0;
+  while (OB_SUCC(rc = file_scanner.next_batch(records))) {
+    ASSERT_FALSE(records.empty());
+    batch_num++;
+    for (const Record &record : records) {
+      ASSERT_EQ(records.front().rid().page_num, record.rid().page_num);
+      ids.push_back(*reinterpret_cast<const int *>(record.data()));
+    }
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_EQ(batch_num, file_scanner.scanned_pages());
+  file_scanner.close_scan();
+
+  std::vector<int> expected;
+  for (int i = 0; i < record_insert_num; i++) {
+    if (i % 2 == 1 && i % 3 == 0) {
+      expected.push_back(i);
+    }
+  }
+  ASSERT_EQ(expected, ids);
+
+  file_handler.close();
+  bpm.close_file(fsm_file);
+  bpm.close_file(record_manager_file);
+  filesystem::remove(fsm_file);
+  filesystem::remove(record_manager_file);
+}
+
+TEST(SlottedRecordPageHandler, variable_length)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(bpm->create_file(record_manager_file), RC::SUCCESS);
+  ASSERT_EQ(bpm->open_file(log_handler, record_manager_file, bp), RC::SUCCESS);
+
+  // create table t(id int, name char(200))
+  vector<AttrInfoSqlNode> attrs(2);
+  attrs[0] = AttrInfoSqlNode{AttrType::INTS, "id", 1, 0, false};
+  attrs[1] = AttrInfoSqlNode{AttrType::CHARS, "name", 200, 0, false};
+  TableMeta table_meta;
+  ASSERT_EQ(table_meta.init(1, "t", nullptr, attrs, StorageFormat::SLOTTED_FORMAT), RC::SUCCESS);
+  const int        record_size = table_meta.record_size();
+  const FieldMeta *id_field    = table_meta.field(0);
+  const FieldMeta *name_field  = table_meta.field(1);
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(bp->allocate_page(&frame), RC::SUCCESS);
+
+  SlottedRecordPageHandler page_handler;
+  ASSERT_EQ(page_handler.init_empty_page(*bp, log_handler, frame->page_num(), record_size, &table_meta), RC::SUCCESS);
+
+  auto make_record = [&](int id, const string &name) {
+    string record(record_size, '\0');
+    memcpy(record.data() + id_field->offset(), &id, sizeof(id));
+    memcpy(record.data() + name_field->offset(), name.data(), name.size());
+    return record;
+  };
+
+  // 短字符串只占用实际的长度，一页能放下的记录数要远多于定长格式
+  map<int, string> records;  // slot num -> record
+  for (int i = 0; !page_handler.is_full(); i++) {
+    string record = make_record(i, "name" + to_string(i));
+    RID    rid;
+    ASSERT_EQ(page_handler.insert_record(record.data(), &rid), RC::SUCCESS);
+    records[rid.slot_num] = record;
+  }
+  ASSERT_GT(static_cast<int>(records.size()), BP_PAGE_DATA_SIZE / record_size * 4);
+
+  auto check_records = [&]() {
+    for (const auto &[slot_num, expected] : records) {
+      Record record;
+      ASSERT_EQ(page_handler.get_record(RID(frame->page_num(), slot_num), record), RC::SUCCESS);
+      ASSERT_EQ(record.len(), record_size);
+      ASSERT_EQ(memcmp(record.data(), expected.data(), record_size), 0);
+    }
+  };
+  check_records();
+
+  // 删除一半的记录，再把剩下的记录更新成长字符串，需要整理页面才能放下
+  for (auto iter = records.begin(); iter != records.end();) {
+    if (iter->first % 2 == 0) {
+      RID rid(frame->page_num(), iter->first);
+      ASSERT_EQ(page_handler.delete_record(&rid), RC::SUCCESS);
+      ASSERT_EQ(page_handler.delete_record(&rid), RC::RECORD_NOT_EXIST);
+      iter = records.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  check_records();
+
+  int updated = 0;
+  for (auto &[slot_num, record] : records) {
+    string new_record = make_record(slot_num, string(60, 'a' + slot_num % 26));
+    RC     rc         = page_handler.update_record(RID(frame->page_num(), slot_num), new_record.data());
+    if (rc == RC::RECORD_NOMEM) {
+      break;
+    }
+    ASSERT_EQ(rc, RC::SUCCESS);
+    record = new_record;
+    updated++;
+  }
+  ASSERT_GT(updated, 0);
+  check_records();
+
+  // 更新变短以后空出来的空间可以继续插入
+  for (auto &[slot_num, record] : records) {
+    string new_record = make_record(slot_num, "");
+    ASSERT_EQ(page_handler.update_record(RID(frame->page_num(), slot_num), new_record.data()), RC::SUCCESS);
+    record = new_record;
+  }
+  ASSERT_FALSE(page_handler.is_full());
+  string record = make_record(-1, "new");
+  RID    rid;
+  ASSERT_EQ(page_handler.insert_record(record.data(), &rid), RC::SUCCESS);
+  records[rid.slot_num] = record;
+  check_records();
+
+  int    count = 0;
+  Record tmp;
+  RecordPageIterator iterator;
+  iterator.init(&page_handler);
+  while (iterator.has_next()) {
+    ASSERT_EQ(iterator.next(tmp), RC::SUCCESS);
+    count++;
+  }
+  ASSERT_EQ(count, static_cast<int>(records.size()));
+
+  page_handler.cleanup();
   bpm->close_file(record_manager_file);
   delete bpm;
 }
@@ -233,8 +438,14 @@ TEST(RecordManager, durability)
   ASSERT_EQ(bpm.open_file(log_handler, record_manager_file.c_str(), buffer_pool), RC::SUCCESS);
   ASSERT_NE(buffer_pool, nullptr);
 
+  filesystem::path fsm_file        = directory / "record_manager.fsm";
+  DiskBufferPool  *fsm_buffer_pool = nullptr;
+  ASSERT_EQ(bpm.create_file(fsm_file.c_str()), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(log_handler, fsm_file.c_str(), fsm_buffer_pool), RC::SUCCESS);
+
   RecordFileHandler record_file_handler(StorageFormat::ROW_FORMAT);
   ASSERT_EQ(record_file_handler.init(*buffer_pool, log_handler, nullptr), RC::SUCCESS);
+  ASSERT_EQ(record_file_handler.init_free_space_map(*fsm_buffer_pool), RC::SUCCESS);
 
   const int  record_size              = 100;
   const char record_data[record_size] = "hello, world!";
@@ -321,9 +532,13 @@ TEST(RecordManager, durability)
   // 把文件复制出来
   filesystem::path record_manager_file_copy = directory / "record_manager_copy.bp";
   filesystem::copy_file(record_manager_file, record_manager_file_copy);
+  filesystem::path fsm_file_copy = directory / "record_manager_copy.fsm";
+  filesystem::copy_file(fsm_file, fsm_file_copy);
   // 删掉旧文件
   bpm.close_file(record_manager_file.c_str());
   filesystem::remove(record_manager_file);
+  bpm.close_file(fsm_file.c_str());
+  filesystem::remove(fsm_file);
   // 停掉log_handler
   ASSERT_EQ(log_handler.stop(), RC::SUCCESS);
   ASSERT_EQ(log_handler.await_termination(), RC::SUCCESS);
@@ -336,6 +551,10 @@ TEST(RecordManager, durability)
   filesystem::copy(record_manager_file_copy, record_manager_file);
   ASSERT_EQ(bpm2.open_file(log_handler2, record_manager_file.c_str(), buffer_pool2), RC::SUCCESS);
   ASSERT_NE(buffer_pool2, nullptr);
+  // 空闲空间映射文件分配页面也有日志，回放前要打开
+  DiskBufferPool *fsm_buffer_pool2 = nullptr;
+  filesystem::copy(fsm_file_copy, fsm_file);
+  ASSERT_EQ(bpm2.open_file(log_handler2, fsm_file.c_str(), fsm_buffer_pool2), RC::SUCCESS);
 
   IntegratedLogReplayer log_replayer2(bpm2);
   ASSERT_EQ(log_handler2.init(directory.c_str()), RC::SUCCESS);
@@ -353,6 +572,111 @@ TEST(RecordManager, durability)
   ASSERT_EQ(log_handler2.stop(), RC::SUCCESS);
   ASSERT_EQ(log_handler2.await_termination(), RC::SUCCESS);
   bpm2.close_file(record_manager_file.c_str());
+  bpm2.close_file(fsm_file.c_str());
+}
+
+TEST(RecordFileBulkInserter, durability)
+{
+  /*
+   * 测试场景：
+   * 1. 批量插入一些记录，写满的页面只记录整页镜像日志
+   * 2. 普通插入的记录会放到最后一个没有写满的页面中
+   * 3. 重启数据库，检查记录是否恢复
+   */
+  filesystem::path directory("record_bulk_inserter_durability");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+
+  filesystem::path record_manager_file = directory / "record_manager.bp";
+  filesystem::path fsm_file            = directory / "record_manager.fsm";
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(bpm.init(make_unique<VacuousDoubleWriteBuffer>()), RC::SUCCESS);
+
+  DiskLogHandler        log_handler;
+  IntegratedLogReplayer log_replayer(bpm);
+  ASSERT_EQ(log_handler.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler.replay(log_replayer, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler.start(), RC::SUCCESS);
+
+  DiskBufferPool *buffer_pool     = nullptr;
+  DiskBufferPool *fsm_buffer_pool = nullptr;
+  ASSERT_EQ(bpm.create_file(record_manager_file.c_str()), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(log_handler, record_manager_file.c_str(), buffer_pool), RC::SUCCESS);
+  ASSERT_EQ(bpm.create_file(fsm_file.c_str()), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(log_handler, fsm_file.c_str(), fsm_buffer_pool), RC::SUCCESS);
+
+  RecordFileHandler record_file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(record_file_handler.init(*buffer_pool, log_handler, nullptr), RC::SUCCESS);
+  ASSERT_EQ(record_file_handler.init_free_space_map(*fsm_buffer_pool), RC::SUCCESS);
+
+  const int record_size       = 100;
+  const int insert_record_num = 2000;
+  char      record_data[record_size];
+
+  vector<pair<RID, string>> records;
+  RecordFileBulkInserter    inserter;
+  ASSERT_EQ(inserter.open(record_file_handler, record_size), RC::SUCCESS);
+  for (int i = 0; i < insert_record_num; i++) {
+    snprintf(record_data, sizeof(record_data), "bulk record %d", i);
+    RID rid;
+    ASSERT_EQ(inserter.insert_record(record_data, &rid), RC::SUCCESS);
+    if (!records.empty() && records.back().first.page_num == rid.page_num) {
+      ASSERT_EQ(records.back().first.slot_num + 1, rid.slot_num);
+    }
+    records.emplace_back(rid, string(record_data, record_size));
+  }
+  ASSERT_EQ(inserter.close(), RC::SUCCESS);
+
+  const PageNum last_page_num = records.back().first.page_num;
+  ASSERT_EQ(inserter.page_count(), last_page_num - records.front().first.page_num + 1);
+
+  // 最后一个页面没有写满，已经放到空闲空间映射中了
+  snprintf(record_data, sizeof(record_data), "normal record");
+  RID rid;
+  ASSERT_EQ(record_file_handler.insert_record(record_data, record_size, &rid), RC::SUCCESS);
+  ASSERT_EQ(rid.page_num, last_page_num);
+  records.emplace_back(rid, string(record_data, record_size));
+
+  // 把文件复制出来，只保留日志中的数据
+  filesystem::path record_manager_file_copy = directory / "record_manager_copy.bp";
+  filesystem::path fsm_file_copy            = directory / "record_manager_copy.fsm";
+  filesystem::copy_file(record_manager_file, record_manager_file_copy);
+  filesystem::copy_file(fsm_file, fsm_file_copy);
+  bpm.close_file(record_manager_file.c_str());
+  filesystem::remove(record_manager_file);
+  bpm.close_file(fsm_file.c_str());
+  filesystem::remove(fsm_file);
+  ASSERT_EQ(log_handler.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler.await_termination(), RC::SUCCESS);
+
+  DiskLogHandler    log_handler2;
+  BufferPoolManager bpm2;
+  ASSERT_EQ(RC::SUCCESS, bpm2.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *buffer_pool2     = nullptr;
+  DiskBufferPool *fsm_buffer_pool2 = nullptr;
+  filesystem::copy(record_manager_file_copy, record_manager_file);
+  filesystem::copy(fsm_file_copy, fsm_file);
+  ASSERT_EQ(bpm2.open_file(log_handler2, record_manager_file.c_str(), buffer_pool2), RC::SUCCESS);
+  ASSERT_EQ(bpm2.open_file(log_handler2, fsm_file.c_str(), fsm_buffer_pool2), RC::SUCCESS);
+
+  IntegratedLogReplayer log_replayer2(bpm2);
+  ASSERT_EQ(log_handler2.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.replay(log_replayer2, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.start(), RC::SUCCESS);
+
+  RecordFileHandler record_file_handler2(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(record_file_handler2.init(*buffer_pool2, log_handler2, nullptr), RC::SUCCESS);
+  for (const auto &[rid, record] : records) {
+    Record record_data;
+    ASSERT_EQ(record_file_handler2.get_record(rid, record_data), RC::SUCCESS);
+    ASSERT_EQ(memcmp(record_data.data(), record.c_str(), record.size()), 0);
+  }
+
+  ASSERT_EQ(log_handler2.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.await_termination(), RC::SUCCESS);
+  bpm2.close_file(record_manager_file.c_str());
+  bpm2.close_file(fsm_file.c_str());
 }
 
 int main(int argc, char **argv)
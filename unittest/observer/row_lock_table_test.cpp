@@ -0,0 +1,77 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "gtest/gtest.h"
+#include "common/lang/chrono.h"
+#include "common/lang/thread.h"
+#include "storage/trx/row_lock_table.h"
+
+using namespace std;
+
+TEST(RowLockTable, first_writer_wins)
+{
+  RowLockTable lock_table;
+  RID          rid(1, 2);
+
+  ASSERT_EQ(-1, lock_table.owner(1, rid));
+  ASSERT_EQ(RC::SUCCESS, lock_table.lock(10, 1, rid));
+  ASSERT_EQ(10, lock_table.owner(1, rid));
+
+  // 重复加锁
+  ASSERT_EQ(RC::SUCCESS, lock_table.lock(10, 1, rid));
+
+  // 不同的表或者不同的记录互不影响
+  ASSERT_EQ(RC::SUCCESS, lock_table.lock(11, 2, rid));
+  ASSERT_EQ(RC::SUCCESS, lock_table.lock(11, 1, RID(1, 3)));
+
+  ASSERT_EQ(RC::LOCKED_CONCURRENCY_CONFLICT, lock_table.lock(11, 1, rid));
+  ASSERT_EQ(1, lock_table.stats().lock_conflicts.load());
+  ASSERT_EQ(0, lock_table.stats().lock_waits.load());
+
+  // 不是持有者，不能释放
+  lock_table.unlock(11, 1, rid);
+  ASSERT_EQ(10, lock_table.owner(1, rid));
+
+  lock_table.unlock(10, 1, rid);
+  ASSERT_EQ(-1, lock_table.owner(1, rid));
+  ASSERT_EQ(RC::SUCCESS, lock_table.lock(11, 1, rid));
+  ASSERT_EQ(11, lock_table.owner(1, rid));
+}
+
+TEST(RowLockTable, wait_with_timeout)
+{
+  RowLockTable lock_table;
+  lock_table.set_wait_timeout_ms(50);
+  RID rid(3, 4);
+
+  ASSERT_EQ(RC::SUCCESS, lock_table.lock(10, 1, rid));
+  ASSERT_EQ(RC::LOCKED_CONCURRENCY_CONFLICT, lock_table.lock(11, 1, rid));
+  ASSERT_EQ(1, lock_table.stats().wait_timeouts.load());
+
+  lock_table.set_wait_timeout_ms(10 * 1000);
+  thread unlocker([&lock_table, &rid]() {
+    this_thread::sleep_for(chrono::milliseconds(20));
+    lock_table.unlock(10, 1, rid);
+  });
+
+  ASSERT_EQ(RC::SUCCESS, lock_table.lock(11, 1, rid));
+  unlocker.join();
+
+  ASSERT_EQ(11, lock_table.owner(1, rid));
+  ASSERT_EQ(2, lock_table.stats().lock_waits.load());
+  ASSERT_EQ(1, lock_table.stats().wait_timeouts.load());
+  ASSERT_GT(lock_table.stats().wait_time_us.load(), 0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#include "common/lang/memory.h"
+#include "common/lang/vector.h"
+#include "sql/expr/expression.h"
+#include "sql/expr/tuple.h"
+#include "sql/operator/hash_semi_join_physical_operator.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+/**
+ * @brief 按下标读取元组中的一个值，代替需要表结构的 FieldExpr
+ */
+class CellExpr : public Expression
+{
+public:
+  explicit CellExpr(int index) : index_(index) {}
+
+  RC get_value(const Tuple &tuple, Value &value, Trx *trx = nullptr) const override
+  {
+    return tuple.cell_at(index_, value);
+  }
+  ExprType type() const override { return ExprType::FIELD; }
+  AttrType value_type() const override { return AttrType::INTS; }
+
+private:
+  int index_;
+};
+
+/**
+ * @brief 依次输出给定值的单列算子
+ */
+class IntRowsPhysicalOperator : public PhysicalOperator
+{
+public:
+  explicit IntRowsPhysicalOperator(vector<Value> values) : values_(std::move(values)) {}
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::STRING_LIST; }
+
+  RC open(Trx *) override
+  {
+    index_ = 0;
+    return RC::SUCCESS;
+  }
+
+  RC next() override
+  {
+    if (index_ >= values_.size()) {
+      return RC::RECORD_EOF;
+    }
+    tuple_.set_cells({values_[index_++]});
+    return RC::SUCCESS;
+  }
+
+  RC     close() override { return RC::SUCCESS; }
+  Tuple *current_tuple() override { return &tuple_; }
+
+private:
+  vector<Value>  values_;
+  size_t         index_ = 0;
+  ValueListTuple tuple_;
+};
+
+const int NULL_VALUE = -1;
+
+vector<Value> make_values(const vector<int> &ints)
+{
+  vector<Value> values;
+  for (int i : ints) {
+    Value value(i);
+    if (i == NULL_VALUE) {
+      value.set_null();
+    }
+    values.push_back(value);
+  }
+  return values;
+}
+
+/// 返回连接输出的左表的值，null 输出为 NULL_VALUE
+vector<int> run_join(JoinType join_type, const vector<int> &left, const vector<int> &right)
+{
+  vector<unique_ptr<Expression>> left_keys;
+  vector<unique_ptr<Expression>> right_keys;
+  left_keys.push_back(make_unique<CellExpr>(0));
+  right_keys.push_back(make_unique<CellExpr>(0));
+  HashSemiJoinPhysicalOperator join(join_type, std::move(left_keys), std::move(right_keys));
+  join.add_child(make_unique<IntRowsPhysicalOperator>(make_values(left)));
+  join.add_child(make_unique<IntRowsPhysicalOperator>(make_values(right)));
+
+  vector<int> result;
+  EXPECT_EQ(RC::SUCCESS, join.open(nullptr));
+  RC rc = RC::SUCCESS;
+  while ((rc = join.next()) == RC::SUCCESS) {
+    Value value;
+    EXPECT_EQ(RC::SUCCESS, join.current_tuple()->cell_at(0, value));
+    result.push_back(value.is_null() ? NULL_VALUE : value.get_int());
+  }
+  EXPECT_EQ(RC::RECORD_EOF, rc);
+  EXPECT_EQ(RC::SUCCESS, join.close());
+  return result;
+}
+
+}  // namespace
+
+TEST(HashSemiJoin, semi)
+{
+  EXPECT_EQ((vector<int>{1, 3, 3}), run_join(JoinType::SEMI, {1, 2, 3, NULL_VALUE, 3}, {3, 1, 1, NULL_VALUE}));
+  EXPECT_EQ((vector<int>{}), run_join(JoinType::SEMI, {1, 2}, {}));
+}
+
+TEST(HashSemiJoin, anti)
+{
+  // NOT EXISTS: 键为 null 的行找不到匹配，会输出
+  EXPECT_EQ((vector<int>{2, NULL_VALUE}), run_join(JoinType::ANTI, {1, 2, NULL_VALUE}, {1, NULL_VALUE}));
+  EXPECT_EQ((vector<int>{1, NULL_VALUE}), run_join(JoinType::ANTI, {1, NULL_VALUE}, {}));
+}
+
+TEST(HashSemiJoin, null_aware_anti)
+{
+  // NOT IN: 左边为 null 时结果为 null，不输出
+  EXPECT_EQ((vector<int>{2}), run_join(JoinType::NULL_AWARE_ANTI, {1, 2, NULL_VALUE}, {1, 3}));
+  // 右表有 null 时没有行能满足 NOT IN
+  EXPECT_EQ((vector<int>{}), run_join(JoinType::NULL_AWARE_ANTI, {1, 2}, {1, NULL_VALUE}));
+  // 右表为空时 NOT IN 总是 true，包括左边为 null 的行
+  EXPECT_EQ((vector<int>{1, NULL_VALUE}), run_join(JoinType::NULL_AWARE_ANTI, {1, NULL_VALUE}, {}));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
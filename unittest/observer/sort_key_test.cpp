@@ -0,0 +1,99 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/value.h"
+#include "sql/operator/sort_key.h"
+#include "gtest/gtest.h"
+
+using namespace common;
+
+namespace {
+Value null_value()
+{
+  Value value;
+  value.set_null();
+  return value;
+}
+
+string encode(const Value &value, bool desc)
+{
+  string key;
+  SortKeyEncoder::encode_value(value, desc, key);
+  return key;
+}
+
+/// values 已经按照从小到大排列，检查排序键的顺序与它一致
+void check_order(const vector<Value> &values)
+{
+  for (size_t i = 0; i + 1 < values.size(); i++) {
+    const int cmp = values[i].compare(values[i + 1]);
+    ASSERT_LE(cmp, 0) << "values are not sorted. index=" << i;
+
+    const string left  = encode(values[i], false);
+    const string right = encode(values[i + 1], false);
+    if (cmp == 0) {
+      ASSERT_EQ(left, right) << "index=" << i;
+    } else {
+      ASSERT_LT(left, right) << "index=" << i;
+    }
+    // 降序时顺序相反
+    ASSERT_GE(encode(values[i], true), encode(values[i + 1], true)) << "index=" << i;
+  }
+}
+}  // namespace
+
+TEST(SortKey, ints)
+{
+  check_order({Value(-2147483647 - 1), Value(-100), Value(-1), Value(0), Value(1), Value(255), Value(256), Value(2147483647)});
+}
+
+TEST(SortKey, floats)
+{
+  check_order({Value(-1e30f), Value(-2.5f), Value(-0.5f), Value(0.0f), Value(0.25f), Value(1.0f), Value(3.5f), Value(1e30f)});
+  ASSERT_EQ(encode(Value(-0.0f), false), encode(Value(0.0f), false));
+  // 整数和浮点数可以互相比较
+  ASSERT_LT(encode(Value(1), false), encode(Value(1.5f), false));
+  ASSERT_LT(encode(Value(-1.5f), false), encode(Value(-1), false));
+}
+
+TEST(SortKey, chars)
+{
+  check_order({Value(""), Value("a"), Value("ab"), Value("abc"), Value("b"), Value("ba"), Value("\xff")});
+}
+
+TEST(SortKey, nulls)
+{
+  // null 排在最前面，降序时排在最后面
+  ASSERT_LT(encode(null_value(), false), encode(Value(-2147483647 - 1), false));
+  ASSERT_LT(encode(null_value(), false), encode(Value(""), false));
+  ASSERT_GT(encode(null_value(), true), encode(Value(-2147483647 - 1), true));
+}
+
+TEST(SortKey, multiple_keys)
+{
+  // (a asc, b desc)
+  auto encode_row = [](const Value &a, const Value &b) {
+    string key;
+    SortKeyEncoder::encode_value(a, false, key);
+    SortKeyEncoder::encode_value(b, true, key);
+    return key;
+  };
+  ASSERT_LT(encode_row(Value("a"), Value(1)), encode_row(Value("ab"), Value(2)));
+  ASSERT_LT(encode_row(Value("a"), Value(2)), encode_row(Value("a"), Value(1)));
+  ASSERT_LT(encode_row(Value("a"), Value(1)), encode_row(Value("a"), null_value()));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,217 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/lang/map.h"
+#include "common/lang/memory.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/memory_budget.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/hash_group_by_physical_operator.h"
+#include "sql/operator/order_by_physical_operator.h"
+#include "sql/operator/spill_file.h"
+#include "gtest/gtest.h"
+
+using namespace common;
+
+namespace {
+
+/**
+ * @brief 按下标读取元组中的一个值，代替需要表结构的 FieldExpr
+ */
+class CellExpr : public Expression
+{
+public:
+  explicit CellExpr(int index) : index_(index) {}
+
+  RC get_value(const Tuple &tuple, Value &value, Trx *trx = nullptr) const override
+  {
+    return tuple.cell_at(index_, value);
+  }
+  ExprType type() const override { return ExprType::FIELD; }
+  AttrType value_type() const override { return AttrType::INTS; }
+
+private:
+  int index_;
+};
+
+/**
+ * @brief 输出 (key, id, name) 三列的算子，key 有 key_num 种不同的值，id 是记录的序号
+ */
+class RowsPhysicalOperator : public PhysicalOperator
+{
+public:
+  RowsPhysicalOperator(int row_num, int key_num) : row_num_(row_num), key_num_(key_num)
+  {
+    tuple_.set_names({TupleCellSpec("key"), TupleCellSpec("id"), TupleCellSpec("name")});
+  }
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::STRING_LIST; }
+
+  RC open(Trx *) override
+  {
+    current_ = -1;
+    return RC::SUCCESS;
+  }
+
+  RC next() override
+  {
+    if (++current_ >= row_num_) {
+      return RC::RECORD_EOF;
+    }
+    vector<Value> cells(3);
+    cells[0].set_int(static_cast<int>((current_ * 2654435761LL) % key_num_));
+    cells[1].set_int(current_);
+    cells[2].set_string(("name_" + std::to_string(current_)).c_str());
+    tuple_.set_cells(cells);
+    return RC::SUCCESS;
+  }
+
+  RC     close() override { return RC::SUCCESS; }
+  Tuple *current_tuple() override { return &tuple_; }
+
+private:
+  int            row_num_;
+  int            key_num_;
+  int            current_ = -1;
+  ValueListTuple tuple_;
+};
+
+int cell_int(Tuple *tuple, int index)
+{
+  Value value;
+  EXPECT_EQ(tuple->cell_at(index, value), RC::SUCCESS);
+  return value.get_int();
+}
+
+}  // namespace
+
+TEST(SpillFile, write_and_read)
+{
+  unique_ptr<SpillFile> file;
+  ASSERT_EQ(SpillFile::create(file), RC::SUCCESS);
+
+  Value date;
+  date.set_date(20240101);
+  vector<Value> row = {Value(1), Value(2.5f), Value("hello"), Value::NullValue(), Value(true), date, Value("")};
+  for (int i = 0; i < 100; i++) {
+    row[0].set_int(i);
+    ASSERT_EQ(file->write_row("key_" + std::to_string(i), row.data(), static_cast<int>(row.size())), RC::SUCCESS);
+  }
+  ASSERT_EQ(file->row_num(), 100);
+  ASSERT_EQ(file->rewind(), RC::SUCCESS);
+
+  string        key;
+  vector<Value> values;
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(file->read_row(key, values), RC::SUCCESS);
+    ASSERT_EQ(key, "key_" + std::to_string(i));
+    ASSERT_EQ(values.size(), row.size());
+    row[0].set_int(i);
+    for (size_t j = 0; j < row.size(); j++) {
+      ASSERT_EQ(values[j].attr_type(), row[j].attr_type());
+      ASSERT_EQ(values[j].to_string(), row[j].to_string()) << "column " << j;
+    }
+  }
+  ASSERT_EQ(file->read_row(key, values), RC::RECORD_EOF);
+}
+
+TEST(Spill, external_sort)
+{
+  /*
+   * 测试场景：
+   * 1. 内存预算很小，排序时会产生很多 run，超过一次归并的路数，需要分批归并
+   * 2. 结果与不限制内存时相同：按 key 有序，key 相同时保持输入的顺序
+   * 3. 结束后释放所有申请的预算
+   */
+  const int    row_num = 20000;
+  MemoryBudget budget(32 * 1024);
+
+  vector<unique_ptr<Expression>> exprs;
+  exprs.push_back(make_unique<CellExpr>(0));
+  OrderByPhysicalOperator order_by(std::move(exprs), vector<bool>{false});
+  order_by.add_child(make_unique<RowsPhysicalOperator>(row_num, 1000));
+  order_by.set_memory_budget(&budget);
+
+  ASSERT_EQ(order_by.open(nullptr), RC::SUCCESS);
+  ASSERT_GT(order_by.spilled_run_num(), 64);
+
+  int count    = 0;
+  int last_key = -1;
+  int last_id  = -1;
+  while (order_by.next() == RC::SUCCESS) {
+    Tuple *tuple = order_by.current_tuple();
+    const int key = cell_int(tuple, 0);
+    const int id  = cell_int(tuple, 1);
+    ASSERT_LE(last_key, key);
+    if (key == last_key) {
+      ASSERT_LT(last_id, id);
+    }
+
+    Value name;
+    ASSERT_EQ(tuple->cell_at(2, name), RC::SUCCESS);
+    ASSERT_EQ(name.get_string(), "name_" + std::to_string(id));
+
+    last_key = key;
+    last_id  = id;
+    count++;
+  }
+  ASSERT_EQ(count, row_num);
+  ASSERT_EQ(order_by.close(), RC::SUCCESS);
+  ASSERT_EQ(budget.used(), 0);
+}
+
+TEST(Spill, hash_group_by)
+{
+  /*
+   * 测试场景：
+   * 1. 分组很多，内存预算放不下所有的分组，记录会溢出到分区文件中，分区还会被继续拆分
+   * 2. 每个分组只输出一次，聚合结果正确
+   */
+  const int    row_num = 30000;
+  const int    key_num = 5000;
+  MemoryBudget budget(16 * 1024);
+
+  AggregateExpr                  count_expr(AggregateType::COUNT, make_unique<CellExpr>(1));
+  AggregateExpr                  sum_expr(AggregateType::SUM, make_unique<CellExpr>(1));
+  vector<unique_ptr<Expression>> group_by_exprs;
+  group_by_exprs.push_back(make_unique<CellExpr>(0));
+  HashGroupByPhysicalOperator group_by(std::move(group_by_exprs), vector<Expression *>{&count_expr, &sum_expr});
+  group_by.add_child(make_unique<RowsPhysicalOperator>(row_num, key_num));
+  group_by.set_memory_budget(&budget);
+
+  map<int, pair<int, long long>> expected;
+  for (long long i = 0; i < row_num; i++) {
+    auto &[count, sum] = expected[static_cast<int>((i * 2654435761LL) % key_num)];
+    count++;
+    sum += i;
+  }
+
+  ASSERT_EQ(group_by.open(nullptr), RC::SUCCESS);
+  map<int, pair<int, long long>> result;
+  while (group_by.next() == RC::SUCCESS) {
+    Tuple    *tuple    = group_by.current_tuple();
+    const int cell_num = tuple->cell_num();
+    const int key      = cell_int(tuple, 0);
+    ASSERT_EQ(result.count(key), 0) << "group " << key << " is emitted twice";
+    result[key] = {cell_int(tuple, cell_num - 2), cell_int(tuple, cell_num - 1)};
+  }
+  // 第一轮最多产生 8 个分区，更多说明分区又被拆分过
+  ASSERT_GT(group_by.spilled_partition_num(), 8);
+  ASSERT_EQ(result, expected);
+  ASSERT_EQ(group_by.close(), RC::SUCCESS);
+  ASSERT_EQ(budget.used(), 0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,131 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+
+#include "common/lang/memory.h"
+#include "common/lang/vector.h"
+#include "sql/expr/expression.h"
+#include "sql/expr/tuple.h"
+#include "sql/operator/logical_operator.h"
+#include "sql/operator/physical_operator.h"
+#include "sql/stmt/select_stmt.h"
+#include "gtest/gtest.h"
+
+namespace {
+
+/**
+ * @brief 依次输出给定值的算子，记录被打开了多少次
+ */
+class ValuesPhysicalOperator : public PhysicalOperator
+{
+public:
+  explicit ValuesPhysicalOperator(vector<Value> values, int &open_count)
+      : values_(std::move(values)), open_count_(open_count)
+  {}
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::STRING_LIST; }
+
+  RC open(Trx *) override
+  {
+    open_count_++;
+    index_ = 0;
+    return RC::SUCCESS;
+  }
+
+  RC next() override
+  {
+    if (index_ >= values_.size()) {
+      return RC::RECORD_EOF;
+    }
+    tuple_.set_cells({values_[index_++]});
+    return RC::SUCCESS;
+  }
+
+  RC     close() override { return RC::SUCCESS; }
+  Tuple *current_tuple() override { return &tuple_; }
+
+private:
+  vector<Value>  values_;
+  size_t         index_ = 0;
+  int           &open_count_;
+  ValueListTuple tuple_;
+};
+
+Value null_value()
+{
+  Value value;
+  value.set_null();
+  return value;
+}
+
+/// 计算 left comp (subquery)，返回结果并记录子查询被执行的次数
+bool eval(CompOp comp, const Value &left, const vector<Value> &subquery_values, int rows = 1, int *open_count = nullptr)
+{
+  int  opened   = 0;
+  auto subquery = make_unique<SubqueryExpr>(nullptr);
+  subquery->set_physical_operator(make_unique<ValuesPhysicalOperator>(subquery_values, opened));
+  subquery->set_outer_fields({});
+
+  ComparisonExpr expr(comp, make_unique<ValueExpr>(left), std::move(subquery));
+  ValueListTuple tuple;
+  bool           result = false;
+  for (int i = 0; i < rows; i++) {
+    Value value;
+    EXPECT_EQ(RC::SUCCESS, expr.get_value(tuple, value));
+    result = value.get_boolean();
+  }
+  if (open_count != nullptr) {
+    *open_count = opened;
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(SubqueryCache, in_and_not_in)
+{
+  vector<Value> ints{Value(1), Value(2), Value(3)};
+  EXPECT_TRUE(eval(CompOp::IN, Value(2), ints));
+  EXPECT_FALSE(eval(CompOp::IN, Value(4), ints));
+  EXPECT_FALSE(eval(CompOp::NOT_IN, Value(2), ints));
+  EXPECT_TRUE(eval(CompOp::NOT_IN, Value(4), ints));
+
+  // 不同类型的值逐个比较
+  EXPECT_TRUE(eval(CompOp::IN, Value(2.0f), ints));
+  EXPECT_TRUE(eval(CompOp::IN, Value("b"), {Value("a"), Value("b")}));
+  EXPECT_FALSE(eval(CompOp::IN, Value("bc"), {Value("a"), Value("b")}));
+}
+
+TEST(SubqueryCache, null_semantics)
+{
+  vector<Value> with_null{Value(1), null_value()};
+  EXPECT_TRUE(eval(CompOp::IN, Value(1), with_null));
+  EXPECT_FALSE(eval(CompOp::IN, Value(2), with_null));
+  EXPECT_FALSE(eval(CompOp::NOT_IN, Value(2), with_null));
+  EXPECT_FALSE(eval(CompOp::IN, null_value(), {Value(1)}));
+  EXPECT_FALSE(eval(CompOp::NOT_IN, null_value(), {Value(1)}));
+
+  // 子查询结果为空时 NOT IN 总是 true
+  EXPECT_TRUE(eval(CompOp::NOT_IN, null_value(), {}));
+  EXPECT_FALSE(eval(CompOp::IN, Value(1), {}));
+}
+
+TEST(SubqueryCache, uncorrelated_subquery_runs_once)
+{
+  int opened = 0;
+  EXPECT_TRUE(eval(CompOp::IN, Value(3), {Value(1), Value(3)}, 100, &opened));
+  EXPECT_EQ(1, opened);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
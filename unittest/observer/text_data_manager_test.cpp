@@ -0,0 +1,220 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "common/lang/filesystem.h"
+#include "common/lang/memory.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/log/log.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/disk_log_handler.h"
+#include "storage/clog/integrated_log_replayer.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/table/text_data_manager.h"
+#include "gtest/gtest.h"
+
+using namespace common;
+
+namespace {
+string make_text(size_t len, int seed)
+{
+  string text(len, ' ');
+  for (size_t i = 0; i < len; i++) {
+    text[i] = static_cast<char>('a' + (i + seed) % 26);
+  }
+  return text;
+}
+
+void check_text(TextDataManager &manager, const TextData &text_data, const string &expected)
+{
+  TextData loaded = text_data;
+  ASSERT_EQ(manager.load_text(&loaded), RC::SUCCESS);
+  ASSERT_EQ(string(loaded.str), expected);
+  delete[] loaded.str;
+}
+}  // namespace
+
+TEST(TextDataManager, load_and_dump)
+{
+  filesystem::path directory("text_data_manager_load_and_dump");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+  const string data_file = (directory / "test.textdata").string();
+  const string fsm_file  = (directory / "test.textfsm").string();
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(bpm.init(make_unique<VacuousDoubleWriteBuffer>()), RC::SUCCESS);
+  VacuousLogHandler log_handler;
+
+  TextDataManager manager;
+  ASSERT_EQ(TextDataManager::create(bpm, data_file.c_str(), fsm_file.c_str()), RC::SUCCESS);
+  ASSERT_EQ(manager.open(bpm, log_handler, data_file.c_str(), fsm_file.c_str()), RC::SUCCESS);
+
+  // 覆盖空文本、一个分片以内、正好一个分片和跨越多个分片的情况
+  const vector<size_t> lengths = {0,
+      1,
+      100,
+      TextDataManager::CHUNK_SIZE - 1,
+      TextDataManager::CHUNK_SIZE,
+      TextDataManager::CHUNK_SIZE + 1,
+      TextDataManager::CHUNK_SIZE * 5 + 7,
+      65535};
+  vector<pair<TextData, string>> texts;
+  for (size_t i = 0; i < lengths.size(); i++) {
+    string   text      = make_text(lengths[i], static_cast<int>(i));
+    TextData text_data = {.offset = 0, .len = text.size(), .str = text.c_str()};
+    ASSERT_EQ(manager.dump_text(&text_data), RC::SUCCESS);
+    texts.emplace_back(text_data, std::move(text));
+  }
+
+  for (const auto &[text_data, text] : texts) {
+    check_text(manager, text_data, text);
+  }
+
+  manager.close();
+  filesystem::remove_all(directory);
+}
+
+TEST(TextDataManager, reuse_space)
+{
+  /*
+   * 测试场景：
+   * 1. 反复写入和删除同样大小的文本，删除后留下的空间会被重新使用，文件不会一直增长
+   * 2. 没有删除的文本不受影响
+   */
+  filesystem::path directory("text_data_manager_reuse_space");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+  const string data_file = (directory / "test.textdata").string();
+  const string fsm_file  = (directory / "test.textfsm").string();
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(bpm.init(make_unique<VacuousDoubleWriteBuffer>()), RC::SUCCESS);
+  VacuousLogHandler log_handler;
+
+  TextDataManager manager;
+  ASSERT_EQ(TextDataManager::create(bpm, data_file.c_str(), fsm_file.c_str()), RC::SUCCESS);
+  ASSERT_EQ(manager.open(bpm, log_handler, data_file.c_str(), fsm_file.c_str()), RC::SUCCESS);
+
+  const string kept      = make_text(TextDataManager::CHUNK_SIZE * 2, 1);
+  TextData     kept_data = {.offset = 0, .len = kept.size(), .str = kept.c_str()};
+  ASSERT_EQ(manager.dump_text(&kept_data), RC::SUCCESS);
+
+  const string text      = make_text(TextDataManager::CHUNK_SIZE * 10, 2);
+  uintmax_t    file_size = 0;
+  for (int i = 0; i < 100; i++) {
+    TextData text_data = {.offset = 0, .len = text.size(), .str = text.c_str()};
+    ASSERT_EQ(manager.dump_text(&text_data), RC::SUCCESS);
+    check_text(manager, text_data, text);
+    ASSERT_EQ(manager.delete_text(text_data), RC::SUCCESS);
+
+    ASSERT_EQ(manager.sync(), RC::SUCCESS);
+    if (i == 0) {
+      file_size = filesystem::file_size(data_file);
+    } else {
+      ASSERT_EQ(filesystem::file_size(data_file), file_size);
+    }
+  }
+
+  check_text(manager, kept_data, kept);
+
+  manager.close();
+  filesystem::remove_all(directory);
+}
+
+TEST(TextDataManager, durability)
+{
+  /*
+   * 测试场景：
+   * 1. 写入和删除一些文本，不刷盘
+   * 2. 用没有刷盘时的文件替换掉当前的文件，模拟宕机
+   * 3. 重放日志后文本都可以读出来
+   */
+  filesystem::path directory("text_data_manager_durability");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+  const string data_file      = (directory / "test.textdata").string();
+  const string fsm_file       = (directory / "test.textfsm").string();
+  const string data_file_copy = (directory / "test_copy.textdata").string();
+  const string fsm_file_copy  = (directory / "test_copy.textfsm").string();
+
+  vector<pair<TextData, string>> texts;
+  {
+    BufferPoolManager bpm;
+    ASSERT_EQ(bpm.init(make_unique<VacuousDoubleWriteBuffer>()), RC::SUCCESS);
+    DiskLogHandler        log_handler;
+    IntegratedLogReplayer log_replayer(bpm);
+    ASSERT_EQ(log_handler.init(directory.c_str()), RC::SUCCESS);
+    ASSERT_EQ(log_handler.replay(log_replayer, 0), RC::SUCCESS);
+    ASSERT_EQ(log_handler.start(), RC::SUCCESS);
+
+    ASSERT_EQ(TextDataManager::create(bpm, data_file.c_str(), fsm_file.c_str()), RC::SUCCESS);
+    TextDataManager manager;
+    ASSERT_EQ(manager.open(bpm, log_handler, data_file.c_str(), fsm_file.c_str()), RC::SUCCESS);
+    // 先刷一次盘，保证重新打开时空闲空间映射的根页面已经在文件中
+    ASSERT_EQ(manager.sync(), RC::SUCCESS);
+    for (int i = 0; i < 20; i++) {
+      string   text      = make_text(i * 700 + 1, i);
+      TextData text_data = {.offset = 0, .len = text.size(), .str = text.c_str()};
+      ASSERT_EQ(manager.dump_text(&text_data), RC::SUCCESS);
+      texts.emplace_back(text_data, std::move(text));
+    }
+    // 删除一部分文本，重放日志后它们占用的槽位也是空闲的
+    for (int i = 0; i < 20; i += 3) {
+      ASSERT_EQ(manager.delete_text(texts[i].first), RC::SUCCESS);
+    }
+
+    // 把文件复制出来，页面还没有刷盘，只保留日志中的数据
+    filesystem::copy_file(data_file, data_file_copy);
+    filesystem::copy_file(fsm_file, fsm_file_copy);
+    manager.close();
+    ASSERT_EQ(log_handler.stop(), RC::SUCCESS);
+    ASSERT_EQ(log_handler.await_termination(), RC::SUCCESS);
+  }
+
+  filesystem::remove(data_file);
+  filesystem::remove(fsm_file);
+  filesystem::copy_file(data_file_copy, data_file);
+  filesystem::copy_file(fsm_file_copy, fsm_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(bpm.init(make_unique<VacuousDoubleWriteBuffer>()), RC::SUCCESS);
+  DiskLogHandler  log_handler;
+  TextDataManager manager;
+  ASSERT_EQ(manager.open(bpm, log_handler, data_file.c_str(), fsm_file.c_str()), RC::SUCCESS);
+
+  IntegratedLogReplayer log_replayer(bpm);
+  ASSERT_EQ(log_handler.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler.replay(log_replayer, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler.start(), RC::SUCCESS);
+
+  for (int i = 0; i < 20; i++) {
+    if (i % 3 == 0) {
+      TextData loaded = texts[i].first;
+      ASSERT_NE(manager.load_text(&loaded), RC::SUCCESS);
+    } else {
+      check_text(manager, texts[i].first, texts[i].second);
+    }
+  }
+
+  manager.close();
+  ASSERT_EQ(log_handler.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler.await_termination(), RC::SUCCESS);
+  filesystem::remove_all(directory);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  filesystem::path log_filename = filesystem::path(argv[0]).filename();
+  LoggerFactory::init_default(log_filename.string() + ".log", LOG_LEVEL_TRACE);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,91 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/trx/mvcc_trx.h"
+
+using namespace std;
+
+TEST(TrxRegistry, active_trxes)
+{
+  MvccTrxKit kit;
+  ASSERT_EQ(RC::SUCCESS, kit.init());
+
+  VacuousLogHandler log_handler;
+
+  const int     trx_num = 100;
+  vector<Trx *> trxes;
+  for (int i = 0; i < trx_num; i++) {
+    trxes.push_back(kit.create_trx(log_handler));
+  }
+
+  vector<Trx *> all_trxes;
+  kit.all_trxes(all_trxes);
+  ASSERT_EQ(trx_num, static_cast<int>(all_trxes.size()));
+
+  // 没有开始的事务不是活跃事务
+  vector<int32_t> active_ids;
+  kit.active_trx_ids(active_ids);
+  ASSERT_TRUE(active_ids.empty());
+
+  for (Trx *trx : trxes) {
+    ASSERT_EQ(RC::SUCCESS, trx->start_if_need());
+  }
+
+  kit.active_trx_ids(active_ids);
+  ASSERT_EQ(trx_num, static_cast<int>(active_ids.size()));
+  for (Trx *trx : trxes) {
+    ASSERT_EQ(trx, kit.find_trx(trx->id()));
+    ASSERT_NE(active_ids.end(), find(active_ids.begin(), active_ids.end(), trx->id()));
+  }
+
+  // 提交一半的事务
+  for (int i = 0; i < trx_num; i += 2) {
+    int32_t trx_id = trxes[i]->id();
+    ASSERT_EQ(RC::SUCCESS, trxes[i]->commit());
+    ASSERT_EQ(nullptr, kit.find_trx(trx_id));
+  }
+
+  kit.active_trx_ids(active_ids);
+  ASSERT_EQ(trx_num / 2, static_cast<int>(active_ids.size()));
+
+  // 销毁事务对象时也会从活跃事务中删除
+  for (Trx *trx : trxes) {
+    kit.destroy_trx(trx);
+  }
+
+  kit.active_trx_ids(active_ids);
+  ASSERT_TRUE(active_ids.empty());
+  kit.all_trxes(all_trxes);
+  ASSERT_TRUE(all_trxes.empty());
+}
+
+TEST(TrxRegistry, recover_trx)
+{
+  MvccTrxKit kit;
+  ASSERT_EQ(RC::SUCCESS, kit.init());
+
+  VacuousLogHandler log_handler;
+
+  Trx *trx = kit.create_trx(log_handler, 100);
+  ASSERT_EQ(trx, kit.find_trx(100));
+  ASSERT_GT(kit.next_trx_id(), 100);
+  kit.destroy_trx(trx);
+  ASSERT_EQ(nullptr, kit.find_trx(100));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,206 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <cstring>
+
+#include "common/lang/bitmap.h"
+#include "common/lang/filesystem.h"
+#include "storage/record/zone_map.h"
+#include "storage/table/table.h"
+#include "gtest/gtest.h"
+
+using namespace common;
+
+/**
+ * @brief 一张两列的表：id int not null, name char(8) nullable
+ */
+class ZoneMapTest : public testing::Test
+{
+public:
+  void SetUp() override
+  {
+    vector<AttrInfoSqlNode> attrs(2);
+    attrs[0].type     = AttrType::INTS;
+    attrs[0].name     = "id";
+    attrs[0].arr_len  = 1;
+    attrs[0].dim      = 0;
+    attrs[0].nullable = false;
+    attrs[1].type     = AttrType::CHARS;
+    attrs[1].name     = "name";
+    attrs[1].arr_len  = 8;
+    attrs[1].dim      = 0;
+    attrs[1].nullable = true;
+    ASSERT_EQ(RC::SUCCESS, table_meta_.init(1, "t", nullptr, attrs, StorageFormat::ROW_FORMAT));
+
+    zone_map_.init(&table_meta_);
+    record_.resize(table_meta_.record_size());
+  }
+
+  const char *make_record(int id, const char *name)
+  {
+    memset(record_.data(), 0, record_.size());
+    memcpy(record_.data() + table_meta_.field(0)->offset(), &id, sizeof(id));
+    if (name == nullptr) {
+      Bitmap null_bitmap(record_.data() + table_meta_.null_bitmap_start(), table_meta_.field_num());
+      null_bitmap.set_bit(1);
+    } else {
+      strncpy(record_.data() + table_meta_.field(1)->offset(), name, table_meta_.field(1)->len());
+    }
+    return record_.data();
+  }
+
+protected:
+  TableMeta    table_meta_;
+  ZoneMap      zone_map_;
+  vector<char> record_;
+};
+
+TEST_F(ZoneMapTest, column_zone)
+{
+  ColumnZone zone;
+  zone.update(Value(10));
+  zone.update(Value(3));
+  zone.update(Value::NullValue());
+  zone.update(Value(7));
+  ASSERT_EQ(3, zone.value_count);
+  ASSERT_EQ(1, zone.null_count);
+  ASSERT_EQ(3, zone.min_value.get_int());
+  ASSERT_EQ(10, zone.max_value.get_int());
+}
+
+TEST_F(ZoneMapTest, filter)
+{
+  ASSERT_TRUE(zone_map_.enabled());
+  ASSERT_EQ(0, zone_map_.column_of(table_meta_.field(0)));
+  ASSERT_EQ(1, zone_map_.column_of(table_meta_.field(1)));
+
+  vector<ColumnZone> zones;
+  zone_map_.init_zones(zones);
+  zone_map_.add_record(zones, make_record(10, "bob"));
+  zone_map_.add_record(zones, make_record(20, nullptr));
+
+  auto may_match = [&zones](int column, CompOp comp, const Value &value) {
+    ZoneFilter filter;
+    filter.add(column, comp, value);
+    return filter.may_match(zones);
+  };
+
+  ASSERT_TRUE(may_match(0, CompOp::EQUAL_TO, Value(10)));
+  ASSERT_TRUE(may_match(0, CompOp::EQUAL_TO, Value(15)));
+  ASSERT_FALSE(may_match(0, CompOp::EQUAL_TO, Value(21)));
+  ASSERT_FALSE(may_match(0, CompOp::LESS_THAN, Value(10)));
+  ASSERT_TRUE(may_match(0, CompOp::LESS_EQUAL, Value(10)));
+  ASSERT_FALSE(may_match(0, CompOp::GREAT_THAN, Value(20)));
+  ASSERT_TRUE(may_match(0, CompOp::GREAT_EQUAL, Value(20)));
+  ASSERT_TRUE(may_match(0, CompOp::NOT_EQUAL, Value(10)));
+  ASSERT_TRUE(may_match(0, CompOp::LESS_THAN, Value(10.5f)));
+
+  ASSERT_TRUE(may_match(1, CompOp::EQUAL_TO, Value("bob")));
+  ASSERT_FALSE(may_match(1, CompOp::EQUAL_TO, Value("alice")));
+  ASSERT_TRUE(may_match(1, CompOp::IS, Value::NullValue()));
+  ASSERT_FALSE(may_match(0, CompOp::IS, Value::NullValue()));
+  ASSERT_TRUE(may_match(0, CompOp::NOT_IS, Value::NullValue()));
+
+  // 多个条件是 AND 关系
+  ZoneFilter filter;
+  filter.add(0, CompOp::GREAT_EQUAL, Value(10));
+  filter.add(1, CompOp::EQUAL_TO, Value("zed"));
+  ASSERT_FALSE(filter.may_match(zones));
+
+  // 全是空值的列，任何比较都不成立
+  vector<ColumnZone> null_zones;
+  zone_map_.init_zones(null_zones);
+  zone_map_.add_record(null_zones, make_record(1, nullptr));
+  filter = ZoneFilter();
+  filter.add(1, CompOp::NOT_EQUAL, Value("bob"));
+  ASSERT_FALSE(filter.may_match(null_zones));
+}
+
+TEST_F(ZoneMapTest, page_summary)
+{
+  ZoneFilter filter;
+  filter.add(0, CompOp::GREAT_THAN, Value(100));
+
+  // 没有统计信息的页面不能跳过，修改也不会生成统计信息
+  zone_map_.update(1, make_record(1, "a"));
+  ASSERT_FALSE(zone_map_.has_page(1));
+  ASSERT_TRUE(zone_map_.may_match(1, filter));
+
+  // 新页面的统计信息随着插入变宽
+  zone_map_.reset_page(2);
+  ASSERT_FALSE(zone_map_.may_match(2, filter));
+  zone_map_.update(2, make_record(50, "a"));
+  ASSERT_FALSE(zone_map_.may_match(2, filter));
+  zone_map_.update(2, make_record(200, "b"));
+  ASSERT_TRUE(zone_map_.may_match(2, filter));
+
+  // 遍历页面生成统计信息
+  vector<ColumnZone> zones;
+  zone_map_.init_zones(zones);
+  uint64_t build_id = zone_map_.begin_build();
+  zone_map_.add_record(zones, make_record(1, "a"));
+  zone_map_.finish_build(1, std::move(zones), build_id);
+  ASSERT_TRUE(zone_map_.has_page(1));
+  ASSERT_FALSE(zone_map_.may_match(1, filter));
+
+  // 遍历期间没有统计信息的页面被修改了，放弃生成的统计信息
+  zone_map_.init_zones(zones);
+  build_id = zone_map_.begin_build();
+  zone_map_.add_record(zones, make_record(1, "a"));
+  zone_map_.update(3, make_record(300, "c"));
+  zone_map_.finish_build(3, std::move(zones), build_id);
+  ASSERT_FALSE(zone_map_.has_page(3));
+  ASSERT_TRUE(zone_map_.may_match(3, filter));
+}
+
+TEST_F(ZoneMapTest, save_and_load)
+{
+  const char *file_name = "zone_map_test.zonemap";
+  filesystem::remove(file_name);
+
+  zone_map_.reset_page(1);
+  zone_map_.update(1, make_record(10, "bob"));
+  zone_map_.update(1, make_record(20, nullptr));
+  zone_map_.reset_page(2);
+  ASSERT_EQ(RC::SUCCESS, zone_map_.save(file_name));
+
+  ZoneMap loaded;
+  loaded.init(&table_meta_);
+  ASSERT_EQ(RC::SUCCESS, loaded.load(file_name));
+  ASSERT_FALSE(filesystem::exists(file_name));
+
+  ASSERT_TRUE(loaded.has_page(1));
+  ASSERT_TRUE(loaded.has_page(2));
+  ASSERT_FALSE(loaded.has_page(3));
+
+  ZoneFilter filter;
+  filter.add(0, CompOp::EQUAL_TO, Value(20));
+  ASSERT_TRUE(loaded.may_match(1, filter));
+  ASSERT_FALSE(loaded.may_match(2, filter));
+
+  filter = ZoneFilter();
+  filter.add(1, CompOp::GREAT_THAN, Value("bob"));
+  ASSERT_FALSE(loaded.may_match(1, filter));
+  filter = ZoneFilter();
+  filter.add(1, CompOp::IS, Value::NullValue());
+  ASSERT_TRUE(loaded.may_match(1, filter));
+
+  // 没有文件时所有页面都没有统计信息
+  ZoneMap empty;
+  empty.init(&table_meta_);
+  ASSERT_EQ(RC::SUCCESS, empty.load(file_name));
+  ASSERT_FALSE(empty.has_page(1));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}